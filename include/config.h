@@ -141,6 +141,11 @@
  *              the playground directory.  Commenting out LOGFILE, XLOGFILE,
  *              NEWS or PANICLOG removes that feature from the game.
  *
+ *              SCORE_INDEX names an indexed copy of the high-score list,
+ *              also in the playground.  It is built from 'record' the first
+ *              time it's needed and used in place of 'record' thereafter;
+ *              commenting it out goes back to rewriting 'record' whole.
+ *
  *              Building with debugging features enabled is now unconditional;
  *              the old WIZARD setting for that has been eliminated.
  *              If SYSCF is enabled, WIZARD_NAME will be overridden at
@@ -205,6 +210,7 @@
 #define XLOGFILE "xlogfile" /* even larger logfile */
 #define NEWS     "news"     /* the file containing the latest hack news */
 #define PANICLOG "paniclog" /* log of panic and impossible events */
+#define SCORE_INDEX "record.idx" /* indexed high-score list */
 
 /*
  *      PERSMAX, POINTSMIN, ENTRYMAX, PERS_IS_UID:
@@ -293,6 +299,20 @@
 /* # define ZEROCOMP      */ /* Support ZEROCOMP compression */
 /* # define RLECOMP       */ /* Support RLECOMP compression  */
 
+/*
+ *      Defining LZCOMP builds in support for internal Lempel-Ziv
+ *      compression of everything written to save, bones and level files.
+ *      It saves running a separate program for each file, but it is a
+ *      fast block compressor, not a replacement for COMPRESS's ratio:
+ *      save files come out about twice the size gzip makes (22 KB
+ *      against 10.8 KB for a typical game).  Save and bones files it
+ *      wrote are left alone by COMPRESS.  If LZCOMP support is included
+ *      it is used by default, ahead of ZEROCOMP, and can be turned off
+ *      via the config file option lzcomp.  Files written without it can
+ *      still be read.
+ */
+#define LZCOMP /* Support LZCOMP compression */
+
 /*
  *      Data librarian.  Defining DLB places most of the support files into
  *      a tar-like file, thus making a neater installation.  See *conf.h
@@ -307,6 +327,16 @@
  */
 #define INSURANCE /* allow crashed game recovery */
 
+/*
+ *      Defining LEVEL_STORE keeps levels that have been left in memory
+ *      instead of writing each one to a level file and reading it back
+ *      when it is revisited.  The value is how many levels to keep; the
+ *      one left longest ago goes out to its level file when there are
+ *      more.  While the checkpoint option is on, levels are still written
+ *      out as they are left so that a crashed game can be recovered.
+ */
+#define LEVEL_STORE 10 /* levels kept in memory */
+
 #ifndef MAC
 #define CHDIR /* delete if no chdir() available */
 #endif
@@ -410,10 +440,18 @@ typedef unsigned char uchar;
  * If VISION_TABLES is not defined, things will be faster if you can use
  * MACRO_CPATH.  Some cpps, however, cannot deal with the size of the
  * functions that have been macroized.
+ *
+ * VISION_BITS keeps the alternate algorithm's clear map and "could see"
+ * rows as bitsets and scans them a word at a time.  It has no effect
+ * when VISION_TABLES is defined.  "nhbench -V" (sys/unix/bench) checks
+ * that it agrees with the plain version on freshly made levels.
  */
 
 /* #define VISION_TABLES */ /* use vision tables generated at compile time */
-#ifndef VISION_TABLES
+/* #define VISION_BITS */   /* bitset rows for the alternate algorithm */
+#ifdef VISION_TABLES
+#undef VISION_BITS
+#else
 #ifndef NO_MACRO_CPATH
 #define MACRO_CPATH /* use clear_path macros instead of functions */
 #endif
@@ -444,6 +482,10 @@ typedef unsigned char uchar;
 /* #define DEBUG_MIGRATING_MONS */  /* add a wizard-mode command to help debug
                                        migrating monsters */
 
+/* #define TRAVEL_ASTAR */          /* travel toward unexplored places by
+                                       A* search through the unknown;
+                                       takes other routes than 3.6.0 */
+
 /* SCORE_ON_BOTL is neither experimental nor inadequately tested,
    but doesn't seem to fit in any other section... */
 /* #define SCORE_ON_BOTL */         /* enable the 'showscore' option to
@@ -413,6 +413,30 @@ E struct plinemsg_type *plinemsg_types;
 E char *ARGV0;
 #endif
 
+/* Optional timing hook used by the benchmark harness (sys/unix/bench);
+ * called with TRUE on entry to and FALSE on exit from the instrumented
+ * section.  Null during normal play.
+ */
+#define BENCH_MOVEMON 0
+#define BENCH_VISION 1
+#define BENCH_FLUSH 2
+#define BENCH_TIMERS 3
+#define BENCH_LEVEL 4
+#define BENCH_TRAVEL 5
+#define BENCH_MONFLOW 6
+#define NUM_BENCH_SLOTS 7
+E void FDECL((*bench_hook), (int, BOOLEAN_P));
+#define bench_begin(slot)                   \
+    do {                                    \
+        if (bench_hook)                     \
+            (*bench_hook)((slot), TRUE);    \
+    } while (0)
+#define bench_end(slot)                     \
+    do {                                    \
+        if (bench_hook)                     \
+            (*bench_hook)((slot), FALSE);   \
+    } while (0)
+
 #undef E
 
 #endif /* DECL_H */
@@ -33,6 +33,12 @@ typedef struct dlb_library {
     long nentries; /* # of files in directory */
     long rev;      /* dlb file revision */
     long strsize;  /* dlb file string size */
+#ifdef DLBMMAP
+    char *mbase;   /* whole library file mapped read-only, or null */
+    long msize;    /* size of the mapping */
+    long *hash;    /* directory indices by name hash, -1 if empty */
+    long hashsize; /* # of hash slots, a power of 2 */
+#endif
 } library;
 
 /* library definitions */
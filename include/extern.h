@@ -215,6 +215,9 @@ E boolean FDECL(paranoid_query, (BOOLEAN_P, const char *));
 
 /* ### dbridge.c ### */
 
+E void FDECL(update_bitboards, (int, int));
+E void NDECL(rebuild_bitboards);
+E void NDECL(bitboard_sanity_check);
 E boolean FDECL(is_pool, (int, int));
 E boolean FDECL(is_lava, (int, int));
 E boolean FDECL(is_pool_or_lava, (int, int));
@@ -713,6 +716,13 @@ E void FDECL(set_levelfile_name, (char *, int));
 E int FDECL(create_levelfile, (int, char *));
 E int FDECL(open_levelfile, (int, char *));
 E void FDECL(delete_levelfile, (int));
+#ifdef LEVEL_STORE
+E int FDECL(levstore_create, (int));
+E void FDECL(levstore_write, (genericptr_t, unsigned));
+E void FDECL(levstore_read, (genericptr_t, unsigned));
+E void NDECL(levstore_close);
+E void FDECL(levstore_drop, (int));
+#endif
 E void NDECL(clearlocks);
 E int FDECL(create_bonesfile, (d_level *, char **, char *));
 #ifdef MFLOPPY
@@ -867,6 +877,7 @@ E char *FDECL(strstri, (const char *, const char *));
 E boolean
 FDECL(fuzzymatch, (const char *, const char *, const char *, BOOLEAN_P));
 E void NDECL(setrandom);
+E void FDECL(seedrandom, (unsigned long));
 E time_t NDECL(getnow);
 E int NDECL(getyear);
 #if 0
@@ -1067,6 +1078,8 @@ E void FDECL(readmail, (struct obj *));
 /* ### makemon.c ### */
 
 E void FDECL(dealloc_monst, (struct monst *));
+E void FDECL(index_monst, (struct monst *));
+E struct monst *FDECL(monst_by_mid, (unsigned));
 E boolean FDECL(is_home_elemental, (struct permonst *));
 E struct monst *FDECL(clone_mon, (struct monst *, XCHAR_P, XCHAR_P));
 E int FDECL(monhp_per_lvl, (struct monst *));
@@ -1163,6 +1176,7 @@ E void FDECL(add_room, (int, int, int, int, BOOLEAN_P, SCHAR_P, BOOLEAN_P));
 E void FDECL(add_subroom, (struct mkroom *, int, int, int, int, BOOLEAN_P,
                            SCHAR_P, BOOLEAN_P));
 E void NDECL(makecorridors);
+E void NDECL(clear_level_structures);
 E void FDECL(add_door, (int, int, struct mkroom *));
 E void NDECL(mklev);
 #ifdef SPECIALIZATION
@@ -1250,10 +1264,13 @@ E void FDECL(uncurse, (struct obj *));
 E void FDECL(blessorcurse, (struct obj *, int));
 E boolean FDECL(is_flammable, (struct obj *));
 E boolean FDECL(is_rottable, (struct obj *));
+E int FDECL(objsum_bit, (int));
 E void FDECL(place_object, (struct obj *, int, int));
 E void FDECL(remove_object, (struct obj *));
 E void FDECL(discard_minvent, (struct monst *));
 E void FDECL(obj_extract_self, (struct obj *));
+E void FDECL(link_nobj, (struct obj *, struct obj **));
+E void FDECL(relink_nobj, (struct obj *));
 E void FDECL(extract_nobj, (struct obj *, struct obj **));
 E void FDECL(extract_nexthere, (struct obj *, struct obj **));
 E int FDECL(add_to_minv, (struct monst *, struct obj *));
@@ -1261,6 +1278,8 @@ E struct obj *FDECL(add_to_container, (struct obj *, struct obj *));
 E void FDECL(add_to_migration, (struct obj *));
 E void FDECL(add_to_buried, (struct obj *));
 E void FDECL(dealloc_obj, (struct obj *));
+E void FDECL(index_obj, (struct obj *));
+E struct obj *FDECL(obj_by_oid, (unsigned, BOOLEAN_P));
 E void FDECL(obj_ice_effects, (int, int, BOOLEAN_P));
 E long FDECL(peek_at_iced_corpse_age, (struct obj *));
 E int FDECL(hornoplenty, (struct obj *, BOOLEAN_P));
@@ -1534,6 +1553,10 @@ E boolean FDECL(regex_compile, (const char *, struct nhregex *));
 E const char *FDECL(regex_error_desc, (struct nhregex *));
 E boolean FDECL(regex_match, (const char *, struct nhregex *));
 E void FDECL(regex_free, (struct nhregex *));
+E struct nhregex_set *NDECL(regex_set_init);
+E void FDECL(regex_set_add, (struct nhregex_set *, struct nhregex *));
+E int FDECL(regex_set_match, (const char *, struct nhregex_set *, int));
+E void FDECL(regex_set_free, (struct nhregex_set *));
 
 /* ### nttty.c ### */
 
@@ -1642,6 +1665,7 @@ E void FDECL(set_wc2_option_mod_status, (unsigned long, int));
 E void FDECL(set_option_mod_status, (const char *, int));
 E int FDECL(add_autopickup_exception, (const char *));
 E void NDECL(free_autopickup_exceptions);
+E struct nhregex_set *FDECL(autopickup_exception_set, (BOOLEAN_P));
 E int FDECL(load_symset, (const char *, int));
 E void NDECL(free_symsets);
 E void FDECL(parsesymbols, (char *));
@@ -2021,6 +2045,7 @@ E const char *NDECL(Goodbye);
 
 E char *FDECL(getrumor, (int, char *, BOOLEAN_P));
 E char *FDECL(get_rnd_text, (const char *, char *));
+E void NDECL(free_rumors);
 E void FDECL(outrumor, (int, int));
 E void FDECL(outoracle, (BOOLEAN_P, BOOLEAN_P));
 E void FDECL(save_oracles, (int, int));
@@ -2053,6 +2078,9 @@ E void FDECL(def_bclose, (int));
 #if defined(ZEROCOMP)
 E void FDECL(zerocomp_bclose, (int));
 #endif
+#if defined(LZCOMP)
+E void FDECL(lzcomp_bclose, (int));
+#endif
 E void FDECL(savecemetery, (int, int, struct cemetery **));
 E void FDECL(savefruitchn, (int, int));
 E void FDECL(store_plname_in_file, (int));
@@ -2180,6 +2208,7 @@ E boolean
 FDECL(dig_corridor, (coord *, coord *, BOOLEAN_P, SCHAR_P, SCHAR_P));
 E void FDECL(fill_room, (struct mkroom *, BOOLEAN_P));
 E boolean FDECL(load_special, (const char *));
+E void NDECL(free_splev_cache);
 
 /* ### spell.c ### */
 
@@ -2297,6 +2326,9 @@ E void FDECL(formatkiller, (char *, unsigned, int));
 E void FDECL(topten, (int, time_t));
 E void FDECL(prscore, (int, char **));
 E struct obj *FDECL(tt_oname, (struct obj *));
+#ifdef SCORE_INDEX
+E boolean NDECL(score_index_bloated);
+#endif
 
 /* ### track.c ### */
 
@@ -2490,6 +2522,10 @@ E void FDECL(vision_recalc, (int));
 E void FDECL(block_point, (int, int));
 E void FDECL(unblock_point, (int, int));
 E boolean FDECL(clear_path, (int, int, int, int));
+E void FDECL(light_area, (int, int, int, char **));
+#ifdef VISION_BITS
+E int NDECL(vision_diff);
+#endif
 E void FDECL(do_clear_area, (int, int, int,
                              void (*)(int, int, genericptr), genericptr_t));
 E unsigned FDECL(howmonseen, (struct monst *));
@@ -183,6 +183,7 @@ struct instance_flags {
     boolean vision_inited; /* true if vision is ready */
     boolean sanity_check;  /* run sanity checks */
     boolean mon_polycontrol; /* debug: control monster polymorphs */
+    boolean mon_flow;      /* debug: monsters approach by walking distance */
     /* stuff that is related to options and/or user or platform preferences */
     unsigned msg_history; /* hint: # of top lines to save */
     int menu_headings;    /* ATR for menu headings */
@@ -205,6 +206,7 @@ struct instance_flags {
     boolean renameinprogress; /* we are changing hero name */
     boolean toptenwin;        /* ending list in window instead of stdout */
     boolean zerocomp;         /* write zero-compressed save files */
+    boolean lzcomp;           /* write Lempel-Ziv compressed save files */
     boolean rlecomp; /* run-length comp of levels when writing savefile */
     uchar num_pad_mode;
     boolean echo;             /* 1 to echo characters */
@@ -22,6 +22,7 @@
 #define RUMORFILE "rumors"      /* file with fortune cookies */
 #define ORACLEFILE "oracles"    /* file with oracular information */
 #define DATAFILE "data"         /* file giving the meaning of symbols used */
+#define DATAIDXFILE "dataidx"   /* hashed index of the keys in DATAFILE */
 #define CMDHELPFILE "cmdhelp"   /* file telling what commands do */
 #define HISTORY "history"       /* file giving nethack's history */
 #define LICENSE "license"       /* file with license information */
@@ -147,6 +148,15 @@ typedef uchar nhsym;
 #endif
 #endif
 
+#ifdef LEVEL_STORE
+#ifdef MFLOPPY /* has its own scheme for moving level files around */
+#undef LEVEL_STORE
+#else
+/* stands for a level held in memory; never a real file descriptor */
+#define LEVSTORE_FD ((int) (~0U >> 1))
+#endif
+#endif
+
 /* Displayable name of this port; don't redefine if defined in *conf.h */
 #ifndef PORT_ID
 #ifdef AMIGA
@@ -279,6 +289,26 @@ struct version_info {
     unsigned long struct_sizes2; /* size of more key structs */
 };
 
+/* Layout of DATAIDXFILE, written by 'makedefs -d' and read by checkfile()
+   in pager.c.  Every field is a 32-bit little-endian word.  The header
+   (magic, version, DATAFILE's text offset, # of hash buckets, # of keys,
+   # of wildcard keys, size of the string area) is followed by the
+   buckets, the key records, the wildcard list and the key strings.  A
+   bucket holds the first literal key hashing to it; a key record is next
+   key in that chain, string offset, entry number, flags, text offset and
+   line count; the wildcard list pairs key number with string offset.
+   Keys stay in DATAFILE order, which decides between multiple matches. */
+#define DATAIDX_MAGIC 0x78644e48UL /* "NHdx" */
+#define DATAIDX_VERSION 1UL
+#define DATAIDX_HDRSIZ 7 /* words */
+#define DATAIDX_KEYSIZ 6 /* words */
+#define DATAIDX_WILDSIZ 2 /* words */
+#define DATAIDX_NONE 0xffffffffUL
+#define DATAIDX_TILDE 0x1UL /* "~key": a match skips the rest of the entry */
+#define DATAIDX_HASHINIT 2166136261UL /* FNV-1a */
+#define DATAIDX_HASH(h, c) \
+    ((((h) ^ (unsigned long) (uchar) (c)) * 16777619UL) & 0xffffffffUL)
+
 struct savefile_info {
     unsigned long sfi1; /* compression etc. */
     unsigned long sfi2; /* miscellaneous */
@@ -288,10 +318,12 @@ struct savefile_info {
 #define SFI1_EXTERNALCOMP (1UL)
 #define SFI1_RLECOMP (1UL << 1)
 #define SFI1_ZEROCOMP (1UL << 2)
+#define SFI1_LZCOMP (1UL << 3)
 #else
 #define SFI1_EXTERNALCOMP (1L)
 #define SFI1_RLECOMP (1L << 1)
 #define SFI1_ZEROCOMP (1L << 2)
+#define SFI1_LZCOMP (1L << 3)
 #endif
 
 /*
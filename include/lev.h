@@ -17,6 +17,10 @@
 #define perform_bwrite(mode) ((mode) & (COUNT_SAVE | WRITE_SAVE))
 #define release_data(mode) ((mode) &FREE_SAVE)
 
+/* LZCOMP save files; the block format is described in save.c */
+#define LZ_BLOCK 32768 /* most uncompressed bytes in one block */
+#define LZ_MINMATCH 4  /* shortest match, what a match length counts from */
+
 /* The following are used in mkmaze.c */
 struct container {
     struct container *next;
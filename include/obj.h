@@ -119,8 +119,17 @@ struct obj {
     long age;               /* creation date */
     long owornmask;
     struct oextra *oextra; /* pointer to oextra struct */
+
+    /* back links, so that extraction needn't search the chains; these
+       follow the saved part of the structure and are rebuilt on restore */
+    struct obj *oprev;     /* previous object in nobj chain */
+    struct obj *oprevhere; /* previous object in nexthere chain (floor) */
 };
 
+/* the part of struct obj written to save and bones files: all but the
+   two back links at the end */
+#define OBJ_SAVESZ (sizeof(struct obj) - 2 * sizeof(struct obj *))
+
 #define newobj() (struct obj *) alloc(sizeof(struct obj))
 
 /***
@@ -562,6 +562,35 @@ struct levelflags {
                                   rather than ROOM */
 };
 
+/*
+ * Bitboards of the current level, bit y of [x] being set for <x,y>, for
+ * the water and lava tests made on every square a monster thinks of
+ * moving to.  update_bitboards() must be called whenever a location
+ * becomes or stops being one of these; until mklev() or getlev() has
+ * built them, the tests look at levl[][] instead.
+ */
+#define BB_POOL 0 /* is_pool() */
+#define BB_LAVA 1 /* is_lava() */
+#define NUM_BITBOARDS 2
+
+#define bitboard_at(b, x, y) ((level.bitboards[b][x] >> (y)) & 1L)
+
+/*
+ * Summary of the object pile at each location, kept by place_object()
+ * and remove_object() so that the common "is there a boulder here?"
+ * questions needn't walk the nexthere chain.  A bit is set whenever
+ * an object of its kind is present; it may stay set after such an
+ * object changes type in place, so a set bit means "look", while a
+ * clear bit means "there is none".
+ */
+#define OSUM_BOULDER 0x01   /* BOULDER */
+#define OSUM_SCARE 0x02     /* SCR_SCARE_MONSTER */
+#define OSUM_CONTAINER 0x04 /* Is_container() */
+#define OSUM_CORPSE 0x08    /* CORPSE */
+#define OSUM_GOLD 0x10      /* COIN_CLASS */
+
+#define objsum_at(f, x, y) (level.objsummary[x][y] & (f))
+
 typedef struct {
     struct rm locations[COLNO][ROWNO];
 #ifndef MICROPORT_BUG
@@ -573,12 +602,18 @@ typedef struct {
     struct monst *monsters[1][ROWNO];
     char *yuk2[COLNO - 1][ROWNO];
 #endif
+    struct trap *traps[COLNO][ROWNO];      /* ftrap by location */
+    struct engr *engravings[COLNO][ROWNO]; /* head_engr by location */
+    uchar objsummary[COLNO][ROWNO];        /* OSUM_xxx of objects[][] */
+    unsigned short objcount[COLNO][ROWNO]; /* length of objects[][] */
     struct obj *objlist;
     struct obj *buriedobjlist;
     struct monst *monlist;
     struct damage *damagelist;
     struct cemetery *bonesinfo;
     struct levelflags flags;
+    unsigned long bitboards[NUM_BITBOARDS][COLNO];
+    boolean bitboards_ok;
 } dlevel_t;
 
 extern schar lastseentyp[COLNO][ROWNO]; /* last seen/touched dungeon typ */
@@ -200,7 +200,8 @@ enum opcode_defs {
 #define SPOVAR_NULL 0x00
 #define SPOVAR_INT 0x01      /* l */
 #define SPOVAR_STRING 0x02   /* str */
-#define SPOVAR_VARIABLE 0x03 /* str (contains the variable name) */
+#define SPOVAR_VARIABLE 0x03 /* str (contains the variable name); once
+                                loaded by the game, l is its slot */
 #define SPOVAR_COORD \
     0x04 /* coordinate, encoded in l; use SP_COORD_X() and SP_COORD_Y() */
 #define SPOVAR_REGION 0x05  /* region, encoded in l; use SP_REGION_X1() etc \
@@ -212,7 +213,8 @@ enum opcode_defs {
 #define SPOVAR_OBJ                                                 \
     0x08 /* object class & specific object type, encoded in l; use \
             SP_OBJ_... */
-#define SPOVAR_SEL 0x09   /* selection. char[COLNO][ROWNO] in str */
+#define SPOVAR_SEL 0x09   /* selection. char[ROWNO][COLNO] in str; in sel \
+                             once the game has loaded it */
 #define SPOVAR_ARRAY 0x40 /* used in splev_var & lc_vardefs, not in opvar */
 
 #define SP_COORD_IS_RANDOM 0x01000000
@@ -250,18 +252,25 @@ enum opcode_defs {
 #define SP_MAPCHAR_LIT(l) ((l >> 8) & 0xff)
 #define SP_MAPCHAR_PACK(typ, lit) (((lit) << 8) + ((char) (typ)))
 
+/* a selection of map locations: bit y of col[x] is set if <x,y> is in
+   it, so ROWNO must fit in the 32 bits a long is sure to have */
+struct selectionvar {
+    unsigned long col[COLNO];
+};
+
 struct opvar {
     xchar spovartyp; /* one of SPOVAR_foo */
     union {
         char *str;
+        struct selectionvar *sel; /* once the game has loaded it */
         long l;
+        struct opvar *nextfree; /* while in the game's free list */
     } vardata;
 };
 
+/* one of a frame's variable slots */
 struct splev_var {
-    struct splev_var *next;
-    char *name;
-    xchar svtyp; /* SPOVAR_foo */
+    xchar svtyp; /* SPOVAR_foo; SPOVAR_NULL until it is set */
     union {
         struct opvar *value;
         struct opvar **arrayvalues;
@@ -278,7 +287,7 @@ struct splevstack {
 struct sp_frame {
     struct sp_frame *next;
     struct splevstack *stack;
-    struct splev_var *variables;
+    struct splev_var *variables; /* n_vars slots, made on first use */
     long n_opcode;
 };
 
@@ -297,6 +306,9 @@ struct sp_coder {
 
     int opcode;          /* current opcode */
     struct opvar *opdat; /* current push data (req. opcode == SPO_PUSH) */
+    long n_opcodes;      /* length of the level's code */
+    int n_vars;          /* number of variable slots */
+    long room_stack;     /* rooms skipped inside a room that failed */
 };
 
 /* special level coder CPU flags */
@@ -443,6 +455,7 @@ typedef struct {
 typedef struct {
     _opcode *opcodes;
     long n_opcodes;
+    int n_vars; /* variable slots, counted by the game's loader */
 } sp_lev;
 
 typedef struct {
@@ -33,7 +33,7 @@ typedef void FDECL((*timeout_proc), (ANY_P *, long));
 
 /* used in timeout.c */
 typedef struct fe {
-    struct fe *next;          /* next item in chain */
+    struct fe *next;          /* unused; kept for the save file layout */
     long timeout;             /* when we time out */
     unsigned long tid;        /* timer ID */
     short kind;               /* kind of use */
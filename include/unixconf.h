@@ -216,6 +216,17 @@
 #define USE_FCNTL
 #endif
 
+/* Define LOGAPPEND to add each LOGFILE and XLOGFILE entry with one
+ * write(2) to a file opened with O_APPEND, rather than taking a lock_file()
+ * lock around it; appends that small are not interleaved with others. */
+#define LOGAPPEND
+
+/* Define DLBMMAP to map the DLB library file read-only with mmap(2) and
+ * serve reads straight from the mapping, so every running game shares
+ * the same page-cached copy of nhdat; directory lookups use a hash table
+ * built when the library is opened.  Falls back to stdio if the map fails. */
+#define DLBMMAP
+
 /*
  * The remainder of the file should not need to be changed.
  */
@@ -130,6 +130,10 @@ E void NDECL(backsp);
 E void NDECL(graph_on);
 E void NDECL(graph_off);
 E void NDECL(cl_eos);
+#ifndef NO_TERMS
+E void FDECL(shadow_glyph, (int, int, int, int));
+E void FDECL(shadow_forget, (int));
+#endif
 
 /*
  * termcap.c (or facsimiles in other ports) is the right place for doing
@@ -101,7 +101,9 @@ boolean resuming;
 
                 context.mon_moving = TRUE;
                 do {
+                    bench_begin(BENCH_MOVEMON);
                     monscanmove = movemon();
+                    bench_end(BENCH_MOVEMON);
                     if (youmonst.movement >= NORMAL_SPEED)
                         break; /* it's now your turn */
                 } while (monscanmove);
@@ -3207,6 +3207,7 @@ struct obj *obj;
                 typ = fillholetyp(x, y, FALSE);
                 if (typ != ROOM) {
                     levl[x][y].typ = typ;
+                    update_bitboards(x, y);
                     liquid_flow(x, y, typ, t_at(x, y),
                                 fillmsg
                                   ? (char *) 0
@@ -576,6 +576,7 @@ getbones()
         if (wizard) {
             if (yn("Get bones?") == 'n') {
                 (void) nhclose(fd);
+                reset_restpref();
                 compress_bonesfile();
                 return 0;
             }
@@ -622,6 +623,7 @@ getbones()
         }
     }
     (void) nhclose(fd);
+    reset_restpref(); /* validate() matched it to the bones file */
     sanitize_engravings();
     u.uroleplay.numbones++;
 
@@ -3079,6 +3079,7 @@ sanity_check()
     timer_sanity_check();
     mon_sanity_check();
     light_sources_sanity_check();
+    bitboard_sanity_check();
 }
 
 #ifdef DEBUG_MIGRATING_MONS
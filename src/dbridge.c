@@ -32,16 +32,16 @@ STATIC_DCL boolean FDECL(automiss, (struct entity *));
 STATIC_DCL boolean FDECL(e_missed, (struct entity *, BOOLEAN_P));
 STATIC_DCL boolean FDECL(e_jumps, (struct entity *));
 STATIC_DCL void FDECL(do_entity, (struct entity *));
+STATIC_DCL boolean FDECL(pool_terrain, (int, int));
+STATIC_DCL boolean FDECL(lava_terrain, (int, int));
 
-boolean
-is_pool(x, y)
+/* is_pool() from levl[][] */
+STATIC_OVL boolean
+pool_terrain(x, y)
 int x, y;
 {
-    schar ltyp;
+    schar ltyp = levl[x][y].typ;
 
-    if (!isok(x, y))
-        return FALSE;
-    ltyp = levl[x][y].typ;
     /* The ltyp == MOAT is not redundant with is_moat, because the
      * Juiblex level does not have moats, although it has MOATs. There
      * is probably a better way to express this. */
@@ -50,15 +50,13 @@ int x, y;
     return FALSE;
 }
 
-boolean
-is_lava(x, y)
+/* is_lava() from levl[][] */
+STATIC_OVL boolean
+lava_terrain(x, y)
 int x, y;
 {
-    schar ltyp;
+    schar ltyp = levl[x][y].typ;
 
-    if (!isok(x, y))
-        return FALSE;
-    ltyp = levl[x][y].typ;
     if (ltyp == LAVAPOOL
         || (ltyp == DRAWBRIDGE_UP
             && (levl[x][y].drawbridgemask & DB_UNDER) == DB_LAVA))
@@ -66,6 +64,76 @@ int x, y;
     return FALSE;
 }
 
+/* <x,y> may have become or stopped being water or lava */
+void
+update_bitboards(x, y)
+int x, y;
+{
+    unsigned long bit = 1L << y;
+
+    if (!isok(x, y))
+        return;
+    level.bitboards[BB_POOL][x] &= ~bit;
+    level.bitboards[BB_LAVA][x] &= ~bit;
+    if (pool_terrain(x, y))
+        level.bitboards[BB_POOL][x] |= bit;
+    if (lava_terrain(x, y))
+        level.bitboards[BB_LAVA][x] |= bit;
+}
+
+/* build the bitboards for a level which has just been made or loaded */
+void
+rebuild_bitboards()
+{
+    int x, y;
+
+    (void) memset((genericptr_t) level.bitboards, 0,
+                  sizeof level.bitboards);
+    for (x = 1; x < COLNO; x++)
+        for (y = 0; y < ROWNO; y++)
+            update_bitboards(x, y);
+    level.bitboards_ok = TRUE;
+}
+
+/* support for wizard-mode's `sanity_check' option */
+void
+bitboard_sanity_check()
+{
+    int x, y;
+
+    if (!level.bitboards_ok)
+        return;
+    for (x = 1; x < COLNO; x++)
+        for (y = 0; y < ROWNO; y++) {
+            if (!bitboard_at(BB_POOL, x, y) != !pool_terrain(x, y))
+                impossible("pool bitboard wrong at <%d,%d>", x, y);
+            if (!bitboard_at(BB_LAVA, x, y) != !lava_terrain(x, y))
+                impossible("lava bitboard wrong at <%d,%d>", x, y);
+        }
+}
+
+boolean
+is_pool(x, y)
+int x, y;
+{
+    if (!isok(x, y))
+        return FALSE;
+    if (level.bitboards_ok)
+        return (boolean) bitboard_at(BB_POOL, x, y);
+    return pool_terrain(x, y);
+}
+
+boolean
+is_lava(x, y)
+int x, y;
+{
+    if (!isok(x, y))
+        return FALSE;
+    if (level.bitboards_ok)
+        return (boolean) bitboard_at(BB_LAVA, x, y);
+    return lava_terrain(x, y);
+}
+
 boolean
 is_pool_or_lava(x, y)
 int x, y;
@@ -788,6 +856,7 @@ int x, y;
     else /* "5 gears turn" for castle drawbridge tune */
         You_hear("chains rattling and gears turning.");
     lev1->typ = DRAWBRIDGE_UP;
+    update_bitboards(x, y);
     lev2 = &levl[x2][y2];
     lev2->typ = DBWALL;
     switch (lev1->drawbridgemask & DB_DIR) {
@@ -847,6 +916,7 @@ int x, y;
     else /* "5 gears turn" for castle drawbridge tune */
         You_hear("gears turning and chains rattling.");
     lev1->typ = DRAWBRIDGE_DOWN;
+    update_bitboards(x, y);
     lev2 = &levl[x2][y2];
     lev2->typ = DOOR;
     lev2->doormask = D_NODOOR;
@@ -911,6 +981,7 @@ int x, y;
         }
         lev1->typ = lava ? LAVAPOOL : MOAT;
         lev1->drawbridgemask = 0;
+        update_bitboards(x, y);
         if ((otmp2 = sobj_at(BOULDER, x, y)) != 0) {
             obj_extract_self(otmp2);
             (void) flooreffects(otmp2, x, y, "fall");
@@ -922,6 +993,7 @@ int x, y;
             You_hear("a loud *CRASH*!");
         lev1->typ = ((lev1->drawbridgemask & DB_ICE) ? ICE : ROOM);
         lev1->icedpool = ((lev1->drawbridgemask & DB_ICE) ? ICED_MOAT : 0);
+        update_bitboards(x, y);
     }
     wake_nearto(x, y, 500);
     lev2->typ = DOOR;
@@ -297,6 +297,9 @@ NEARDATA struct savefile_info sfcap = {
 #endif
 #if defined(RLECOMP)
         | SFI1_RLECOMP
+#endif
+#if defined(LZCOMP)
+        | SFI1_LZCOMP
 #endif
     ,
 #ifdef NHSTDC
@@ -335,6 +338,8 @@ struct plinemsg_type *plinemsg_types = (struct plinemsg_type *) 0;
 char *ARGV0;
 #endif
 
+void FDECL((*bench_hook), (int, BOOLEAN_P)) = 0;
+
 /* support for lint.h */
 unsigned nhUse_dummy = 0;
 
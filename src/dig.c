@@ -79,6 +79,7 @@ boolean waslit, rockit;
     /* short-circuit vision recalc */
     viz_array[y][x] = (dist < 3) ? (IN_SIGHT | COULD_SEE) : COULD_SEE;
     lev->typ = (rockit ? STONE : ROOM);
+    update_bitboards(x, y);
     if (dist >= 3)
         impossible("mkcavepos called with dist %d", dist);
     feel_newsym(x, y);
@@ -838,6 +839,7 @@ coord *cc;
 
         lev->drawbridgemask &= ~DB_UNDER;
         lev->drawbridgemask |= (typ == LAVAPOOL) ? DB_LAVA : DB_MOAT;
+        update_bitboards(dig_x, dig_y);
         liquid_flow(dig_x, dig_y, typ, ttmp,
                     "As you dig, the hole fills with %s!");
         return TRUE;
@@ -854,6 +856,7 @@ coord *cc;
 
         if (typ != ROOM) {
             lev->typ = typ;
+            update_bitboards(dig_x, dig_y);
             liquid_flow(dig_x, dig_y, typ, ttmp,
                         "As you dig, the hole fills with %s!");
             return TRUE;
@@ -1678,6 +1681,7 @@ schar filltyp;
 
         t = *trap;
         levl[trap->tx][trap->ty].typ = filltyp;
+        update_bitboards(trap->tx, trap->ty);
         liquid_flow(trap->tx, trap->ty, filltyp, trap,
                     (trap->tx == u.ux && trap->ty == u.uy)
                         ? "Suddenly %s flows in from the adjacent pit!"
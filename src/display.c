@@ -1490,6 +1490,7 @@ int cursor_on_u;
     if (program_state.done_hup)
         return;
 #endif
+    bench_begin(BENCH_FLUSH);
 
     for (y = 0; y < ROWNO; y++) {
         register gbuf_entry *gptr = &gbuf[y][x = gbuf_start[y]];
@@ -1507,6 +1508,7 @@ int cursor_on_u;
     flushing = 0;
     if (context.botl || context.botlx)
         bot();
+    bench_end(BENCH_FLUSH);
 }
 
 /* =========================================================================
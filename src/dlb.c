@@ -9,6 +9,12 @@
 #include <string.h>
 #endif
 
+#if defined(DLB) && defined(DLBMMAP)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
 #define DATAPREFIX 4
 
 #if defined(OVERLAY)
@@ -62,6 +68,12 @@ extern FILE *FDECL(fopen_datafile, (const char *, const char *, int));
 static library dlb_libs[MAX_LIBS];
 
 STATIC_DCL boolean FDECL(readlibdir, (library * lp));
+#ifdef DLBMMAP
+STATIC_DCL unsigned long FDECL(hash_name, (const char *));
+STATIC_DCL void FDECL(hash_libdir, (library *));
+STATIC_DCL void FDECL(map_library, (library *));
+#endif
+STATIC_DCL long FDECL(lookup_libdir, (library *, const char *));
 STATIC_DCL boolean FDECL(find_file, (const char *name, library **lib,
                                      long *startp, long *sizep));
 STATIC_DCL boolean NDECL(lib_dlb_init);
@@ -168,6 +180,112 @@ library *lp; /* library pointer to fill in */
     return TRUE;
 }
 
+#ifdef DLBMMAP
+/*
+ * Hash a file name for the directory index.  Letters are folded to
+ * lower case so that names FILENAME_CMP considers equal always hash
+ * alike, whichever comparison a port uses.
+ */
+STATIC_OVL unsigned long
+hash_name(name)
+const char *name;
+{
+    unsigned long h = 2166136261UL; /* FNV-1a */
+    char c;
+
+    while ((c = *name++) != '\0') {
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        h = ((h ^ (unsigned char) c) * 16777619UL) & 0xffffffffUL;
+    }
+    return h;
+}
+
+/*
+ * Build an open-addressed hash index over the library directory so
+ * that dlb_fopen() needn't compare against every name.  Entries are
+ * inserted in directory order; with linear probing, a name listed twice
+ * still resolves to its first entry, as the linear search did.
+ */
+STATIC_OVL void
+hash_libdir(lp)
+library *lp;
+{
+    long i, h, mask;
+
+    for (lp->hashsize = 16; lp->hashsize < 2 * lp->nentries;)
+        lp->hashsize <<= 1;
+    mask = lp->hashsize - 1;
+    lp->hash = (long *) alloc(lp->hashsize * sizeof(long));
+    for (h = 0; h < lp->hashsize; h++)
+        lp->hash[h] = -1L;
+    for (i = 0; i < lp->nentries; i++) {
+        for (h = (long) (hash_name(lp->dir[i].fname) & mask);
+             lp->hash[h] >= 0; h = (h + 1) & mask)
+            continue;
+        lp->hash[h] = i;
+    }
+}
+
+/*
+ * Map the whole library read-only.  Pages come straight from the page
+ * cache, so concurrent games share one copy of the data.  If the map
+ * can't be made, or the directory doesn't fit inside the file, mbase
+ * stays null and reads go through stdio as before.
+ */
+STATIC_OVL void
+map_library(lp)
+library *lp;
+{
+    struct stat st;
+    genericptr_t base;
+    long i;
+
+    lp->mbase = (char *) 0;
+    lp->msize = 0L;
+    if (fstat(fileno(lp->fdata), &st) < 0 || st.st_size <= 0)
+        return;
+    for (i = 0; i < lp->nentries; i++)
+        if (lp->dir[i].foffset < 0L || lp->dir[i].fsize < 0L
+            || lp->dir[i].foffset + lp->dir[i].fsize > (long) st.st_size)
+            return;
+    base = mmap((genericptr_t) 0, (size_t) st.st_size, PROT_READ, MAP_SHARED,
+                fileno(lp->fdata), (off_t) 0);
+    if (base == MAP_FAILED)
+        return;
+    lp->mbase = (char *) base;
+    lp->msize = (long) st.st_size;
+}
+#endif /* DLBMMAP */
+
+/*
+ * Return the directory index of the named file in the given library,
+ * or -1 if it isn't there.
+ */
+STATIC_OVL long
+lookup_libdir(lp, name)
+library *lp;
+const char *name;
+{
+    long j;
+
+#ifdef DLBMMAP
+    if (lp->hash) {
+        long mask = lp->hashsize - 1;
+
+        for (j = (long) (hash_name(name) & mask); lp->hash[j] >= 0;
+             j = (j + 1) & mask)
+            if (FILENAME_CMP(name, lp->dir[lp->hash[j]].fname) == 0)
+                return lp->hash[j];
+        return -1L;
+    }
+#endif
+    for (j = 0; j < lp->nentries; j++)
+        if (FILENAME_CMP(name, lp->dir[j].fname) == 0)
+            return j;
+    return -1L;
+}
+
 /*
  * Look for the file in our directory structure.  Return 1 if successful,
  * 0 if not found.  Fill in the size and starting position.
@@ -178,18 +296,17 @@ const char *name;
 library **lib;
 long *startp, *sizep;
 {
-    int i, j;
+    int i;
+    long j;
     library *lp;
 
     for (i = 0; i < MAX_LIBS && dlb_libs[i].fdata; i++) {
         lp = &dlb_libs[i];
-        for (j = 0; j < lp->nentries; j++) {
-            if (FILENAME_CMP(name, lp->dir[j].fname) == 0) {
-                *lib = lp;
-                *startp = lp->dir[j].foffset;
-                *sizep = lp->dir[j].fsize;
-                return TRUE;
-            }
+        if ((j = lookup_libdir(lp, name)) >= 0) {
+            *lib = lp;
+            *startp = lp->dir[j].foffset;
+            *sizep = lp->dir[j].fsize;
+            return TRUE;
         }
     }
     *lib = (library *) 0;
@@ -211,6 +328,10 @@ library *lp;
     lp->fdata = fopen_datafile(lib_name, RDBMODE, DATAPREFIX);
     if (lp->fdata) {
         if (readlibdir(lp)) {
+#ifdef DLBMMAP
+            hash_libdir(lp);
+            map_library(lp);
+#endif
             status = TRUE;
         } else {
             (void) fclose(lp->fdata);
@@ -224,6 +345,12 @@ void
 close_library(lp)
 library *lp;
 {
+#ifdef DLBMMAP
+    if (lp->mbase)
+        (void) munmap((genericptr_t) lp->mbase, (size_t) lp->msize);
+    if (lp->hash)
+        free((genericptr_t) lp->hash);
+#endif
     (void) fclose(lp->fdata);
     free((genericptr_t) lp->dir);
     free((genericptr_t) lp->sspace);
@@ -233,7 +360,8 @@ library *lp;
 
 /*
  * Open the library file once using stdio.  Keep it open, but
- * keep track of the file position.
+ * keep track of the file position.  With DLBMMAP the file is also
+ * mapped, and reads are served from the mapping instead.
  */
 STATIC_OVL boolean
 lib_dlb_init(VOID_ARGS)
@@ -308,6 +436,15 @@ dlb *dp;
     if (quan == 0)
         return 0;
 
+#ifdef DLBMMAP
+    if (dp->lib->mbase) {
+        nbytes = (long) quan * size;
+        (void) memcpy(buf, dp->lib->mbase + dp->start + dp->mark,
+                      (size_t) nbytes);
+        dp->mark += nbytes;
+        return quan;
+    }
+#endif
     pos = dp->start + dp->mark;
     if (dp->lib->fmark != pos) {
         fseek(dp->lib->fdata, pos, SEEK_SET); /* check for error??? */
@@ -367,6 +504,21 @@ dlb *dp;
         return (char *) 0;
 
     len--; /* save room for null */
+#ifdef DLBMMAP
+    if (dp->lib->mbase) {
+        /* copy up to and including the newline in one go */
+        const char *p = dp->lib->mbase + dp->start + dp->mark, *nl;
+        long n = dp->size - dp->mark;
+
+        if (n > (long) len)
+            n = (long) len;
+        if ((nl = (const char *) memchr(p, '\n', (size_t) n)) != 0)
+            n = (long) (nl - p) + 1L;
+        (void) memcpy(buf, p, (size_t) n);
+        dp->mark += n;
+        bp = buf + n;
+    } else
+#endif
     for (i = 0, bp = buf; i < len && dp->mark < dp->size && c != '\n';
          i++, bp++) {
         if (dlb_fread(bp, 1, 1, dp) <= 0)
@@ -391,6 +543,14 @@ dlb *dp;
 {
     char c;
 
+#ifdef DLBMMAP
+    if (dp->lib->mbase) {
+        if (dp->mark >= dp->size)
+            return EOF;
+        c = dp->lib->mbase[dp->start + dp->mark++];
+        return (int) c;
+    }
+#endif
     if (lib_dlb_fread(&c, 1, 1, dp) != 1)
         return EOF;
     return (int) c;
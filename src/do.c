@@ -66,6 +66,7 @@ boolean pushing;
                 levl[rx][ry].drawbridgemask |= DB_FLOOR;
             } else
                 levl[rx][ry].typ = ROOM;
+            update_bitboards(rx, ry);
 
             if (ttmp)
                 (void) delfloortrap(ttmp);
@@ -1163,9 +1164,15 @@ boolean at_stairs, falling, portal;
     if (u.utrap && u.utraptype == TT_BURIEDBALL)
         buried_ball_to_punishment(); /* (before we save/leave old level) */
 
+#ifdef LEVEL_STORE
+    mark_synch();
+    fd = levstore_create(ledger_no(&u.uz)); /* keep it in memory */
+#else
     fd = currentlevel_rewrite();
     if (fd < 0)
         return;
+#endif
+    bench_begin(BENCH_LEVEL); /* through loading or making the new level */
 
     if (falling) /* assuming this is only trap door or hole */
         impact_drop((struct obj *) 0, u.ux, u.uy, newlevel->dlevel);
@@ -1262,6 +1269,7 @@ boolean at_stairs, falling, portal;
         (void) nhclose(fd);
         oinit(); /* reassign level dependent obj probabilities */
     }
+    bench_end(BENCH_LEVEL);
     reglyph_darkroom();
     /* do this prior to level-change pline messages */
     vision_reset();         /* clear old level's line-of-sight */
@@ -241,14 +241,9 @@ struct engr *
 engr_at(x, y)
 xchar x, y;
 {
-    register struct engr *ep = head_engr;
-
-    while (ep) {
-        if (x == ep->engr_x && y == ep->engr_y)
-            return ep;
-        ep = ep->nxt_engr;
-    }
-    return (struct engr *) 0;
+    if (x < 0 || x >= COLNO || y < 0 || y >= ROWNO)
+        return (struct engr *) 0;
+    return level.engravings[x][y];
 }
 
 /* Decide whether a particular string is engraved at a specified
@@ -392,6 +387,7 @@ xchar e_type;
     head_engr = ep;
     ep->engr_x = x;
     ep->engr_y = y;
+    level.engravings[x][y] = ep;
     ep->engr_txt = (char *) (ep + 1);
     Strcpy(ep->engr_txt, s);
     /* engraving Elbereth shows wisdom */
@@ -1164,8 +1160,11 @@ int fd, mode;
             bwrite(fd, (genericptr_t) &ep->engr_lth, sizeof ep->engr_lth);
             bwrite(fd, (genericptr_t) ep, sizeof (struct engr) + ep->engr_lth);
         }
-        if (release_data(mode))
+        if (release_data(mode)) {
+            if (level.engravings[ep->engr_x][ep->engr_y] == ep)
+                level.engravings[ep->engr_x][ep->engr_y] = (struct engr *) 0;
             dealloc_engr(ep);
+        }
     }
     if (perform_bwrite(mode))
         bwrite(fd, (genericptr_t) &no_more_engr, sizeof no_more_engr);
@@ -1179,8 +1178,12 @@ int fd;
 {
     struct engr *ep;
     unsigned lth;
+    int x, y;
 
     head_engr = 0;
+    for (x = 0; x < COLNO; x++)
+        for (y = 0; y < ROWNO; y++)
+            level.engravings[x][y] = (struct engr *) 0;
     while (1) {
         mread(fd, (genericptr_t) &lth, sizeof lth);
         if (lth == 0)
@@ -1189,6 +1192,7 @@ int fd;
         mread(fd, (genericptr_t) ep, sizeof (struct engr) + lth);
         ep->nxt_engr = head_engr;
         head_engr = ep;
+        level.engravings[ep->engr_x][ep->engr_y] = ep;
         ep->engr_txt = (char *) (ep + 1); /* Andreas Bormann */
         /* Mark as finished for bones levels -- no problem for
          * normal levels as the player must have finished engraving
@@ -1217,6 +1221,8 @@ register struct engr *ep;
             return;
         }
     }
+    if (level.engravings[ep->engr_x][ep->engr_y] == ep)
+        level.engravings[ep->engr_x][ep->engr_y] = (struct engr *) 0;
     dealloc_engr(ep);
 }
 
@@ -1234,8 +1240,11 @@ struct engr *ep;
         ty = rn2(ROWNO);
     } while (engr_at(tx, ty) || !goodpos(tx, ty, (struct monst *) 0, 0));
 
+    if (level.engravings[ep->engr_x][ep->engr_y] == ep)
+        level.engravings[ep->engr_x][ep->engr_y] = (struct engr *) 0;
     ep->engr_x = tx;
     ep->engr_y = ty;
+    level.engravings[tx][ty] = ep;
 }
 
 /* Create a headstone at the given location.
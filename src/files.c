@@ -181,6 +181,9 @@ STATIC_DCL void FDECL(redirect, (const char *, const char *, FILE *,
 #endif
 #if defined(COMPRESS) || defined(ZLIB_COMP)
 STATIC_DCL void FDECL(docompress_file, (const char *, BOOLEAN_P));
+#ifdef LZCOMP
+STATIC_DCL boolean FDECL(lzcomp_file, (const char *));
+#endif
 #endif
 #if defined(ZLIB_COMP)
 STATIC_DCL boolean FDECL(make_compressed_name, (const char *, char *));
@@ -203,6 +206,10 @@ STATIC_DCL boolean FDECL(copy_bytes, (int, int));
 #ifdef HOLD_LOCKFILE_OPEN
 STATIC_DCL int FDECL(open_levelfile_exclusively, (const char *, int, int));
 #endif
+#ifdef LEVEL_STORE
+STATIC_DCL boolean FDECL(levstore_writeout, (int));
+STATIC_DCL boolean NDECL(levstore_swapout);
+#endif
 
 /*
  * fname_encode()
@@ -445,6 +452,172 @@ set_lock_and_bones()
 }
 #endif /* MFLOPPY */
 
+#ifdef LEVEL_STORE
+/*
+ * Level store.  Levels that have been left are kept in memory exactly
+ * as savelev() wrote them, for getlev() to read back, instead of going
+ * through a level file.  They are written to and read from memory
+ * through the pseudo file descriptor LEVSTORE_FD, which bwrite(),
+ * mread() and nhclose() recognize.  open_levelfile() hands it out for
+ * a level that is in memory, and reading a level back uses it up since
+ * the level is then current.  When more than LEVEL_STORE levels are
+ * held, the one used longest ago goes out to its level file.  With the
+ * checkpoint option on, levels are written out as soon as they are
+ * stored so that recover can still piece together a crashed game.
+ */
+static struct levstore_ent {
+    char *data;       /* the level, or null if not held */
+    unsigned len;     /* bytes of it */
+    unsigned size;    /* bytes allocated */
+    long used;        /* when it was stored */
+    boolean ondisk;   /* its level file is up to date as well */
+} levstore[MAXLINFO];
+static int levstore_lev = -1;      /* level being written or read */
+static boolean levstore_writing = FALSE;
+static unsigned levstore_pos = 0;  /* read position */
+static int levstore_count = 0;     /* levels held */
+static long levstore_clock = 0L;
+
+/* start storing level lev; returns the pseudo file descriptor */
+int
+levstore_create(lev)
+int lev;
+{
+    if (levstore_lev >= 0)
+        panic("levstore_create: level %d is still open", levstore_lev);
+    if (!levstore[lev].data) {
+        levstore[lev].size = 16 * BUFSIZ;
+        levstore[lev].data = (char *) alloc(levstore[lev].size);
+        levstore_count++;
+    }
+    levstore[lev].len = 0;
+    levstore[lev].ondisk = FALSE;
+    levstore_lev = lev;
+    levstore_writing = TRUE;
+    level_info[lev].flags |= LFILE_EXISTS;
+    return LEVSTORE_FD;
+}
+
+void
+levstore_write(buf, len)
+genericptr_t buf;
+unsigned len;
+{
+    struct levstore_ent *ls;
+
+    if (levstore_lev < 0 || !levstore_writing)
+        panic("levstore_write: no level open for writing");
+    ls = &levstore[levstore_lev];
+    if (ls->len + len > ls->size) {
+        char *data;
+
+        while (ls->len + len > ls->size)
+            ls->size *= 2;
+        data = (char *) alloc(ls->size);
+        (void) memcpy((genericptr_t) data, (genericptr_t) ls->data, ls->len);
+        free((genericptr_t) ls->data);
+        ls->data = data;
+    }
+    (void) memcpy((genericptr_t) (ls->data + ls->len), buf, len);
+    ls->len += len;
+}
+
+void
+levstore_read(buf, len)
+genericptr_t buf;
+unsigned len;
+{
+    struct levstore_ent *ls;
+
+    if (levstore_lev < 0 || levstore_writing)
+        panic("levstore_read: no level open for reading");
+    ls = &levstore[levstore_lev];
+    if (len > ls->len - levstore_pos) {
+        pline("Read %u instead of %u bytes.", ls->len - levstore_pos, len);
+        panic("Error reading level %d from memory.", levstore_lev);
+    }
+    (void) memcpy(buf, (genericptr_t) (ls->data + levstore_pos), len);
+    levstore_pos += len;
+}
+
+/* finish with the open level: keep one that was just written, drop one
+   that has been read back */
+void
+levstore_close()
+{
+    int lev = levstore_lev;
+
+    if (lev < 0)
+        panic("levstore_close: no level open");
+    levstore_lev = -1;
+    if (!levstore_writing) {
+        levstore_drop(lev);
+        return;
+    }
+    levstore_writing = FALSE;
+    levstore[lev].used = ++levstore_clock;
+    if (flags.ins_chkpt)
+        (void) levstore_writeout(lev);
+    while (levstore_count > LEVEL_STORE)
+        if (!levstore_swapout())
+            break;
+}
+
+/* forget the stored copy of a level, if any */
+void
+levstore_drop(lev)
+int lev;
+{
+    if (lev == levstore_lev) /* abandoned, e.g. by a panic */
+        levstore_lev = -1, levstore_writing = FALSE;
+    if (levstore[lev].data) {
+        free((genericptr_t) levstore[lev].data);
+        levstore[lev].data = (char *) 0;
+        levstore[lev].len = levstore[lev].size = 0;
+        levstore_count--;
+    }
+}
+
+/* write a stored level to its level file, in the save file format */
+STATIC_OVL boolean
+levstore_writeout(lev)
+int lev;
+{
+    char whynot[BUFSZ];
+    int fd;
+
+    if (levstore[lev].ondisk)
+        return TRUE;
+    fd = create_levelfile(lev, whynot);
+    if (fd < 0) {
+        pline1(whynot);
+        return FALSE;
+    }
+    bufon(fd);
+    bwrite(fd, (genericptr_t) levstore[lev].data, levstore[lev].len);
+    bflush(fd);
+    bclose(fd);
+    levstore[lev].ondisk = TRUE;
+    return TRUE;
+}
+
+/* make room by moving the least recently stored level out to disk */
+STATIC_OVL boolean
+levstore_swapout()
+{
+    int i, oldest = -1;
+
+    for (i = 1; i < MAXLINFO; i++)
+        if (levstore[i].data && i != levstore_lev
+            && (oldest < 0 || levstore[i].used < levstore[oldest].used))
+            oldest = i;
+    if (oldest < 0 || !levstore_writeout(oldest))
+        return FALSE;
+    levstore_drop(oldest);
+    return TRUE;
+}
+#endif /* LEVEL_STORE */
+
 /* Construct a file name for a level-type file, which is of the form
  * something.level (with any old level stripped off).
  * This assumes there is space on the end of 'file' to append
@@ -519,6 +692,13 @@ char errbuf[];
 
     if (errbuf)
         *errbuf = '\0';
+#ifdef LEVEL_STORE
+    if (levstore[lev].data) {
+        levstore_lev = lev;
+        levstore_pos = 0;
+        return LEVSTORE_FD;
+    }
+#endif
     set_levelfile_name(lock, lev);
     fq_lock = fqname(lock, LEVELPREFIX, 0);
 #ifdef MFLOPPY
@@ -555,6 +735,9 @@ int lev;
      * Level 0 might be created by port specific code that doesn't
      * call create_levfile(), so always assume that it exists.
      */
+#ifdef LEVEL_STORE
+    levstore_drop(lev);
+#endif
     if (lev == 0 || (level_info[lev].flags & LFILE_EXISTS)) {
         set_levelfile_name(lock, lev);
 #ifdef HOLD_LOCKFILE_OPEN
@@ -668,6 +851,12 @@ int fd;
         lftrack.nethack_thinks_it_is_open = FALSE;
         return 0;
     }
+#ifdef LEVEL_STORE
+    if (fd == LEVSTORE_FD) {
+        levstore_close();
+        return 0;
+    }
+#endif
     return close(fd);
 }
 #else
@@ -676,6 +865,12 @@ int
 nhclose(fd)
 int fd;
 {
+#ifdef LEVEL_STORE
+    if (fd == LEVSTORE_FD) {
+        levstore_close();
+        return 0;
+    }
+#endif
     return close(fd);
 }
 #endif
@@ -1031,7 +1226,11 @@ const char *filename;
 
     Strcpy(SAVEF, filename);
 #ifdef COMPRESS_EXTENSION
-    SAVEF[strlen(SAVEF) - strlen(COMPRESS_EXTENSION)] = '\0';
+    /* LZCOMP save files don't get the extension */
+    if (strlen(SAVEF) > strlen(COMPRESS_EXTENSION)
+        && !strcmp(eos(SAVEF) - strlen(COMPRESS_EXTENSION),
+                   COMPRESS_EXTENSION))
+        SAVEF[strlen(SAVEF) - strlen(COMPRESS_EXTENSION)] = '\0';
 #endif
     nh_uncompress(SAVEF);
     if ((fd = open_savefile()) >= 0) {
@@ -1370,6 +1569,27 @@ boolean uncomp;
 #define UNUSED_if_not_COMPRESS UNUSED
 #endif
 
+#if defined(LZCOMP) && (defined(COMPRESS) || defined(ZLIB_COMP))
+/* is filename a save or bones file that was written with LZCOMP? */
+STATIC_OVL boolean
+lzcomp_file(filename)
+const char *filename;
+{
+    FILE *cf;
+    struct version_info vers_info;
+    struct savefile_info sfi;
+    boolean res = FALSE;
+
+    if ((cf = fopen(filename, RDBMODE)) != (FILE *) 0) {
+        if (fread((genericptr_t) &vers_info, sizeof vers_info, 1, cf) == 1
+            && fread((genericptr_t) &sfi, sizeof sfi, 1, cf) == 1)
+            res = (sfi.sfi1 & SFI1_LZCOMP) == SFI1_LZCOMP;
+        (void) fclose(cf);
+    }
+    return res;
+}
+#endif
+
 /* compress file */
 void
 nh_compress(filename)
@@ -1380,6 +1600,11 @@ const char *filename UNUSED_if_not_COMPRESS;
 #pragma unused(filename)
 #endif
 #else
+#ifdef LZCOMP
+    /* already compressed; running the compressor would gain nothing */
+    if (lzcomp_file(filename))
+        return;
+#endif
     docompress_file(filename, FALSE);
 #endif
 }
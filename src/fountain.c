@@ -138,6 +138,7 @@ genericptr_t poolcnt;
 
     /* Put a pool at x, y */
     levl[x][y].typ = POOL;
+    update_bitboards(x, y);
     /* No kelp! */
     del_engr_at(x, y);
     water_damage_chain(level.objects[x][y], TRUE);
@@ -67,6 +67,8 @@ const char *msg;
     coord cc;
     boolean revived = FALSE;
 
+    if (!objsum_at(OSUM_CORPSE, x, y))
+        return FALSE;
     for (otmp = level.objects[x][y]; otmp; otmp = otmp2) {
         otmp2 = otmp->nexthere;
         if (otmp->otyp == CORPSE
@@ -851,6 +853,383 @@ int wiz_debug_cmd_traveldisplay()
 }
 #endif /* DEBUG */
 
+/*
+ * Travel keeps the breadth-first search it made from its destination,
+ * since the hero mostly walks along the path that search found.  The
+ * search stops when it reaches the hero, and each square reached on the
+ * way records the square it was first reached from; that is the step a
+ * fresh search would pick for a hero standing there.  Before the search
+ * is reused, travel_ok() checks that nothing it looked at has changed:
+ * terrain, doors, boulders, seen traps, which squares are known or in
+ * view, and what the hero is or carries that test_move() cares about.
+ * Shopkeepers and long worms, whose movements test_move() also notices,
+ * turn the reuse off while they could matter.
+ */
+struct travfield {
+    xchar tx, ty;         /* the search started here (tx 0: none) */
+    xchar ux, uy;         /* looking for the hero here */
+    d_level uz;
+    boolean complete;     /* the hero wasn't reached */
+    long herokey;         /* travel_herokey() at the time */
+    struct permonst *herodata;
+    int nlooked;          /* squares whose travel_sig() was kept */
+    xchar lookx[COLNO * ROWNO], looky[COLNO * ROWNO];
+    unsigned short sig[COLNO][ROWNO];
+    xchar from[COLNO][ROWNO]; /* 1 + xdir[] index of the way there */
+};
+
+/* may travel look at <x,y>? */
+#define travel_usable(x, y) \
+    (levl[x][y].seenv || (!Blind && couldsee(x, y)))
+
+/* orthogonal directions first, for grid bugs */
+static int ordered[] = { 0, 2, 4, 6, 1, 3, 5, 7 };
+
+/* the last two travel destinations, and a spot picked by guessing */
+static struct travfield travfields[3];
+static int travlast; /* the destination used last */
+
+STATIC_DCL long NDECL(travel_herokey);
+STATIC_DCL unsigned FDECL(travel_sig, (int, int));
+STATIC_DCL boolean NDECL(travel_reusable);
+STATIC_DCL boolean FDECL(travel_ok, (struct travfield *, XCHAR_P, XCHAR_P));
+STATIC_DCL void FDECL(travel_search, (XCHAR_P, XCHAR_P, XCHAR_P, XCHAR_P,
+                                      xchar (*)[ROWNO], struct travfield *));
+STATIC_DCL boolean FDECL(travel_step, (int, XCHAR_P, XCHAR_P));
+#ifdef TRAVEL_ASTAR
+STATIC_DCL boolean FDECL(travel_astar, (int *, int *));
+#endif
+
+/* what test_move(TEST_TRAV) depends on about the hero */
+STATIC_OVL long
+travel_herokey()
+{
+    struct obj *obj;
+    long key = (long) context.run;
+
+    if (Blind)
+        key |= 0x10L;
+    if (Levitation)
+        key |= 0x20L;
+    if (Flying)
+        key |= 0x40L;
+    if (Passes_walls)
+        key |= 0x80L;
+    if (can_ooze(&youmonst))
+        key |= 0x100L;
+    if (Sokoban)
+        key |= 0x200L;
+    if (carrying(PICK_AXE) || carrying(DWARVISH_MATTOCK)
+        || ((obj = carrying(WAN_DIGGING)) != 0
+            && !objects[obj->otyp].oc_name_known))
+        key |= 0x400L;
+    key |= (long) cant_squeeze_thru(&youmonst) << 11;
+    key |= (long) u.umonnum << 13;
+    return key;
+}
+
+/* what travel's search depends on about a square */
+STATIC_OVL unsigned
+travel_sig(x, y)
+int x, y;
+{
+    struct rm *lev = &levl[x][y];
+    struct trap *t;
+    unsigned sig = (unsigned) (lev->typ & 0x3f);
+
+    sig |= (unsigned) lev->flags << 6;
+
+    if (travel_usable(x, y))
+        sig |= 0x800;
+    if (sobj_at(BOULDER, x, y))
+        sig |= 0x1000;
+    if ((t = t_at(x, y)) != 0 && t->tseen)
+        sig |= 0x2000;
+    /* test_move() only steers travel around water and lava seen before */
+    if (lev->seenv)
+        sig |= 0x4000;
+    return sig;
+}
+
+/* can a search be reused once monsters have moved? */
+STATIC_OVL boolean
+travel_reusable()
+{
+    struct monst *mtmp;
+
+    /* shopkeepers block shop doors (block_door(), block_entry()) */
+    if (*u.ushops || (IS_DOOR(levl[u.ux][u.uy].typ)
+                      && levl[u.ux][u.uy].doormask == D_BROKEN))
+        return FALSE;
+    /* no squeezing between consecutive worm segments (worm_cross()) */
+    for (mtmp = fmon; mtmp; mtmp = mtmp->nmon)
+        if (mtmp->wormno && !DEADMONSTER(mtmp) && count_wsegs(mtmp))
+            return FALSE;
+    return TRUE;
+}
+
+/* does tf hold what a fresh search from <tx,ty> would find now? */
+STATIC_OVL boolean
+travel_ok(tf, tx, ty)
+struct travfield *tf;
+xchar tx, ty;
+{
+    int i;
+
+    if (tf->tx != tx || tf->ty != ty || !on_level(&tf->uz, &u.uz)
+        || tf->herodata != youmonst.data
+        || tf->herokey != travel_herokey() || !travel_reusable())
+        return FALSE;
+    /* not reached: the search stopped short of here, or it was done for
+       a hero elsewhere, for whom test_move() made different exceptions */
+    if (!tf->from[u.ux][u.uy]
+        && (!tf->complete || u.ux != tf->ux || u.uy != tf->uy))
+        return FALSE;
+    for (i = 0; i < tf->nlooked; i++)
+        if (travel_sig(tf->lookx[i], tf->looky[i])
+            != tf->sig[tf->lookx[i]][tf->looky[i]])
+            return FALSE;
+    return TRUE;
+}
+
+/*
+ * Breadth-first search from <tx,ty> over the squares travel may use,
+ * leaving in travel[][] the radius at which each was reached.  Given a
+ * travfield, the search is for the hero at <ux,uy>: it stops there and
+ * fills in the travfield.  Otherwise (guessing) <ux,uy> is just skipped.
+ */
+STATIC_OVL void
+travel_search(tx, ty, ux, uy, travel, tf)
+xchar tx, ty, ux, uy;
+xchar (*travel)[ROWNO];
+struct travfield *tf;
+{
+    static xchar travelstepx[2][COLNO * ROWNO];
+    static xchar travelstepy[2][COLNO * ROWNO];
+    static char looked[COLNO][ROWNO];
+    int n = 1;      /* max offset in travelsteps */
+    int set = 0;    /* two sets current and previous */
+    int radius = 1; /* search radius */
+    int i, lx, ly;
+
+    if (tf) {
+        (void) memset((genericptr_t) looked, 0, sizeof looked);
+        (void) memset((genericptr_t) tf->from, 0, sizeof tf->from);
+        tf->nlooked = 0;
+        tf->complete = FALSE;
+    }
+    travelstepx[0][0] = tx;
+    travelstepy[0][0] = ty;
+
+    while (n != 0) {
+        int nn = 0;
+
+        for (i = 0; i < n; i++) {
+            int dir;
+            int x = travelstepx[set][i];
+            int y = travelstepy[set][i];
+            /* no diagonal movement for grid bugs */
+            int dirmax = NODIAG(u.umonnum) ? 4 : 8;
+
+            /* test_move() from here looks no further than next door */
+            if (tf)
+                for (lx = x - 1; lx <= x + 1; lx++)
+                    for (ly = y - 1; ly <= y + 1; ly++)
+                        if (isok(lx, ly) && !looked[lx][ly]) {
+                            looked[lx][ly] = 1;
+                            tf->lookx[tf->nlooked] = lx;
+                            tf->looky[tf->nlooked++] = ly;
+                        }
+
+            for (dir = 0; dir < dirmax; ++dir) {
+                int nx = x + xdir[ordered[dir]];
+                int ny = y + ydir[ordered[dir]];
+
+                if (!isok(nx, ny))
+                    continue;
+                if ((!Passes_walls && !can_ooze(&youmonst)
+                     && closed_door(x, y)) || sobj_at(BOULDER, x, y)) {
+                    /* closed doors and boulders usually
+                     * cause a delay, so prefer another path */
+                    if (travel[x][y] > radius - 3) {
+                        travelstepx[1 - set][nn] = x;
+                        travelstepy[1 - set][nn] = y;
+                        /* don't change travel matrix! */
+                        nn++;
+                        continue;
+                    }
+                }
+                if (test_move(x, y, nx - x, ny - y, TEST_TRAV)
+                    && travel_usable(nx, ny)) {
+                    if (nx == ux && ny == uy) {
+                        if (tf) {
+                            tf->from[nx][ny] = ordered[dir] + 1;
+                            goto found;
+                        }
+                    } else if (!travel[nx][ny]) {
+                        travelstepx[1 - set][nn] = nx;
+                        travelstepy[1 - set][nn] = ny;
+                        travel[nx][ny] = radius;
+                        if (tf)
+                            tf->from[nx][ny] = ordered[dir] + 1;
+                        nn++;
+                    }
+                }
+            }
+        }
+
+#ifdef DEBUG
+        if (trav_debug) {
+            /* Use of warning glyph is arbitrary. It stands out. */
+            tmp_at(DISP_ALL, warning_to_glyph(1));
+            for (i = 0; i < nn; ++i) {
+                tmp_at(travelstepx[1 - set][i], travelstepy[1 - set][i]);
+            }
+            delay_output();
+            if (flags.runmode == RUN_CRAWL) {
+                delay_output();
+                delay_output();
+            }
+            tmp_at(DISP_END, 0);
+        }
+#endif /* DEBUG */
+
+        n = nn;
+        set = 1 - set;
+        radius++;
+    }
+    if (!tf)
+        return;
+    tf->complete = TRUE;
+found:
+    for (i = 0; i < tf->nlooked; i++) {
+        lx = tf->lookx[i], ly = tf->looky[i];
+        tf->sig[lx][ly] = (unsigned short) travel_sig(lx, ly);
+    }
+}
+
+/*
+ * Set u.dx,u.dy for the hero's first step on a shortest way to <tx,ty>,
+ * searching again only if the search kept in travfields[slot] might no
+ * longer be what a new one would find.  Returns TRUE if there is a way.
+ */
+STATIC_OVL boolean
+travel_step(slot, tx, ty)
+int slot;
+xchar tx, ty;
+{
+    static xchar travel[COLNO][ROWNO];
+    struct travfield *tf = &travfields[slot];
+    int d;
+
+    if (!travel_ok(tf, tx, ty)) {
+        tf->tx = tx, tf->ty = ty;
+        tf->ux = u.ux, tf->uy = u.uy;
+        assign_level(&tf->uz, &u.uz);
+        tf->herokey = travel_herokey();
+        tf->herodata = youmonst.data;
+        (void) memset((genericptr_t) travel, 0, sizeof travel);
+        travel_search(tx, ty, u.ux, u.uy, travel, tf);
+    }
+    d = tf->from[u.ux][u.uy];
+    if (!travel_reusable())
+        tf->tx = 0; /* good for this turn only */
+    if (!d--)
+        return FALSE;
+    u.dx = -xdir[d];
+    u.dy = -ydir[d];
+    if (u.ux + u.dx == u.tx && u.uy + u.dy == u.ty) {
+        nomul(0);
+        /* reset run so domove run checks work */
+        context.run = 8;
+        iflags.travelcc.x = iflags.travelcc.y = -1;
+    }
+    return TRUE;
+}
+
+#ifdef TRAVEL_ASTAR
+/*
+ * Guess by A* search from the hero to the destination, taking squares
+ * the hero knows nothing about to be open floor.  The spot to head for
+ * is the last one before the route leaves the squares travel may use.
+ * Returns FALSE if there is none, leaving it to the usual guess.
+ */
+STATIC_OVL boolean
+travel_astar(px, py)
+int *px, *py;
+{
+    static xchar heapx[8 * COLNO * ROWNO], heapy[8 * COLNO * ROWNO];
+    static int heapkey[8 * COLNO * ROWNO];
+    static short cost[COLNO][ROWNO]; /* steps from the hero + 1 */
+    static xchar from[COLNO][ROWNO];
+    static xchar pathx[COLNO * ROWNO], pathy[COLNO * ROWNO];
+    int dirmax = NODIAG(u.umonnum) ? 4 : 8;
+    int n = 0, i, j, k, dir, x, y, nx, ny, g, h, key;
+    boolean usable;
+
+    (void) memset((genericptr_t) cost, 0, sizeof cost);
+    cost[u.ux][u.uy] = 1;
+    h = distmin(u.ux, u.uy, u.tx, u.ty);
+    heapx[0] = u.ux, heapy[0] = u.uy;
+    heapkey[n++] = h * 128 + h;
+    for (;;) {
+        if (!n)
+            return FALSE;
+        /* take the most promising square off the heap */
+        x = heapx[0], y = heapy[0], key = heapkey[0];
+        n--;
+        for (i = 0; (j = 2 * i + 1) < n; i = j) {
+            if (j + 1 < n && heapkey[j + 1] < heapkey[j])
+                j++;
+            if (heapkey[n] <= heapkey[j])
+                break;
+            heapx[i] = heapx[j], heapy[i] = heapy[j];
+            heapkey[i] = heapkey[j];
+        }
+        heapx[i] = heapx[n], heapy[i] = heapy[n], heapkey[i] = heapkey[n];
+        g = cost[x][y];
+        if (key / 128 != g + distmin(x, y, u.tx, u.ty) - 1)
+            continue; /* superseded by a shorter way here */
+        if (x == u.tx && y == u.ty)
+            break;
+
+        usable = travel_usable(x, y);
+        for (dir = 0; dir < dirmax; ++dir) {
+            nx = x + xdir[ordered[dir]];
+            ny = y + ydir[ordered[dir]];
+            if (!isok(nx, ny) || (cost[nx][ny] && cost[nx][ny] <= g + 1))
+                continue;
+            if (travel_usable(nx, ny)
+                && (usable ? !test_move(x, y, nx - x, ny - y, TEST_TRAV)
+                           : IS_ROCK(levl[nx][ny].typ)))
+                continue;
+            cost[nx][ny] = g + 1;
+            from[nx][ny] = ordered[dir];
+            h = distmin(nx, ny, u.tx, u.ty);
+            key = (g + h) * 128 + h;
+            for (i = n++; i > 0 && heapkey[k = (i - 1) / 2] > key; i = k) {
+                heapx[i] = heapx[k], heapy[i] = heapy[k];
+                heapkey[i] = heapkey[k];
+            }
+            heapx[i] = nx, heapy[i] = ny, heapkey[i] = key;
+        }
+    }
+
+    /* walk the route back to the hero, then forward while usable */
+    for (i = 0; x != u.ux || y != u.uy; i++) {
+        pathx[i] = x, pathy[i] = y;
+        dir = from[x][y];
+        x -= xdir[dir], y -= ydir[dir];
+    }
+    while (--i >= 0 && travel_usable(pathx[i], pathy[i]))
+        x = pathx[i], y = pathy[i];
+    if (x == u.ux && y == u.uy)
+        return FALSE;
+    *px = x, *py = y;
+    return TRUE;
+}
+#endif /* TRAVEL_ASTAR */
+
 /*
  * Find a path from the destination (u.tx,u.ty) back to (u.ux,u.uy).
  * A shortest path is returned.  If guess is TRUE, consider various
@@ -875,172 +1254,82 @@ boolean guess;
         context.run = 8;
     }
     if (u.tx != u.ux || u.ty != u.uy) {
-        xchar travel[COLNO][ROWNO];
-        xchar travelstepx[2][COLNO * ROWNO];
-        xchar travelstepy[2][COLNO * ROWNO];
+        static xchar travel[COLNO][ROWNO];
         xchar tx, ty, ux, uy;
-        int n = 1;      /* max offset in travelsteps */
-        int set = 0;    /* two sets current and previous */
-        int radius = 1; /* search radius */
-        int i;
+        int px, py; /* pick location */
+        int dist, nxtdist, d2, nd2;
+
+        if (!guess) {
+            /* the other one if it matches; if neither does, the older */
+            if (travfields[travlast].tx != u.tx
+                || travfields[travlast].ty != u.ty)
+                travlast = 1 - travlast;
+            return travel_step(travlast, u.tx, u.ty);
+        }
+#ifdef TRAVEL_ASTAR
+        if (travel_astar(&px, &py) && travel_step(2, px, py))
+            return TRUE;
+#endif
 
         /* If guessing, first find an "obvious" goal location.  The obvious
          * goal is the position the player knows of, or might figure out
          * (couldsee) that is closest to the target on a straight path.
          */
-        if (guess) {
-            tx = u.ux;
-            ty = u.uy;
-            ux = u.tx;
-            uy = u.ty;
-        } else {
-            tx = u.tx;
-            ty = u.ty;
-            ux = u.ux;
-            uy = u.uy;
-        }
-
-    noguess:
-        (void) memset((genericptr_t) travel, 0, sizeof(travel));
-        travelstepx[0][0] = tx;
-        travelstepy[0][0] = ty;
-
-        while (n != 0) {
-            int nn = 0;
-
-            for (i = 0; i < n; i++) {
-                int dir;
-                int x = travelstepx[set][i];
-                int y = travelstepy[set][i];
-                static int ordered[] = { 0, 2, 4, 6, 1, 3, 5, 7 };
-                /* no diagonal movement for grid bugs */
-                int dirmax = NODIAG(u.umonnum) ? 4 : 8;
-
-                for (dir = 0; dir < dirmax; ++dir) {
-                    int nx = x + xdir[ordered[dir]];
-                    int ny = y + ydir[ordered[dir]];
-
-                    if (!isok(nx, ny))
-                        continue;
-                    if ((!Passes_walls && !can_ooze(&youmonst)
-                         && closed_door(x, y)) || sobj_at(BOULDER, x, y)) {
-                        /* closed doors and boulders usually
-                         * cause a delay, so prefer another path */
-                        if (travel[x][y] > radius - 3) {
-                            travelstepx[1 - set][nn] = x;
-                            travelstepy[1 - set][nn] = y;
-                            /* don't change travel matrix! */
-                            nn++;
-                            continue;
-                        }
-                    }
-                    if (test_move(x, y, nx - x, ny - y, TEST_TRAV)
-                        && (levl[nx][ny].seenv
-                            || (!Blind && couldsee(nx, ny)))) {
-                        if (nx == ux && ny == uy) {
-                            if (!guess) {
-                                u.dx = x - ux;
-                                u.dy = y - uy;
-                                if (x == u.tx && y == u.ty) {
-                                    nomul(0);
-                                    /* reset run so domove run checks work */
-                                    context.run = 8;
-                                    iflags.travelcc.x = iflags.travelcc.y =
-                                        -1;
-                                }
-                                return TRUE;
-                            }
-                        } else if (!travel[nx][ny]) {
-                            travelstepx[1 - set][nn] = nx;
-                            travelstepy[1 - set][nn] = ny;
-                            travel[nx][ny] = radius;
-                            nn++;
-                        }
-                    }
-                }
-            }
-
-#ifdef DEBUG
-            if (trav_debug) {
-                /* Use of warning glyph is arbitrary. It stands out. */
-                tmp_at(DISP_ALL, warning_to_glyph(1));
-                for (i = 0; i < nn; ++i) {
-                    tmp_at(travelstepx[1 - set][i], travelstepy[1 - set][i]);
-                }
-                delay_output();
-                if (flags.runmode == RUN_CRAWL) {
-                    delay_output();
-                    delay_output();
-                }
-                tmp_at(DISP_END, 0);
-            }
-#endif /* DEBUG */
-
-            n = nn;
-            set = 1 - set;
-            radius++;
-        }
-
-        /* if guessing, find best location in travel matrix and go there */
-        if (guess) {
-            int px = tx, py = ty; /* pick location */
-            int dist, nxtdist, d2, nd2;
-
-            dist = distmin(ux, uy, tx, ty);
-            d2 = dist2(ux, uy, tx, ty);
-            for (tx = 1; tx < COLNO; ++tx)
-                for (ty = 0; ty < ROWNO; ++ty)
-                    if (travel[tx][ty]) {
-                        nxtdist = distmin(ux, uy, tx, ty);
-                        if (nxtdist == dist && couldsee(tx, ty)) {
-                            nd2 = dist2(ux, uy, tx, ty);
-                            if (nd2 < d2) {
-                                /* prefer non-zigzag path */
-                                px = tx;
-                                py = ty;
-                                d2 = nd2;
-                            }
-                        } else if (nxtdist < dist && couldsee(tx, ty)) {
+        tx = u.ux;
+        ty = u.uy;
+        ux = u.tx;
+        uy = u.ty;
+        (void) memset((genericptr_t) travel, 0, sizeof travel);
+        travel_search(tx, ty, ux, uy, travel, (struct travfield *) 0);
+
+        /* find best location in travel matrix and go there */
+        px = tx, py = ty;
+        dist = distmin(ux, uy, tx, ty);
+        d2 = dist2(ux, uy, tx, ty);
+        for (tx = 1; tx < COLNO; ++tx)
+            for (ty = 0; ty < ROWNO; ++ty)
+                if (travel[tx][ty]) {
+                    nxtdist = distmin(ux, uy, tx, ty);
+                    if (nxtdist == dist && couldsee(tx, ty)) {
+                        nd2 = dist2(ux, uy, tx, ty);
+                        if (nd2 < d2) {
+                            /* prefer non-zigzag path */
                             px = tx;
                             py = ty;
-                            dist = nxtdist;
-                            d2 = dist2(ux, uy, tx, ty);
+                            d2 = nd2;
                         }
+                    } else if (nxtdist < dist && couldsee(tx, ty)) {
+                        px = tx;
+                        py = ty;
+                        dist = nxtdist;
+                        d2 = dist2(ux, uy, tx, ty);
                     }
+                }
 
-            if (px == u.ux && py == u.uy) {
-                /* no guesses, just go in the general direction */
-                u.dx = sgn(u.tx - u.ux);
-                u.dy = sgn(u.ty - u.uy);
-                if (test_move(u.ux, u.uy, u.dx, u.dy, TEST_MOVE))
-                    return TRUE;
-                goto found;
-            }
+        if (px == u.ux && py == u.uy) {
+            /* no guesses, just go in the general direction */
+            u.dx = sgn(u.tx - u.ux);
+            u.dy = sgn(u.ty - u.uy);
+            if (test_move(u.ux, u.uy, u.dx, u.dy, TEST_MOVE))
+                return TRUE;
+            goto found;
+        }
 #ifdef DEBUG
-            if (trav_debug) {
-                /* Use of warning glyph is arbitrary. It stands out. */
-                tmp_at(DISP_ALL, warning_to_glyph(2));
-                tmp_at(px, py);
+        if (trav_debug) {
+            /* Use of warning glyph is arbitrary. It stands out. */
+            tmp_at(DISP_ALL, warning_to_glyph(2));
+            tmp_at(px, py);
+            delay_output();
+            if (flags.runmode == RUN_CRAWL) {
+                delay_output();
+                delay_output();
+                delay_output();
                 delay_output();
-                if (flags.runmode == RUN_CRAWL) {
-                    delay_output();
-                    delay_output();
-                    delay_output();
-                    delay_output();
-                }
-                tmp_at(DISP_END, 0);
             }
-#endif /* DEBUG */
-            tx = px;
-            ty = py;
-            ux = u.ux;
-            uy = u.uy;
-            set = 0;
-            n = radius = 1;
-            guess = FALSE;
-            goto noguess;
+            tmp_at(DISP_END, 0);
         }
-        return FALSE;
+#endif /* DEBUG */
+        return travel_step(2, px, py);
     }
 
 found:
@@ -1215,8 +1504,10 @@ domove()
     u_wipe_engr(rnd(5));
 
     if (context.travel) {
+        bench_begin(BENCH_TRAVEL);
         if (!findtravelpath(FALSE))
             (void) findtravelpath(TRUE);
+        bench_end(BENCH_TRAVEL);
         context.travel1 = 0;
     }
 
@@ -46,6 +46,7 @@
         boolean         fuzzymatch      (const char *,const char *,
                                          const char *, boolean)
         void            setrandom       (void)
+        void            seedrandom      (unsigned long)
         time_t          getnow          (void)
         int             getyear         (void)
         char *          yymmdd          (time_t)
@@ -743,7 +744,15 @@ setrandom()
         }
     }
 #endif
+    seedrandom(seed);
+}
 
+/* seed the random number generator with a specific value; used by
+   setrandom() and by the benchmark harness for repeatable runs */
+void
+seedrandom(seed)
+unsigned long seed;
+{
     /* the types are different enough here that sweeping the different
      * routine names into one via #defines is even more confusing
      */
@@ -206,6 +206,10 @@ reorder_invent()
                     invent = next;
                 otmp->nobj = next->nobj;
                 next->nobj = otmp;
+                next->oprev = prev;
+                otmp->oprev = next;
+                if (otmp->nobj)
+                    otmp->nobj->oprev = otmp;
                 prev = next;
             } else {
                 prev = otmp;
@@ -466,13 +470,13 @@ struct obj *obj;
     /* didn't merge, so insert into chain */
     assigninvlet(obj);
     if (flags.invlet_constant || !prev) {
-        obj->nobj = invent; /* insert at beginning */
-        invent = obj;
+        link_nobj(obj, &invent); /* insert at beginning */
         if (flags.invlet_constant)
             reorder_invent();
     } else {
         prev->nobj = obj; /* insert at end */
         obj->nobj = 0;
+        obj->oprev = prev;
     }
     obj->where = OBJ_INVENT;
 
@@ -731,7 +735,11 @@ int otyp;
 int x, y;
 {
     register struct obj *otmp;
+    int bit = objsum_bit(otyp);
 
+    /* a clear summary bit rules out the common types without a walk */
+    if (bit && !objsum_at(bit, x, y))
+        return (struct obj *) 0;
     for (otmp = level.objects[x][y]; otmp; otmp = otmp->nexthere)
         if (otmp->otyp == otyp)
             break;
@@ -868,6 +876,8 @@ register int x, y;
 {
     register struct obj *obj = level.objects[x][y];
 
+    if (!objsum_at(OSUM_GOLD, x, y))
+        return (struct obj *) 0;
     while (obj) {
         if (obj->oclass == COIN_CLASS)
             return obj;
@@ -3253,6 +3263,8 @@ reassign()
                 prevobj->nobj = goldobj->nobj;
             else
                 invent = goldobj->nobj;
+            if (goldobj->nobj)
+                goldobj->nobj->oprev = prevobj;
             break;
         }
     /* second, re-letter the rest of the list */
@@ -3262,8 +3274,7 @@ reassign()
     /* third, assign gold the "letter" '$' and re-insert it at head */
     if (goldobj) {
         goldobj->invlet = GOLD_SYM;
-        goldobj->nobj = invent;
-        invent = goldobj;
+        link_nobj(goldobj, &invent);
     }
     if (i >= 52)
         i = 52 - 1;
@@ -3454,18 +3465,16 @@ doorganize() /* inventory organizer by Del Lamb */
 
     /* inline addinv; insert loose object at beginning of inventory */
     obj->invlet = let;
-    obj->nobj = invent;
+    link_nobj(obj, &invent);
     obj->where = OBJ_INVENT;
-    invent = obj;
     reorder_invent();
     if (bumped) {
         /* splitting the 'from' stack is causing an incompatible
            stack in the 'to' slot to be moved into an open one;
            we need to do another inline insertion to inventory */
         assigninvlet(bumped);
-        bumped->nobj = invent;
+        link_nobj(bumped, &invent);
         bumped->where = OBJ_INVENT;
-        invent = bumped;
         reorder_invent();
     }
 
@@ -46,6 +46,7 @@ static light_source *light_base = 0;
 
 STATIC_DCL void FDECL(write_ls, (int, light_source *));
 STATIC_DCL int FDECL(maybe_write_ls, (int, int, BOOLEAN_P));
+STATIC_DCL boolean FDECL(mon_on_chain, (struct monst *, struct monst *));
 
 /* imported from vision.c, for small circles */
 extern char circle_data[];
@@ -141,10 +142,9 @@ char **cs_rows;
         ls->flags &= ~LSF_SHOW;
 
         /*
-         * Check for moved light sources.  It may be possible to
-         * save some effort if an object has not moved, but not in
-         * the current setup -- we need to recalculate for every
-         * vision recalc.
+         * Check for moved light sources.  Unless it is at the hero's
+         * spot, a source that hasn't moved costs little: light_area()
+         * remembers what it reached last time.
          */
         if (ls->type == LS_OBJECT) {
             if (get_obj_location(ls->id.a_obj, &ls->x, &ls->y, 0))
@@ -171,6 +171,11 @@ char **cs_rows;
              * Kevin's tests indicated that doing this brute-force
              * method is faster for radius <= 3 (or so).
              */
+            if (ls->x != u.ux || ls->y != u.uy) {
+                /* the vision code remembers these between calls */
+                light_area(ls->x, ls->y, ls->range, cs_rows);
+                continue;
+            }
             limits = circle_ptr(ls->range);
             if ((max_y = (ls->y + ls->range)) >= ROWNO)
                 max_y = ROWNO - 1;
@@ -184,27 +189,19 @@ char **cs_rows;
                 if ((max_x = (ls->x + offset)) >= COLNO)
                     max_x = COLNO - 1;
 
-                if (ls->x == u.ux && ls->y == u.uy) {
-                    /*
-                     * If the light source is located at the hero, then
-                     * we can use the COULD_SEE bits already calculated
-                     * by the vision system.  More importantly than
-                     * this optimization, is that it allows the vision
-                     * system to correct problems with clear_path().
-                     * The function clear_path() is a simple LOS
-                     * path checker that doesn't go out of its way
-                     * make things look "correct".  The vision system
-                     * does this.
-                     */
-                    for (x = min_x; x <= max_x; x++)
-                        if (row[x] & COULD_SEE)
-                            row[x] |= TEMP_LIT;
-                } else {
-                    for (x = min_x; x <= max_x; x++)
-                        if ((ls->x == x && ls->y == y)
-                            || clear_path((int) ls->x, (int) ls->y, x, y))
-                            row[x] |= TEMP_LIT;
-                }
+                /*
+                 * The light source is located at the hero, so we can
+                 * use the COULD_SEE bits already calculated by the
+                 * vision system.  More importantly than this
+                 * optimization, is that it allows the vision system
+                 * to correct problems with clear_path().  The function
+                 * clear_path() is a simple LOS path checker that
+                 * doesn't go out of its way make things look "correct".
+                 * The vision system does this.
+                 */
+                for (x = min_x; x <= max_x; x++)
+                    if (row[x] & COULD_SEE)
+                        row[x] |= TEMP_LIT;
             }
         }
     }
@@ -213,6 +210,16 @@ char **cs_rows;
 /* (mon->mx == 0) implies migrating */
 #define mon_is_local(mon) ((mon)->mx > 0)
 
+STATIC_OVL boolean
+mon_on_chain(mon, chain)
+struct monst *mon, *chain;
+{
+    for (; chain; chain = chain->nmon)
+        if (chain == mon)
+            return TRUE;
+    return FALSE;
+}
+
 struct monst *
 find_mid(nid, fmflags)
 unsigned nid;
@@ -222,18 +229,22 @@ unsigned fmflags;
 
     if (!nid)
         return &youmonst;
-    if (fmflags & FM_FMON)
-        for (mtmp = fmon; mtmp; mtmp = mtmp->nmon)
-            if (!DEADMONSTER(mtmp) && mtmp->m_id == nid)
-                return mtmp;
-    if (fmflags & FM_MIGRATE)
-        for (mtmp = migrating_mons; mtmp; mtmp = mtmp->nmon)
-            if (mtmp->m_id == nid)
-                return mtmp;
-    if (fmflags & FM_MYDOGS)
-        for (mtmp = mydogs; mtmp; mtmp = mtmp->nmon)
-            if (mtmp->m_id == nid)
-                return mtmp;
+    /* the m_id index finds the monster wherever it is; nothing dead is
+       left on migrating_mons or mydogs, so DEADMONSTER() only matters
+       for fmon, where it always rules the monster out */
+    mtmp = monst_by_mid(nid);
+    if (!mtmp || DEADMONSTER(mtmp))
+        return (struct monst *) 0;
+    if ((fmflags & FM_EVERYWHERE) == FM_EVERYWHERE)
+        return mtmp;
+    if (mon_is_local(mtmp))
+        return (fmflags & FM_FMON) ? mtmp : (struct monst *) 0;
+    /* off the map; usually migrating or in mydogs, but fmon can hold
+       a monster in limbo too (a parked vault guard, for instance) */
+    if (((fmflags & FM_FMON) && mon_on_chain(mtmp, fmon))
+        || ((fmflags & FM_MIGRATE) && mon_on_chain(mtmp, migrating_mons))
+        || ((fmflags & FM_MYDOGS) && mon_on_chain(mtmp, mydogs)))
+        return mtmp;
     return (struct monst *) 0;
 }
 
@@ -760,6 +760,7 @@ xchar x, y; /* clone's preferred location or 0 (near mon) */
     m2->m_id = context.ident++;
     if (!m2->m_id)
         m2->m_id = context.ident++; /* ident overflowed */
+    index_monst(m2);
     m2->mx = mm.x;
     m2->my = mm.y;
 
@@ -1119,6 +1120,7 @@ int mmflags;
     mtmp->m_id = context.ident++;
     if (!mtmp->m_id)
         mtmp->m_id = context.ident++; /* ident overflowed */
+    index_monst(mtmp);
     set_mon_data(mtmp, ptr, 0);
     if (ptr->msound == MS_LEADER && quest_info(MS_LEADER) == mndx)
         quest_status.leader_m_id = mtmp->m_id;
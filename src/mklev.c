@@ -13,7 +13,6 @@ STATIC_DCL void FDECL(mksink, (struct mkroom *));
 STATIC_DCL void FDECL(mkaltar, (struct mkroom *));
 STATIC_DCL void FDECL(mkgrave, (struct mkroom *));
 STATIC_DCL void NDECL(makevtele);
-STATIC_DCL void NDECL(clear_level_structures);
 STATIC_DCL void NDECL(makelevel);
 STATIC_DCL boolean FDECL(bydoor, (XCHAR_P, XCHAR_P));
 STATIC_DCL struct mkroom *FDECL(find_branch_room, (coord *));
@@ -574,7 +573,7 @@ makevtele()
  * special) but it's easier to put it all in one place than make sure
  * each type initializes what it needs to separately.
  */
-STATIC_OVL void
+void
 clear_level_structures()
 {
     static struct rm zerorm = { cmap_to_glyph(S_stone),
@@ -595,6 +594,10 @@ clear_level_structures()
              */
             level.objects[x][y] = (struct obj *) 0;
             level.monsters[x][y] = (struct monst *) 0;
+            level.traps[x][y] = (struct trap *) 0;
+            level.engravings[x][y] = (struct engr *) 0;
+            level.objsummary[x][y] = 0;
+            level.objcount[x][y] = 0;
         }
     }
     level.objlist = (struct obj *) 0;
@@ -602,6 +605,7 @@ clear_level_structures()
     level.monlist = (struct monst *) 0;
     level.damagelist = (struct damage *) 0;
     level.bonesinfo = (struct cemetery *) 0;
+    level.bitboards_ok = FALSE;
 
     level.flags.nfountains = 0;
     level.flags.nsinks = 0;
@@ -991,6 +995,7 @@ mklev()
     bound_digging();
     mineralize(-1, -1, -1, -1, FALSE);
     in_mklev = FALSE;
+    rebuild_bitboards();
     /* has_morgue gets cleared once morgue is entered; graveyard stays
        set (graveyard might already be set even when has_morgue is clear
        [see fixup_special()], so don't update it unconditionally) */
@@ -1651,6 +1656,7 @@ int dist;
         impossible("mkinvpos called with dist %d", dist);
         break;
     }
+    update_bitboards(x, y);
 
     /* display new value of position; could have a monster/object on it */
     newsym(x, y);
@@ -1061,9 +1061,11 @@ movebubbles()
 
                             cons->next = b->cons;
                             b->cons = cons;
+                            level.traps[x][y] = (struct trap *) 0;
                         }
 
                         levl[x][y] = water_pos;
+                        update_bitboards(x, y);
                         block_point(x, y);
                     }
         }
@@ -1412,6 +1414,7 @@ register boolean ini;
                 if (Is_waterlevel(&u.uz)) {
                     levl[x][y].typ = AIR;
                     levl[x][y].lit = 1;
+                    update_bitboards(x, y);
                     unblock_point(x, y);
                 } else if (Is_airlevel(&u.uz)) {
                     levl[x][y].typ = CLOUD;
@@ -1462,6 +1465,7 @@ register boolean ini;
                 struct trap *btrap = (struct trap *) cons->list;
                 btrap->tx = cons->x;
                 btrap->ty = cons->y;
+                level.traps[btrap->tx][btrap->ty] = btrap;
                 break;
             }
 
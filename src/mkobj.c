@@ -9,6 +9,7 @@ STATIC_DCL void FDECL(maybe_adjust_light, (struct obj *, int));
 STATIC_DCL void FDECL(obj_timer_checks, (struct obj *,
                                          XCHAR_P, XCHAR_P, int));
 STATIC_DCL void FDECL(container_weight, (struct obj *));
+STATIC_DCL void FDECL(objsum_recheck, (int, int, int));
 STATIC_DCL struct obj *FDECL(save_mtraits, (struct obj *, struct monst *));
 STATIC_DCL void FDECL(objlist_sanity, (struct obj *, int, const char *));
 STATIC_DCL void FDECL(mon_obj_sanity, (struct monst *, const char *));
@@ -17,6 +18,8 @@ STATIC_DCL void FDECL(insane_object, (struct obj *, const char *,
                                       const char *, struct monst *));
 STATIC_DCL void FDECL(check_contained, (struct obj *, const char *));
 STATIC_DCL void FDECL(sanity_check_worn, (struct obj *));
+STATIC_DCL void NDECL(grow_oid_index);
+STATIC_DCL void FDECL(unindex_obj, (struct obj *));
 
 struct icp {
     int iprob;   /* probability of an item type */
@@ -422,6 +425,7 @@ long num;
     otmp->o_id = context.ident++;
     if (!otmp->o_id)
         otmp->o_id = context.ident++; /* ident overflowed */
+    index_obj(otmp);
     otmp->timed = 0;                  /* not timed, yet */
     otmp->lamplit = 0;                /* ditto */
     otmp->owornmask = 0L;             /* new object isn't worn */
@@ -433,10 +437,18 @@ long num;
     context.objsplit.parent_oid = obj->o_id;
     context.objsplit.child_oid = otmp->o_id;
     obj->nobj = otmp;
+    otmp->oprev = obj;
+    if (otmp->nobj)
+        otmp->nobj->oprev = otmp;
     /* Only set nexthere when on the floor, nexthere is also used */
     /* as a back pointer to the container object when contained. */
-    if (obj->where == OBJ_FLOOR)
+    if (obj->where == OBJ_FLOOR) {
         obj->nexthere = otmp;
+        otmp->oprevhere = obj;
+        if (otmp->nexthere)
+            otmp->nexthere->oprevhere = otmp;
+        level.objcount[obj->ox][obj->oy]++;
+    }
     copy_oextra(otmp, obj);
     if (has_omid(otmp))
         free_omid(otmp); /* only one association with m_id*/
@@ -542,6 +554,8 @@ replace_object(obj, otmp)
 struct obj *obj;
 struct obj *otmp;
 {
+    int bit;
+
     otmp->where = obj->where;
     switch (obj->where) {
     case OBJ_FREE:
@@ -550,18 +564,27 @@ struct obj *otmp;
     case OBJ_INVENT:
         otmp->nobj = obj->nobj;
         obj->nobj = otmp;
+        otmp->oprev = obj;
+        if (otmp->nobj)
+            otmp->nobj->oprev = otmp;
         extract_nobj(obj, &invent);
         break;
     case OBJ_CONTAINED:
         otmp->nobj = obj->nobj;
         otmp->ocontainer = obj->ocontainer;
         obj->nobj = otmp;
+        otmp->oprev = obj;
+        if (otmp->nobj)
+            otmp->nobj->oprev = otmp;
         extract_nobj(obj, &obj->ocontainer->cobj);
         break;
     case OBJ_MINVENT:
         otmp->nobj = obj->nobj;
         otmp->ocarry = obj->ocarry;
         obj->nobj = otmp;
+        otmp->oprev = obj;
+        if (otmp->nobj)
+            otmp->nobj->oprev = otmp;
         extract_nobj(obj, &obj->ocarry->minvent);
         break;
     case OBJ_FLOOR:
@@ -570,9 +593,19 @@ struct obj *otmp;
         otmp->ox = obj->ox;
         otmp->oy = obj->oy;
         obj->nobj = otmp;
+        otmp->oprev = obj;
+        if (otmp->nobj)
+            otmp->nobj->oprev = otmp;
         obj->nexthere = otmp;
+        otmp->oprevhere = obj;
+        if (otmp->nexthere)
+            otmp->nexthere->oprevhere = otmp;
         extract_nobj(obj, &fobj);
         extract_nexthere(obj, &level.objects[obj->ox][obj->oy]);
+        level.objsummary[otmp->ox][otmp->oy] |= objsum_bit(otmp->otyp);
+        if ((bit = objsum_bit(obj->otyp)) != 0
+            && bit != objsum_bit(otmp->otyp))
+            objsum_recheck(bit, otmp->ox, otmp->oy);
         break;
     default:
         panic("replace_object: obj position");
@@ -612,6 +645,7 @@ register struct obj *otmp;
     dummy->o_id = context.ident++;
     if (!dummy->o_id)
         dummy->o_id = context.ident++; /* ident overflowed */
+    index_obj(dummy);
     dummy->timed = 0;
     copy_oextra(dummy, otmp);
     if (has_omid(dummy))
@@ -730,6 +764,7 @@ boolean artif;
     otmp->o_id = context.ident++;
     if (!otmp->o_id)
         otmp->o_id = context.ident++; /* ident overflowed */
+    index_obj(otmp);
     otmp->quan = 1L;
     otmp->oclass = let;
     otmp->otyp = otyp;
@@ -1643,6 +1678,43 @@ register struct obj *otmp;
  * and threaded through the nexthere fields in the object-instance structure.
  */
 
+/* the OSUM_xxx bit kept in level.objsummary[][] for objects of type otyp */
+int
+objsum_bit(otyp)
+int otyp;
+{
+    switch (otyp) {
+    case BOULDER:
+        return OSUM_BOULDER;
+    case SCR_SCARE_MONSTER:
+        return OSUM_SCARE;
+    case CORPSE:
+        return OSUM_CORPSE;
+    case GOLD_PIECE:
+        return OSUM_GOLD;
+    default:
+        if (otyp >= LARGE_BOX && otyp <= BAG_OF_TRICKS)
+            return OSUM_CONTAINER;
+        return 0;
+    }
+}
+
+/* an object with summary bit 'bit' has left <x,y>; clear the bit unless
+   something else there still calls for it */
+STATIC_OVL void
+objsum_recheck(bit, x, y)
+int bit, x, y;
+{
+    struct obj *otmp;
+
+    level.objsummary[x][y] &= ~bit;
+    for (otmp = level.objects[x][y]; otmp; otmp = otmp->nexthere)
+        if (objsum_bit(otmp->otyp) == bit) {
+            level.objsummary[x][y] |= bit;
+            break;
+        }
+}
+
 /* put the object at the given location */
 void
 place_object(otmp, x, y)
@@ -1662,11 +1734,18 @@ int x, y;
     /* obj goes under boulders */
     if (otmp2 && (otmp2->otyp == BOULDER)) {
         otmp->nexthere = otmp2->nexthere;
+        otmp->oprevhere = otmp2;
         otmp2->nexthere = otmp;
     } else {
         otmp->nexthere = otmp2;
+        otmp->oprevhere = (struct obj *) 0;
         level.objects[x][y] = otmp;
     }
+    if (otmp->nexthere)
+        otmp->nexthere->oprevhere = otmp;
+
+    level.objsummary[x][y] |= objsum_bit(otmp->otyp);
+    level.objcount[x][y]++;
 
     /* set the new object's location */
     otmp->ox = x;
@@ -1675,8 +1754,7 @@ int x, y;
     otmp->where = OBJ_FLOOR;
 
     /* add to floor chain */
-    otmp->nobj = fobj;
-    fobj = otmp;
+    link_nobj(otmp, &fobj);
     if (otmp->timed)
         obj_timer_checks(otmp, x, y, 0);
 }
@@ -1806,11 +1884,16 @@ register struct obj *otmp;
 {
     xchar x = otmp->ox;
     xchar y = otmp->oy;
+    int bit;
 
     if (otmp->where != OBJ_FLOOR)
         panic("remove_object: obj not on floor");
     extract_nexthere(otmp, &level.objects[x][y]);
     extract_nobj(otmp, &fobj);
+    if (!--level.objcount[x][y])
+        level.objsummary[x][y] = 0;
+    else if ((bit = objsum_bit(otmp->otyp)) != 0)
+        objsum_recheck(bit, x, y);
     /* update vision iff this was the only boulder at its spot */
     if (otmp->otyp == BOULDER && !sobj_at(BOULDER, x, y))
         unblock_point(x, y); /* vision */
@@ -1892,27 +1975,46 @@ struct obj *obj;
     }
 }
 
+/* Put obj at the head of the chain, maintaining the nobj back links. */
+void
+link_nobj(obj, head_ptr)
+struct obj *obj, **head_ptr;
+{
+    obj->nobj = *head_ptr;
+    obj->oprev = (struct obj *) 0;
+    if (obj->nobj)
+        obj->nobj->oprev = obj;
+    *head_ptr = obj;
+}
+
+/* Recompute the nobj back links of a chain which was rearranged by hand. */
+void
+relink_nobj(chain)
+struct obj *chain;
+{
+    struct obj *prev;
+
+    for (prev = (struct obj *) 0; chain; prev = chain, chain = chain->nobj)
+        chain->oprev = prev;
+}
+
 /* Extract the given object from the chain, following nobj chain. */
 void
 extract_nobj(obj, head_ptr)
 struct obj *obj, **head_ptr;
 {
-    struct obj *curr, *prev;
+    struct obj *prev = obj->oprev;
 
-    curr = *head_ptr;
-    for (prev = (struct obj *) 0; curr; prev = curr, curr = curr->nobj) {
-        if (curr == obj) {
-            if (prev)
-                prev->nobj = curr->nobj;
-            else
-                *head_ptr = curr->nobj;
-            break;
-        }
-    }
-    if (!curr)
+    if (prev ? prev->nobj != obj : *head_ptr != obj)
         panic("extract_nobj: object lost");
+    if (prev)
+        prev->nobj = obj->nobj;
+    else
+        *head_ptr = obj->nobj;
+    if (obj->nobj)
+        obj->nobj->oprev = prev;
     obj->where = OBJ_FREE;
-    obj->nobj = NULL;
+    obj->nobj = obj->oprev = NULL;
 }
 
 /*
@@ -1925,20 +2027,17 @@ void
 extract_nexthere(obj, head_ptr)
 struct obj *obj, **head_ptr;
 {
-    struct obj *curr, *prev;
+    struct obj *prev = obj->oprevhere;
 
-    curr = *head_ptr;
-    for (prev = (struct obj *) 0; curr; prev = curr, curr = curr->nexthere) {
-        if (curr == obj) {
-            if (prev)
-                prev->nexthere = curr->nexthere;
-            else
-                *head_ptr = curr->nexthere;
-            break;
-        }
-    }
-    if (!curr)
+    if (prev ? prev->nexthere != obj : *head_ptr != obj)
         panic("extract_nexthere: object lost");
+    if (prev)
+        prev->nexthere = obj->nexthere;
+    else
+        *head_ptr = obj->nexthere;
+    if (obj->nexthere)
+        obj->nexthere->oprevhere = prev;
+    obj->oprevhere = (struct obj *) 0;
 }
 
 /*
@@ -1963,8 +2062,7 @@ struct obj *obj;
     /* else insert; don't bother forcing it to end of chain */
     obj->where = OBJ_MINVENT;
     obj->ocarry = mon;
-    obj->nobj = mon->minvent;
-    mon->minvent = obj;
+    link_nobj(obj, &mon->minvent);
     return 0; /* obj on mon's inventory chain */
 }
 
@@ -1990,8 +2088,7 @@ struct obj *container, *obj;
 
     obj->where = OBJ_CONTAINED;
     obj->ocontainer = container;
-    obj->nobj = container->cobj;
-    container->cobj = obj;
+    link_nobj(obj, &container->cobj);
     return obj;
 }
 
@@ -2003,8 +2100,7 @@ struct obj *obj;
         panic("add_to_migration: obj not free");
 
     obj->where = OBJ_MIGRATING;
-    obj->nobj = migrating_objs;
-    migrating_objs = obj;
+    link_nobj(obj, &migrating_objs);
 }
 
 void
@@ -2015,8 +2111,7 @@ struct obj *obj;
         panic("add_to_buried: obj not free");
 
     obj->where = OBJ_BURIED;
-    obj->nobj = level.buriedobjlist;
-    level.buriedobjlist = obj;
+    link_nobj(obj, &level.buriedobjlist);
 }
 
 /* Recalculate the weight of this container and all of _its_ containers. */
@@ -2070,9 +2165,119 @@ struct obj *obj;
 
     if (obj->oextra)
         dealloc_oextra(obj);
+    unindex_obj(obj);
     free((genericptr_t) obj);
 }
 
+/*
+ * Index of objects by o_id, so that find_oid() doesn't have to walk
+ * every object chain on the level.  Each object is entered once it
+ * has been given its final o_id and stays until dealloc_obj(); since
+ * objects move between chains far more often than they are created,
+ * the index doesn't track where they are, obj_by_oid() checks that.
+ * Open addressing with linear probing, kept at most half full.
+ */
+static struct obj **oid_index = 0;
+static unsigned oid_indexsz = 0, oid_indexct = 0;
+
+#define OID_SLOT(id) (((id) ^ ((id) >> 12)) & (oid_indexsz - 1))
+
+STATIC_OVL void
+grow_oid_index()
+{
+    struct obj **oldindex = oid_index, *obj;
+    unsigned i, j, oldsz = oid_indexsz;
+
+    oid_indexsz = oldsz ? 2 * oldsz : 256;
+    oid_index = (struct obj **) alloc(oid_indexsz * sizeof *oid_index);
+    (void) memset((genericptr_t) oid_index, 0,
+                  oid_indexsz * sizeof *oid_index);
+    for (i = 0; i < oldsz; i++)
+        if ((obj = oldindex[i]) != 0) {
+            for (j = OID_SLOT(obj->o_id); oid_index[j];
+                 j = (j + 1) & (oid_indexsz - 1))
+                continue;
+            oid_index[j] = obj;
+        }
+    if (oldindex)
+        free((genericptr_t) oldindex);
+}
+
+/* enter a newly created or restored object into the o_id index */
+void
+index_obj(obj)
+struct obj *obj;
+{
+    unsigned i;
+
+    if (2 * (oid_indexct + 1) > oid_indexsz)
+        grow_oid_index();
+    for (i = OID_SLOT(obj->o_id); oid_index[i];
+         i = (i + 1) & (oid_indexsz - 1))
+        continue;
+    oid_index[i] = obj;
+    oid_indexct++;
+}
+
+STATIC_OVL void
+unindex_obj(obj)
+struct obj *obj;
+{
+    struct obj *otmp;
+    unsigned i, j, k, mask = oid_indexsz - 1;
+
+    if (!oid_indexct) {
+        impossible("unindex_obj: object %u not indexed", obj->o_id);
+        return;
+    }
+    for (i = OID_SLOT(obj->o_id); oid_index[i] != obj; i = (i + 1) & mask)
+        if (!oid_index[i]) {
+            impossible("unindex_obj: object %u not indexed", obj->o_id);
+            return;
+        }
+    /* close the gap so that later probes don't stop short */
+    oid_index[i] = 0;
+    for (j = (i + 1) & mask; (otmp = oid_index[j]) != 0; j = (j + 1) & mask) {
+        k = OID_SLOT(otmp->o_id);
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+            continue; /* already reachable from its home slot */
+        oid_index[i] = otmp;
+        oid_index[j] = 0;
+        i = j;
+    }
+    if (!--oid_indexct) {
+        free((genericptr_t) oid_index);
+        oid_index = 0;
+        oid_indexsz = 0;
+    }
+}
+
+/* look up an object by o_id; if onbill, only objects on billobjs (or
+   inside one) count, otherwise only ones on the lists find_oid() has
+   always searched--free objects and billobjs are skipped */
+struct obj *
+obj_by_oid(id, onbill)
+unsigned id;
+boolean onbill;
+{
+    struct obj *obj, *top;
+    unsigned i;
+
+    if (!oid_indexct)
+        return (struct obj *) 0;
+    for (i = OID_SLOT(id); (obj = oid_index[i]) != 0;
+         i = (i + 1) & (oid_indexsz - 1)) {
+        if (obj->o_id != id)
+            continue;
+        for (top = obj; top->where == OBJ_CONTAINED; top = top->ocontainer)
+            continue;
+        if (onbill ? (top->where == OBJ_ONBILL)
+                   : (top->where != OBJ_FREE && top->where != OBJ_ONBILL))
+            return obj;
+    }
+    return (struct obj *) 0;
+}
+
 /* create an object from a horn of plenty; mirrors bagotricks(makemon.c) */
 int
 hornoplenty(horn, tipping)
@@ -2149,6 +2354,7 @@ boolean tipping; /* caller emptying entire contents; affects shop handling */
 static const char NEARDATA /* pline formats for insane_object() */
     ofmt0[] = "%s obj %s %s: %s",
     ofmt3[] = "%s [not null] %s %s: %s",
+    ofmt4[] = "%s [bad back link] %s %s: %s",
     /* " held by mon %p (%s)" will be appended, filled by M,mon_nam(M) */
     mfmt1[] = "%s obj %s %s (%s)", mfmt2[] = "%s obj %s %s (%s) *not*";
 
@@ -2156,8 +2362,8 @@ static const char NEARDATA /* pline formats for insane_object() */
 void
 obj_sanity_check()
 {
-    int x, y;
-    struct obj *obj;
+    int x, y, bits, count;
+    struct obj *obj, *prev;
 
     objlist_sanity(fobj, OBJ_FLOOR, "floor sanity");
 
@@ -2165,8 +2371,15 @@ obj_sanity_check()
        those objects should have already been sanity checked via
        the floor list so container contents are skipped here */
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            for (obj = level.objects[x][y]; obj; obj = obj->nexthere) {
+        for (y = 0; y < ROWNO; y++) {
+            bits = count = 0;
+            for (obj = level.objects[x][y], prev = (struct obj *) 0; obj;
+                 prev = obj, obj = obj->nexthere) {
+                bits |= objsum_bit(obj->otyp);
+                count++;
+                if (obj->oprevhere != prev)
+                    insane_object(obj, ofmt4, "location sanity",
+                                  (struct monst *) 0);
                 /* <ox,oy> should match <x,y>; <0,*> should always be empty */
                 if (obj->where != OBJ_FLOOR || x == 0 || obj->ox != x
                     || obj->oy != y) {
@@ -2178,6 +2391,13 @@ obj_sanity_check()
                                   (struct monst *) 0);
                 }
             }
+            /* summary bits may be stale only in the "look" direction */
+            if (count != level.objcount[x][y]
+                || (bits & ~level.objsummary[x][y]) != 0)
+                impossible("object summary sanity <%d,%d> (%d/%d, %02x/%02x)",
+                           x, y, count, level.objcount[x][y], bits,
+                           level.objsummary[x][y]);
+        }
 
     objlist_sanity(invent, OBJ_INVENT, "invent sanity");
     objlist_sanity(migrating_objs, OBJ_MIGRATING, "migrating sanity");
@@ -2211,11 +2431,14 @@ struct obj *objlist;
 int wheretype;
 const char *mesg;
 {
-    struct obj *obj;
+    struct obj *obj, *prev;
 
-    for (obj = objlist; obj; obj = obj->nobj) {
+    for (obj = objlist, prev = (struct obj *) 0; obj;
+         prev = obj, obj = obj->nobj) {
         if (obj->where != wheretype)
             insane_object(obj, ofmt0, mesg, (struct monst *) 0);
+        if (obj->oprev != prev)
+            insane_object(obj, ofmt4, mesg, (struct monst *) 0);
         if (Has_contents(obj)) {
             if (wheretype == OBJ_ONBILL)
                 /* containers on shop bill should always be empty */
@@ -2261,7 +2484,7 @@ struct monst *monlist;
 const char *mesg;
 {
     struct monst *mon;
-    struct obj *obj, *mwep;
+    struct obj *obj, *mwep, *prev;
 
     for (mon = monlist; mon; mon = mon->nmon) {
         if (DEADMONSTER(mon)) continue;
@@ -2272,9 +2495,12 @@ const char *mesg;
             if (mwep->ocarry != mon)
                 insane_object(mwep, mfmt2, mesg, mon);
         }
-        for (obj = mon->minvent; obj; obj = obj->nobj) {
+        for (obj = mon->minvent, prev = (struct obj *) 0; obj;
+             prev = obj, obj = obj->nobj) {
             if (obj->where != OBJ_MINVENT)
                 insane_object(obj, mfmt1, mesg, mon);
+            if (obj->oprev != prev)
+                insane_object(obj, ofmt4, mesg, mon);
             if (obj->ocarry != mon)
                 insane_object(obj, mfmt2, mesg, mon);
             check_contained(obj, mesg);
@@ -2337,7 +2563,7 @@ check_contained(container, mesg)
 struct obj *container;
 const char *mesg;
 {
-    struct obj *obj;
+    struct obj *obj, *prev;
     /* big enough to work with, not too big to blow out stack in recursion */
     char mesgbuf[40], nestedmesg[120];
 
@@ -2348,10 +2574,13 @@ const char *mesg;
     if (!strstri(mesg, "contained"))
         mesg = strcat(strcpy(mesgbuf, "contained "), mesg);
 
-    for (obj = container->cobj; obj; obj = obj->nobj) {
+    for (obj = container->cobj, prev = (struct obj *) 0; obj;
+         prev = obj, obj = obj->nobj) {
         /* catch direct cycle to avoid unbounded recursion */
         if (obj == container)
             panic("failed sanity check: container holds itself");
+        if (obj->oprev != prev)
+            insane_object(obj, ofmt4, mesg, (struct monst *) 0);
         if (obj->where != OBJ_CONTAINED)
             insane_object(obj, "%s obj %s %s: %s", mesg, (struct monst *) 0);
         else if (obj->ocontainer != container)
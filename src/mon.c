@@ -27,6 +27,8 @@ STATIC_DCL struct permonst *FDECL(accept_newcham_form, (int));
 STATIC_DCL struct obj *FDECL(make_corpse, (struct monst *, unsigned));
 STATIC_DCL void FDECL(m_detach, (struct monst *, struct permonst *));
 STATIC_DCL void FDECL(lifesaved_monster, (struct monst *));
+STATIC_DCL void NDECL(grow_mid_index);
+STATIC_DCL void FDECL(unindex_monst, (struct monst *));
 
 #define LEVEL_SPECIFIC_NOCORPSE(mdat) \
     (Is_rogue_level(&u.uz)            \
@@ -1492,6 +1494,7 @@ struct monst *mtmp, *mtmp2;
     }
     mtmp2->nmon = fmon;
     fmon = mtmp2;
+    index_monst(mtmp2);
     if (u.ustuck == mtmp)
         u.ustuck = mtmp2;
     if (u.usteed == mtmp)
@@ -1633,9 +1636,107 @@ struct monst *mon;
         panic("dealloc_monst with nmon");
     if (mon->mextra)
         dealloc_mextra(mon);
+    unindex_monst(mon);
     free((genericptr_t) mon);
 }
 
+/*
+ * Index of monsters by m_id for find_mid().  Monsters are entered when
+ * created or restored and removed by dealloc_monst(); which chain a
+ * monster is on is left for find_mid() to sort out.  Same scheme as
+ * the o_id index in mkobj.c.
+ */
+static struct monst **mid_index = 0;
+static unsigned mid_indexsz = 0, mid_indexct = 0;
+
+#define MID_SLOT(id) (((id) ^ ((id) >> 12)) & (mid_indexsz - 1))
+
+STATIC_OVL void
+grow_mid_index()
+{
+    struct monst **oldindex = mid_index, *mtmp;
+    unsigned i, j, oldsz = mid_indexsz;
+
+    mid_indexsz = oldsz ? 2 * oldsz : 128;
+    mid_index = (struct monst **) alloc(mid_indexsz * sizeof *mid_index);
+    (void) memset((genericptr_t) mid_index, 0,
+                  mid_indexsz * sizeof *mid_index);
+    for (i = 0; i < oldsz; i++)
+        if ((mtmp = oldindex[i]) != 0) {
+            for (j = MID_SLOT(mtmp->m_id); mid_index[j];
+                 j = (j + 1) & (mid_indexsz - 1))
+                continue;
+            mid_index[j] = mtmp;
+        }
+    if (oldindex)
+        free((genericptr_t) oldindex);
+}
+
+/* enter a newly created or restored monster into the m_id index */
+void
+index_monst(mtmp)
+struct monst *mtmp;
+{
+    unsigned i;
+
+    if (2 * (mid_indexct + 1) > mid_indexsz)
+        grow_mid_index();
+    for (i = MID_SLOT(mtmp->m_id); mid_index[i];
+         i = (i + 1) & (mid_indexsz - 1))
+        continue;
+    mid_index[i] = mtmp;
+    mid_indexct++;
+}
+
+STATIC_OVL void
+unindex_monst(mon)
+struct monst *mon;
+{
+    struct monst *mtmp;
+    unsigned i, j, k, mask = mid_indexsz - 1;
+
+    if (!mid_indexct) {
+        impossible("unindex_monst: monster %u not indexed", mon->m_id);
+        return;
+    }
+    for (i = MID_SLOT(mon->m_id); mid_index[i] != mon; i = (i + 1) & mask)
+        if (!mid_index[i]) {
+            impossible("unindex_monst: monster %u not indexed", mon->m_id);
+            return;
+        }
+    /* close the gap so that later probes don't stop short */
+    mid_index[i] = 0;
+    for (j = (i + 1) & mask; (mtmp = mid_index[j]) != 0; j = (j + 1) & mask) {
+        k = MID_SLOT(mtmp->m_id);
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+            continue; /* already reachable from its home slot */
+        mid_index[i] = mtmp;
+        mid_index[j] = 0;
+        i = j;
+    }
+    if (!--mid_indexct) {
+        free((genericptr_t) mid_index);
+        mid_index = 0;
+        mid_indexsz = 0;
+    }
+}
+
+/* look up a monster by m_id, whatever chain it is on */
+struct monst *
+monst_by_mid(id)
+unsigned id;
+{
+    struct monst *mtmp;
+    unsigned i;
+
+    if (mid_indexct)
+        for (i = MID_SLOT(id); (mtmp = mid_index[i]) != 0;
+             i = (i + 1) & (mid_indexsz - 1))
+            if (mtmp->m_id == id)
+                return mtmp;
+    return (struct monst *) 0;
+}
+
 /* remove effects of mtmp from other data structures */
 STATIC_OVL void
 m_detach(mtmp, mptr)
@@ -15,6 +15,7 @@ STATIC_DCL void FDECL(distfleeck, (struct monst *, int *, int *, int *));
 STATIC_DCL int FDECL(m_arrival, (struct monst *));
 STATIC_DCL boolean FDECL(stuff_prevents_passage, (struct monst *));
 STATIC_DCL int FDECL(vamp_shift, (struct monst *, struct permonst *));
+STATIC_DCL void NDECL(monflow_update);
 
 /* True if mtmp died */
 boolean
@@ -690,6 +691,59 @@ xchar gx, gy;
     return FALSE;
 }
 
+/*
+ * With the wizard mode monflow option, monsters heading for the hero
+ * pick their steps by walking distance rather than straight-line
+ * distance, so they go around walls instead of bunching up behind them.
+ * The distances come from one breadth-first search out from the hero,
+ * made when the first monster needs it in a turn and shared by the
+ * rest.  It knows about terrain, boulders and the door rules for
+ * diagonal steps, but not about monsters; one standing where it can't
+ * reach (in rock or water, say) goes by straight-line distance.
+ * Without the option, monsters move exactly as they always have.
+ */
+static short flowdist[COLNO][ROWNO]; /* steps from the hero + 1; 0: none */
+static long flowmoves = -1L;         /* the turn it was made for */
+static xchar flowx, flowy;           /* and where the hero was */
+static d_level flowlev;
+
+#define flow_ok(x, y) \
+    (ACCESSIBLE(levl[x][y].typ) && !sobj_at(BOULDER, x, y))
+#define flow_door(x, y) \
+    (IS_DOOR(levl[x][y].typ) && (levl[x][y].doormask & ~D_BROKEN))
+
+STATIC_OVL void
+monflow_update()
+{
+    static xchar stepx[COLNO * ROWNO], stepy[COLNO * ROWNO];
+    int head = 0, tail = 0, dir, x, y, nx, ny;
+
+    if (flowmoves == moves && flowx == u.ux && flowy == u.uy
+        && on_level(&flowlev, &u.uz))
+        return;
+    bench_begin(BENCH_MONFLOW);
+    flowmoves = moves;
+    flowx = u.ux, flowy = u.uy;
+    assign_level(&flowlev, &u.uz);
+    (void) memset((genericptr_t) flowdist, 0, sizeof flowdist);
+    flowdist[u.ux][u.uy] = 1;
+    stepx[tail] = u.ux, stepy[tail++] = u.uy;
+    while (head < tail) {
+        x = stepx[head], y = stepy[head++];
+        for (dir = 0; dir < 8; dir++) {
+            nx = x + xdir[dir], ny = y + ydir[dir];
+            if (!isok(nx, ny) || flowdist[nx][ny] || !flow_ok(nx, ny))
+                continue;
+            /* no diagonal moves into or out of a doorway */
+            if (nx != x && ny != y && (flow_door(x, y) || flow_door(nx, ny)))
+                continue;
+            flowdist[nx][ny] = flowdist[x][y] + 1;
+            stepx[tail] = nx, stepy[tail++] = ny;
+        }
+    }
+    bench_end(BENCH_MONFLOW);
+}
+
 /* Return values:
  * 0: did not move, but can still attack and do other stuff.
  * 1: moved, possibly can attack.
@@ -711,6 +765,7 @@ register int after;
     boolean uses_items = 0, setlikes = 0;
     boolean avoid = FALSE;
     boolean better_with_displacing = FALSE;
+    boolean use_flow = FALSE;
     struct permonst *ptr;
     struct monst *mtoo;
     schar mmoved = 0; /* not strictly nec.: chi >= 0 will do */
@@ -1049,6 +1104,14 @@ not_special:
         if (!mtmp->mpeaceful && level.flags.shortsighted
             && nidist > (couldsee(nix, niy) ? 144 : 36) && appr == 1)
             appr = 0;
+        if (appr == 1 && wizard && iflags.mon_flow && gx == u.ux
+            && gy == u.uy) {
+            monflow_update();
+            if (flowdist[omx][omy]) {
+                use_flow = TRUE;
+                nidist = flowdist[omx][omy];
+            }
+        }
         if (is_unicorn(ptr) && level.flags.noteleport) {
             /* on noteleport levels, perhaps we cannot avoid hero */
             for (i = 0; i < cnt; i++)
@@ -1074,7 +1137,11 @@ not_special:
                             goto nxti;
             }
 
-            nearer = ((ndist = dist2(nx, ny, gx, gy)) < nidist);
+            if (!use_flow)
+                ndist = dist2(nx, ny, gx, gy);
+            else if (!(ndist = flowdist[nx][ny]))
+                ndist = COLNO * ROWNO; /* no known way on from there */
+            nearer = (ndist < nidist);
 
             if ((appr == 1 && nearer) || (appr == -1 && !nearer)
                 || (!appr && !rn2(++chcnt)) || !mmoved) {
@@ -318,6 +318,7 @@ int force;
                     filltype = fillholetyp(x, y, FALSE);
                     if (filltype != ROOM) {
                         levl[x][y].typ = filltype;
+                        update_bitboards(x, y);
                         liquid_flow(x, y, filltype, chasm, (char *) 0);
                     }
 
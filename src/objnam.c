@@ -3121,6 +3121,7 @@ wiztrap:
         p = eos(bp);
         if (!BSTRCMPI(bp, p - 8, "fountain")) {
             lev->typ = FOUNTAIN;
+            update_bitboards(x, y);
             level.flags.nfountains++;
             if (!strncmpi(bp, "magic ", 6))
                 lev->blessedftn = 1;
@@ -3130,12 +3131,14 @@ wiztrap:
         }
         if (!BSTRCMPI(bp, p - 6, "throne")) {
             lev->typ = THRONE;
+            update_bitboards(x, y);
             pline("A throne.");
             newsym(x, y);
             return &zeroobj;
         }
         if (!BSTRCMPI(bp, p - 4, "sink")) {
             lev->typ = SINK;
+            update_bitboards(x, y);
             level.flags.nsinks++;
             pline("A sink.");
             newsym(x, y);
@@ -3144,6 +3147,7 @@ wiztrap:
         /* ("water" matches "potion of water" rather than terrain) */
         if (!BSTRCMPI(bp, p - 4, "pool") || !BSTRCMPI(bp, p - 4, "moat")) {
             lev->typ = !BSTRCMPI(bp, p - 4, "pool") ? POOL : MOAT;
+            update_bitboards(x, y);
             del_engr_at(x, y);
             pline("A %s.", (lev->typ == POOL) ? "pool" : "moat");
             /* Must manually make kelp! */
@@ -3153,6 +3157,7 @@ wiztrap:
         }
         if (!BSTRCMPI(bp, p - 4, "lava")) { /* also matches "molten lava" */
             lev->typ = LAVAPOOL;
+            update_bitboards(x, y);
             del_engr_at(x, y);
             pline("A pool of molten lava.");
             if (!(Levitation || Flying))
@@ -3165,6 +3170,7 @@ wiztrap:
             aligntyp al;
 
             lev->typ = ALTAR;
+            update_bitboards(x, y);
             if (!strncmpi(bp, "chaotic ", 8))
                 al = A_CHAOTIC;
             else if (!strncmpi(bp, "neutral ", 8))
@@ -3192,6 +3198,7 @@ wiztrap:
 
         if (!BSTRCMPI(bp, p - 4, "tree")) {
             lev->typ = TREE;
+            update_bitboards(x, y);
             pline("A tree.");
             newsym(x, y);
             block_point(x, y);
@@ -3200,6 +3207,7 @@ wiztrap:
 
         if (!BSTRCMPI(bp, p - 4, "bars")) {
             lev->typ = IRONBARS;
+            update_bitboards(x, y);
             pline("Iron bars.");
             newsym(x, y);
             return &zeroobj;
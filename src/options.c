@@ -138,6 +138,9 @@ static struct Bool_Opt {
     { "legacy", &flags.legacy, TRUE, DISP_IN_GAME },
     { "lit_corridor", &flags.lit_corridor, FALSE, SET_IN_GAME },
     { "lootabc", &flags.lootabc, FALSE, SET_IN_GAME },
+#ifdef LZCOMP
+    { "lzcomp", &iflags.lzcomp, TRUE, DISP_IN_GAME },
+#endif
 #ifdef MAIL
     { "mail", &flags.biff, TRUE, SET_IN_GAME },
 #else
@@ -148,6 +151,7 @@ static struct Bool_Opt {
     /* for menu debugging only*/
     { "menu_tab_sep", &iflags.menu_tab_sep, FALSE, SET_IN_GAME },
     { "menu_objsyms", &iflags.menu_head_objsym, FALSE, SET_IN_GAME },
+    { "monflow", &iflags.mon_flow, FALSE, SET_IN_GAME },
     { "mouse_support", &iflags.wc_mouse_support, TRUE, DISP_IN_GAME }, /*WC*/
 #ifdef NEWS
     { "news", &iflags.news, TRUE, DISP_IN_GAME },
@@ -520,6 +524,7 @@ STATIC_DCL boolean FDECL(add_menu_coloring_parsed, (char *, int, int));
 STATIC_DCL void FDECL(free_one_menu_coloring, (int));
 STATIC_DCL int NDECL(count_menucolors);
 STATIC_DCL int FDECL(handle_add_list_remove, (const char *, int));
+STATIC_DCL void FDECL(discard_regex_set, (struct nhregex_set **));
 
 void
 reglyph_darkroom()
@@ -658,6 +663,10 @@ initoptions_init()
     set_restpref("rlecomp");
 #endif
 #endif
+#ifdef LZCOMP
+    set_savepref("lzcomp");
+    set_restpref("lzcomp");
+#endif
 #ifdef SYSFLAGS
     Strcpy(sysflags.sysflagsid, "sysflags");
     sysflags.sysflagsid[9] = (char) sizeof(struct sysflag);
@@ -1208,6 +1217,13 @@ STATIC_VAR const struct paranoia_opts {
 
 extern struct menucoloring *menu_colorings;
 
+/* the MSGTYPE, MENUCOLOR and AUTOPICKUP_EXCEPTION regexes combined into
+   one set per list, in list order, so that each string is tested against
+   a whole list at once; discarded whenever its list changes and rebuilt
+   when next needed */
+static struct nhregex_set *msgtype_set = 0, *menucolor_set = 0,
+                          *ape_set[2] = { 0, 0 };
+
 static const struct {
     const char *name;
     const int color;
@@ -1403,6 +1419,7 @@ char *pattern;
     tmp->pattern = dupstr(pattern);
     tmp->next = plinemsg_types;
     plinemsg_types = tmp;
+    discard_regex_set(&msgtype_set);
     return TRUE;
 }
 
@@ -1411,6 +1428,7 @@ msgtype_free()
 {
     struct plinemsg_type *tmp, *tmp2 = 0;
 
+    discard_regex_set(&msgtype_set);
     for (tmp = plinemsg_types; tmp; tmp = tmp2) {
         tmp2 = tmp->next;
         free((genericptr_t) tmp->pattern);
@@ -1431,6 +1449,7 @@ int idx; /* 0 .. */
         if (idx == 0) {
             struct plinemsg_type *next = tmp->next;
 
+            discard_regex_set(&msgtype_set);
             regex_free(tmp->regex);
             free((genericptr_t) tmp->pattern);
             free((genericptr_t) tmp);
@@ -1450,14 +1469,32 @@ int
 msgtype_type(msg)
 const char *msg;
 {
-    struct plinemsg_type *tmp = plinemsg_types;
+    struct plinemsg_type *tmp;
+    int i;
 
-    while (tmp) {
-        if (regex_match(msg, tmp->regex))
-            return tmp->msgtype;
+    if (!plinemsg_types)
+        return MSGTYP_NORMAL;
+    if (!msgtype_set) {
+        msgtype_set = regex_set_init();
+        for (tmp = plinemsg_types; tmp; tmp = tmp->next)
+            regex_set_add(msgtype_set, tmp->regex);
+    }
+    /* first match in the list wins */
+    if ((i = regex_set_match(msg, msgtype_set, 0)) < 0)
+        return MSGTYP_NORMAL;
+    for (tmp = plinemsg_types; i > 0; i--)
         tmp = tmp->next;
+    return tmp->msgtype;
+}
+
+STATIC_OVL void
+discard_regex_set(setp)
+struct nhregex_set **setp;
+{
+    if (*setp) {
+        regex_set_free(*setp);
+        *setp = (struct nhregex_set *) 0;
     }
-    return MSGTYP_NORMAL;
 }
 
 int
@@ -1522,6 +1559,7 @@ int c, a;
         tmp->color = c;
         tmp->attr = a;
         menu_colorings = tmp;
+        discard_regex_set(&menucolor_set);
         return TRUE;
     }
 }
@@ -1593,15 +1631,22 @@ char *str;
 int *color, *attr;
 {
     struct menucoloring *tmpmc;
+    int i;
 
-    if (iflags.use_menu_color)
+    if (!iflags.use_menu_color || !menu_colorings)
+        return FALSE;
+    if (!menucolor_set) {
+        menucolor_set = regex_set_init();
         for (tmpmc = menu_colorings; tmpmc; tmpmc = tmpmc->next)
-            if (regex_match(str, tmpmc->match)) {
-                *color = tmpmc->color;
-                *attr = tmpmc->attr;
-                return TRUE;
-            }
-    return FALSE;
+            regex_set_add(menucolor_set, tmpmc->match);
+    }
+    if ((i = regex_set_match(str, menucolor_set, 0)) < 0)
+        return FALSE;
+    for (tmpmc = menu_colorings; i > 0; i--)
+        tmpmc = tmpmc->next;
+    *color = tmpmc->color;
+    *attr = tmpmc->attr;
+    return TRUE;
 }
 
 void
@@ -1609,6 +1654,7 @@ free_menu_coloring()
 {
     struct menucoloring *tmp = menu_colorings;
 
+    discard_regex_set(&menucolor_set);
     while (tmp) {
         struct menucoloring *tmp2 = tmp->next;
 
@@ -1630,6 +1676,7 @@ int idx; /* 0 .. */
         if (idx == 0) {
             struct menucoloring *next = tmp->next;
 
+            discard_regex_set(&menucolor_set);
             regex_free(tmp->match);
             free((genericptr_t) tmp->origstr);
             free((genericptr_t) tmp);
@@ -3320,11 +3367,29 @@ boolean tinitial, tfrom_file;
 #endif
 #ifdef ZEROCOMP
             if ((boolopt[i].addr) == &iflags.zerocomp) {
+#ifdef LZCOMP
+                /* lzcomp, when on, wins regardless of option order */
+                if (iflags.lzcomp)
+                    set_savepref("lzcomp");
+                else
+#endif
                 if (*boolopt[i].addr)
                     set_savepref("zerocomp");
                 else
                     set_savepref("externalcomp");
             }
+#endif
+#ifdef LZCOMP
+            if ((boolopt[i].addr) == &iflags.lzcomp) {
+                if (*boolopt[i].addr)
+                    set_savepref("lzcomp");
+#ifdef ZEROCOMP
+                else if (iflags.zerocomp)
+                    set_savepref("zerocomp");
+#endif
+                else
+                    set_savepref("externalcomp");
+            }
 #endif
             /* only do processing below if setting with doset() */
             if (initial)
@@ -3528,6 +3593,8 @@ doset()
                     continue; /* obsolete */
                 if (bool_p == &iflags.sanity_check && !wizard)
                     continue;
+                if (bool_p == &iflags.mon_flow && !wizard)
+                    continue;
                 if (bool_p == &iflags.menu_tab_sep && !wizard)
                     continue;
                 if (is_wc_option(boolopt[i].name)
@@ -4845,6 +4912,7 @@ const char *mapping;
         ape->grab = grab;
         ape->next = *apehead;
         *apehead = ape;
+        discard_regex_set(&ape_set[grab ? AP_GRAB : AP_LEAVE]);
     } else {
         raw_print("syntax error in AUTOPICKUP_EXCEPTION");
         return 0;
@@ -4868,6 +4936,7 @@ struct autopickup_exception *whichape;
                 prev->next = ape;
             else
                 iflags.autopickup_exceptions[chain] = ape;
+            discard_regex_set(&ape_set[chain]);
             regex_free(freeape->regex);
             free((genericptr_t) freeape->pattern);
             free((genericptr_t) freeape);
@@ -4907,6 +4976,7 @@ free_autopickup_exceptions()
     int pass;
 
     for (pass = AP_LEAVE; pass <= AP_GRAB; ++pass) {
+        discard_regex_set(&ape_set[pass]);
         while ((ape = iflags.autopickup_exceptions[pass]) != 0) {
             regex_free(ape->regex);
             free((genericptr_t) ape->pattern);
@@ -4916,6 +4986,22 @@ free_autopickup_exceptions()
     }
 }
 
+/* the regexes of one AUTOPICKUP_EXCEPTION chain, as a set in chain order */
+struct nhregex_set *
+autopickup_exception_set(grab)
+boolean grab;
+{
+    struct autopickup_exception *ape;
+    int chain = grab ? AP_GRAB : AP_LEAVE;
+
+    if (!ape_set[chain]) {
+        ape_set[chain] = regex_set_init();
+        for (ape = iflags.autopickup_exceptions[chain]; ape; ape = ape->next)
+            regex_set_add(ape_set[chain], ape->regex);
+    }
+    return ape_set[chain];
+}
+
 /* bundle some common usage into one easy-to-use routine */
 int
 load_symset(s, which_set)
@@ -5061,6 +5147,8 @@ option_help()
         if (boolopt[i].addr) {
             if (boolopt[i].addr == &iflags.sanity_check && !wizard)
                 continue;
+            if (boolopt[i].addr == &iflags.mon_flow && !wizard)
+                continue;
             if (boolopt[i].addr == &iflags.menu_tab_sep && !wizard)
                 continue;
             next_opt(datawin, boolopt[i].name);
@@ -8,12 +8,34 @@
 #include "hack.h"
 #include "dlb.h"
 
+/* DATAIDXFILE while checkfile() is using it; its layout is in global.h */
+struct dataidx {
+    dlb *fp;
+    unsigned long nbuckets, nkeys, nwild, strsize;
+    long keys;           /* file offset of the key records */
+    unsigned char *wild; /* the wildcard list */
+    char *strs;          /* the key strings */
+    boolean bad;         /* unusable; fall back to scanning DATAFILE */
+};
+
 STATIC_DCL boolean FDECL(is_swallow_sym, (int));
 STATIC_DCL int FDECL(append_str, (char *, const char *));
 STATIC_DCL void FDECL(look_at_object, (char *, int, int, int));
 STATIC_DCL void FDECL(look_at_monster, (char *, char *,
                                         struct monst *, int, int));
 STATIC_DCL struct permonst *FDECL(lookat, (int, int, char *, char *));
+STATIC_DCL unsigned long FDECL(dx_word, (const unsigned char *));
+STATIC_DCL boolean FDECL(dx_read, (struct dataidx *, long, genericptr_t,
+                                   long));
+STATIC_DCL boolean FDECL(dx_key, (struct dataidx *, unsigned long,
+                                  unsigned long *));
+STATIC_DCL unsigned long FDECL(dx_chain, (struct dataidx *, unsigned long,
+                                          const char *));
+STATIC_DCL boolean FDECL(dx_maybe, (const char *, const char *, int));
+STATIC_DCL unsigned long FDECL(dx_wild, (struct dataidx *, unsigned long *,
+                                         const char *, const char *));
+STATIC_DCL int FDECL(lookup_dataidx, (const char *, const char *,
+                                      unsigned long, long *, int *));
 STATIC_DCL void FDECL(checkfile, (char *, struct permonst *,
                                   BOOLEAN_P, BOOLEAN_P));
 STATIC_DCL void FDECL(look_all, (BOOLEAN_P,BOOLEAN_P));
@@ -362,6 +384,211 @@ char *buf, *monbuf;
     return (pm && !Hallucination) ? pm : (struct permonst *) 0;
 }
 
+/* decode one of the index's little-endian words */
+STATIC_OVL unsigned long
+dx_word(b)
+const unsigned char *b;
+{
+    return (unsigned long) b[0] | ((unsigned long) b[1] << 8)
+           | ((unsigned long) b[2] << 16) | ((unsigned long) b[3] << 24);
+}
+
+/* read len bytes at pos in the index */
+STATIC_OVL boolean
+dx_read(dx, pos, buf, len)
+struct dataidx *dx;
+long pos;
+genericptr_t buf;
+long len;
+{
+    if (dx->bad || dlb_fseek(dx->fp, pos, SEEK_SET) < 0
+        || (len > 0L && dlb_fread((char *) buf, (int) len, 1, dx->fp) != 1))
+        dx->bad = TRUE;
+    return !dx->bad;
+}
+
+/* fetch the record for key k */
+STATIC_OVL boolean
+dx_key(dx, k, rec)
+struct dataidx *dx;
+unsigned long k;
+unsigned long *rec;
+{
+    unsigned char b[4 * DATAIDX_KEYSIZ];
+    int i;
+
+    if (k >= dx->nkeys)
+        dx->bad = TRUE;
+    if (!dx_read(dx, dx->keys + (long) sizeof b * (long) k, (genericptr_t) b,
+                 (long) sizeof b))
+        return FALSE;
+    for (i = 0; i < DATAIDX_KEYSIZ; i++)
+        rec[i] = dx_word(&b[4 * i]);
+    if (rec[1] >= dx->strsize)
+        dx->bad = TRUE;
+    return !dx->bad;
+}
+
+/* follow a hash chain from key k to the first literal key equal to str */
+STATIC_OVL unsigned long
+dx_chain(dx, k, str)
+struct dataidx *dx;
+unsigned long k;
+const char *str;
+{
+    unsigned long rec[DATAIDX_KEYSIZ], n;
+
+    for (n = 0; k != DATAIDX_NONE && n < dx->nkeys; n++) {
+        if (!dx_key(dx, k, rec))
+            break;
+        if (!strcmp(&dx->strs[rec[1]], str))
+            return k;
+        k = rec[0];
+    }
+    return DATAIDX_NONE;
+}
+
+/* whether a wildcard key's fixed first and last characters let it match
+   str at all; most keys are "foo*" or "*foo", so this spares pmatch() */
+STATIC_OVL boolean
+dx_maybe(name, str, len)
+const char *name, *str;
+int len;
+{
+    int nlen = (int) strlen(name);
+    char c;
+
+    if ((c = name[0]) != '*' && c != '?' && c != str[0])
+        return FALSE;
+    if ((c = name[nlen - 1]) != '*' && c != '?'
+        && (!len || c != str[len - 1]))
+        return FALSE;
+    return TRUE;
+}
+
+/* continue the scan of wildcard keys for one matching either string */
+STATIC_OVL unsigned long
+dx_wild(dx, wpos, str, alt)
+struct dataidx *dx;
+unsigned long *wpos;
+const char *str, *alt;
+{
+    const unsigned char *w;
+    const char *name;
+    int len = (int) strlen(str), altlen = alt ? (int) strlen(alt) : 0;
+
+    while (*wpos < dx->nwild) {
+        w = &dx->wild[4 * DATAIDX_WILDSIZ * (*wpos)++];
+        if (dx_word(w + 4) >= dx->strsize) {
+            dx->bad = TRUE;
+            break;
+        }
+        name = &dx->strs[dx_word(w + 4)];
+        if ((dx_maybe(name, str, len) && pmatch(name, str))
+            || (alt && dx_maybe(name, alt, altlen) && pmatch(name, alt)))
+            return dx_word(w);
+    }
+    return DATAIDX_NONE;
+}
+
+/*
+ * Find the entry for str or alt using DATAIDXFILE.  The literal keys equal
+ * to either string come from two hash chains and the wildcard keys from
+ * a scan; all three are in key order, so merging them visits the matches
+ * in the order checkfile()'s scan of DATAFILE would.  Returns 1 and sets
+ * the entry's text offset and line count if found, 0 if not found, or -1
+ * if the index is missing, stale or unreadable.
+ */
+STATIC_OVL int
+lookup_dataidx(str, alt, txt_offset, entry_offset, entry_count)
+const char *str, *alt;
+unsigned long txt_offset;
+long *entry_offset;
+int *entry_count;
+{
+    struct dataidx dx;
+    unsigned char b[4 * DATAIDX_HDRSIZ];
+    unsigned long hdr[DATAIDX_HDRSIZ], rec[DATAIDX_KEYSIZ], cur[3], h,
+        wpos = 0, skip = DATAIDX_NONE;
+    long wildpos;
+    const char *p;
+    int i, best, result = -1;
+
+    if (!(dx.fp = dlb_fopen(DATAIDXFILE, RDBMODE)))
+        return -1;
+    dx.bad = FALSE;
+    dx.wild = (unsigned char *) 0;
+    dx.strs = (char *) 0;
+    if (!dx_read(&dx, 0L, (genericptr_t) b, (long) sizeof b))
+        goto done;
+    for (i = 0; i < DATAIDX_HDRSIZ; i++)
+        hdr[i] = dx_word(&b[4 * i]);
+    if (hdr[0] != DATAIDX_MAGIC || hdr[1] != DATAIDX_VERSION
+        || hdr[2] != txt_offset || !hdr[3] || (hdr[3] & (hdr[3] - 1)) != 0
+        || !hdr[6])
+        goto done;
+    dx.nbuckets = hdr[3], dx.nkeys = hdr[4], dx.nwild = hdr[5];
+    dx.strsize = hdr[6];
+    dx.keys = 4L * (DATAIDX_HDRSIZ + (long) dx.nbuckets);
+    wildpos = dx.keys + 4L * DATAIDX_KEYSIZ * (long) dx.nkeys;
+
+    /* the wildcard list and the strings are wanted whole */
+    dx.wild = (unsigned char *) alloc(4 * DATAIDX_WILDSIZ * dx.nwild + 1);
+    dx.strs = (char *) alloc(dx.strsize);
+    if (!dx_read(&dx, wildpos, (genericptr_t) dx.wild,
+                 4L * DATAIDX_WILDSIZ * (long) dx.nwild)
+        || !dx_read(&dx, wildpos + 4L * DATAIDX_WILDSIZ * (long) dx.nwild,
+                    (genericptr_t) dx.strs, (long) dx.strsize)
+        || dx.strs[dx.strsize - 1] != '\0')
+        goto done;
+
+    for (i = 0; i < 2; i++) {
+        cur[i] = DATAIDX_NONE;
+        if (!(p = i ? alt : str))
+            continue;
+        for (h = DATAIDX_HASHINIT; *p; p++)
+            h = DATAIDX_HASH(h, *p);
+        h &= dx.nbuckets - 1;
+        if (dx_read(&dx, 4L * (DATAIDX_HDRSIZ + (long) h), (genericptr_t) b,
+                    4L))
+            cur[i] = dx_chain(&dx, dx_word(b), i ? alt : str);
+    }
+    cur[2] = dx_wild(&dx, &wpos, str, alt);
+
+    result = 0;
+    for (;;) {
+        for (best = -1, i = 0; i < 3; i++)
+            if (cur[i] != DATAIDX_NONE && (best < 0 || cur[i] < cur[best]))
+                best = i;
+        if (best < 0 || !dx_key(&dx, cur[best], rec))
+            break;
+        /* the first key to match in an entry decides it; a "~key"
+           match means the rest of that entry is skipped */
+        if (rec[2] != skip) {
+            if (!(rec[3] & DATAIDX_TILDE)) {
+                *entry_offset = (long) rec[4];
+                *entry_count = (int) rec[5];
+                result = 1;
+                break;
+            }
+            skip = rec[2];
+        }
+        if (best < 2)
+            cur[best] = dx_chain(&dx, rec[0], best ? alt : str);
+        else
+            cur[2] = dx_wild(&dx, &wpos, str, alt);
+    }
+done:
+    if (dx.bad)
+        result = -1;
+    if (dx.wild)
+        free((genericptr_t) dx.wild);
+    if (dx.strs)
+        free((genericptr_t) dx.strs);
+    (void) dlb_fclose(dx.fp);
+    return result;
+}
+
 /*
  * Look in the "data" file for more info.  Called if the user typed in the
  * whole name (user_typed_name == TRUE), or we've found a possible match
@@ -382,8 +609,9 @@ boolean user_typed_name, without_asking;
     char buf[BUFSZ], newstr[BUFSZ];
     char *ep, *dbase_str;
     unsigned long txt_offset = 0L;
-    int chk_skip;
-    boolean found_in_file = FALSE, skipping_entry = FALSE;
+    long entry_offset = 0L;
+    int chk_skip, idx_result, entry_count = 0;
+    boolean found_in_file = FALSE, skipping_entry = FALSE, indexed = FALSE;
     winid datawin = WIN_ERR;
 
     fp = dlb_fopen(DATAFILE, "r");
@@ -465,28 +693,35 @@ boolean user_typed_name, without_asking;
         } else if (sscanf(buf, "%8lx\n", &txt_offset) < 1 || txt_offset == 0L)
             goto bad_data_file;
 
-        /* look for the appropriate entry */
-        while (dlb_fgets(buf, BUFSZ, fp)) {
-            if (*buf == '.')
-                break; /* we passed last entry without success */
-
-            if (digit(*buf)) {
-                /* a number indicates the end of current entry */
-                skipping_entry = FALSE;
-            } else if (!skipping_entry) {
-                if (!(ep = index(buf, '\n')))
-                    goto bad_data_file;
-                *ep = 0;
-                /* if we match a key that begins with "~", skip this entry */
-                chk_skip = (*buf == '~') ? 1 : 0;
-                if (pmatch(&buf[chk_skip], dbase_str)
-                    || (alt && pmatch(&buf[chk_skip], alt))) {
-                    if (chk_skip) {
-                        skipping_entry = TRUE;
-                        continue;
-                    } else {
-                        found_in_file = TRUE;
-                        break;
+        /* try the index first; scan the file only if it can't be used */
+        if ((idx_result = lookup_dataidx(dbase_str, alt, txt_offset,
+                                         &entry_offset, &entry_count)) >= 0) {
+            found_in_file = indexed = (idx_result > 0);
+        } else {
+            /* look for the appropriate entry */
+            while (dlb_fgets(buf, BUFSZ, fp)) {
+                if (*buf == '.')
+                    break; /* we passed last entry without success */
+
+                if (digit(*buf)) {
+                    /* a number indicates the end of current entry */
+                    skipping_entry = FALSE;
+                } else if (!skipping_entry) {
+                    if (!(ep = index(buf, '\n')))
+                        goto bad_data_file;
+                    *ep = 0;
+                    /* if we match a key that begins with "~",
+                       skip this entry */
+                    chk_skip = (*buf == '~') ? 1 : 0;
+                    if (pmatch(&buf[chk_skip], dbase_str)
+                        || (alt && pmatch(&buf[chk_skip], alt))) {
+                        if (chk_skip) {
+                            skipping_entry = TRUE;
+                            continue;
+                        } else {
+                            found_in_file = TRUE;
+                            break;
+                        }
                     }
                 }
             }
@@ -494,16 +729,17 @@ boolean user_typed_name, without_asking;
     }
 
     if (found_in_file) {
-        long entry_offset;
-        int entry_count;
         int i;
 
         /* skip over other possible matches for the info */
-        do {
-            if (!dlb_fgets(buf, BUFSZ, fp))
-                goto bad_data_file;
-        } while (!digit(*buf));
-        if (sscanf(buf, "%ld,%d\n", &entry_offset, &entry_count) < 2) {
+        if (!indexed) {
+            do {
+                if (!dlb_fgets(buf, BUFSZ, fp))
+                    goto bad_data_file;
+            } while (!digit(*buf));
+        }
+        if (!indexed
+            && sscanf(buf, "%ld,%d\n", &entry_offset, &entry_count) < 2) {
         bad_data_file:
             impossible("'data' file in wrong format or corrupted");
             /* window will exist if we came here from below via 'goto' */
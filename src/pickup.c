@@ -285,14 +285,12 @@ STATIC_OVL void
 check_here(picked_some)
 boolean picked_some;
 {
-    register struct obj *obj;
-    register int ct = 0;
+    register int ct = level.objcount[u.ux][u.uy];
 
-    /* count the objects here */
-    for (obj = level.objects[u.ux][u.uy]; obj; obj = obj->nexthere) {
-        if (obj != uchain)
-            ct++;
-    }
+    /* count the objects here, other than the chain */
+    if (uchain && uchain->where == OBJ_FLOOR && uchain->ox == u.ux
+        && uchain->oy == u.uy)
+        ct--;
 
     /* If there are objects here, take a look. */
     if (ct) {
@@ -683,16 +681,14 @@ boolean grab; /* forced pickup, rather than forced leave behind? */
     /*
      *  Does the text description of this match an exception?
      */
-    char *objdesc = makesingular(doname(obj));
-    struct autopickup_exception *ape =
-        (grab) ? iflags.autopickup_exceptions[AP_GRAB]
-               : iflags.autopickup_exceptions[AP_LEAVE];
-    while (ape) {
-        if (regex_match(objdesc, ape->regex))
-            return TRUE;
-        ape = ape->next;
-    }
-    return FALSE;
+    char *objdesc;
+
+    if (!iflags.autopickup_exceptions[grab ? AP_GRAB : AP_LEAVE])
+        return FALSE;
+    objdesc = makesingular(doname(obj));
+    return (boolean) (regex_set_match(objdesc,
+                                      autopickup_exception_set(grab), 0)
+                      >= 0);
 }
 
 /*
@@ -1511,6 +1507,8 @@ boolean countem;
     struct obj *cobj, *nobj;
     int container_count = 0;
 
+    if (!objsum_at(OSUM_CONTAINER, x, y))
+        return 0;
     for (cobj = level.objects[x][y]; cobj; cobj = nobj) {
         nobj = cobj->nexthere;
         if (Is_container(cobj)) {
@@ -20,6 +20,13 @@ STATIC_DCL void NDECL(zerocomp_minit);
 STATIC_DCL void FDECL(zerocomp_mread, (int, genericptr_t, unsigned int));
 STATIC_DCL int NDECL(zerocomp_mgetc);
 #endif
+#ifdef LZCOMP
+STATIC_DCL void NDECL(lzcomp_minit);
+STATIC_DCL void FDECL(lzcomp_mread, (int, genericptr_t, unsigned int));
+STATIC_DCL boolean FDECL(lzcomp_fill, (int));
+STATIC_DCL int FDECL(lzcomp_unpack, (unsigned char *, unsigned,
+                                     unsigned char *, unsigned));
+#endif
 
 STATIC_DCL void NDECL(def_minit);
 STATIC_DCL void FDECL(def_mread, (int, genericptr_t, unsigned int));
@@ -58,22 +65,24 @@ static struct restore_procs {
 
 /*
  * Save a mapping of IDs from ghost levels to the current level.  This
- * map is used by the timer routines when restoring ghost levels.
+ * map is used by the timer routines when restoring ghost levels.  It
+ * is a hash table on the ghost ID (open addressing, at most half full)
+ * so that loading a large bones level stays linear in its contents.
+ * Object and monster IDs are never 0, so a 0 gid marks an empty slot.
  */
-#define N_PER_BUCKET 64
-struct bucket {
-    struct bucket *next;
-    struct {
-        unsigned gid; /* ghost ID */
-        unsigned nid; /* new ID */
-    } map[N_PER_BUCKET];
+struct id_map_ent {
+    unsigned gid; /* ghost ID */
+    unsigned nid; /* new ID */
 };
 
+#define ID_MAP_SLOT(id) (((id) ^ ((id) >> 12)) & (id_map_size - 1))
+
 STATIC_DCL void NDECL(clear_id_mapping);
 STATIC_DCL void FDECL(add_id_mapping, (unsigned, unsigned));
 
 static int n_ids_mapped = 0;
-static struct bucket *id_map = 0;
+static unsigned id_map_size = 0;
+static struct id_map_ent *id_map = 0;
 
 #ifdef AMII_GRAPHICS
 void FDECL(amii_setpens, (int)); /* use colors from save file */
@@ -97,8 +106,11 @@ find_lev_obj()
     int x, y;
 
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
+        for (y = 0; y < ROWNO; y++) {
             level.objects[x][y] = (struct obj *) 0;
+            level.objsummary[x][y] = 0;
+            level.objcount[x][y] = 0;
+        }
 
     /*
      * Reverse the entire fobj chain, which is necessary so that we can
@@ -213,11 +225,12 @@ struct obj *otmp;
 {
     int buflen;
 
-    mread(fd, (genericptr_t) otmp, sizeof(struct obj));
+    mread(fd, (genericptr_t) otmp, OBJ_SAVESZ);
 
     /* next object pointers are invalid; otmp->cobj needs to be left
        as is--being non-null is key to restoring container contents */
     otmp->nobj = otmp->nexthere = (struct obj *) 0;
+    otmp->oprev = otmp->oprevhere = (struct obj *) 0;
     /* non-null oextra needs to be reconstructed */
     if (otmp->oextra) {
         otmp->oextra = newoextra();
@@ -278,14 +291,17 @@ boolean ghostly, frozen;
         restobj(fd, otmp);
         if (!first)
             first = otmp;
-        else
+        else {
             otmp2->nobj = otmp;
+            otmp->oprev = otmp2;
+        }
 
         if (ghostly) {
             unsigned nid = context.ident++;
             add_id_mapping(otmp->o_id, nid);
             otmp->o_id = nid;
         }
+        index_obj(otmp);
         if (ghostly && otmp->otyp == SLIME_MOLD)
             ghostfruit(otmp);
         /* Ghost levels get object age shifted from old player's clock
@@ -408,6 +424,7 @@ boolean ghostly;
             add_id_mapping(mtmp->m_id, nid);
             mtmp->m_id = nid;
         }
+        index_monst(mtmp);
         offset = mtmp->mnum;
         mtmp->data = &mons[offset];
         if (ghostly) {
@@ -707,7 +724,11 @@ xchar ltmp;
 #ifndef MFLOPPY
     nhUse(fd);
 #endif
+#ifdef LEVEL_STORE
+    nfd = levstore_create(ltmp);
+#else
     nfd = create_levelfile(ltmp, whynot);
+#endif
     if (nfd < 0) {
         /* BUG: should suppress any attempt to write a panic
            save file if file creation is now failing... */
@@ -1019,6 +1040,7 @@ boolean ghostly;
     restcemetery(fd, &level.bonesinfo);
     rest_levl(fd,
               (boolean) ((sfrestinfo.sfi1 & SFI1_RLECOMP) == SFI1_RLECOMP));
+    rebuild_bitboards();
     mread(fd, (genericptr_t) lastseentyp, sizeof(lastseentyp));
     mread(fd, (genericptr_t) &omoves, sizeof(omoves));
     elapsed = monstermoves - omoves;
@@ -1043,11 +1065,15 @@ boolean ghostly;
 
     rest_worm(fd); /* restore worm information */
     ftrap = 0;
+    for (x = 0; x < COLNO; x++)
+        for (y = 0; y < ROWNO; y++)
+            level.traps[x][y] = (struct trap *) 0;
     while (trap = newtrap(),
            mread(fd, (genericptr_t) trap, sizeof(struct trap)),
            trap->tx != 0) { /* need "!= 0" to work around DICE 3.0 bug */
         trap->ntrap = ftrap;
         ftrap = trap;
+        level.traps[trap->tx][trap->ty] = trap;
     }
     dealloc_trap(trap);
     fobj = restobjchn(fd, ghostly, FALSE);
@@ -1192,12 +1218,10 @@ register int fd;
 STATIC_OVL void
 clear_id_mapping()
 {
-    struct bucket *curr;
-
-    while ((curr = id_map) != 0) {
-        id_map = curr->next;
-        free((genericptr_t) curr);
-    }
+    if (id_map)
+        free((genericptr_t) id_map);
+    id_map = (struct id_map_ent *) 0;
+    id_map_size = 0;
     n_ids_mapped = 0;
 }
 
@@ -1206,20 +1230,34 @@ STATIC_OVL void
 add_id_mapping(gid, nid)
 unsigned gid, nid;
 {
-    int idx;
-
-    idx = n_ids_mapped % N_PER_BUCKET;
-    /* idx is zero on first time through, as well as when a new bucket is */
-    /* needed */
-    if (idx == 0) {
-        struct bucket *gnu = (struct bucket *) alloc(sizeof(struct bucket));
-        gnu->next = id_map;
-        id_map = gnu;
+    unsigned i;
+
+    if (2 * (unsigned) (n_ids_mapped + 1) > id_map_size) {
+        struct id_map_ent *oldmap = id_map;
+        unsigned oldsize = id_map_size;
+
+        id_map_size = oldsize ? 2 * oldsize : 256;
+        id_map = (struct id_map_ent *) alloc(id_map_size * sizeof *id_map);
+        (void) memset((genericptr_t) id_map, 0, id_map_size * sizeof *id_map);
+        for (i = 0; i < oldsize; i++)
+            if (oldmap[i].gid) {
+                unsigned j = ID_MAP_SLOT(oldmap[i].gid);
+
+                while (id_map[j].gid)
+                    j = (j + 1) & (id_map_size - 1);
+                id_map[j] = oldmap[i];
+            }
+        if (oldmap)
+            free((genericptr_t) oldmap);
     }
 
-    id_map->map[idx].gid = gid;
-    id_map->map[idx].nid = nid;
-    n_ids_mapped++;
+    for (i = ID_MAP_SLOT(gid); id_map[i].gid; i = (i + 1) & (id_map_size - 1))
+        if (id_map[i].gid == gid)
+            break; /* remapped again; the latest mapping wins */
+    if (!id_map[i].gid)
+        n_ids_mapped++;
+    id_map[i].gid = gid;
+    id_map[i].nid = nid;
 }
 
 /*
@@ -1231,25 +1269,15 @@ boolean
 lookup_id_mapping(gid, nidp)
 unsigned gid, *nidp;
 {
-    int i;
-    struct bucket *curr;
-
-    if (n_ids_mapped)
-        for (curr = id_map; curr; curr = curr->next) {
-            /* first bucket might not be totally full */
-            if (curr == id_map) {
-                i = n_ids_mapped % N_PER_BUCKET;
-                if (i == 0)
-                    i = N_PER_BUCKET;
-            } else
-                i = N_PER_BUCKET;
-
-            while (--i >= 0)
-                if (gid == curr->map[i].gid) {
-                    *nidp = curr->map[i].nid;
-                    return TRUE;
-                }
-        }
+    unsigned i;
+
+    if (n_ids_mapped && gid)
+        for (i = ID_MAP_SLOT(gid); id_map[i].gid;
+             i = (i + 1) & (id_map_size - 1))
+            if (id_map[i].gid == gid) {
+                *nidp = id_map[i].nid;
+                return TRUE;
+            }
 
     return FALSE;
 }
@@ -1363,6 +1391,12 @@ register int fd;
 register genericptr_t buf;
 register unsigned int len;
 {
+#ifdef LEVEL_STORE
+    if (fd == LEVSTORE_FD) { /* level kept in memory */
+        levstore_read(buf, len);
+        return;
+    }
+#endif
     (*restoreprocs.restore_mread)(fd, buf, len);
     return;
 }
@@ -1413,6 +1447,19 @@ const char *name;
         }
     }
 
+    if ((sfi.sfi1 & SFI1_LZCOMP) == SFI1_LZCOMP) {
+        if ((compatible & SFI1_LZCOMP) != SFI1_LZCOMP) {
+            if (verbose) {
+                pline("File \"%s\" has incompatible LZCOMP compression.",
+                      name);
+                wait_synch();
+            }
+            return 2;
+        } else if ((sfrestinfo.sfi1 & SFI1_LZCOMP) != SFI1_LZCOMP) {
+            set_restpref("lzcomp");
+        }
+    }
+
     if ((sfi.sfi1 & SFI1_EXTERNALCOMP) == SFI1_EXTERNALCOMP) {
         if ((compatible & SFI1_EXTERNALCOMP) != SFI1_EXTERNALCOMP) {
             if (verbose) {
@@ -1451,6 +1498,12 @@ const char *name;
 void
 reset_restpref()
 {
+#ifdef LZCOMP
+    /* level files are written with whatever the save file would get */
+    if ((sfsaveinfo.sfi1 & SFI1_LZCOMP) == SFI1_LZCOMP)
+        set_restpref("lzcomp");
+    else
+#endif
 #ifdef ZEROCOMP
     if (iflags.zerocomp)
         set_restpref("zerocomp");
@@ -1474,7 +1527,7 @@ const char *suitename;
         restoreprocs.restore_mread = def_mread;
         restoreprocs.restore_minit = def_minit;
         sfrestinfo.sfi1 |= SFI1_EXTERNALCOMP;
-        sfrestinfo.sfi1 &= ~SFI1_ZEROCOMP;
+        sfrestinfo.sfi1 &= ~(SFI1_ZEROCOMP | SFI1_LZCOMP);
         def_minit();
     }
     if (!strcmpi(suitename, "!rlecomp")) {
@@ -1486,10 +1539,20 @@ const char *suitename;
         restoreprocs.restore_mread = zerocomp_mread;
         restoreprocs.restore_minit = zerocomp_minit;
         sfrestinfo.sfi1 |= SFI1_ZEROCOMP;
-        sfrestinfo.sfi1 &= ~SFI1_EXTERNALCOMP;
+        sfrestinfo.sfi1 &= ~(SFI1_EXTERNALCOMP | SFI1_LZCOMP);
         zerocomp_minit();
     }
 #endif
+#ifdef LZCOMP
+    if (!strcmpi(suitename, "lzcomp")) {
+        restoreprocs.name = "lzcomp";
+        restoreprocs.restore_mread = lzcomp_mread;
+        restoreprocs.restore_minit = lzcomp_minit;
+        sfrestinfo.sfi1 |= SFI1_LZCOMP;
+        sfrestinfo.sfi1 &= ~(SFI1_EXTERNALCOMP | SFI1_ZEROCOMP);
+        lzcomp_minit();
+    }
+#endif
 #ifdef RLECOMP
     if (!strcmpi(suitename, "rlecomp")) {
         sfrestinfo.sfi1 |= SFI1_RLECOMP;
@@ -1562,6 +1625,127 @@ register unsigned len;
 }
 #endif /* ZEROCOMP */
 
+#ifdef LZCOMP
+/* see the description of the format in save.c */
+static unsigned char lz_blk[LZ_BLOCK], lz_packed[LZ_BLOCK];
+static unsigned lz_blkp = 0, lz_blksz = 0;
+
+STATIC_OVL void
+lzcomp_minit()
+{
+    lz_blkp = lz_blksz = 0;
+}
+
+/* expand src[0..n-1] into exactly dn bytes of dst; -1 if it's corrupt */
+STATIC_OVL int
+lzcomp_unpack(src, n, dst, dn)
+unsigned char *src, *dst;
+unsigned n, dn;
+{
+    unsigned ip = 0, op = 0, len, off;
+    int c, token;
+
+    while (ip < n) {
+        token = src[ip++];
+        if ((len = (unsigned) token >> 4) == 15)
+            do {
+                if (ip >= n)
+                    return -1;
+                len += (c = src[ip++]);
+            } while (c == 255);
+        if (len > n - ip || len > dn - op)
+            return -1;
+        (void) memcpy((genericptr_t) (dst + op), (genericptr_t) (src + ip),
+                      len);
+        ip += len, op += len;
+        if (ip == n)
+            break; /* the last sequence has no match */
+
+        if (ip + 2 > n)
+            return -1;
+        off = src[ip] | ((unsigned) src[ip + 1] << 8);
+        ip += 2;
+        if ((len = (unsigned) (token & 15)) == 15)
+            do {
+                if (ip >= n)
+                    return -1;
+                len += (c = src[ip++]);
+            } while (c == 255);
+        len += LZ_MINMATCH;
+        if (!off || off > op || len > dn - op)
+            return -1;
+        for (; len; len--, op++) /* may overlap */
+            dst[op] = dst[op - off];
+    }
+    return (op == dn) ? 0 : -1;
+}
+
+/* read the next block; FALSE at the end of the file */
+STATIC_OVL boolean
+lzcomp_fill(fd)
+int fd;
+{
+    unsigned char hdr[4];
+    unsigned rawlen, clen;
+
+    lz_blkp = lz_blksz = 0;
+    if (read(fd, (genericptr_t) hdr, 1) != 1)
+        return FALSE;
+    if (hdr[0]) { /* a byte written outside of any block */
+        lz_blk[0] = hdr[0];
+        lz_blksz = 1;
+        return TRUE;
+    }
+    if (read(fd, (genericptr_t) hdr, 4) != 4)
+        return FALSE;
+    rawlen = 1 + (hdr[0] | ((unsigned) hdr[1] << 8));
+    clen = hdr[2] | ((unsigned) hdr[3] << 8);
+    if (rawlen > LZ_BLOCK || clen >= rawlen)
+        return FALSE;
+    if (!clen) {
+        if ((unsigned) read(fd, (genericptr_t) lz_blk, rawlen) != rawlen)
+            return FALSE;
+    } else {
+        if ((unsigned) read(fd, (genericptr_t) lz_packed, clen) != clen
+            || lzcomp_unpack(lz_packed, clen, lz_blk, rawlen) < 0)
+            return FALSE;
+    }
+    lz_blksz = rawlen;
+    return TRUE;
+}
+
+STATIC_OVL void
+lzcomp_mread(fd, buf, len)
+int fd;
+genericptr_t buf;
+register unsigned len;
+{
+    char *bp = (char *) buf;
+    unsigned n;
+
+    if (fd < 0)
+        error("Restore error; mread attempting to read file %d.", fd);
+    while (len) {
+        if (lz_blkp >= lz_blksz && !lzcomp_fill(fd)) {
+            if (restoreprocs.mread_flags == 1) { /* means "return anyway" */
+                restoreprocs.mread_flags = -1;
+                return;
+            }
+            pline("Read of compressed data failed.");
+            if (restoring) {
+                (void) nhclose(fd);
+                (void) delete_savefile();
+                error("Error restoring old game.");
+            }
+            panic("Error reading level file.");
+        }
+        n = min(len, lz_blksz - lz_blkp);
+        (void) memcpy((genericptr_t) bp, (genericptr_t) (lz_blk + lz_blkp), n);
+        lz_blkp += n, bp += n, len -= n;
+    }
+}
+#endif /* LZCOMP */
+
 STATIC_OVL void
 def_minit()
 {
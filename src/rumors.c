@@ -25,6 +25,14 @@
  * the first true rumor plus the size of the true rumors matches the offset
  * of the first false rumor.  Likewise, the offset of the first false rumor
  * plus the size of the false rumors matches the offset for end-of-file.
+ * At that end-of-file offset, 'makedefs' appends a table giving the file
+ * offset of each rumor (true ones first), one hexadecimal number per line,
+ * so a rumor is picked uniformly with a single seek and read; the
+ * fseek()-based bias described above no longer applies.
+ *
+ * The epitaph, engrave and bogusmon files read by get_rnd_text() have a
+ * "do not edit" line, a decimal count N, N hexadecimal offsets of lines
+ * relative to the first one, and then those lines.
  */
 
 /*      3.1     [now obsolete for rumors but still accurate for oracles]
@@ -40,11 +48,15 @@
  * and placed there by 'makedefs'.
  */
 
+STATIC_DCL long *FDECL(read_line_offsets, (dlb *, int));
 STATIC_DCL void FDECL(init_rumors, (dlb *));
 STATIC_DCL void FDECL(init_oracles, (dlb *));
 
 /* rumor size variables are signed so that value -1 can be used as a flag */
 static long true_rumor_size = 0L, false_rumor_size;
+/* offsets of all the rumors, true ones first */
+static int true_rumor_count, false_rumor_count;
+static long *rumor_loc = 0;
 /* rumor start offsets are unsigned because they're handled via %lx format */
 static unsigned long true_rumor_start, false_rumor_start;
 /* rumor end offsets are signed because they're compared with [dlb_]ftell() */
@@ -53,23 +65,55 @@ static long true_rumor_end, false_rumor_end;
 static int oracle_flg = 0; /* -1=>don't use, 0=>need init, 1=>init done */
 static unsigned oracle_cnt = 0;
 static unsigned long *oracle_loc = 0;
+/* line offsets of the files read by get_rnd_text(), loaded on first use;
+   engravings, graves and hallucinatory monster names all share them */
+#define MAX_RND_TEXTS 4
+static struct rnd_text {
+    const char *fname;
+    int count; /* # of lines; -1 => don't use, 0 => need init */
+    long *loc;
+} rnd_texts[MAX_RND_TEXTS];
+
+/* read a table of cnt hexadecimal line offsets */
+STATIC_OVL long *
+read_line_offsets(fp, cnt)
+dlb *fp;
+int cnt;
+{
+    long *loc = (long *) alloc((unsigned) cnt * sizeof (long));
+    unsigned long offset;
+    char line[BUFSZ];
+    int i;
+
+    for (i = 0; i < cnt; i++) {
+        if (!dlb_fgets(line, sizeof line, fp)
+            || sscanf(line, "%lx", &offset) != 1) {
+            free((genericptr_t) loc);
+            return (long *) 0;
+        }
+        loc[i] = (long) offset;
+    }
+    return loc;
+}
 
 STATIC_OVL void
 init_rumors(fp)
 dlb *fp;
 {
     static const char rumors_header[] = "%d,%ld,%lx;%d,%ld,%lx;0,0,%lx\n";
-    int true_count, false_count; /* in file but not used here */
     unsigned long eof_offset;
     char line[BUFSZ];
 
     (void) dlb_fgets(line, sizeof line, fp); /* skip "don't edit" comment */
     (void) dlb_fgets(line, sizeof line, fp);
-    if (sscanf(line, rumors_header, &true_count, &true_rumor_size,
-               &true_rumor_start, &false_count, &false_rumor_size,
+    if (sscanf(line, rumors_header, &true_rumor_count, &true_rumor_size,
+               &true_rumor_start, &false_rumor_count, &false_rumor_size,
                &false_rumor_start, &eof_offset) == 7
-        && true_rumor_size > 0L
-        && false_rumor_size > 0L) {
+        && true_rumor_size > 0L && false_rumor_size > 0L
+        && true_rumor_count > 0 && false_rumor_count > 0
+        && dlb_fseek(fp, (long) eof_offset, SEEK_SET) >= 0
+        && (rumor_loc = read_line_offsets(fp, true_rumor_count
+                                                  + false_rumor_count)) != 0) {
         true_rumor_end = (long) true_rumor_start + true_rumor_size;
         /* assert( true_rumor_end == false_rumor_start ); */
         false_rumor_end = (long) false_rumor_start + false_rumor_size;
@@ -92,7 +136,7 @@ char *rumor_buf;
 boolean exclude_cookie;
 {
     dlb *rumors;
-    long tidbit, beginning;
+    long tidbit;
     char *endp, line[BUFSZ], xbuf[BUFSZ];
 
     rumor_buf[0] = '\0';
@@ -122,26 +166,19 @@ boolean exclude_cookie;
             switch (adjtruth = truth + rn2(2)) {
             case 2: /*(might let a bogus input arg sneak thru)*/
             case 1:
-                beginning = (long) true_rumor_start;
-                tidbit = Rand() % true_rumor_size;
+                tidbit = Rand() % (long) true_rumor_count;
                 break;
             case 0: /* once here, 0 => false rather than "either"*/
             case -1:
-                beginning = (long) false_rumor_start;
-                tidbit = Rand() % false_rumor_size;
+                tidbit = true_rumor_count + Rand() % (long) false_rumor_count;
                 break;
             default:
                 impossible("strange truth value for rumor");
                 return strcpy(rumor_buf, "Oops...");
             }
-            (void) dlb_fseek(rumors, beginning + tidbit, SEEK_SET);
-            (void) dlb_fgets(line, sizeof line, rumors);
-            if (!dlb_fgets(line, sizeof line, rumors)
-                || (adjtruth > 0 && dlb_ftell(rumors) > true_rumor_end)) {
-                /* reached end of rumors -- go back to beginning */
-                (void) dlb_fseek(rumors, beginning, SEEK_SET);
-                (void) dlb_fgets(line, sizeof line, rumors);
-            }
+            if (dlb_fseek(rumors, rumor_loc[tidbit], SEEK_SET) < 0
+                || !dlb_fgets(line, sizeof line, rumors))
+                line[0] = '\0';
             if ((endp = index(line, '\n')) != 0)
                 *endp = 0;
             Strcat(rumor_buf, xcrypt(line, xbuf));
@@ -282,42 +319,79 @@ get_rnd_text(fname, buf)
 const char *fname;
 char *buf;
 {
+    struct rnd_text *rt;
     dlb *fh;
+    int i;
 
     buf[0] = '\0';
 
+    for (i = 0; i < MAX_RND_TEXTS && rnd_texts[i].fname; i++)
+        if (!strcmp(rnd_texts[i].fname, fname))
+            break;
+    if (i == MAX_RND_TEXTS) {
+        impossible("Too many random text files for %s!", fname);
+        return buf;
+    }
+    rt = &rnd_texts[i];
+    if (!rt->fname)
+        rt->fname = fname, rt->count = 0;
+    else if (rt->count < 0) /* couldn't read it before */
+        return buf;
+
     fh = dlb_fopen(fname, "r");
 
     if (fh) {
-        /* TODO: cache sizetxt, starttxt, endtxt. maybe cache file contents?
-         */
-        long sizetxt = 0, starttxt = 0, endtxt = 0, tidbit = 0;
         char *endp, line[BUFSZ], xbuf[BUFSZ];
-        (void) dlb_fgets(line, sizeof line,
-                         fh); /* skip "don't edit" comment */
-
-        (void) dlb_fseek(fh, 0L, SEEK_CUR);
-        starttxt = dlb_ftell(fh);
-        (void) dlb_fseek(fh, 0L, SEEK_END);
-        endtxt = dlb_ftell(fh);
-        sizetxt = endtxt - starttxt;
-        tidbit = Rand() % sizetxt;
-
-        (void) dlb_fseek(fh, starttxt + tidbit, SEEK_SET);
-        (void) dlb_fgets(line, sizeof line, fh);
-        if (!dlb_fgets(line, sizeof line, fh)) {
-            (void) dlb_fseek(fh, starttxt, SEEK_SET);
-            (void) dlb_fgets(line, sizeof line, fh);
+
+        if (!rt->count) { /* first use; load its line offsets */
+            long base;
+
+            (void) dlb_fgets(line, sizeof line,
+                             fh); /* skip "don't edit" comment */
+            if (!dlb_fgets(line, sizeof line, fh)
+                || sscanf(line, "%d", &rt->count) != 1 || rt->count <= 0
+                || !(rt->loc = read_line_offsets(fh, rt->count))) {
+                rt->count = -1;
+                (void) dlb_fclose(fh);
+                impossible("Can't read file %s!", fname);
+                return buf;
+            }
+            /* the offsets are relative to the first line of text, which
+               follows the table */
+            base = dlb_ftell(fh);
+            for (i = 0; i < rt->count; i++)
+                rt->loc[i] += base;
+        }
+        if (dlb_fseek(fh, rt->loc[Rand() % (long) rt->count], SEEK_SET) >= 0
+            && dlb_fgets(line, sizeof line, fh)) {
+            if ((endp = index(line, '\n')) != 0)
+                *endp = 0;
+            Strcat(buf, xcrypt(line, xbuf));
         }
-        if ((endp = index(line, '\n')) != 0)
-            *endp = 0;
-        Strcat(buf, xcrypt(line, xbuf));
         (void) dlb_fclose(fh);
     } else
         impossible("Can't open file %s!", fname);
     return buf;
 }
 
+/* release the line offset tables; they'll be reloaded if needed again */
+void
+free_rumors()
+{
+    int i;
+
+    if (rumor_loc)
+        free((genericptr_t) rumor_loc), rumor_loc = 0;
+    true_rumor_size = 0L;
+    for (i = 0; i < MAX_RND_TEXTS; i++) {
+        if (rnd_texts[i].loc)
+            free((genericptr_t) rnd_texts[i].loc);
+        rnd_texts[i].fname = (const char *) 0;
+        rnd_texts[i].count = 0;
+        rnd_texts[i].loc = (long *) 0;
+    }
+}
+
 void
 outrumor(truth, mechanism)
 int truth; /* 1=true, -1=false, 0=either */
@@ -47,6 +47,13 @@ STATIC_DCL void FDECL(zerocomp_bflush, (int));
 STATIC_DCL void FDECL(zerocomp_bwrite, (int, genericptr_t, unsigned int));
 STATIC_DCL void FDECL(zerocomp_bputc, (int));
 #endif
+#ifdef LZCOMP
+STATIC_DCL void FDECL(lzcomp_bufon, (int));
+STATIC_DCL void FDECL(lzcomp_bufoff, (int));
+STATIC_DCL void FDECL(lzcomp_bflush, (int));
+STATIC_DCL void FDECL(lzcomp_bwrite, (int, genericptr_t, unsigned int));
+STATIC_DCL unsigned FDECL(lzcomp_pack, (unsigned char *, unsigned));
+#endif
 
 static struct save_procs {
     const char *name;
@@ -608,6 +615,10 @@ void
 bufon(fd)
 int fd;
 {
+#ifdef LEVEL_STORE
+    if (fd == LEVSTORE_FD)
+        return;
+#endif
     (*saveprocs.save_bufon)(fd);
     return;
 }
@@ -617,6 +628,10 @@ void
 bufoff(fd)
 int fd;
 {
+#ifdef LEVEL_STORE
+    if (fd == LEVSTORE_FD)
+        return;
+#endif
     (*saveprocs.save_bufoff)(fd);
     return;
 }
@@ -626,6 +641,10 @@ void
 bflush(fd)
 register int fd;
 {
+#ifdef LEVEL_STORE
+    if (fd == LEVSTORE_FD)
+        return;
+#endif
     (*saveprocs.save_bflush)(fd);
     return;
 }
@@ -636,6 +655,12 @@ int fd;
 genericptr_t loc;
 register unsigned num;
 {
+#ifdef LEVEL_STORE
+    if (fd == LEVSTORE_FD) { /* level kept in memory */
+        levstore_write(loc, num);
+        return;
+    }
+#endif
     (*saveprocs.save_bwrite)(fd, loc, num);
     return;
 }
@@ -644,6 +669,12 @@ void
 bclose(fd)
 int fd;
 {
+#ifdef LEVEL_STORE
+    if (fd == LEVSTORE_FD) {
+        (void) nhclose(fd);
+        return;
+    }
+#endif
     (*saveprocs.save_bclose)(fd);
     return;
 }
@@ -887,6 +918,220 @@ int fd;
 }
 #endif /* ZEROCOMP */
 
+#ifdef LZCOMP
+/* Lempel-Ziv compression of everything, in the style of LZ4.  Data is
+ * collected into blocks of up to LZ_BLOCK bytes which are compressed
+ * independently of each other and written out as
+ *      a zero byte,
+ *      the uncompressed length less one, two bytes, low byte first,
+ *      the compressed length, two bytes, or zero if the block was not
+ *      compressible and is stored as is,
+ *      the compressed data.
+ * The data is a series of sequences, each a token byte whose upper four
+ * bits hold the number of literal bytes and lower four bits the match
+ * length less LZ_MINMATCH (15 meaning that more length bytes follow,
+ * added up until one is less than 255), the literals, and the offset
+ * back to the match (two bytes, low byte first).  The final sequence of
+ * a block has literals only.
+ *
+ * Like the zero-comp runs, blocks end wherever the caller flushes, so
+ * game state and level files can be glued together to form a save file.
+ * A nonzero byte where a block would start stands for itself; recover
+ * relies on that when it puts level numbers between level files.
+ */
+
+#define LZ_HASHBITS 13
+#define LZ_HASH(p) \
+    ((((((unsigned long) (p)[3] << 24) | ((unsigned long) (p)[2] << 16)   \
+        | ((unsigned long) (p)[1] << 8) | (unsigned long) (p)[0])         \
+       * 2654435761UL) & 0xffffffffUL) >> (32 - LZ_HASHBITS))
+
+static unsigned char lz_inbuf[LZ_BLOCK];
+static unsigned char lz_outbuf[5 + LZ_BLOCK];
+static unsigned short lz_head[1 << LZ_HASHBITS]; /* 1 + last position */
+static unsigned lz_inlen = 0;
+static int lz_fd = -1;
+static boolean lz_compressing = FALSE;
+
+/* put a sequence into the output; FALSE if it doesn't fit in dmax bytes */
+#define LZ_PUTLEN(n)                     \
+    for (k = (n); k >= 255; k -= 255) { \
+        if (op >= dmax)                  \
+            return 0;                    \
+        dst[op++] = 255;                 \
+    }                                    \
+    if (op >= dmax)                      \
+        return 0;                        \
+    dst[op++] = (unsigned char) k
+
+/* compress src[0..n-1] into lz_outbuf after its header; return the
+   compressed length, or 0 if it wouldn't be smaller than n */
+STATIC_OVL unsigned
+lzcomp_pack(src, n)
+unsigned char *src;
+unsigned n;
+{
+    unsigned char *dst = lz_outbuf + 5;
+    unsigned ip = 0, anchor = 0, op = 0, dmax = n - 1;
+    unsigned ref, mlen, nlit, k, h;
+
+    (void) memset((genericptr_t) lz_head, 0, sizeof lz_head);
+    for (;;) {
+        mlen = 0;
+        while (ip + LZ_MINMATCH <= n) {
+            h = (unsigned) LZ_HASH(src + ip);
+            ref = lz_head[h];
+            lz_head[h] = (unsigned short) (ip + 1);
+            if (ref-- && !memcmp(src + ref, src + ip, LZ_MINMATCH)) {
+                for (mlen = LZ_MINMATCH;
+                     ip + mlen < n && src[ref + mlen] == src[ip + mlen];
+                     mlen++)
+                    continue;
+                break;
+            }
+            ip++;
+        }
+        if (!mlen)
+            ip = n; /* the rest are literals */
+
+        nlit = ip - anchor;
+        if (op >= dmax)
+            return 0;
+        dst[op++] = (unsigned char) ((min(nlit, 15) << 4)
+                                     | (mlen ? min(mlen - LZ_MINMATCH, 15)
+                                             : 0));
+        if (nlit >= 15) {
+            LZ_PUTLEN(nlit - 15);
+        }
+        if (op + nlit > dmax)
+            return 0;
+        (void) memcpy((genericptr_t) (dst + op), (genericptr_t) (src + anchor),
+                      nlit);
+        op += nlit;
+        if (!mlen)
+            break;
+
+        if (op + 2 > dmax)
+            return 0;
+        dst[op++] = (unsigned char) ((ip - ref) & 0xff);
+        dst[op++] = (unsigned char) ((ip - ref) >> 8);
+        if (mlen - LZ_MINMATCH >= 15) {
+            LZ_PUTLEN(mlen - LZ_MINMATCH - 15);
+        }
+        /* remember the positions inside the match too */
+        for (k = ip + 1, ip += mlen; k + LZ_MINMATCH <= n && k < ip; k++)
+            lz_head[LZ_HASH(src + k)] = (unsigned short) (k + 1);
+        anchor = ip;
+    }
+    return op;
+}
+
+#undef LZ_PUTLEN
+
+/*ARGSUSED*/
+STATIC_OVL void
+lzcomp_bufon(fd)
+int fd;
+{
+    lz_compressing = TRUE;
+    return;
+}
+
+STATIC_OVL void
+lzcomp_bufoff(fd)
+int fd;
+{
+    lzcomp_bflush(fd);
+    lz_compressing = FALSE;
+    return;
+}
+
+/* compress and write out the current block */
+STATIC_OVL void
+lzcomp_bflush(fd)
+int fd;
+{
+    unsigned clen, wlen;
+
+    if (!lz_inlen)
+        return;
+    if (fd != lz_fd)
+        panic("lzcomp: flushing file #%d with data for file #%d", fd, lz_fd);
+#ifdef MFLOPPY
+    if (count_only) {
+        lz_inlen = 0;
+        return;
+    }
+#endif
+    clen = lzcomp_pack(lz_inbuf, lz_inlen);
+    lz_outbuf[0] = 0;
+    lz_outbuf[1] = (unsigned char) ((lz_inlen - 1) & 0xff);
+    lz_outbuf[2] = (unsigned char) ((lz_inlen - 1) >> 8);
+    lz_outbuf[3] = (unsigned char) (clen & 0xff);
+    lz_outbuf[4] = (unsigned char) (clen >> 8);
+    if (!clen)
+        (void) memcpy((genericptr_t) (lz_outbuf + 5), (genericptr_t) lz_inbuf,
+                      lz_inlen);
+    wlen = 5 + (clen ? clen : lz_inlen);
+    lz_inlen = 0;
+    if ((unsigned) write(fd, (genericptr_t) lz_outbuf, wlen) != wlen) {
+#if defined(UNIX) || defined(VMS) || defined(__EMX__)
+        if (program_state.done_hup)
+            terminate(EXIT_FAILURE);
+        else
+#endif
+            panic("cannot write %u bytes to file #%d", wlen, fd);
+    }
+}
+
+STATIC_OVL void
+lzcomp_bwrite(fd, loc, num)
+int fd;
+genericptr_t loc;
+register unsigned num;
+{
+    unsigned char *bp = (unsigned char *) loc;
+    unsigned n;
+
+#ifdef MFLOPPY
+    bytes_counted += num;
+    if (count_only)
+        return;
+#endif
+    if (!lz_compressing) {
+        if ((unsigned) write(fd, loc, num) != num) {
+#if defined(UNIX) || defined(VMS) || defined(__EMX__)
+            if (program_state.done_hup)
+                terminate(EXIT_FAILURE);
+            else
+#endif
+                panic("cannot write %u bytes to file #%d", num, fd);
+        }
+        return;
+    }
+    if (lz_inlen && fd != lz_fd)
+        panic("lzcomp: write to file #%d with data for file #%d", fd, lz_fd);
+    lz_fd = fd;
+    while (num) {
+        n = min(num, LZ_BLOCK - lz_inlen);
+        (void) memcpy((genericptr_t) (lz_inbuf + lz_inlen), (genericptr_t) bp,
+                      n);
+        lz_inlen += n, bp += n, num -= n;
+        if (lz_inlen == LZ_BLOCK)
+            lzcomp_bflush(fd);
+    }
+}
+
+void
+lzcomp_bclose(fd)
+int fd;
+{
+    lzcomp_bufoff(fd);
+    (void) nhclose(fd);
+    return;
+}
+#endif /* LZCOMP */
+
 STATIC_OVL void
 savelevchn(fd, mode)
 register int fd, mode;
@@ -967,7 +1212,7 @@ struct obj *otmp;
 {
     int buflen, zerobuf = 0;
 
-    buflen = sizeof(struct obj);
+    buflen = OBJ_SAVESZ;
     bwrite(fd, (genericptr_t) &buflen, sizeof(int));
     bwrite(fd, (genericptr_t) otmp, buflen);
     if (otmp->oextra) {
@@ -1181,8 +1426,11 @@ register struct trap *trap;
         trap2 = trap->ntrap;
         if (perform_bwrite(mode))
             bwrite(fd, (genericptr_t) trap, sizeof(struct trap));
-        if (release_data(mode))
+        if (release_data(mode)) {
+            if (level.traps[trap->tx][trap->ty] == trap)
+                level.traps[trap->tx][trap->ty] = (struct trap *) 0;
             dealloc_trap(trap);
+        }
         trap = trap2;
     }
     if (perform_bwrite(mode))
@@ -1291,7 +1539,7 @@ const char *suitename;
         saveprocs.save_bwrite = def_bwrite;
         saveprocs.save_bclose = def_bclose;
         sfsaveinfo.sfi1 |= SFI1_EXTERNALCOMP;
-        sfsaveinfo.sfi1 &= ~SFI1_ZEROCOMP;
+        sfsaveinfo.sfi1 &= ~(SFI1_ZEROCOMP | SFI1_LZCOMP);
     }
     if (!strcmpi(suitename, "!rlecomp")) {
         sfsaveinfo.sfi1 &= ~SFI1_RLECOMP;
@@ -1305,7 +1553,19 @@ const char *suitename;
         saveprocs.save_bwrite = zerocomp_bwrite;
         saveprocs.save_bclose = zerocomp_bclose;
         sfsaveinfo.sfi1 |= SFI1_ZEROCOMP;
-        sfsaveinfo.sfi1 &= ~SFI1_EXTERNALCOMP;
+        sfsaveinfo.sfi1 &= ~(SFI1_EXTERNALCOMP | SFI1_LZCOMP);
+    }
+#endif
+#ifdef LZCOMP
+    if (!strcmpi(suitename, "lzcomp")) {
+        saveprocs.name = "lzcomp";
+        saveprocs.save_bufon = lzcomp_bufon;
+        saveprocs.save_bufoff = lzcomp_bufoff;
+        saveprocs.save_bflush = lzcomp_bflush;
+        saveprocs.save_bwrite = lzcomp_bwrite;
+        saveprocs.save_bclose = lzcomp_bclose;
+        sfsaveinfo.sfi1 |= SFI1_LZCOMP;
+        sfsaveinfo.sfi1 &= ~(SFI1_EXTERNALCOMP | SFI1_ZEROCOMP);
     }
 #endif
 #ifdef RLECOMP
@@ -1330,6 +1590,8 @@ void
 freedynamicdata()
 {
     unload_qtlist();
+    free_rumors();           /* line offsets (rumors.c) */
+    free_splev_cache();      /* parsed levels (sp_lev.c) */
     free_menu_coloring();
     free_invbuf();           /* let_to_name (invent.c) */
     free_youbuf();           /* You_buf,&c (pline.c) */
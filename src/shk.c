@@ -1834,7 +1834,7 @@ register struct bill_x *bp;
     register unsigned int id = bp->bo_id;
 
     if (bp->useup)
-        obj = o_on(id, billobjs);
+        obj = obj_by_oid(id, TRUE);
     else
         obj = find_oid(id);
     return obj;
@@ -1849,31 +1849,7 @@ struct obj *
 find_oid(id)
 unsigned id;
 {
-    struct obj *obj;
-    struct monst *mon, *mmtmp[3];
-    int i;
-
-    /* first check various obj lists directly */
-    if ((obj = o_on(id, invent)) != 0)
-        return obj;
-    if ((obj = o_on(id, fobj)) != 0)
-        return obj;
-    if ((obj = o_on(id, level.buriedobjlist)) != 0)
-        return obj;
-    if ((obj = o_on(id, migrating_objs)) != 0)
-        return obj;
-
-    /* not found yet; check inventory for members of various monst lists */
-    mmtmp[0] = fmon;
-    mmtmp[1] = migrating_mons;
-    mmtmp[2] = mydogs; /* for use during level changes */
-    for (i = 0; i < 3; i++)
-        for (mon = mmtmp[i]; mon; mon = mon->nmon)
-            if ((obj = o_on(id, mon->minvent)) != 0)
-                return obj;
-
-    /* not found at all */
-    return (struct obj *) 0;
+    return obj_by_oid(id, FALSE); /* uses the o_id index in mkobj.c */
 }
 
 /* Returns the price of an arbitrary item in the shop.
@@ -2282,8 +2258,7 @@ struct obj *obj;
     if (obj->timed)
         obj_stop_timers(obj);
 
-    obj->nobj = billobjs;
-    billobjs = obj;
+    link_nobj(obj, &billobjs);
     obj->where = OBJ_ONBILL;
 }
 
@@ -2558,6 +2533,7 @@ register struct monst *shkp;
             *otmp = *obj;
             otmp->oextra = (struct oextra *) 0;
             bp->bo_id = otmp->o_id = context.ident++;
+            index_obj(otmp);
             otmp->where = OBJ_FREE;
             otmp->quan = (bp->bquan -= obj->quan);
             otmp->owt = 0; /* superfluous */
@@ -3397,6 +3373,7 @@ boolean catchup; /* restoring a level */
             block_point(x, y);
         } else if (IS_WALL(tmp_dam->typ)) {
             levl[x][y].typ = tmp_dam->typ;
+            update_bitboards(x, y);
             block_point(x, y);
         }
         newsym(x, y);
@@ -3411,6 +3388,7 @@ boolean catchup; /* restoring a level */
         /* No messages if player already replaced shop door */
         return 1;
     levl[x][y].typ = tmp_dam->typ;
+    update_bitboards(x, y);
     (void) memset((genericptr_t) litter, 0, sizeof(litter));
     if ((otmp = level.objects[x][y]) != 0) {
 /* Scatter objects haphazardly into the shop */
@@ -1098,6 +1098,8 @@ typedef struct audio_mapping_rec {
 } audio_mapping;
 
 static audio_mapping *soundmap = 0;
+/* soundmap's regexes in list order; rebuilt after a mapping is added */
+static struct nhregex_set *soundmap_set = 0;
 
 char *sounddir = ".";
 
@@ -1136,6 +1138,10 @@ const char *mapping;
                 return 0;
             } else {
                 soundmap = new_map;
+                if (soundmap_set) {
+                    regex_set_free(soundmap_set);
+                    soundmap_set = (struct nhregex_set *) 0;
+                }
             }
         } else {
             Sprintf(text, "cannot read %.243s", filespec);
@@ -1155,12 +1161,22 @@ play_sound_for_message(msg)
 const char *msg;
 {
     audio_mapping *cursor = soundmap;
+    int i, prev = 0;
 
-    while (cursor) {
-        if (regex_match(msg, cursor->regex)) {
-            play_usersound(cursor->filename, cursor->volume);
-        }
-        cursor = cursor->next;
+    if (!soundmap)
+        return;
+    if (!soundmap_set) {
+        soundmap_set = regex_set_init();
+        for (; cursor; cursor = cursor->next)
+            regex_set_add(soundmap_set, cursor->regex);
+        cursor = soundmap;
+    }
+    /* every matching mapping gets played, in list order */
+    for (i = regex_set_match(msg, soundmap_set, 0); i >= 0;
+         i = regex_set_match(msg, soundmap_set, i + 1)) {
+        for (; prev < i; prev++)
+            cursor = cursor->next;
+        play_usersound(cursor->filename, cursor->volume);
     }
 }
 
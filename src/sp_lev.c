@@ -30,6 +30,9 @@ STATIC_DCL void FDECL(splev_stack_push, (struct splevstack *,
 STATIC_DCL struct opvar *FDECL(splev_stack_pop, (struct splevstack *));
 STATIC_DCL struct splevstack *FDECL(splev_stack_reverse,
                                     (struct splevstack *));
+STATIC_DCL struct opvar *NDECL(opvar_alloc);
+STATIC_DCL void FDECL(opvar_release, (struct opvar *));
+STATIC_DCL void NDECL(opvar_pool_done);
 STATIC_DCL struct opvar *FDECL(opvar_new_str, (char *));
 STATIC_DCL struct opvar *FDECL(opvar_new_int, (long));
 STATIC_DCL struct opvar *FDECL(opvar_new_coord, (int, int));
@@ -41,11 +44,11 @@ STATIC_DCL struct opvar *FDECL(opvar_clone, (struct opvar *));
 STATIC_DCL struct opvar *FDECL(opvar_var_conversion, (struct sp_coder *,
                                                       struct opvar *));
 STATIC_DCL struct splev_var *FDECL(opvar_var_defined, (struct sp_coder *,
-                                                       char *));
+                                                       long));
 STATIC_DCL struct opvar *FDECL(splev_stack_getdat, (struct sp_coder *,
                                                     XCHAR_P));
 STATIC_DCL struct opvar *FDECL(splev_stack_getdat_any, (struct sp_coder *));
-STATIC_DCL void FDECL(variable_list_del, (struct splev_var *));
+STATIC_DCL void FDECL(variable_list_del, (struct splev_var *, int));
 STATIC_DCL void FDECL(lvlfill_maze_grid, (int, int, int, int, SCHAR_P));
 STATIC_DCL void FDECL(lvlfill_solid, (SCHAR_P, SCHAR_P));
 STATIC_DCL void FDECL(set_wall_property, (XCHAR_P, XCHAR_P, XCHAR_P, XCHAR_P,
@@ -85,11 +88,14 @@ STATIC_DCL void FDECL(light_region, (region *));
 STATIC_DCL void FDECL(wallify_map, (int, int, int, int));
 STATIC_DCL void FDECL(maze1xy, (coord *, int));
 STATIC_DCL void NDECL(fill_empty_maze);
+STATIC_DCL void FDECL(sp_level_varslot, (sp_lev *, char ***,
+                                          struct opvar *));
 STATIC_DCL boolean FDECL(sp_level_loader, (dlb *, sp_lev *));
 STATIC_DCL boolean FDECL(sp_level_free, (sp_lev *));
+STATIC_DCL sp_lev *FDECL(sp_level_cached, (const char *));
 STATIC_DCL void FDECL(splev_initlev, (lev_init *));
 STATIC_DCL struct sp_frame *FDECL(frame_new, (long));
-STATIC_DCL void FDECL(frame_del, (struct sp_frame *));
+STATIC_DCL void FDECL(frame_del, (struct sp_frame *, int));
 STATIC_DCL void FDECL(spo_frame_push, (struct sp_coder *));
 STATIC_DCL void FDECL(spo_frame_pop, (struct sp_coder *));
 STATIC_DCL long FDECL(sp_code_jmpaddr, (long, long));
@@ -113,6 +119,8 @@ STATIC_DCL void FDECL(spo_altar, (struct sp_coder *));
 STATIC_DCL void FDECL(spo_trap, (struct sp_coder *));
 STATIC_DCL void FDECL(spo_gold, (struct sp_coder *));
 STATIC_DCL void FDECL(spo_corridor, (struct sp_coder *));
+STATIC_DCL int FDECL(selection_colcount, (unsigned long));
+STATIC_DCL struct selectionvar *FDECL(selection_new, (const char *));
 STATIC_DCL struct opvar *FDECL(selection_opvar, (char *));
 STATIC_DCL xchar FDECL(selection_getpoint, (int, int, struct opvar *));
 STATIC_DCL void FDECL(selection_setpoint, (int, int, struct opvar *, XCHAR_P));
@@ -160,13 +168,38 @@ STATIC_DCL void FDECL(spo_room_door, (struct sp_coder *));
 STATIC_DCL void FDECL(sel_set_wallify, (int, int, genericptr_t));
 STATIC_DCL void FDECL(spo_wallify, (struct sp_coder *));
 STATIC_DCL void FDECL(spo_map, (struct sp_coder *));
-STATIC_DCL void FDECL(spo_jmp, (struct sp_coder *, sp_lev *));
-STATIC_DCL void FDECL(spo_conditional_jump, (struct sp_coder *, sp_lev *));
+STATIC_DCL void FDECL(spo_jmp, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_conditional_jump, (struct sp_coder *));
 STATIC_DCL void FDECL(spo_var_init, (struct sp_coder *));
 #if 0
 STATIC_DCL long FDECL(opvar_array_length, (struct sp_coder *));
 #endif /*0*/
 STATIC_DCL void FDECL(spo_shuffle_array, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_nested_room, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_nested_endroom, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_null, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_exit, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_push, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_pop, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_copy, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_math_unary, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_math_add, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_math_binary, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_cmp, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_rn2, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_dice, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_add, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_complement, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_filter, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_point, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_rect, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_line, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_rndline, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_grow, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_flood, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_rndcoord, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_ellipse, (struct sp_coder *));
+STATIC_DCL void FDECL(spo_sel_gradient, (struct sp_coder *));
 STATIC_DCL boolean FDECL(sp_level_coder, (sp_lev *));
 
 #define LEFT 1
@@ -254,15 +287,18 @@ struct splevstack *st;
                 case SPOVAR_MONST:
                 case SPOVAR_OBJ:
                 case SPOVAR_INT:
-                    break;
                 case SPOVAR_VARIABLE:
+                    break;
                 case SPOVAR_STRING:
-                case SPOVAR_SEL:
                     Free(st->stackdata[i]->vardata.str);
                     st->stackdata[i]->vardata.str = NULL;
                     break;
+                case SPOVAR_SEL:
+                    Free(st->stackdata[i]->vardata.sel);
+                    st->stackdata[i]->vardata.sel = NULL;
+                    break;
                 }
-                Free(st->stackdata[i]);
+                opvar_release(st->stackdata[i]);
                 st->stackdata[i] = NULL;
             }
         }
@@ -349,11 +385,74 @@ struct splevstack *st;
 #define OV_pop(x) (x = splev_stack_getdat_any(coder))
 #define OV_pop_typ(x, typ) (x = splev_stack_getdat(coder, typ))
 
+/*
+ * Opvars are taken from chunks of OPVAR_CHUNK of them and put back on a
+ * free list, so that pushing and popping values doesn't call alloc().
+ * The chunks are given back once no opvar is left, which is when the
+ * cache of parsed levels is freed.
+ */
+#define OPVAR_CHUNK 256
+
+struct opvar_chunk {
+    struct opvar_chunk *next;
+    struct opvar ov[OPVAR_CHUNK];
+};
+
+static struct opvar_chunk *opvar_chunks = 0;
+static struct opvar *opvar_freelist = 0;
+static long opvars_inuse = 0L;
+
+STATIC_OVL struct opvar *
+opvar_alloc()
+{
+    struct opvar *ov;
+
+    if (!opvar_freelist) {
+        struct opvar_chunk *chunk = New(struct opvar_chunk);
+        int i;
+
+        chunk->next = opvar_chunks;
+        opvar_chunks = chunk;
+        for (i = OPVAR_CHUNK - 1; i >= 0; i--) {
+            chunk->ov[i].vardata.nextfree = opvar_freelist;
+            opvar_freelist = &chunk->ov[i];
+        }
+    }
+    ov = opvar_freelist;
+    opvar_freelist = ov->vardata.nextfree;
+    opvars_inuse++;
+    return ov;
+}
+
+STATIC_OVL void
+opvar_release(ov)
+struct opvar *ov;
+{
+    ov->spovartyp = SPOVAR_NULL;
+    ov->vardata.nextfree = opvar_freelist;
+    opvar_freelist = ov;
+    opvars_inuse--;
+}
+
+STATIC_OVL void
+opvar_pool_done()
+{
+    struct opvar_chunk *chunk;
+
+    if (opvars_inuse)
+        return;
+    while ((chunk = opvar_chunks) != 0) {
+        opvar_chunks = chunk->next;
+        free((genericptr_t) chunk);
+    }
+    opvar_freelist = (struct opvar *) 0;
+}
+
 struct opvar *
 opvar_new_str(s)
 char *s;
 {
-    struct opvar *tmpov = (struct opvar *) alloc(sizeof(struct opvar));
+    struct opvar *tmpov = opvar_alloc();
 
     tmpov->spovartyp = SPOVAR_STRING;
     if (s) {
@@ -371,7 +470,7 @@ struct opvar *
 opvar_new_int(i)
 long i;
 {
-    struct opvar *tmpov = (struct opvar *) alloc(sizeof(struct opvar));
+    struct opvar *tmpov = opvar_alloc();
 
     tmpov->spovartyp = SPOVAR_INT;
     tmpov->vardata.l = i;
@@ -382,7 +481,7 @@ struct opvar *
 opvar_new_coord(x, y)
 int x, y;
 {
-    struct opvar *tmpov = (struct opvar *) alloc(sizeof(struct opvar));
+    struct opvar *tmpov = opvar_alloc();
 
     tmpov->spovartyp = SPOVAR_COORD;
     tmpov->vardata.l = SP_COORD_PACK(x, y);
@@ -394,7 +493,7 @@ struct opvar *
 opvar_new_region(x1,y1,x2,y2)
      int x1,y1,x2,y2;
 {
-    struct opvar *tmpov = (struct opvar *)alloc(sizeof (struct opvar));
+    struct opvar *tmpov = opvar_alloc();
 
     tmpov->spovartyp = SPOVAR_REGION;
     tmpov->vardata.l = SP_REGION_PACK(x1,y1,x2,y2);
@@ -415,16 +514,18 @@ struct opvar *ov;
     case SPOVAR_MONST:
     case SPOVAR_OBJ:
     case SPOVAR_INT:
-        break;
     case SPOVAR_VARIABLE:
+        break;
     case SPOVAR_STRING:
-    case SPOVAR_SEL:
         Free(ov->vardata.str);
         break;
+    case SPOVAR_SEL:
+        Free(ov->vardata.sel);
+        break;
     default:
         impossible("Unknown opvar value type (%i)!", ov->spovartyp);
     }
-    Free(ov);
+    opvar_release(ov);
 }
 
 /*
@@ -453,7 +554,7 @@ struct opvar *ov;
 
     if (!ov)
         panic("no opvar to clone");
-    tmpov = (struct opvar *) alloc(sizeof(struct opvar));
+    tmpov = opvar_alloc();
     tmpov->spovartyp = ov->spovartyp;
     switch (ov->spovartyp) {
     case SPOVAR_COORD:
@@ -462,13 +563,16 @@ struct opvar *ov;
     case SPOVAR_MONST:
     case SPOVAR_OBJ:
     case SPOVAR_INT:
+    case SPOVAR_VARIABLE:
         tmpov->vardata.l = ov->vardata.l;
         break;
-    case SPOVAR_VARIABLE:
     case SPOVAR_STRING:
-    case SPOVAR_SEL:
         tmpov->vardata.str = dupstr(ov->vardata.str);
         break;
+    case SPOVAR_SEL:
+        tmpov->vardata.sel = New(struct selectionvar);
+        *tmpov->vardata.sel = *ov->vardata.sel;
+        break;
     default:
         impossible("Unknown push value type (%i)!", ov->spovartyp);
     }
@@ -489,46 +593,39 @@ struct opvar *ov;
         return NULL;
     if (ov->spovartyp != SPOVAR_VARIABLE)
         return ov;
-    tmp = coder->frame->variables;
-    while (tmp) {
-        if (!strcmp(tmp->name, OV_s(ov))) {
-            if ((tmp->svtyp & SPOVAR_ARRAY)) {
-                array_idx = opvar_var_conversion(coder,
-                                               splev_stack_pop(coder->stack));
-                if (!array_idx || OV_typ(array_idx) != SPOVAR_INT)
-                    panic("array idx not an int");
-                if (tmp->array_len < 1)
-                    panic("array len < 1");
-                OV_i(array_idx) = (OV_i(array_idx) % tmp->array_len);
-                tmpov = opvar_clone(tmp->data.arrayvalues[OV_i(array_idx)]);
-                opvar_free(array_idx);
-                return tmpov;
-            } else {
-                tmpov = opvar_clone(tmp->data.value);
-                return tmpov;
-            }
+    if ((tmp = opvar_var_defined(coder, OV_i(ov))) != 0) {
+        if ((tmp->svtyp & SPOVAR_ARRAY)) {
+            array_idx = opvar_var_conversion(coder,
+                                             splev_stack_pop(coder->stack));
+            if (!array_idx || OV_typ(array_idx) != SPOVAR_INT)
+                panic("array idx not an int");
+            if (tmp->array_len < 1)
+                panic("array len < 1");
+            OV_i(array_idx) = (OV_i(array_idx) % tmp->array_len);
+            tmpov = opvar_clone(tmp->data.arrayvalues[OV_i(array_idx)]);
+            opvar_free(array_idx);
+            return tmpov;
+        } else {
+            tmpov = opvar_clone(tmp->data.value);
+            return tmpov;
         }
-        tmp = tmp->next;
     }
     return NULL;
 }
 
+/* the variable in the given slot of the current frame, if it is set */
 struct splev_var *
-opvar_var_defined(coder, name)
+opvar_var_defined(coder, slot)
 struct sp_coder *coder;
-char *name;
+long slot;
 {
     struct splev_var *tmp;
 
-    if (!coder)
+    if (!coder || !coder->frame->variables || slot < 0
+        || slot >= coder->n_vars)
         return NULL;
-    tmp = coder->frame->variables;
-    while (tmp) {
-        if (!strcmp(tmp->name, name))
-            return tmp;
-        tmp = tmp->next;
-    }
-    return NULL;
+    tmp = &coder->frame->variables[slot];
+    return (tmp->svtyp != SPOVAR_NULL) ? tmp : NULL;
 }
 
 struct opvar *
@@ -573,16 +670,18 @@ struct sp_coder *coder;
 }
 
 void
-variable_list_del(varlist)
+variable_list_del(varlist, nvars)
 struct splev_var *varlist;
+int nvars;
 {
     static const char nhFunc[] = "variable_list_del";
-    struct splev_var *tmp = varlist;
+    struct splev_var *tmp;
 
-    if (!tmp)
+    if (!varlist)
         return;
-    while (tmp) {
-        Free(tmp->name);
+    for (tmp = varlist; tmp < &varlist[nvars]; tmp++) {
+        if (tmp->svtyp == SPOVAR_NULL)
+            continue;
         if ((tmp->svtyp & SPOVAR_ARRAY)) {
             long idx = tmp->array_len;
 
@@ -593,10 +692,8 @@ struct splev_var *varlist;
         } else {
             opvar_free(tmp->data.value);
         }
-        tmp = varlist->next;
-        Free(varlist);
-        varlist = tmp;
     }
+    Free(varlist);
 }
 
 void
@@ -2555,6 +2652,42 @@ fill_empty_maze()
     }
 }
 
+/*
+ * Turn the variable name in ov into the number of its slot in a frame's
+ * variables[], so that the coder never has to look a name up.  names[]
+ * keeps the names seen so far; it takes over the ones it adds.
+ */
+STATIC_OVL void
+sp_level_varslot(lvl, names, ov)
+sp_lev *lvl;
+char ***names;
+struct opvar *ov;
+{
+    char **tmp;
+    int i;
+
+    for (i = 0; i < lvl->n_vars; i++)
+        if (!strcmp((*names)[i], OV_s(ov)))
+            break;
+    if (i < lvl->n_vars) {
+        Free(OV_s(ov));
+    } else {
+        if (!(lvl->n_vars % 16)) {
+            tmp = (char **) alloc((unsigned) (lvl->n_vars + 16)
+                                  * sizeof (char *));
+            if (lvl->n_vars) {
+                (void) memcpy((genericptr_t) tmp, (genericptr_t) *names,
+                              lvl->n_vars * sizeof (char *));
+                free((genericptr_t) *names);
+            }
+            *names = tmp;
+        }
+        (*names)[lvl->n_vars++] = OV_s(ov);
+    }
+    ov->spovartyp = SPOVAR_VARIABLE;
+    OV_i(ov) = (long) i;
+}
+
 /*
  * special level loader
  */
@@ -2566,23 +2699,34 @@ sp_lev *lvl;
     long n_opcode = 0;
     struct opvar *opdat;
     int opcode;
+    char **varnames = (char **) 0;
 
     Fread((genericptr_t) & (lvl->n_opcodes), 1, sizeof(lvl->n_opcodes), fd);
     lvl->opcodes = (_opcode *) alloc(sizeof(_opcode) * (lvl->n_opcodes));
+    lvl->n_vars = 0;
 
     while (n_opcode < lvl->n_opcodes) {
         Fread((genericptr_t) &lvl->opcodes[n_opcode].opcode, 1,
               sizeof(lvl->opcodes[n_opcode].opcode), fd);
         opcode = lvl->opcodes[n_opcode].opcode;
 
-        opdat = NULL;
-
         if (opcode < SPO_NULL || opcode >= MAX_SP_OPCODES)
             panic("sp_level_loader: impossible opcode %i.", opcode);
 
+        if (opcode == SPO_VAR_INIT || opcode == SPO_SHUFFLE_ARRAY) {
+            /* lev_comp pushes the name of the variable right before */
+            opdat = n_opcode ? lvl->opcodes[n_opcode - 1].opdat : NULL;
+            if (!opdat || OV_typ(opdat) != SPOVAR_STRING)
+                panic("sp_level_loader: no variable name for opcode %i.",
+                      opcode);
+            sp_level_varslot(lvl, &varnames, opdat);
+        }
+
+        opdat = NULL;
+
         if (opcode == SPO_PUSH) {
             int nsize;
-            struct opvar *ov = (struct opvar *) alloc(sizeof(struct opvar));
+            struct opvar *ov = opvar_alloc();
 
             opdat = ov;
             ov->spovartyp = SPO_NULL;
@@ -2614,6 +2758,12 @@ sp_lev *lvl;
                     Fread(opd, 1, nsize, fd);
                 opd[nsize] = 0;
                 ov->vardata.str = opd;
+                if (ov->spovartyp == SPOVAR_VARIABLE) {
+                    sp_level_varslot(lvl, &varnames, ov);
+                } else if (ov->spovartyp == SPOVAR_SEL) {
+                    ov->vardata.sel = selection_new(opd);
+                    Free(opd);
+                }
                 break;
             }
             default:
@@ -2626,6 +2776,9 @@ sp_lev *lvl;
         n_opcode++;
     } /*while*/
 
+    for (opcode = 0; opcode < lvl->n_vars; opcode++)
+        free((genericptr_t) varnames[opcode]);
+    Free(varnames);
     return TRUE;
 }
 
@@ -2701,8 +2854,9 @@ long execptr;
 }
 
 void
-frame_del(frame)
+frame_del(frame, nvars)
 struct sp_frame *frame;
+int nvars;
 {
     if (!frame)
         return;
@@ -2711,7 +2865,7 @@ struct sp_frame *frame;
         frame->stack = NULL;
     }
     if (frame->variables) {
-        variable_list_del(frame->variables);
+        variable_list_del(frame->variables, nvars);
         frame->variables = NULL;
     }
     Free(frame);
@@ -2734,7 +2888,7 @@ struct sp_coder *coder;
     if (coder->frame && coder->frame->next) {
         struct sp_frame *tmpframe = coder->frame->next;
 
-        frame_del(coder->frame);
+        frame_del(coder->frame, coder->n_vars);
         coder->frame = tmpframe;
         coder->stack = coder->frame->stack;
     }
@@ -2799,7 +2953,7 @@ struct sp_coder *coder;
     /* pop the frame */
     if (coder->frame->next) {
         struct sp_frame *tmpframe = coder->frame->next;
-        frame_del(coder->frame);
+        frame_del(coder->frame, coder->n_vars);
         coder->frame = tmpframe;
         coder->stack = coder->frame->stack;
     }
@@ -3529,21 +3683,51 @@ struct sp_coder *coder;
     opvar_free(srcroom);
 }
 
+/* all the rows of one column of a selection */
+#define SEL_COLMASK ((((unsigned long) 1 << (ROWNO - 1)) << 1) - 1)
+
+#if ROWNO > 32
+#error "a selection column has more than 32 rows"
+#endif
+
+/* how many locations of one column are selected */
+STATIC_OVL int
+selection_colcount(w)
+unsigned long w;
+{
+    int n = 0;
+
+    for (; w; w &= w - 1)
+        n++;
+    return n;
+}
+
+/* a new selection, empty or unpacked from the char-per-location form a
+   special level file holds */
+STATIC_OVL struct selectionvar *
+selection_new(nbuf)
+const char *nbuf;
+{
+    struct selectionvar *sel = New(struct selectionvar);
+    int x, y;
+
+    (void) memset((genericptr_t) sel, 0, sizeof(struct selectionvar));
+    if (nbuf && strlen(nbuf) >= (COLNO * ROWNO))
+        for (x = 0; x < COLNO; x++)
+            for (y = 0; y < ROWNO; y++)
+                if (nbuf[COLNO * y + x] - 1)
+                    sel->col[x] |= (unsigned long) 1 << y;
+    return sel;
+}
+
 struct opvar *
 selection_opvar(nbuf)
 char *nbuf;
 {
-    struct opvar *ov;
-    char buf[(COLNO * ROWNO) + 1];
+    struct opvar *ov = opvar_alloc();
 
-    if (!nbuf) {
-        (void) memset(buf, 1, sizeof(buf));
-        buf[(COLNO * ROWNO)] = '\0';
-        ov = opvar_new_str(buf);
-    } else {
-        ov = opvar_new_str(nbuf);
-    }
     ov->spovartyp = SPOVAR_SEL;
+    ov->vardata.sel = selection_new(nbuf);
     return ov;
 }
 
@@ -3557,7 +3741,7 @@ struct opvar *ov;
     if (x < 0 || y < 0 || x >= COLNO || y >= ROWNO)
         return 0;
 
-    return (ov->vardata.str[COLNO * y + x] - 1);
+    return (xchar) ((ov->vardata.sel->col[x] >> y) & 1);
 }
 
 void
@@ -3571,7 +3755,10 @@ xchar c;
     if (x < 0 || y < 0 || x >= COLNO || y >= ROWNO)
         return;
 
-    ov->vardata.str[COLNO * y + x] = (char) (c + 1);
+    if (c)
+        ov->vardata.sel->col[x] |= (unsigned long) 1 << y;
+    else
+        ov->vardata.sel->col[x] &= ~((unsigned long) 1 << y);
 }
 
 struct opvar *
@@ -3579,16 +3766,14 @@ selection_not(s)
 struct opvar *s;
 {
     struct opvar *ov;
-    int x, y;
+    int x;
 
     ov = selection_opvar((char *) 0);
     if (!ov)
         return NULL;
 
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            if (!selection_getpoint(x, y, s))
-                selection_setpoint(x, y, ov, 1);
+        ov->vardata.sel->col[x] = ~s->vardata.sel->col[x] & SEL_COLMASK;
 
     return ov;
 }
@@ -3599,28 +3784,30 @@ struct opvar *s1, *s2;
 char oper;
 {
     struct opvar *ov;
-    int x, y;
+    unsigned long *c, *c1, *c2;
+    int x;
 
     ov = selection_opvar((char *) 0);
     if (!ov)
         return NULL;
 
-    for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++) {
-            switch (oper) {
-            default:
-            case '|':
-                if (selection_getpoint(x, y, s1)
-                    || selection_getpoint(x, y, s2))
-                    selection_setpoint(x, y, ov, 1);
-                break;
-            case '&':
-                if (selection_getpoint(x, y, s1)
-                    && selection_getpoint(x, y, s2))
-                    selection_setpoint(x, y, ov, 1);
-                break;
-            }
+    c = ov->vardata.sel->col;
+    c1 = s1->vardata.sel->col;
+    c2 = s2->vardata.sel->col;
+    for (x = 0; x < COLNO; x++) {
+        switch (oper) {
+        default:
+        case '|':
+            c[x] = c1[x] | c2[x];
+            break;
+        case '&':
+            c[x] = c1[x] & c2[x];
+            break;
+        case '^':
+            c[x] = c1[x] ^ c2[x];
+            break;
         }
+    }
 
     return ov;
 }
@@ -3633,6 +3820,7 @@ struct opvar *mc;
     int x, y;
     schar mapc;
     xchar lit;
+    unsigned long w;
     struct opvar *ret = selection_opvar((char *) 0);
 
     if (!ov || !mc || !ret)
@@ -3640,8 +3828,8 @@ struct opvar *mc;
     mapc = SP_MAPCHAR_TYP(OV_i(mc));
     lit = SP_MAPCHAR_LIT(OV_i(mc));
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            if (selection_getpoint(x, y, ov) && (levl[x][y].typ == mapc)) {
+        for (y = 0, w = ov->vardata.sel->col[x]; w; y++, w >>= 1)
+            if ((w & 1) && (levl[x][y].typ == mapc)) {
                 switch (lit) {
                 default:
                 case -2:
@@ -3666,12 +3854,13 @@ struct opvar *ov;
 int percent;
 {
     int x, y;
+    unsigned long w;
 
     if (!ov)
         return;
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            if (selection_getpoint(x, y, ov) && (rn2(100) >= percent))
+        for (y = 0, w = ov->vardata.sel->col[x]; w; y++, w >>= 1)
+            if ((w & 1) && (rn2(100) >= percent))
                 selection_setpoint(x, y, ov, 0);
 }
 
@@ -3682,82 +3871,80 @@ schar *x, *y;
 boolean removeit;
 {
     int idx = 0;
-    int c;
+    int c, n;
     int dx, dy;
+    unsigned long w, *col = ov->vardata.sel->col;
 
-    for (dx = 0; dx < COLNO; dx++)
-        for (dy = 0; dy < ROWNO; dy++)
-            if (isok(dx, dy) && selection_getpoint(dx, dy, ov))
-                idx++;
+    /* column 0 is never isok() */
+    for (dx = 1; dx < COLNO; dx++)
+        if (col[dx])
+            idx += selection_colcount(col[dx]);
 
     if (idx) {
         c = rn2(idx);
-        for (dx = 0; dx < COLNO; dx++)
-            for (dy = 0; dy < ROWNO; dy++)
-                if (isok(dx, dy) && selection_getpoint(dx, dy, ov)) {
-                    if (!c) {
-                        *x = dx;
-                        *y = dy;
-                        if (removeit) selection_setpoint(dx, dy, ov, 0);
-                        return 1;
-                    }
-                    c--;
-                }
+        for (dx = 1; dx < COLNO; dx++) {
+            if (!col[dx])
+                continue;
+            if (c >= (n = selection_colcount(col[dx]))) {
+                c -= n;
+                continue;
+            }
+            for (dy = 0, w = col[dx]; ; dy++, w >>= 1)
+                if ((w & 1) && !c--)
+                    break;
+            *x = dx;
+            *y = dy;
+            if (removeit)
+                selection_setpoint(dx, dy, ov, 0);
+            return 1;
+        }
     }
     *x = *y = -1;
     return 0;
 }
 
+/* each direction adds the locations next to a selected one on the side
+   away from it, a column shifted by one row or moved over by one */
 void
 selection_do_grow(ov, dir)
 struct opvar *ov;
 int dir;
 {
-    int x, y, c;
-    char tmp[COLNO][ROWNO];
+    int x;
+    unsigned long tmp[COLNO], *col;
 
-    if (ov->spovartyp != SPOVAR_SEL)
-        return;
     if (!ov)
         return;
+    if (ov->spovartyp != SPOVAR_SEL)
+        return;
 
-    (void) memset(tmp, 0, sizeof(tmp));
-
-    for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++) {
-            c = 0;
-            if ((dir & W_WEST) && (x > 0)
-                && (selection_getpoint(x - 1, y, ov)))
-                c++;
-            if ((dir & (W_WEST | W_NORTH)) && (x > 0) && (y > 0)
-                && (selection_getpoint(x - 1, y - 1, ov)))
-                c++;
-            if ((dir & W_NORTH) && (y > 0)
-                && (selection_getpoint(x, y - 1, ov)))
-                c++;
-            if ((dir & (W_NORTH | W_EAST)) && (y > 0) && (x < COLNO - 1)
-                && (selection_getpoint(x + 1, y - 1, ov)))
-                c++;
-            if ((dir & W_EAST) && (x < COLNO - 1)
-                && (selection_getpoint(x + 1, y, ov)))
-                c++;
-            if ((dir & (W_EAST | W_SOUTH)) && (x < COLNO - 1)
-                && (y < ROWNO - 1) && (selection_getpoint(x + 1, y + 1, ov)))
-                c++;
-            if ((dir & W_SOUTH) && (y < ROWNO - 1)
-                && (selection_getpoint(x, y + 1, ov)))
-                c++;
-            if ((dir & (W_SOUTH | W_WEST)) && (y < ROWNO - 1) && (x > 0)
-                && (selection_getpoint(x - 1, y + 1, ov)))
-                c++;
-            if (c)
-                tmp[x][y] = 1;
+    col = ov->vardata.sel->col;
+    for (x = 0; x < COLNO; x++) {
+        tmp[x] = 0L;
+        if (dir & W_NORTH)
+            tmp[x] |= col[x] << 1;
+        if (dir & W_SOUTH)
+            tmp[x] |= col[x] >> 1;
+        if (x > 0) {
+            if (dir & W_WEST)
+                tmp[x] |= col[x - 1];
+            if (dir & (W_WEST | W_NORTH))
+                tmp[x] |= col[x - 1] << 1;
+            if (dir & (W_SOUTH | W_WEST))
+                tmp[x] |= col[x - 1] >> 1;
+        }
+        if (x < COLNO - 1) {
+            if (dir & W_EAST)
+                tmp[x] |= col[x + 1];
+            if (dir & (W_NORTH | W_EAST))
+                tmp[x] |= col[x + 1] << 1;
+            if (dir & (W_EAST | W_SOUTH))
+                tmp[x] |= col[x + 1] >> 1;
         }
+    }
 
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            if (tmp[x][y])
-                selection_setpoint(x, y, ov, 1);
+        col[x] |= tmp[x] & SEL_COLMASK;
 }
 
 STATIC_VAR int FDECL((*selection_flood_check_func), (int, int));
@@ -3786,62 +3973,72 @@ int x, y;
             || levl[x][y].typ == SCORR);
 }
 
+/*
+ * Scanline fill along the columns: each seed taken off the stack is
+ * stretched up and down into a run of the column, and the columns on
+ * either side (one row further each way with diagonals) get one seed
+ * per run of locations not yet reached.  A location is marked as soon
+ * as it is seeded, so the stack never holds more than the map.
+ */
 STATIC_OVL void
 selection_floodfill(ov, x, y, diagonals)
 struct opvar *ov;
 int x, y;
 boolean diagonals;
 {
-    static const char nhFunc[] = "selection_floodfill";
-    struct opvar *tmp = selection_opvar((char *) 0);
-#define SEL_FLOOD_STACK (COLNO * ROWNO)
-#define SEL_FLOOD(nx, ny)                     \
-    do {                                      \
-        if (idx < SEL_FLOOD_STACK) {          \
-            dx[idx] = (nx);                   \
-            dy[idx] = (ny);                   \
-            idx++;                            \
-        } else                                \
-            panic(floodfill_stack_overrun);   \
-    } while (0)
-#define SEL_FLOOD_CHKDIR(mx,my,sel)                  \
-    if (isok((mx), (my))                             \
-        && (*selection_flood_check_func)((mx), (my)) \
-        && !selection_getpoint((mx), (my), (sel)))   \
-        SEL_FLOOD((mx), (my))
     static const char floodfill_stack_overrun[] = "floodfill stack overrun";
-    int idx = 0;
+#define SEL_FLOOD_STACK (COLNO * ROWNO)
+#define SEL_FLOOD_OK(mx, my)                          \
+    (isok((mx), (my))                                 \
+     && !((seen[(mx)] >> (my)) & 1)                   \
+     && (*selection_flood_check_func)((mx), (my)))
+    unsigned long seen[COLNO];
+    int idx = 0, y1, y2, nx, ny, ylo, yhi;
+    boolean inrun;
     xchar dx[SEL_FLOOD_STACK];
     xchar dy[SEL_FLOOD_STACK];
 
-    if (selection_flood_check_func == NULL) {
-        opvar_free(tmp);
+    if (selection_flood_check_func == NULL || !isok(x, y))
         return;
-    }
-    SEL_FLOOD(x, y);
+    (void) memset((genericptr_t) seen, 0, sizeof seen);
+    /* the starting location is filled whether or not it passes */
+    seen[x] |= (unsigned long) 1 << y;
+    dx[idx] = x;
+    dy[idx] = y;
+    idx++;
     do {
         idx--;
         x = dx[idx];
         y = dy[idx];
-        if (isok(x, y)) {
-            selection_setpoint(x, y, ov, 1);
-            selection_setpoint(x, y, tmp, 1);
-        }
-        SEL_FLOOD_CHKDIR((x + 1), y, tmp);
-        SEL_FLOOD_CHKDIR((x - 1), y, tmp);
-        SEL_FLOOD_CHKDIR(x, (y + 1), tmp);
-        SEL_FLOOD_CHKDIR(x, (y - 1), tmp);
-        if (diagonals) {
-            SEL_FLOOD_CHKDIR((x + 1), (y + 1), tmp);
-            SEL_FLOOD_CHKDIR((x - 1), (y - 1), tmp);
-            SEL_FLOOD_CHKDIR((x - 1), (y + 1), tmp);
-            SEL_FLOOD_CHKDIR((x + 1), (y - 1), tmp);
+        for (y1 = y; SEL_FLOOD_OK(x, y1 - 1); y1--)
+            continue;
+        for (y2 = y; SEL_FLOOD_OK(x, y2 + 1); y2++)
+            continue;
+        ov->vardata.sel->col[x] |= ((SEL_COLMASK >> (ROWNO - 1 - y2))
+                                    >> y1) << y1;
+        seen[x] |= ((SEL_COLMASK >> (ROWNO - 1 - y2)) >> y1) << y1;
+
+        ylo = diagonals ? y1 - 1 : y1;
+        yhi = diagonals ? y2 + 1 : y2;
+        for (nx = x - 1; nx <= x + 1; nx += 2) {
+            inrun = FALSE;
+            for (ny = ylo; ny <= yhi; ny++) {
+                if (!SEL_FLOOD_OK(nx, ny)) {
+                    inrun = FALSE;
+                } else if (!inrun) {
+                    if (idx >= SEL_FLOOD_STACK)
+                        panic(floodfill_stack_overrun);
+                    seen[nx] |= (unsigned long) 1 << ny;
+                    dx[idx] = nx;
+                    dy[idx] = ny;
+                    idx++;
+                    inrun = TRUE;
+                }
+            }
         }
     } while (idx > 0);
-#undef SEL_FLOOD
+#undef SEL_FLOOD_OK
 #undef SEL_FLOOD_STACK
-#undef SEL_FLOOD_CHKDIR
-    opvar_free(tmp);
 }
 
 /* McIlroy's Ellipse Algorithm */
@@ -4111,11 +4308,13 @@ select_iter_func func;
 genericptr_t arg;
 {
     int x, y;
+    unsigned long w;
 
-    /* yes, this is very naive, but it's not _that_ expensive. */
+    if (!ov || ov->spovartyp != SPOVAR_SEL)
+        return;
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            if (selection_getpoint(x, y, ov))
+        for (y = 0, w = ov->vardata.sel->col[x]; w; y++, w >>= 1)
+            if (w & 1)
                 (*func)(x, y, arg);
 }
 
@@ -4200,7 +4399,8 @@ struct sp_coder *coder;
     switch (coder->opcode) {
     default:
         impossible("spo_feature called with wrong opcode %i.", coder->opcode);
-        break;
+        opvar_free(sel);
+        return;
     case SPO_FOUNTAIN:
         typ = FOUNTAIN;
         break;
@@ -4917,9 +5117,8 @@ struct sp_coder *coder;
 }
 
 void
-spo_jmp(coder, lvl)
+spo_jmp(coder)
 struct sp_coder *coder;
-sp_lev *lvl;
 {
     static const char nhFunc[] = "spo_jmp";
     struct opvar *tmpa;
@@ -4928,15 +5127,14 @@ sp_lev *lvl;
     if (!OV_pop_i(tmpa))
         return;
     a = sp_code_jmpaddr(coder->frame->n_opcode, (OV_i(tmpa) - 1));
-    if ((a >= 0) && (a < lvl->n_opcodes) && (a != coder->frame->n_opcode))
+    if ((a >= 0) && (a < coder->n_opcodes) && (a != coder->frame->n_opcode))
         coder->frame->n_opcode = a;
     opvar_free(tmpa);
 }
 
 void
-spo_conditional_jump(coder, lvl)
+spo_conditional_jump(coder)
 struct sp_coder *coder;
-sp_lev *lvl;
 {
     static const char nhFunc[] = "spo_conditional_jump";
     struct opvar *oa, *oc;
@@ -4973,7 +5171,7 @@ sp_lev *lvl;
         break;
     }
 
-    if ((test) && (a >= 0) && (a < lvl->n_opcodes)
+    if ((test) && (a >= 0) && (a < coder->n_opcodes)
         && (a != coder->frame->n_opcode))
         coder->frame->n_opcode = a;
 
@@ -4993,13 +5191,15 @@ struct sp_coder *coder;
     struct splev_var *tmp2;
     long idx;
 
-    OV_pop_s(vname);
+    /* the name is a slot number, see sp_level_loader() */
+    vname = splev_stack_pop(coder->stack);
     OV_pop_i(arraylen);
 
-    if (!vname || !arraylen)
+    if (!vname || OV_typ(vname) != SPOVAR_VARIABLE || !arraylen
+        || OV_i(vname) < 0 || OV_i(vname) >= coder->n_vars)
         panic("no values for SPO_VAR_INIT");
 
-    tmpvar = opvar_var_defined(coder, OV_s(vname));
+    tmpvar = opvar_var_defined(coder, OV_i(vname));
 
     if (tmpvar) {
         /* variable redefinition */
@@ -5036,17 +5236,20 @@ struct sp_coder *coder;
         }
     } else {
         /* new variable definition */
-        tmpvar = (struct splev_var *) alloc(sizeof(struct splev_var));
-        tmpvar->next = coder->frame->variables;
-        tmpvar->name = dupstr(OV_s(vname));
-        coder->frame->variables = tmpvar;
+        if (!coder->frame->variables) {
+            coder->frame->variables = (struct splev_var *) alloc(
+                (unsigned) coder->n_vars * sizeof(struct splev_var));
+            for (idx = 0; idx < coder->n_vars; idx++)
+                coder->frame->variables[idx].svtyp = SPOVAR_NULL;
+        }
+        tmpvar = &coder->frame->variables[OV_i(vname)];
 
         if (OV_i(arraylen) < 0) {
         /* copy variable */
         copy_variable:
-            OV_pop(vvalue);
-            tmp2 = opvar_var_defined(coder, OV_s(vvalue));
-            if (!tmp2)
+            vvalue = splev_stack_pop(coder->stack);
+            if (!vvalue || OV_typ(vvalue) != SPOVAR_VARIABLE
+                || !(tmp2 = opvar_var_defined(coder, OV_i(vvalue))))
                 panic("no copyable var");
             tmpvar->svtyp = tmp2->svtyp;
             tmpvar->array_len = tmp2->array_len;
@@ -5111,17 +5314,11 @@ struct sp_coder *coder;
     if (vname->spovartyp != SPOVAR_VARIABLE)
         goto pass;
 
-    tmp = coder->frame->variables;
-    while (tmp) {
-        if (!strcmp(tmp->name, OV_s(vname))) {
-            if ((tmp->svtyp & SPOVAR_ARRAY)) {
-                len = tmp->array_len;
-                if (len < 1)
-                    len = 0;
-            }
-            goto pass;
-        }
-        tmp = tmp->next;
+    tmp = opvar_var_defined(coder, OV_i(vname));
+    if (tmp && (tmp->svtyp & SPOVAR_ARRAY)) {
+        len = tmp->array_len;
+        if (len < 1)
+            len = 0;
     }
 
 pass:
@@ -5140,10 +5337,12 @@ struct sp_coder *coder;
     struct opvar *tmp2;
     long i, j;
 
-    if (!OV_pop_s(vname))
+    if (!(vname = splev_stack_pop(coder->stack)))
         return;
 
-    tmp = opvar_var_defined(coder, OV_s(vname));
+    tmp = (OV_typ(vname) == SPOVAR_VARIABLE)
+              ? opvar_var_defined(coder, OV_i(vname))
+              : (struct splev_var *) 0;
     if (!tmp || (tmp->array_len < 1)) {
         opvar_free(vname);
         return;
@@ -5159,688 +5358,731 @@ struct sp_coder *coder;
     opvar_free(vname);
 }
 
-/* Special level coder, creates the special level from the sp_lev codes.
- * Does not free the allocated memory.
- */
-STATIC_OVL boolean
-sp_level_coder(lvl)
-sp_lev *lvl;
+/* ROOM and SUBROOM inside a room that could not be made are skipped,
+   and so are their ENDROOMs */
+void
+spo_nested_room(coder)
+struct sp_coder *coder;
 {
-    static const char nhFunc[] = "sp_level_coder";
-    unsigned long exec_opcodes = 0;
-    int tmpi;
-    long room_stack = 0;
-    unsigned long max_execution = SPCODER_MAX_RUNTIME;
-    struct sp_coder *coder =
-        (struct sp_coder *) alloc(sizeof(struct sp_coder));
+    if (!coder->failed_room[coder->n_subroom - 1])
+        spo_room(coder);
+    else
+        coder->room_stack++;
+}
 
-    coder->frame = frame_new(0);
-    coder->stack = NULL;
-    coder->premapped = FALSE;
-    coder->solidify = FALSE;
-    coder->check_inaccessibles = FALSE;
-    coder->croom = NULL;
-    coder->n_subroom = 1;
-    coder->exit_script = FALSE;
-    coder->lvl_is_joined = 0;
+void
+spo_nested_endroom(coder)
+struct sp_coder *coder;
+{
+    if (coder->failed_room[coder->n_subroom - 1] && coder->room_stack)
+        coder->room_stack--;
+    else
+        spo_endroom(coder);
+}
 
-    splev_init_present = FALSE;
-    icedpools = FALSE;
+/*ARGUSED*/
+void
+spo_null(coder)
+struct sp_coder *coder UNUSED;
+{
+    return;
+}
 
-    if (wizard) {
-        char *met = nh_getenv("SPCODER_MAX_RUNTIME");
-        if (met && met[0] == '1')
-            max_execution = (1 << 30) - 1;
-    }
+void
+spo_exit(coder)
+struct sp_coder *coder;
+{
+    coder->exit_script = TRUE;
+}
 
-    for (tmpi = 0; tmpi <= MAX_NESTED_ROOMS; tmpi++) {
-        coder->tmproomlist[tmpi] = (struct mkroom *) 0;
-        coder->failed_room[tmpi] = FALSE;
-    }
+void
+spo_push(coder)
+struct sp_coder *coder;
+{
+    splev_stack_push(coder->stack, opvar_clone(coder->opdat));
+}
 
-    shuffle_alignments();
+void
+spo_pop(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_pop";
+    struct opvar *ov = splev_stack_pop(coder->stack);
 
-    for (tmpi = 0; tmpi < MAX_CONTAINMENT; tmpi++)
-        container_obj[tmpi] = NULL;
-    container_idx = 0;
+    opvar_free(ov);
+}
 
-    invent_carrying_monster = NULL;
+void
+spo_copy(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_copy";
+    struct opvar *a = splev_stack_pop(coder->stack);
 
-    (void) memset((genericptr_t) &SpLev_Map[0][0], 0, sizeof SpLev_Map);
+    splev_stack_push(coder->stack, opvar_clone(a));
+    splev_stack_push(coder->stack, opvar_clone(a));
+    opvar_free(a);
+}
 
-    level.flags.is_maze_lev = 0;
+/* DEC, INC and MATH_SIGN */
+void
+spo_math_unary(coder)
+struct sp_coder *coder;
+{
+    struct opvar *a;
 
-    xstart = 1;
-    ystart = 0;
-    xsize = COLNO - 1;
-    ysize = ROWNO;
+    if (!OV_pop_i(a))
+        return;
+    if (coder->opcode == SPO_DEC)
+        OV_i(a)--;
+    else if (coder->opcode == SPO_INC)
+        OV_i(a)++;
+    else
+        OV_i(a) = ((OV_i(a) < 0) ? -1 : ((OV_i(a) > 0) ? 1 : 0));
+    splev_stack_push(coder->stack, a);
+}
 
-    while (coder->frame->n_opcode < lvl->n_opcodes && !coder->exit_script) {
-        coder->opcode = lvl->opcodes[coder->frame->n_opcode].opcode;
-        coder->opdat = lvl->opcodes[coder->frame->n_opcode].opdat;
+void
+spo_math_add(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_math_add";
+    struct opvar *a, *b;
 
-        coder->stack = coder->frame->stack;
+    if (!OV_pop(b) || !OV_pop(a))
+        return;
+    if (OV_typ(b) == OV_typ(a)) {
+        if (OV_typ(a) == SPOVAR_INT) {
+            OV_i(a) = OV_i(a) + OV_i(b);
+            splev_stack_push(coder->stack, a);
+            opvar_free(b);
+        } else if (OV_typ(a) == SPOVAR_STRING) {
+            struct opvar *c;
+            char *tmpbuf = (char *) alloc(strlen(OV_s(a))
+                                          + strlen(OV_s(b)) + 1);
 
-        if (exec_opcodes++ > max_execution) {
-            impossible("Level script is taking too much time, stopping.");
-            coder->exit_script = TRUE;
+            (void) sprintf(tmpbuf, "%s%s", OV_s(a), OV_s(b));
+            c = opvar_new_str(tmpbuf);
+            splev_stack_push(coder->stack, c);
+            opvar_free(a);
+            opvar_free(b);
+            Free(tmpbuf);
+        } else {
+            splev_stack_push(coder->stack, a);
+            opvar_free(b);
+            impossible("adding weird types");
         }
+    } else {
+        splev_stack_push(coder->stack, a);
+        opvar_free(b);
+        impossible("adding different types");
+    }
+}
 
-        if (coder->failed_room[coder->n_subroom - 1]
-            && coder->opcode != SPO_ENDROOM && coder->opcode != SPO_ROOM
-            && coder->opcode != SPO_SUBROOM)
-            goto next_opcode;
-
-        coder->croom = coder->tmproomlist[coder->n_subroom - 1];
-
-        switch (coder->opcode) {
-        case SPO_NULL:
-            break;
-        case SPO_EXIT:
-            coder->exit_script = TRUE;
-            break;
-        case SPO_FRAME_PUSH:
-            spo_frame_push(coder);
-            break;
-        case SPO_FRAME_POP:
-            spo_frame_pop(coder);
-            break;
-        case SPO_CALL:
-            spo_call(coder);
-            break;
-        case SPO_RETURN:
-            spo_return(coder);
-            break;
-        case SPO_END_MONINVENT:
-            spo_end_moninvent(coder);
-            break;
-        case SPO_POP_CONTAINER:
-            spo_pop_container(coder);
-            break;
-        case SPO_POP: {
-            struct opvar *ov = splev_stack_pop(coder->stack);
+/* MATH_SUB, MATH_MUL, MATH_DIV and MATH_MOD */
+void
+spo_math_binary(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_math_binary";
+    struct opvar *a, *b;
 
-            opvar_free(ov);
-            break;
+    if (!OV_pop_i(b) || !OV_pop_i(a))
+        return;
+    switch (coder->opcode) {
+    case SPO_MATH_SUB:
+        OV_i(a) = OV_i(a) - OV_i(b);
+        break;
+    case SPO_MATH_MUL:
+        OV_i(a) = OV_i(a) * OV_i(b);
+        break;
+    case SPO_MATH_DIV:
+        if (OV_i(b) >= 1) {
+            OV_i(a) = OV_i(a) / OV_i(b);
+        } else {
+            OV_i(a) = 0;
         }
-        case SPO_PUSH:
-            splev_stack_push(coder->stack, opvar_clone(coder->opdat));
-            break;
-        case SPO_MESSAGE:
-            spo_message(coder);
-            break;
-        case SPO_MONSTER:
-            spo_monster(coder);
-            break;
-        case SPO_OBJECT:
-            spo_object(coder);
-            break;
-        case SPO_LEVEL_FLAGS:
-            spo_level_flags(coder);
-            break;
-        case SPO_INITLEVEL:
-            spo_initlevel(coder);
-            break;
-        case SPO_ENGRAVING:
-            spo_engraving(coder);
-            break;
-        case SPO_MINERALIZE:
-            spo_mineralize(coder);
-            break;
-        case SPO_SUBROOM:
-        case SPO_ROOM:
-            if (!coder->failed_room[coder->n_subroom - 1]) {
-                spo_room(coder);
-            } else
-                room_stack++;
-            break;
-        case SPO_ENDROOM:
-            if (coder->failed_room[coder->n_subroom - 1]) {
-                if (!room_stack)
-                    spo_endroom(coder);
-                else
-                    room_stack--;
-            } else {
-                spo_endroom(coder);
-            }
-            break;
-        case SPO_DOOR:
-            spo_door(coder);
-            break;
-        case SPO_STAIR:
-            spo_stair(coder);
-            break;
-        case SPO_LADDER:
-            spo_ladder(coder);
-            break;
-        case SPO_GRAVE:
-            spo_grave(coder);
-            break;
-        case SPO_ALTAR:
-            spo_altar(coder);
-            break;
-        case SPO_SINK:
-        case SPO_POOL:
-        case SPO_FOUNTAIN:
-            spo_feature(coder);
-            break;
-        case SPO_TRAP:
-            spo_trap(coder);
-            break;
-        case SPO_GOLD:
-            spo_gold(coder);
-            break;
-        case SPO_CORRIDOR:
-            spo_corridor(coder);
-            break;
-        case SPO_TERRAIN:
-            spo_terrain(coder);
-            break;
-        case SPO_REPLACETERRAIN:
-            spo_replace_terrain(coder);
-            break;
-        case SPO_LEVREGION:
-            spo_levregion(coder);
-            break;
-        case SPO_REGION:
-            spo_region(coder);
-            break;
-        case SPO_DRAWBRIDGE:
-            spo_drawbridge(coder);
-            break;
-        case SPO_MAZEWALK:
-            spo_mazewalk(coder);
-            break;
-        case SPO_NON_PASSWALL:
-        case SPO_NON_DIGGABLE:
-            spo_wall_property(coder);
-            break;
-        case SPO_ROOM_DOOR:
-            spo_room_door(coder);
-            break;
-        case SPO_WALLIFY:
-            spo_wallify(coder);
-            break;
-        case SPO_COPY: {
-            struct opvar *a = splev_stack_pop(coder->stack);
-
-            splev_stack_push(coder->stack, opvar_clone(a));
-            splev_stack_push(coder->stack, opvar_clone(a));
-            opvar_free(a);
-            break;
+        break;
+    case SPO_MATH_MOD:
+        if (OV_i(b) > 0) {
+            OV_i(a) = OV_i(a) % OV_i(b);
+        } else {
+            OV_i(a) = 0;
         }
-        case SPO_DEC: {
-            struct opvar *a;
+        break;
+    }
+    splev_stack_push(coder->stack, a);
+    opvar_free(b);
+}
 
-            if (!OV_pop_i(a))
-                break;
-            OV_i(a)--;
-            splev_stack_push(coder->stack, a);
-            break;
-        }
-        case SPO_INC: {
-            struct opvar *a;
+void
+spo_cmp(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_cmp";
+    struct opvar *a;
+    struct opvar *b;
+    struct opvar *c;
+    long val = 0;
+
+    OV_pop(b);
+    OV_pop(a);
+    if (!a || !b) {
+        impossible("spo_cmp: no values in stack");
+        return;
+    }
+    if (OV_typ(a) != OV_typ(b)) {
+        impossible("spo_cmp: trying to compare differing datatypes");
+        return;
+    }
+    switch (OV_typ(a)) {
+    case SPOVAR_COORD:
+    case SPOVAR_REGION:
+    case SPOVAR_MAPCHAR:
+    case SPOVAR_MONST:
+    case SPOVAR_OBJ:
+    case SPOVAR_INT:
+        if (OV_i(b) > OV_i(a))
+            val |= SP_CPUFLAG_LT;
+        if (OV_i(b) < OV_i(a))
+            val |= SP_CPUFLAG_GT;
+        if (OV_i(b) == OV_i(a))
+            val |= SP_CPUFLAG_EQ;
+        c = opvar_new_int(val);
+        break;
+    case SPOVAR_STRING:
+        c = opvar_new_int(!strcmp(OV_s(b), OV_s(a))
+                             ? SP_CPUFLAG_EQ
+                             : 0);
+        break;
+    default:
+        c = opvar_new_int(0);
+        break;
+    }
+    splev_stack_push(coder->stack, c);
+    opvar_free(a);
+    opvar_free(b);
+}
 
-            if (!OV_pop_i(a))
-                break;
-            OV_i(a)++;
-            splev_stack_push(coder->stack, a);
-            break;
-        }
-        case SPO_MATH_SIGN: {
-            struct opvar *a;
+void
+spo_rn2(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_rn2";
+    struct opvar *tmpv;
+    struct opvar *t;
 
-            if (!OV_pop_i(a))
-                break;
-            OV_i(a) = ((OV_i(a) < 0) ? -1 : ((OV_i(a) > 0) ? 1 : 0));
-            splev_stack_push(coder->stack, a);
-            break;
-        }
-        case SPO_MATH_ADD: {
-            struct opvar *a, *b;
+    if (!OV_pop_i(tmpv))
+        return;
+    t = opvar_new_int((OV_i(tmpv) > 1) ? rn2(OV_i(tmpv)) : 0);
+    splev_stack_push(coder->stack, t);
+    opvar_free(tmpv);
+}
 
-            if (!OV_pop(b) || !OV_pop(a))
-                break;
-            if (OV_typ(b) == OV_typ(a)) {
-                if (OV_typ(a) == SPOVAR_INT) {
-                    OV_i(a) = OV_i(a) + OV_i(b);
-                    splev_stack_push(coder->stack, a);
-                    opvar_free(b);
-                } else if (OV_typ(a) == SPOVAR_STRING) {
-                    struct opvar *c;
-                    char *tmpbuf = (char *) alloc(strlen(OV_s(a))
-                                                  + strlen(OV_s(b)) + 1);
-
-                    (void) sprintf(tmpbuf, "%s%s", OV_s(a), OV_s(b));
-                    c = opvar_new_str(tmpbuf);
-                    splev_stack_push(coder->stack, c);
-                    opvar_free(a);
-                    opvar_free(b);
-                    Free(tmpbuf);
-                } else {
-                    splev_stack_push(coder->stack, a);
-                    opvar_free(b);
-                    impossible("adding weird types");
-                }
-            } else {
-                splev_stack_push(coder->stack, a);
-                opvar_free(b);
-                impossible("adding different types");
-            }
-            break;
-        }
-        case SPO_MATH_SUB: {
-            struct opvar *a, *b;
+void
+spo_dice(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_dice";
+    struct opvar *a, *b, *t;
 
-            if (!OV_pop_i(b) || !OV_pop_i(a))
-                break;
-            OV_i(a) = OV_i(a) - OV_i(b);
-            splev_stack_push(coder->stack, a);
-            opvar_free(b);
-            break;
-        }
-        case SPO_MATH_MUL: {
-            struct opvar *a, *b;
+    if (!OV_pop_i(b) || !OV_pop_i(a))
+        return;
+    if (OV_i(b) < 1)
+        OV_i(b) = 1;
+    if (OV_i(a) < 1)
+        OV_i(a) = 1;
+    t = opvar_new_int(d(OV_i(a), OV_i(b)));
+    splev_stack_push(coder->stack, t);
+    opvar_free(a);
+    opvar_free(b);
+}
 
-            if (!OV_pop_i(b) || !OV_pop_i(a))
-                break;
-            OV_i(a) = OV_i(a) * OV_i(b);
-            splev_stack_push(coder->stack, a);
-            opvar_free(b);
-            break;
-        }
-        case SPO_MATH_DIV: {
-            struct opvar *a, *b;
+void
+spo_sel_add(coder) /* actually, logical or */
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_add";
+    struct opvar *sel1, *sel2, *pt;
 
-            if (!OV_pop_i(b) || !OV_pop_i(a))
-                break;
-            if (OV_i(b) >= 1) {
-                OV_i(a) = OV_i(a) / OV_i(b);
-            } else {
-                OV_i(a) = 0;
-            }
-            splev_stack_push(coder->stack, a);
-            opvar_free(b);
-            break;
-        }
-        case SPO_MATH_MOD: {
-            struct opvar *a, *b;
+    if (!OV_pop_typ(sel1, SPOVAR_SEL))
+        panic("no sel1 for add");
+    if (!OV_pop_typ(sel2, SPOVAR_SEL))
+        panic("no sel2 for add");
+    pt = selection_logical_oper(sel1, sel2, '|');
+    opvar_free(sel1);
+    opvar_free(sel2);
+    splev_stack_push(coder->stack, pt);
+}
 
-            if (!OV_pop_i(b) || !OV_pop_i(a))
-                break;
-            if (OV_i(b) > 0) {
-                OV_i(a) = OV_i(a) % OV_i(b);
-            } else {
-                OV_i(a) = 0;
-            }
-            splev_stack_push(coder->stack, a);
-            opvar_free(b);
-            break;
-        }
-        case SPO_CMP: {
-            struct opvar *a;
-            struct opvar *b;
-            struct opvar *c;
-            long val = 0;
+void
+spo_sel_complement(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_complement";
+    struct opvar *sel, *pt;
 
-            OV_pop(b);
-            OV_pop(a);
-            if (!a || !b) {
-                impossible("spo_cmp: no values in stack");
-                break;
-            }
-            if (OV_typ(a) != OV_typ(b)) {
-                impossible("spo_cmp: trying to compare differing datatypes");
-                break;
-            }
-            switch (OV_typ(a)) {
-            case SPOVAR_COORD:
-            case SPOVAR_REGION:
-            case SPOVAR_MAPCHAR:
-            case SPOVAR_MONST:
-            case SPOVAR_OBJ:
-            case SPOVAR_INT:
-                if (OV_i(b) > OV_i(a))
-                    val |= SP_CPUFLAG_LT;
-                if (OV_i(b) < OV_i(a))
-                    val |= SP_CPUFLAG_GT;
-                if (OV_i(b) == OV_i(a))
-                    val |= SP_CPUFLAG_EQ;
-                c = opvar_new_int(val);
-                break;
-            case SPOVAR_STRING:
-                c = opvar_new_int(!strcmp(OV_s(b), OV_s(a))
-                                     ? SP_CPUFLAG_EQ
-                                     : 0);
-                break;
-            default:
-                c = opvar_new_int(0);
-                break;
-            }
-            splev_stack_push(coder->stack, c);
-            opvar_free(a);
-            opvar_free(b);
-            break;
-        }
-        case SPO_JMP:
-            spo_jmp(coder, lvl);
-            break;
-        case SPO_JL:
-        case SPO_JLE:
-        case SPO_JG:
-        case SPO_JGE:
-        case SPO_JE:
-        case SPO_JNE:
-            spo_conditional_jump(coder, lvl);
-            break;
-        case SPO_RN2: {
-            struct opvar *tmpv;
-            struct opvar *t;
+    if (!OV_pop_typ(sel, SPOVAR_SEL))
+        panic("no sel for not");
+    pt = selection_not(sel);
+    opvar_free(sel);
+    splev_stack_push(coder->stack, pt);
+}
 
-            if (!OV_pop_i(tmpv))
-                break;
-            t = opvar_new_int((OV_i(tmpv) > 1) ? rn2(OV_i(tmpv)) : 0);
-            splev_stack_push(coder->stack, t);
-            opvar_free(tmpv);
-            break;
-        }
-        case SPO_DICE: {
-            struct opvar *a, *b, *t;
+void
+spo_sel_filter(coder) /* sorta like logical and */
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_filter";
+    struct opvar *filtertype;
+
+    if (!OV_pop_i(filtertype))
+        panic("no sel filter type");
+    switch (OV_i(filtertype)) {
+    case SPOFILTER_PERCENT: {
+        struct opvar *tmp1, *sel;
+
+        if (!OV_pop_i(tmp1))
+            panic("no sel filter percent");
+        if (!OV_pop_typ(sel, SPOVAR_SEL))
+            panic("no sel filter");
+        selection_filter_percent(sel, OV_i(tmp1));
+        splev_stack_push(coder->stack, sel);
+        opvar_free(tmp1);
+        break;
+    }
+    case SPOFILTER_SELECTION: /* logical and */
+    {
+        struct opvar *pt, *sel1, *sel2;
+
+        if (!OV_pop_typ(sel1, SPOVAR_SEL))
+            panic("no sel filter sel1");
+        if (!OV_pop_typ(sel2, SPOVAR_SEL))
+            panic("no sel filter sel2");
+        pt = selection_logical_oper(sel1, sel2, '&');
+        splev_stack_push(coder->stack, pt);
+        opvar_free(sel1);
+        opvar_free(sel2);
+        break;
+    }
+    case SPOFILTER_MAPCHAR: {
+        struct opvar *pt, *tmp1, *sel;
+
+        if (!OV_pop_typ(sel, SPOVAR_SEL))
+            panic("no sel filter");
+        if (!OV_pop_typ(tmp1, SPOVAR_MAPCHAR))
+            panic("no sel filter mapchar");
+        pt = selection_filter_mapchar(sel, tmp1);
+        splev_stack_push(coder->stack, pt);
+        opvar_free(tmp1);
+        opvar_free(sel);
+        break;
+    }
+    default:
+        panic("unknown sel filter type");
+    }
+    opvar_free(filtertype);
+}
 
-            if (!OV_pop_i(b) || !OV_pop_i(a))
-                break;
-            if (OV_i(b) < 1)
-                OV_i(b) = 1;
-            if (OV_i(a) < 1)
-                OV_i(a) = 1;
-            t = opvar_new_int(d(OV_i(a), OV_i(b)));
-            splev_stack_push(coder->stack, t);
-            opvar_free(a);
-            opvar_free(b);
-            break;
-        }
-        case SPO_MAP:
-            spo_map(coder);
-            break;
-        case SPO_VAR_INIT:
-            spo_var_init(coder);
-            break;
-        case SPO_SHUFFLE_ARRAY:
-            spo_shuffle_array(coder);
-            break;
-        case SPO_SEL_ADD: /* actually, logical or */
-        {
-            struct opvar *sel1, *sel2, *pt;
-
-            if (!OV_pop_typ(sel1, SPOVAR_SEL))
-                panic("no sel1 for add");
-            if (!OV_pop_typ(sel2, SPOVAR_SEL))
-                panic("no sel2 for add");
-            pt = selection_logical_oper(sel1, sel2, '|');
-            opvar_free(sel1);
-            opvar_free(sel2);
-            splev_stack_push(coder->stack, pt);
-            break;
-        }
-        case SPO_SEL_COMPLEMENT: {
-            struct opvar *sel, *pt;
-
-            if (!OV_pop_typ(sel, SPOVAR_SEL))
-                panic("no sel for not");
-            pt = selection_not(sel);
-            opvar_free(sel);
-            splev_stack_push(coder->stack, pt);
-            break;
-        }
-        case SPO_SEL_FILTER: /* sorta like logical and */
-        {
-            struct opvar *filtertype;
-
-            if (!OV_pop_i(filtertype))
-                panic("no sel filter type");
-            switch (OV_i(filtertype)) {
-            case SPOFILTER_PERCENT: {
-                struct opvar *tmp1, *sel;
-
-                if (!OV_pop_i(tmp1))
-                    panic("no sel filter percent");
-                if (!OV_pop_typ(sel, SPOVAR_SEL))
-                    panic("no sel filter");
-                selection_filter_percent(sel, OV_i(tmp1));
-                splev_stack_push(coder->stack, sel);
-                opvar_free(tmp1);
-                break;
-            }
-            case SPOFILTER_SELECTION: /* logical and */
-            {
-                struct opvar *pt, *sel1, *sel2;
-
-                if (!OV_pop_typ(sel1, SPOVAR_SEL))
-                    panic("no sel filter sel1");
-                if (!OV_pop_typ(sel2, SPOVAR_SEL))
-                    panic("no sel filter sel2");
-                pt = selection_logical_oper(sel1, sel2, '&');
-                splev_stack_push(coder->stack, pt);
-                opvar_free(sel1);
-                opvar_free(sel2);
-                break;
-            }
-            case SPOFILTER_MAPCHAR: {
-                struct opvar *pt, *tmp1, *sel;
-
-                if (!OV_pop_typ(sel, SPOVAR_SEL))
-                    panic("no sel filter");
-                if (!OV_pop_typ(tmp1, SPOVAR_MAPCHAR))
-                    panic("no sel filter mapchar");
-                pt = selection_filter_mapchar(sel, tmp1);
-                splev_stack_push(coder->stack, pt);
-                opvar_free(tmp1);
-                opvar_free(sel);
-                break;
-            }
-            default:
-                panic("unknown sel filter type");
-            }
-            opvar_free(filtertype);
-            break;
-        }
-        case SPO_SEL_POINT: {
-            struct opvar *tmp;
-            struct opvar *pt = selection_opvar((char *) 0);
-            schar x, y;
-
-            if (!OV_pop_c(tmp))
-                panic("no ter sel coord");
-            get_location_coord(&x, &y, ANY_LOC, coder->croom, OV_i(tmp));
-            selection_setpoint(x, y, pt, 1);
-            splev_stack_push(coder->stack, pt);
-            opvar_free(tmp);
-            break;
-        }
-        case SPO_SEL_RECT:
-        case SPO_SEL_FILLRECT: {
-            struct opvar *tmp, *pt = selection_opvar((char *) 0);
-            schar x, y, x1, y1, x2, y2;
-
-            if (!OV_pop_r(tmp))
-                panic("no ter sel region");
-            x1 = min(SP_REGION_X1(OV_i(tmp)), SP_REGION_X2(OV_i(tmp)));
-            y1 = min(SP_REGION_Y1(OV_i(tmp)), SP_REGION_Y2(OV_i(tmp)));
-            x2 = max(SP_REGION_X1(OV_i(tmp)), SP_REGION_X2(OV_i(tmp)));
-            y2 = max(SP_REGION_Y1(OV_i(tmp)), SP_REGION_Y2(OV_i(tmp)));
-            get_location(&x1, &y1, ANY_LOC, coder->croom);
-            get_location(&x2, &y2, ANY_LOC, coder->croom);
-            x1 = (x1 < 0) ? 0 : x1;
-            y1 = (y1 < 0) ? 0 : y1;
-            x2 = (x2 >= COLNO) ? COLNO - 1 : x2;
-            y2 = (y2 >= ROWNO) ? ROWNO - 1 : y2;
-            if (coder->opcode == SPO_SEL_RECT) {
-                for (x = x1; x <= x2; x++) {
-                    selection_setpoint(x, y1, pt, 1);
-                    selection_setpoint(x, y2, pt, 1);
-                }
-                for (y = y1; y <= y2; y++) {
-                    selection_setpoint(x1, y, pt, 1);
-                    selection_setpoint(x2, y, pt, 1);
-                }
-            } else {
-                for (x = x1; x <= x2; x++)
-                    for (y = y1; y <= y2; y++)
-                        selection_setpoint(x, y, pt, 1);
-            }
-            splev_stack_push(coder->stack, pt);
-            opvar_free(tmp);
-            break;
-        }
-        case SPO_SEL_LINE: {
-            struct opvar *tmp = NULL, *tmp2 = NULL,
-                *pt = selection_opvar((char *) 0);
-            schar x1, y1, x2, y2;
-
-            if (!OV_pop_c(tmp))
-                panic("no ter sel linecoord1");
-            if (!OV_pop_c(tmp2))
-                panic("no ter sel linecoord2");
-            get_location_coord(&x1, &y1, ANY_LOC, coder->croom, OV_i(tmp));
-            get_location_coord(&x2, &y2, ANY_LOC, coder->croom, OV_i(tmp2));
-            x1 = (x1 < 0) ? 0 : x1;
-            y1 = (y1 < 0) ? 0 : y1;
-            x2 = (x2 >= COLNO) ? COLNO - 1 : x2;
-            y2 = (y2 >= ROWNO) ? ROWNO - 1 : y2;
-            selection_do_line(x1, y1, x2, y2, pt);
-            splev_stack_push(coder->stack, pt);
-            opvar_free(tmp);
-            opvar_free(tmp2);
-            break;
-        }
-        case SPO_SEL_RNDLINE: {
-            struct opvar *tmp = NULL, *tmp2 = NULL, *tmp3,
-                *pt = selection_opvar((char *) 0);
-            schar x1, y1, x2, y2;
-
-            if (!OV_pop_i(tmp3))
-                panic("no ter sel randline1");
-            if (!OV_pop_c(tmp))
-                panic("no ter sel randline2");
-            if (!OV_pop_c(tmp2))
-                panic("no ter sel randline3");
-            get_location_coord(&x1, &y1, ANY_LOC, coder->croom, OV_i(tmp));
-            get_location_coord(&x2, &y2, ANY_LOC, coder->croom, OV_i(tmp2));
-            x1 = (x1 < 0) ? 0 : x1;
-            y1 = (y1 < 0) ? 0 : y1;
-            x2 = (x2 >= COLNO) ? COLNO - 1 : x2;
-            y2 = (y2 >= ROWNO) ? ROWNO - 1 : y2;
-            selection_do_randline(x1, y1, x2, y2, OV_i(tmp3), 12, pt);
-            splev_stack_push(coder->stack, pt);
-            opvar_free(tmp);
-            opvar_free(tmp2);
-            opvar_free(tmp3);
-            break;
-        }
-        case SPO_SEL_GROW: {
-            struct opvar *dirs, *pt;
-
-            if (!OV_pop_i(dirs))
-                panic("no dirs for grow");
-            if (!OV_pop_typ(pt, SPOVAR_SEL))
-                panic("no selection for grow");
-            selection_do_grow(pt, OV_i(dirs));
-            splev_stack_push(coder->stack, pt);
-            opvar_free(dirs);
-            break;
-        }
-        case SPO_SEL_FLOOD: {
-            struct opvar *tmp;
-            schar x, y;
-
-            if (!OV_pop_c(tmp))
-                panic("no ter sel flood coord");
-            get_location_coord(&x, &y, ANY_LOC, coder->croom, OV_i(tmp));
-            if (isok(x, y)) {
-                struct opvar *pt = selection_opvar((char *) 0);
-
-                set_selection_floodfillchk(floodfillchk_match_under);
-                floodfillchk_match_under_typ = levl[x][y].typ;
-                selection_floodfill(pt, x, y, FALSE);
-                splev_stack_push(coder->stack, pt);
-            }
-            opvar_free(tmp);
-            break;
-        }
-        case SPO_SEL_RNDCOORD: {
-            struct opvar *pt;
-            schar x, y;
-
-            if (!OV_pop_typ(pt, SPOVAR_SEL))
-                panic("no selection for rndcoord");
-            if (selection_rndcoord(pt, &x, &y, FALSE)) {
-                x -= xstart;
-                y -= ystart;
-            }
-            splev_stack_push(coder->stack, opvar_new_coord(x, y));
-            opvar_free(pt);
-            break;
-        }
-        case SPO_SEL_ELLIPSE: {
-            struct opvar *filled, *xaxis, *yaxis, *pt;
-            struct opvar *sel = selection_opvar((char *) 0);
-            schar x, y;
-
-            if (!OV_pop_i(filled))
-                panic("no filled for ellipse");
-            if (!OV_pop_i(yaxis))
-                panic("no yaxis for ellipse");
-            if (!OV_pop_i(xaxis))
-                panic("no xaxis for ellipse");
-            if (!OV_pop_c(pt))
-                panic("no pt for ellipse");
-            get_location_coord(&x, &y, ANY_LOC, coder->croom, OV_i(pt));
-            selection_do_ellipse(sel, x, y, OV_i(xaxis), OV_i(yaxis),
-                                 OV_i(filled));
-            splev_stack_push(coder->stack, sel);
-            opvar_free(filled);
-            opvar_free(yaxis);
-            opvar_free(xaxis);
-            opvar_free(pt);
-            break;
+void
+spo_sel_point(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_point";
+    struct opvar *tmp;
+    struct opvar *pt = selection_opvar((char *) 0);
+    schar x, y;
+
+    if (!OV_pop_c(tmp))
+        panic("no ter sel coord");
+    get_location_coord(&x, &y, ANY_LOC, coder->croom, OV_i(tmp));
+    selection_setpoint(x, y, pt, 1);
+    splev_stack_push(coder->stack, pt);
+    opvar_free(tmp);
+}
+
+/* SEL_RECT and SEL_FILLRECT */
+void
+spo_sel_rect(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_rect";
+    struct opvar *tmp, *pt = selection_opvar((char *) 0);
+    schar x, y, x1, y1, x2, y2;
+
+    if (!OV_pop_r(tmp))
+        panic("no ter sel region");
+    x1 = min(SP_REGION_X1(OV_i(tmp)), SP_REGION_X2(OV_i(tmp)));
+    y1 = min(SP_REGION_Y1(OV_i(tmp)), SP_REGION_Y2(OV_i(tmp)));
+    x2 = max(SP_REGION_X1(OV_i(tmp)), SP_REGION_X2(OV_i(tmp)));
+    y2 = max(SP_REGION_Y1(OV_i(tmp)), SP_REGION_Y2(OV_i(tmp)));
+    get_location(&x1, &y1, ANY_LOC, coder->croom);
+    get_location(&x2, &y2, ANY_LOC, coder->croom);
+    x1 = (x1 < 0) ? 0 : x1;
+    y1 = (y1 < 0) ? 0 : y1;
+    x2 = (x2 >= COLNO) ? COLNO - 1 : x2;
+    y2 = (y2 >= ROWNO) ? ROWNO - 1 : y2;
+    if (coder->opcode == SPO_SEL_RECT) {
+        for (x = x1; x <= x2; x++) {
+            selection_setpoint(x, y1, pt, 1);
+            selection_setpoint(x, y2, pt, 1);
         }
-        case SPO_SEL_GRADIENT: {
-            struct opvar *gtyp, *glim, *mind, *maxd, *gcoord, *coord2;
-            struct opvar *sel;
-            schar x, y, x2, y2;
-
-            if (!OV_pop_i(gtyp))
-                panic("no gtyp for grad");
-            if (!OV_pop_i(glim))
-                panic("no glim for grad");
-            if (!OV_pop_c(coord2))
-                panic("no coord2 for grad");
-            if (!OV_pop_c(gcoord))
-                panic("no coord for grad");
-            if (!OV_pop_i(maxd))
-                panic("no maxd for grad");
-            if (!OV_pop_i(mind))
-                panic("no mind for grad");
-            get_location_coord(&x, &y, ANY_LOC, coder->croom, OV_i(gcoord));
-            get_location_coord(&x2, &y2, ANY_LOC, coder->croom, OV_i(coord2));
-
-            sel = selection_opvar((char *) 0);
-            selection_do_gradient(sel, x, y, x2, y2, OV_i(gtyp), OV_i(mind),
-                                  OV_i(maxd), OV_i(glim));
-            splev_stack_push(coder->stack, sel);
-
-            opvar_free(gtyp);
-            opvar_free(glim);
-            opvar_free(gcoord);
-            opvar_free(coord2);
-            opvar_free(maxd);
-            opvar_free(mind);
-            break;
+        for (y = y1; y <= y2; y++) {
+            selection_setpoint(x1, y, pt, 1);
+            selection_setpoint(x2, y, pt, 1);
         }
-        default:
-            panic("sp_level_coder: Unknown opcode %i", coder->opcode);
+    } else {
+        for (x = x1; x <= x2; x++)
+            for (y = y1; y <= y2; y++)
+                selection_setpoint(x, y, pt, 1);
+    }
+    splev_stack_push(coder->stack, pt);
+    opvar_free(tmp);
+}
+
+void
+spo_sel_line(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_line";
+    struct opvar *tmp = NULL, *tmp2 = NULL,
+        *pt = selection_opvar((char *) 0);
+    schar x1, y1, x2, y2;
+
+    if (!OV_pop_c(tmp))
+        panic("no ter sel linecoord1");
+    if (!OV_pop_c(tmp2))
+        panic("no ter sel linecoord2");
+    get_location_coord(&x1, &y1, ANY_LOC, coder->croom, OV_i(tmp));
+    get_location_coord(&x2, &y2, ANY_LOC, coder->croom, OV_i(tmp2));
+    x1 = (x1 < 0) ? 0 : x1;
+    y1 = (y1 < 0) ? 0 : y1;
+    x2 = (x2 >= COLNO) ? COLNO - 1 : x2;
+    y2 = (y2 >= ROWNO) ? ROWNO - 1 : y2;
+    selection_do_line(x1, y1, x2, y2, pt);
+    splev_stack_push(coder->stack, pt);
+    opvar_free(tmp);
+    opvar_free(tmp2);
+}
+
+void
+spo_sel_rndline(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_rndline";
+    struct opvar *tmp = NULL, *tmp2 = NULL, *tmp3,
+        *pt = selection_opvar((char *) 0);
+    schar x1, y1, x2, y2;
+
+    if (!OV_pop_i(tmp3))
+        panic("no ter sel randline1");
+    if (!OV_pop_c(tmp))
+        panic("no ter sel randline2");
+    if (!OV_pop_c(tmp2))
+        panic("no ter sel randline3");
+    get_location_coord(&x1, &y1, ANY_LOC, coder->croom, OV_i(tmp));
+    get_location_coord(&x2, &y2, ANY_LOC, coder->croom, OV_i(tmp2));
+    x1 = (x1 < 0) ? 0 : x1;
+    y1 = (y1 < 0) ? 0 : y1;
+    x2 = (x2 >= COLNO) ? COLNO - 1 : x2;
+    y2 = (y2 >= ROWNO) ? ROWNO - 1 : y2;
+    selection_do_randline(x1, y1, x2, y2, OV_i(tmp3), 12, pt);
+    splev_stack_push(coder->stack, pt);
+    opvar_free(tmp);
+    opvar_free(tmp2);
+    opvar_free(tmp3);
+}
+
+void
+spo_sel_grow(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_grow";
+    struct opvar *dirs, *pt;
+
+    if (!OV_pop_i(dirs))
+        panic("no dirs for grow");
+    if (!OV_pop_typ(pt, SPOVAR_SEL))
+        panic("no selection for grow");
+    selection_do_grow(pt, OV_i(dirs));
+    splev_stack_push(coder->stack, pt);
+    opvar_free(dirs);
+}
+
+void
+spo_sel_flood(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_flood";
+    struct opvar *tmp;
+    schar x, y;
+
+    if (!OV_pop_c(tmp))
+        panic("no ter sel flood coord");
+    get_location_coord(&x, &y, ANY_LOC, coder->croom, OV_i(tmp));
+    if (isok(x, y)) {
+        struct opvar *pt = selection_opvar((char *) 0);
+
+        set_selection_floodfillchk(floodfillchk_match_under);
+        floodfillchk_match_under_typ = levl[x][y].typ;
+        selection_floodfill(pt, x, y, FALSE);
+        splev_stack_push(coder->stack, pt);
+    }
+    opvar_free(tmp);
+}
+
+void
+spo_sel_rndcoord(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_rndcoord";
+    struct opvar *pt;
+    schar x, y;
+
+    if (!OV_pop_typ(pt, SPOVAR_SEL))
+        panic("no selection for rndcoord");
+    if (selection_rndcoord(pt, &x, &y, FALSE)) {
+        x -= xstart;
+        y -= ystart;
+    }
+    splev_stack_push(coder->stack, opvar_new_coord(x, y));
+    opvar_free(pt);
+}
+
+void
+spo_sel_ellipse(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_ellipse";
+    struct opvar *filled, *xaxis, *yaxis, *pt;
+    struct opvar *sel = selection_opvar((char *) 0);
+    schar x, y;
+
+    if (!OV_pop_i(filled))
+        panic("no filled for ellipse");
+    if (!OV_pop_i(yaxis))
+        panic("no yaxis for ellipse");
+    if (!OV_pop_i(xaxis))
+        panic("no xaxis for ellipse");
+    if (!OV_pop_c(pt))
+        panic("no pt for ellipse");
+    get_location_coord(&x, &y, ANY_LOC, coder->croom, OV_i(pt));
+    selection_do_ellipse(sel, x, y, OV_i(xaxis), OV_i(yaxis),
+                         OV_i(filled));
+    splev_stack_push(coder->stack, sel);
+    opvar_free(filled);
+    opvar_free(yaxis);
+    opvar_free(xaxis);
+    opvar_free(pt);
+}
+
+void
+spo_sel_gradient(coder)
+struct sp_coder *coder;
+{
+    static const char nhFunc[] = "spo_sel_gradient";
+    struct opvar *gtyp, *glim, *mind, *maxd, *gcoord, *coord2;
+    struct opvar *sel;
+    schar x, y, x2, y2;
+
+    if (!OV_pop_i(gtyp))
+        panic("no gtyp for grad");
+    if (!OV_pop_i(glim))
+        panic("no glim for grad");
+    if (!OV_pop_c(coord2))
+        panic("no coord2 for grad");
+    if (!OV_pop_c(gcoord))
+        panic("no coord for grad");
+    if (!OV_pop_i(maxd))
+        panic("no maxd for grad");
+    if (!OV_pop_i(mind))
+        panic("no mind for grad");
+    get_location_coord(&x, &y, ANY_LOC, coder->croom, OV_i(gcoord));
+    get_location_coord(&x2, &y2, ANY_LOC, coder->croom, OV_i(coord2));
+
+    sel = selection_opvar((char *) 0);
+    selection_do_gradient(sel, x, y, x2, y2, OV_i(gtyp), OV_i(mind),
+                          OV_i(maxd), OV_i(glim));
+    splev_stack_push(coder->stack, sel);
+
+    opvar_free(gtyp);
+    opvar_free(glim);
+    opvar_free(gcoord);
+    opvar_free(coord2);
+    opvar_free(maxd);
+    opvar_free(mind);
+}
+
+/*
+ * What the coder does for each opcode, in opcode_defs order; the
+ * opcodes are there so that sp_level_coder() can check that order.
+ */
+static const struct spo_func {
+    int opcode;
+    void FDECL((*func), (struct sp_coder *));
+} spo_funcs[] = {
+    { SPO_NULL, spo_null },
+    { SPO_MESSAGE, spo_message },
+    { SPO_MONSTER, spo_monster },
+    { SPO_OBJECT, spo_object },
+    { SPO_ENGRAVING, spo_engraving },
+    { SPO_ROOM, spo_nested_room },
+    { SPO_SUBROOM, spo_nested_room },
+    { SPO_DOOR, spo_door },
+    { SPO_STAIR, spo_stair },
+    { SPO_LADDER, spo_ladder },
+    { SPO_ALTAR, spo_altar },
+    { SPO_FOUNTAIN, spo_feature },
+    { SPO_SINK, spo_feature },
+    { SPO_POOL, spo_feature },
+    { SPO_TRAP, spo_trap },
+    { SPO_GOLD, spo_gold },
+    { SPO_CORRIDOR, spo_corridor },
+    { SPO_LEVREGION, spo_levregion },
+    { SPO_DRAWBRIDGE, spo_drawbridge },
+    { SPO_MAZEWALK, spo_mazewalk },
+    { SPO_NON_DIGGABLE, spo_wall_property },
+    { SPO_NON_PASSWALL, spo_wall_property },
+    { SPO_WALLIFY, spo_wallify },
+    { SPO_MAP, spo_map },
+    { SPO_ROOM_DOOR, spo_room_door },
+    { SPO_REGION, spo_region },
+    { SPO_MINERALIZE, spo_mineralize },
+    { SPO_CMP, spo_cmp },
+    { SPO_JMP, spo_jmp },
+    { SPO_JL, spo_conditional_jump },
+    { SPO_JLE, spo_conditional_jump },
+    { SPO_JG, spo_conditional_jump },
+    { SPO_JGE, spo_conditional_jump },
+    { SPO_JE, spo_conditional_jump },
+    { SPO_JNE, spo_conditional_jump },
+    { SPO_TERRAIN, spo_terrain },
+    { SPO_REPLACETERRAIN, spo_replace_terrain },
+    { SPO_EXIT, spo_exit },
+    { SPO_ENDROOM, spo_nested_endroom },
+    { SPO_POP_CONTAINER, spo_pop_container },
+    { SPO_PUSH, spo_push },
+    { SPO_POP, spo_pop },
+    { SPO_RN2, spo_rn2 },
+    { SPO_DEC, spo_math_unary },
+    { SPO_INC, spo_math_unary },
+    { SPO_MATH_ADD, spo_math_add },
+    { SPO_MATH_SUB, spo_math_binary },
+    { SPO_MATH_MUL, spo_math_binary },
+    { SPO_MATH_DIV, spo_math_binary },
+    { SPO_MATH_MOD, spo_math_binary },
+    { SPO_MATH_SIGN, spo_math_unary },
+    { SPO_COPY, spo_copy },
+    { SPO_END_MONINVENT, spo_end_moninvent },
+    { SPO_GRAVE, spo_grave },
+    { SPO_FRAME_PUSH, spo_frame_push },
+    { SPO_FRAME_POP, spo_frame_pop },
+    { SPO_CALL, spo_call },
+    { SPO_RETURN, spo_return },
+    { SPO_INITLEVEL, spo_initlevel },
+    { SPO_LEVEL_FLAGS, spo_level_flags },
+    { SPO_VAR_INIT, spo_var_init },
+    { SPO_SHUFFLE_ARRAY, spo_shuffle_array },
+    { SPO_DICE, spo_dice },
+    { SPO_SEL_ADD, spo_sel_add },
+    { SPO_SEL_POINT, spo_sel_point },
+    { SPO_SEL_RECT, spo_sel_rect },
+    { SPO_SEL_FILLRECT, spo_sel_rect },
+    { SPO_SEL_LINE, spo_sel_line },
+    { SPO_SEL_RNDLINE, spo_sel_rndline },
+    { SPO_SEL_GROW, spo_sel_grow },
+    { SPO_SEL_FLOOD, spo_sel_flood },
+    { SPO_SEL_RNDCOORD, spo_sel_rndcoord },
+    { SPO_SEL_ELLIPSE, spo_sel_ellipse },
+    { SPO_SEL_FILTER, spo_sel_filter },
+    { SPO_SEL_GRADIENT, spo_sel_gradient },
+    { SPO_SEL_COMPLEMENT, spo_sel_complement },
+};
+
+/* Special level coder, creates the special level from the sp_lev codes.
+ * Does not free the allocated memory.
+ */
+STATIC_OVL boolean
+sp_level_coder(lvl)
+sp_lev *lvl;
+{
+    unsigned long exec_opcodes = 0;
+    int tmpi;
+    unsigned long max_execution = SPCODER_MAX_RUNTIME;
+    struct sp_coder *coder;
+
+    if (SIZE(spo_funcs) != MAX_SP_OPCODES)
+        panic("sp_level_coder: %d functions for %d opcodes",
+              (int) SIZE(spo_funcs), MAX_SP_OPCODES);
+    for (tmpi = 0; tmpi < MAX_SP_OPCODES; tmpi++)
+        if (spo_funcs[tmpi].opcode != tmpi)
+            panic("sp_level_coder: opcode %d out of order", tmpi);
+
+    coder = (struct sp_coder *) alloc(sizeof(struct sp_coder));
+    coder->frame = frame_new(0);
+    coder->stack = NULL;
+    coder->premapped = FALSE;
+    coder->solidify = FALSE;
+    coder->check_inaccessibles = FALSE;
+    coder->croom = NULL;
+    coder->n_subroom = 1;
+    coder->exit_script = FALSE;
+    coder->lvl_is_joined = 0;
+    coder->n_opcodes = lvl->n_opcodes;
+    coder->n_vars = lvl->n_vars;
+    coder->room_stack = 0L;
+
+    splev_init_present = FALSE;
+    icedpools = FALSE;
+
+    if (wizard) {
+        char *met = nh_getenv("SPCODER_MAX_RUNTIME");
+        if (met && met[0] == '1')
+            max_execution = (1 << 30) - 1;
+    }
+
+    for (tmpi = 0; tmpi <= MAX_NESTED_ROOMS; tmpi++) {
+        coder->tmproomlist[tmpi] = (struct mkroom *) 0;
+        coder->failed_room[tmpi] = FALSE;
+    }
+
+    shuffle_alignments();
+
+    for (tmpi = 0; tmpi < MAX_CONTAINMENT; tmpi++)
+        container_obj[tmpi] = NULL;
+    container_idx = 0;
+
+    invent_carrying_monster = NULL;
+
+    (void) memset((genericptr_t) &SpLev_Map[0][0], 0, sizeof SpLev_Map);
+
+    level.flags.is_maze_lev = 0;
+
+    xstart = 1;
+    ystart = 0;
+    xsize = COLNO - 1;
+    ysize = ROWNO;
+
+    while (coder->frame->n_opcode < lvl->n_opcodes && !coder->exit_script) {
+        coder->opcode = lvl->opcodes[coder->frame->n_opcode].opcode;
+        coder->opdat = lvl->opcodes[coder->frame->n_opcode].opdat;
+
+        coder->stack = coder->frame->stack;
+
+        if (exec_opcodes++ > max_execution) {
+            impossible("Level script is taking too much time, stopping.");
+            coder->exit_script = TRUE;
         }
 
+        if (coder->failed_room[coder->n_subroom - 1]
+            && coder->opcode != SPO_ENDROOM && coder->opcode != SPO_ROOM
+            && coder->opcode != SPO_SUBROOM)
+            goto next_opcode;
+
+        coder->croom = coder->tmproomlist[coder->n_subroom - 1];
+
+        (*spo_funcs[coder->opcode].func)(coder);
+
     next_opcode:
         coder->frame->n_opcode++;
     } /*while*/
@@ -5871,7 +6113,7 @@ sp_lev *lvl;
         struct sp_frame *tmpframe;
         do {
             tmpframe = coder->frame->next;
-            frame_del(coder->frame);
+            frame_del(coder->frame, coder->n_vars);
             coder->frame = tmpframe;
         } while (coder->frame);
     }
@@ -5881,35 +6123,85 @@ sp_lev *lvl;
 }
 
 /*
- * General loader
+ * Levels are parsed once and kept for the rest of the game, since the
+ * coder never changes them; the mines filler and the Gehennom mazes
+ * are made over and over.
  */
-boolean
-load_special(name)
+struct splev_cache {
+    struct splev_cache *next;
+    char *name;
+    sp_lev *lvl;
+};
+
+static struct splev_cache *splev_cache = 0;
+
+/* the parsed form of level file 'name', read in if it isn't cached */
+STATIC_OVL sp_lev *
+sp_level_cached(name)
 const char *name;
 {
+    struct splev_cache *sc;
     dlb *fd;
-    sp_lev *lvl = NULL;
-    boolean result = FALSE;
+    sp_lev *lvl;
     struct version_info vers_info;
 
+    for (sc = splev_cache; sc; sc = sc->next)
+        if (!strcmp(sc->name, name))
+            return sc->lvl;
+
     fd = dlb_fopen(name, RDBMODE);
     if (!fd)
-        return FALSE;
+        return (sp_lev *) 0;
     Fread((genericptr_t) &vers_info, sizeof vers_info, 1, fd);
     if (!check_version(&vers_info, name, TRUE)) {
         (void) dlb_fclose(fd);
-        goto give_up;
+        return (sp_lev *) 0;
     }
     lvl = (sp_lev *) alloc(sizeof(sp_lev));
-    result = sp_level_loader(fd, lvl);
+    if (!sp_level_loader(fd, lvl)) {
+        (void) dlb_fclose(fd);
+        sp_level_free(lvl);
+        Free(lvl);
+        opvar_pool_done();
+        return (sp_lev *) 0;
+    }
     (void) dlb_fclose(fd);
-    if (result)
-        result = sp_level_coder(lvl);
-    sp_level_free(lvl);
-    Free(lvl);
 
-give_up:
-    return result;
+    sc = New(struct splev_cache);
+    sc->name = dupstr(name);
+    sc->lvl = lvl;
+    sc->next = splev_cache;
+    splev_cache = sc;
+    return lvl;
+}
+
+void
+free_splev_cache()
+{
+    struct splev_cache *sc;
+
+    while ((sc = splev_cache) != 0) {
+        splev_cache = sc->next;
+        sp_level_free(sc->lvl);
+        free((genericptr_t) sc->lvl);
+        free((genericptr_t) sc->name);
+        free((genericptr_t) sc);
+    }
+    opvar_pool_done();
+}
+
+/*
+ * General loader
+ */
+boolean
+load_special(name)
+const char *name;
+{
+    sp_lev *lvl;
+
+    if (!(lvl = sp_level_cached(name)))
+        return FALSE;
+    return sp_level_coder(lvl);
 }
 
 #ifdef _MSC_VER
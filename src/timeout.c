@@ -1311,7 +1311,7 @@ do_storms()
  *      Start a timer of kind 'kind' that will expire at time
  *      monstermoves+'timeout'.  Call the function at 'func_index'
  *      in the timeout table using argument 'arg'.  Return TRUE if
- *      a timer was started.  This places the timer on a list ordered
+ *      a timer was started.  This places the timer in a queue ordered
  *      "sooner" to "later".  If an object, increment the object's
  *      timer count.
  *
@@ -1357,18 +1357,49 @@ do_storms()
  *      Check whether object has a timer of type timer_type.
  */
 
+/*
+ * The timer queue is a binary heap ordered by expiry time.  Timers due
+ * at the same time come out most recently queued first, the order the
+ * sorted list that preceded the heap produced, so expiry order and the
+ * order timers are saved in are as they always were.  Every timer is
+ * also hashed on its argument (object, monster or map spot) so that
+ * finding the timers attached to something doesn't search the queue.
+ */
+typedef struct tnode {
+    timer_element t;     /* the part that gets saved; t.next is unused */
+    unsigned long seq;   /* queueing order; breaks ties in t.timeout */
+    int hidx;            /* position in timer_heap[] */
+    struct tnode *anext; /* next timer in the same timer_args[] bucket */
+} tnode;
+
 STATIC_DCL const char *FDECL(kind_name, (SHORT_P));
-STATIC_DCL void FDECL(print_queue, (winid, timer_element *));
-STATIC_DCL void FDECL(insert_timer, (timer_element *));
-STATIC_DCL timer_element *FDECL(remove_timer,
-                                (timer_element **, SHORT_P, ANY_P *));
+STATIC_DCL void FDECL(print_queue, (winid));
+STATIC_DCL boolean FDECL(timer_before, (tnode *, tnode *));
+STATIC_PTR int FDECL(CFDECLSPEC timer_cmp, (const genericptr,
+                                            const genericptr));
+STATIC_DCL void FDECL(heap_sift, (int));
+STATIC_DCL unsigned FDECL(arg_bucket, (anything *));
+STATIC_DCL void FDECL(hash_timer, (tnode *));
+STATIC_DCL void FDECL(unhash_timer, (tnode *));
+STATIC_DCL void FDECL(insert_timer, (tnode *));
+STATIC_DCL void FDECL(unlink_timer, (tnode *));
+STATIC_DCL boolean FDECL(timer_matches, (tnode *, SHORT_P, SHORT_P,
+                                         anything *));
+STATIC_DCL tnode *FDECL(find_timer, (SHORT_P, ANY_P *));
+STATIC_DCL tnode **FDECL(arg_timers, (SHORT_P, SHORT_P, anything *, int *));
+STATIC_DCL tnode **FDECL(sorted_timers, (int *));
 STATIC_DCL void FDECL(write_timer, (int, timer_element *));
 STATIC_DCL boolean FDECL(mon_is_local, (struct monst *));
 STATIC_DCL boolean FDECL(timer_is_local, (timer_element *));
-STATIC_DCL int FDECL(maybe_write_timer, (int, int, BOOLEAN_P));
-
-/* ordered timer list */
-static timer_element *timer_base; /* "active" */
+STATIC_DCL int FDECL(maybe_write_timer, (int, int, BOOLEAN_P,
+                                         tnode **, int));
+
+/* timer queue */
+static tnode **timer_heap = 0; /* "active"; timer_heap[0] is due first */
+static int timer_count = 0, timer_heapsz = 0;
+static tnode **timer_args = 0; /* hash buckets on timer argument */
+static unsigned timer_argsz = 0;
+static unsigned long timer_seq = 0;
 static unsigned long timer_id = 1;
 
 /* If defined, then include names when printing out the timer queue */
@@ -1420,18 +1451,20 @@ short kind;
 }
 
 STATIC_OVL void
-print_queue(win, base)
+print_queue(win)
 winid win;
-timer_element *base;
 {
+    tnode **queue;
     timer_element *curr;
     char buf[BUFSZ];
+    int i, n;
 
-    if (!base) {
+    if (!(queue = sorted_timers(&n))) {
         putstr(win, 0, "<empty>");
     } else {
         putstr(win, 0, "timeout  id   kind   call");
-        for (curr = base; curr; curr = curr->next) {
+        for (i = 0; i < n; i++) {
+            curr = &queue[i]->t;
 #ifdef VERBOSE_TIMER
             Sprintf(buf, " %4ld   %4ld  %-6s %s(%s)", curr->timeout,
                     curr->tid, kind_name(curr->kind),
@@ -1444,6 +1477,7 @@ timer_element *base;
 #endif
             putstr(win, 0, buf);
         }
+        free((genericptr_t) queue);
     }
 }
 
@@ -1462,7 +1496,7 @@ wiz_timeout_queue()
     putstr(win, 0, "");
     putstr(win, 0, "Active timeout queue:");
     putstr(win, 0, "");
-    print_queue(win, timer_base);
+    print_queue(win);
 
     display_nhwindow(win, FALSE);
     destroy_nhwindow(win);
@@ -1473,17 +1507,21 @@ wiz_timeout_queue()
 void
 timer_sanity_check()
 {
-    timer_element *curr;
+    tnode **queue;
+    int i, n;
 
     /* this should be much more complete */
-    for (curr = timer_base; curr; curr = curr->next)
-        if (curr->kind == TIMER_OBJECT) {
-            struct obj *obj = curr->arg.a_obj;
+    if (!(queue = sorted_timers(&n)))
+        return;
+    for (i = 0; i < n; i++)
+        if (queue[i]->t.kind == TIMER_OBJECT) {
+            struct obj *obj = queue[i]->t.arg.a_obj;
             if (obj->timed == 0) {
                 pline("timer sanity: untimed obj %s, timer %ld",
-                      fmt_ptr((genericptr_t) obj), curr->tid);
+                      fmt_ptr((genericptr_t) obj), queue[i]->t.tid);
             }
         }
+    free((genericptr_t) queue);
 }
 
 /*
@@ -1493,22 +1531,25 @@ timer_sanity_check()
 void
 run_timers()
 {
-    timer_element *curr;
+    tnode *curr;
 
     /*
      * Always use the first element.  Elements may be added or deleted at
-     * any time.  The list is ordered, we are done when the first element
+     * any time.  The queue is ordered, we are done when the first element
      * is in the future.
      */
-    while (timer_base && timer_base->timeout <= monstermoves) {
-        curr = timer_base;
-        timer_base = curr->next;
-
-        if (curr->kind == TIMER_OBJECT)
-            (curr->arg.a_obj)->timed--;
-        (*timeout_funcs[curr->func_index].f)(&curr->arg, curr->timeout);
+    bench_begin(BENCH_TIMERS);
+    while (timer_count && timer_heap[0]->t.timeout <= monstermoves) {
+        curr = timer_heap[0];
+        unlink_timer(curr);
+
+        if (curr->t.kind == TIMER_OBJECT)
+            (curr->t.arg.a_obj)->timed--;
+        (*timeout_funcs[curr->t.func_index].f)(&curr->t.arg,
+                                               curr->t.timeout);
         free((genericptr_t) curr);
     }
+    bench_end(BENCH_TIMERS);
 }
 
 /*
@@ -1521,19 +1562,19 @@ short kind;
 short func_index;
 anything *arg;
 {
-    timer_element *gnu;
+    tnode *gnu;
 
     if (func_index < 0 || func_index >= NUM_TIME_FUNCS)
         panic("start_timer");
 
-    gnu = (timer_element *) alloc(sizeof(timer_element));
-    gnu->next = 0;
-    gnu->tid = timer_id++;
-    gnu->timeout = monstermoves + when;
-    gnu->kind = kind;
-    gnu->needs_fixup = 0;
-    gnu->func_index = func_index;
-    gnu->arg = *arg;
+    gnu = (tnode *) alloc(sizeof(tnode));
+    gnu->t.next = 0;
+    gnu->t.tid = timer_id++;
+    gnu->t.timeout = monstermoves + when;
+    gnu->t.kind = kind;
+    gnu->t.needs_fixup = 0;
+    gnu->t.func_index = func_index;
+    gnu->t.arg = *arg;
     insert_timer(gnu);
 
     if (kind == TIMER_OBJECT) /* increment object's timed count */
@@ -1552,17 +1593,18 @@ stop_timer(func_index, arg)
 short func_index;
 anything *arg;
 {
-    timer_element *doomed;
+    tnode *doomed;
     long timeout;
 
-    doomed = remove_timer(&timer_base, func_index, arg);
+    doomed = find_timer(func_index, arg);
 
     if (doomed) {
-        timeout = doomed->timeout;
-        if (doomed->kind == TIMER_OBJECT)
+        unlink_timer(doomed);
+        timeout = doomed->t.timeout;
+        if (doomed->t.kind == TIMER_OBJECT)
             (arg->a_obj)->timed--;
-        if (timeout_funcs[doomed->func_index].cleanup)
-            (*timeout_funcs[doomed->func_index].cleanup)(arg, timeout);
+        if (timeout_funcs[doomed->t.func_index].cleanup)
+            (*timeout_funcs[doomed->t.func_index].cleanup)(arg, timeout);
         free((genericptr_t) doomed);
         return (timeout - monstermoves);
     }
@@ -1577,13 +1619,9 @@ peek_timer(type, arg)
 short type;
 anything *arg;
 {
-    timer_element *curr;
+    tnode *curr = find_timer(type, arg);
 
-    for (curr = timer_base; curr; curr = curr->next) {
-        if (curr->func_index == type && curr->arg.a_void == arg->a_void)
-            return curr->timeout;
-    }
-    return 0L;
+    return curr ? curr->t.timeout : 0L;
 }
 
 /*
@@ -1593,15 +1631,19 @@ void
 obj_move_timers(src, dest)
 struct obj *src, *dest;
 {
-    int count;
-    timer_element *curr;
-
-    for (count = 0, curr = timer_base; curr; curr = curr->next)
-        if (curr->kind == TIMER_OBJECT && curr->arg.a_obj == src) {
-            curr->arg.a_obj = dest;
-            dest->timed++;
-            count++;
-        }
+    tnode **timers;
+    int i, count;
+
+    timers = arg_timers(TIMER_OBJECT, -1, obj_to_any(src), &count);
+    for (i = 0; i < count; i++) {
+        /* rehash in place; its spot in the queue doesn't change */
+        unhash_timer(timers[i]);
+        timers[i]->t.arg.a_obj = dest;
+        hash_timer(timers[i]);
+        dest->timed++;
+    }
+    if (timers)
+        free((genericptr_t) timers);
     if (count != src->timed)
         panic("obj_move_timers");
     src->timed = 0;
@@ -1614,15 +1656,15 @@ void
 obj_split_timers(src, dest)
 struct obj *src, *dest;
 {
-    timer_element *curr, *next_timer = 0;
-
-    for (curr = timer_base; curr; curr = next_timer) {
-        next_timer = curr->next; /* things may be inserted */
-        if (curr->kind == TIMER_OBJECT && curr->arg.a_obj == src) {
-            (void) start_timer(curr->timeout - monstermoves, TIMER_OBJECT,
-                               curr->func_index, obj_to_any(dest));
-        }
-    }
+    tnode **timers;
+    int i, count;
+
+    timers = arg_timers(TIMER_OBJECT, -1, obj_to_any(src), &count);
+    for (i = 0; i < count; i++)
+        (void) start_timer(timers[i]->t.timeout - monstermoves, TIMER_OBJECT,
+                           timers[i]->t.func_index, obj_to_any(dest));
+    if (timers)
+        free((genericptr_t) timers);
 }
 
 /*
@@ -1633,23 +1675,20 @@ void
 obj_stop_timers(obj)
 struct obj *obj;
 {
-    timer_element *curr, *prev, *next_timer = 0;
-
-    for (prev = 0, curr = timer_base; curr; curr = next_timer) {
-        next_timer = curr->next;
-        if (curr->kind == TIMER_OBJECT && curr->arg.a_obj == obj) {
-            if (prev)
-                prev->next = curr->next;
-            else
-                timer_base = curr->next;
-            if (timeout_funcs[curr->func_index].cleanup)
-                (*timeout_funcs[curr->func_index].cleanup)(&curr->arg,
-                                                           curr->timeout);
-            free((genericptr_t) curr);
-        } else {
-            prev = curr;
-        }
+    tnode **timers, *curr;
+    int i, count;
+
+    timers = arg_timers(TIMER_OBJECT, -1, obj_to_any(obj), &count);
+    for (i = 0; i < count; i++) {
+        curr = timers[i];
+        unlink_timer(curr);
+        if (timeout_funcs[curr->t.func_index].cleanup)
+            (*timeout_funcs[curr->t.func_index].cleanup)(&curr->t.arg,
+                                                         curr->t.timeout);
+        free((genericptr_t) curr);
     }
+    if (timers)
+        free((genericptr_t) timers);
     obj->timed = 0;
 }
 
@@ -1675,25 +1714,21 @@ spot_stop_timers(x, y, func_index)
 xchar x, y;
 short func_index;
 {
-    timer_element *curr, *prev, *next_timer = 0;
+    tnode **timers, *curr;
+    int i, count;
     long where = (((long) x << 16) | ((long) y));
 
-    for (prev = 0, curr = timer_base; curr; curr = next_timer) {
-        next_timer = curr->next;
-        if (curr->kind == TIMER_LEVEL && curr->func_index == func_index
-            && curr->arg.a_long == where) {
-            if (prev)
-                prev->next = curr->next;
-            else
-                timer_base = curr->next;
-            if (timeout_funcs[curr->func_index].cleanup)
-                (*timeout_funcs[curr->func_index].cleanup)(&curr->arg,
-                                                           curr->timeout);
-            free((genericptr_t) curr);
-        } else {
-            prev = curr;
-        }
+    timers = arg_timers(TIMER_LEVEL, func_index, long_to_any(where), &count);
+    for (i = 0; i < count; i++) {
+        curr = timers[i];
+        unlink_timer(curr);
+        if (timeout_funcs[curr->t.func_index].cleanup)
+            (*timeout_funcs[curr->t.func_index].cleanup)(&curr->t.arg,
+                                                         curr->t.timeout);
+        free((genericptr_t) curr);
     }
+    if (timers)
+        free((genericptr_t) timers);
 }
 
 /*
@@ -1705,15 +1740,16 @@ spot_time_expires(x, y, func_index)
 xchar x, y;
 short func_index;
 {
-    timer_element *curr;
+    tnode *curr, *first = 0;
     long where = (((long) x << 16) | ((long) y));
-
-    for (curr = timer_base; curr; curr = curr->next) {
-        if (curr->kind == TIMER_LEVEL && curr->func_index == func_index
-            && curr->arg.a_long == where)
-            return curr->timeout;
-    }
-    return 0L;
+    anything *arg = long_to_any(where);
+
+    if (timer_count)
+        for (curr = timer_args[arg_bucket(arg)]; curr; curr = curr->anext)
+            if (timer_matches(curr, TIMER_LEVEL, func_index, arg)
+                && (!first || timer_before(curr, first)))
+                first = curr;
+    return first ? first->t.timeout : 0L;
 }
 
 long
@@ -1725,44 +1761,223 @@ short func_index;
     return (expires > 0L) ? expires - monstermoves : 0L;
 }
 
+/* does timer a go off before timer b? */
+STATIC_OVL boolean
+timer_before(a, b)
+tnode *a, *b;
+{
+    if (a->t.timeout != b->t.timeout)
+        return (boolean) (a->t.timeout < b->t.timeout);
+    return (boolean) (a->seq > b->seq);
+}
+
+/* Args must be (const genericptr) so that qsort will always be happy. */
+STATIC_PTR int CFDECLSPEC
+timer_cmp(vx, vy)
+const genericptr vx;
+const genericptr vy;
+{
+    tnode *x = *(tnode **) vx, *y = *(tnode **) vy;
+
+    return (x == y) ? 0 : timer_before(x, y) ? -1 : 1;
+}
+
+/* move timer_heap[i] up or down until the heap is in order again */
+STATIC_OVL void
+heap_sift(i)
+int i;
+{
+    tnode *node = timer_heap[i];
+    int parent, child;
+
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (!timer_before(node, timer_heap[parent]))
+            break;
+        timer_heap[i] = timer_heap[parent];
+        timer_heap[i]->hidx = i;
+        i = parent;
+    }
+    while ((child = 2 * i + 1) < timer_count) {
+        if (child + 1 < timer_count
+            && timer_before(timer_heap[child + 1], timer_heap[child]))
+            child++;
+        if (!timer_before(timer_heap[child], node))
+            break;
+        timer_heap[i] = timer_heap[child];
+        timer_heap[i]->hidx = i;
+        i = child;
+    }
+    timer_heap[i] = node;
+    node->hidx = i;
+}
+
+STATIC_OVL unsigned
+arg_bucket(arg)
+anything *arg;
+{
+    unsigned long k = arg->a_ulong;
+
+    return (unsigned) (k ^ (k >> 7) ^ (k >> 17)) & (timer_argsz - 1);
+}
+
+STATIC_OVL void
+hash_timer(node)
+tnode *node;
+{
+    unsigned b = arg_bucket(&node->t.arg);
+
+    node->anext = timer_args[b];
+    timer_args[b] = node;
+}
+
+STATIC_OVL void
+unhash_timer(node)
+tnode *node;
+{
+    tnode **prev;
+
+    for (prev = &timer_args[arg_bucket(&node->t.arg)]; *prev != node;
+         prev = &(*prev)->anext)
+        if (!*prev)
+            panic("unhash_timer");
+    *prev = node->anext;
+    node->anext = 0;
+}
+
 /* Insert timer into the global queue */
 STATIC_OVL void
 insert_timer(gnu)
-timer_element *gnu;
+tnode *gnu;
 {
-    timer_element *curr, *prev;
+    int i;
 
-    for (prev = 0, curr = timer_base; curr; prev = curr, curr = curr->next)
-        if (curr->timeout >= gnu->timeout)
-            break;
+    if (timer_count >= timer_heapsz) {
+        tnode **newheap;
+
+        timer_heapsz = timer_heapsz ? 2 * timer_heapsz : 64;
+        newheap = (tnode **) alloc(timer_heapsz * sizeof *newheap);
+        if (timer_heap) {
+            (void) memcpy((genericptr_t) newheap, (genericptr_t) timer_heap,
+                          timer_count * sizeof *newheap);
+            free((genericptr_t) timer_heap);
+        }
+        timer_heap = newheap;
+    }
+    if ((unsigned) timer_count >= timer_argsz) {
+        if (timer_args)
+            free((genericptr_t) timer_args);
+        timer_argsz = timer_argsz ? 2 * timer_argsz : 64;
+        timer_args = (tnode **) alloc(timer_argsz * sizeof *timer_args);
+        (void) memset((genericptr_t) timer_args, 0,
+                      timer_argsz * sizeof *timer_args);
+        for (i = 0; i < timer_count; i++)
+            hash_timer(timer_heap[i]);
+    }
 
-    gnu->next = curr;
-    if (prev)
-        prev->next = gnu;
-    else
-        timer_base = gnu;
+    gnu->seq = ++timer_seq;
+    timer_heap[timer_count] = gnu;
+    gnu->hidx = timer_count++;
+    heap_sift(gnu->hidx);
+    hash_timer(gnu);
 }
 
-STATIC_OVL timer_element *
-remove_timer(base, func_index, arg)
-timer_element **base;
-short func_index;
+/* take timer out of the queue without freeing it */
+STATIC_OVL void
+unlink_timer(node)
+tnode *node;
+{
+    tnode *last;
+
+    unhash_timer(node);
+    last = timer_heap[--timer_count];
+    if (last != node) {
+        timer_heap[node->hidx] = last;
+        last->hidx = node->hidx;
+        heap_sift(last->hidx);
+    }
+}
+
+STATIC_OVL boolean
+timer_matches(node, kind, func_index, arg)
+tnode *node;
+short kind, func_index; /* func_index -1: any */
 anything *arg;
 {
-    timer_element *prev, *curr;
+    if (node->t.kind != kind
+        || (func_index >= 0 && node->t.func_index != func_index))
+        return FALSE;
+    if (kind == TIMER_LEVEL)
+        return (boolean) (node->t.arg.a_long == arg->a_long);
+    return (boolean) (node->t.arg.a_void == arg->a_void);
+}
 
-    for (prev = 0, curr = *base; curr; prev = curr, curr = curr->next)
-        if (curr->func_index == func_index && curr->arg.a_void == arg->a_void)
-            break;
+/* the first timer in the queue with the given (func_index, arg) pair */
+STATIC_OVL tnode *
+find_timer(func_index, arg)
+short func_index;
+anything *arg;
+{
+    tnode *curr, *first = 0;
+
+    if (timer_count)
+        for (curr = timer_args[arg_bucket(arg)]; curr; curr = curr->anext)
+            if (curr->t.func_index == func_index
+                && curr->t.arg.a_void == arg->a_void
+                && (!first || timer_before(curr, first)))
+                first = curr;
+    return first;
+}
 
-    if (curr) {
-        if (prev)
-            prev->next = curr->next;
-        else
-            *base = curr->next;
+/* the timers of the given kind (and func_index, unless -1) attached to
+   arg, in queue order; the array is the caller's to free */
+STATIC_OVL tnode **
+arg_timers(kind, func_index, arg, countp)
+short kind, func_index;
+anything *arg;
+int *countp;
+{
+    tnode **timers = 0, *curr;
+    anything key;
+    int n = 0;
+
+    key = *arg; /* arg might be obj_to_any()'s, which start_timer reuses */
+    if (timer_count) {
+        for (curr = timer_args[arg_bucket(&key)]; curr; curr = curr->anext)
+            if (timer_matches(curr, kind, func_index, &key))
+                n++;
+        if (n) {
+            timers = (tnode **) alloc(n * sizeof *timers);
+            n = 0;
+            for (curr = timer_args[arg_bucket(&key)]; curr;
+                 curr = curr->anext)
+                if (timer_matches(curr, kind, func_index, &key))
+                    timers[n++] = curr;
+            if (n > 1)
+                qsort((genericptr_t) timers, (size_t) n, sizeof *timers,
+                      timer_cmp);
+        }
     }
+    *countp = n;
+    return timers;
+}
 
-    return curr;
+/* all timers in queue order, or null if there are none; the caller
+   frees the array */
+STATIC_OVL tnode **
+sorted_timers(countp)
+int *countp;
+{
+    tnode **timers;
+
+    if (!(*countp = timer_count))
+        return (tnode **) 0;
+    timers = (tnode **) alloc(timer_count * sizeof *timers);
+    (void) memcpy((genericptr_t) timers, (genericptr_t) timer_heap,
+                  timer_count * sizeof *timers);
+    qsort((genericptr_t) timers, (size_t) timer_count, sizeof *timers,
+          timer_cmp);
+    return timers;
 }
 
 STATIC_OVL void
@@ -1887,14 +2102,17 @@ timer_element *timer;
  * be written.  If write_it is true, actually write the timer.
  */
 STATIC_OVL int
-maybe_write_timer(fd, range, write_it)
+maybe_write_timer(fd, range, write_it, queue, n)
 int fd, range;
 boolean write_it;
+tnode **queue; /* all timers, in queue order */
+int n;
 {
-    int count = 0;
+    int i, count = 0;
     timer_element *curr;
 
-    for (curr = timer_base; curr; curr = curr->next) {
+    for (i = 0; i < n; i++) {
+        curr = &queue[i]->t;
         if (range == RANGE_GLOBAL) {
             /* global timers */
 
@@ -1935,34 +2153,34 @@ void
 save_timers(fd, mode, range)
 int fd, mode, range;
 {
-    timer_element *curr, *prev, *next_timer = 0;
-    int count;
+    tnode **queue;
+    int i, n, count;
 
+    queue = sorted_timers(&n);
     if (perform_bwrite(mode)) {
         if (range == RANGE_GLOBAL)
             bwrite(fd, (genericptr_t) &timer_id, sizeof(timer_id));
 
-        count = maybe_write_timer(fd, range, FALSE);
+        count = maybe_write_timer(fd, range, FALSE, queue, n);
         bwrite(fd, (genericptr_t) &count, sizeof count);
-        (void) maybe_write_timer(fd, range, TRUE);
+        (void) maybe_write_timer(fd, range, TRUE, queue, n);
     }
 
     if (release_data(mode)) {
-        for (prev = 0, curr = timer_base; curr; curr = next_timer) {
-            next_timer = curr->next; /* in case curr is removed */
-
-            if (!(!!(range == RANGE_LEVEL) ^ !!timer_is_local(curr))) {
-                if (prev)
-                    prev->next = curr->next;
-                else
-                    timer_base = curr->next;
-                free((genericptr_t) curr);
-                /* prev stays the same */
-            } else {
-                prev = curr;
+        for (i = 0; i < n; i++) {
+            if (!(!!(range == RANGE_LEVEL) ^ !!timer_is_local(&queue[i]->t))) {
+                unlink_timer(queue[i]);
+                free((genericptr_t) queue[i]);
             }
         }
+        if (!timer_count && timer_heap) {
+            free((genericptr_t) timer_heap), timer_heap = 0;
+            free((genericptr_t) timer_args), timer_args = 0;
+            timer_heapsz = 0, timer_argsz = 0;
+        }
     }
+    if (queue)
+        free((genericptr_t) queue);
 }
 
 /*
@@ -1976,7 +2194,7 @@ boolean ghostly; /* restoring from a ghost level */
 long adjust;     /* how much to adjust timeout */
 {
     int count;
-    timer_element *curr;
+    tnode *curr;
 
     if (range == RANGE_GLOBAL)
         mread(fd, (genericptr_t) &timer_id, sizeof timer_id);
@@ -1984,10 +2202,11 @@ long adjust;     /* how much to adjust timeout */
     /* restore elements */
     mread(fd, (genericptr_t) &count, sizeof count);
     while (count-- > 0) {
-        curr = (timer_element *) alloc(sizeof(timer_element));
-        mread(fd, (genericptr_t) curr, sizeof(timer_element));
+        curr = (tnode *) alloc(sizeof(tnode));
+        mread(fd, (genericptr_t) &curr->t, sizeof(timer_element));
+        curr->t.next = 0;
         if (ghostly)
-            curr->timeout += adjust;
+            curr->t.timeout += adjust;
         insert_timer(curr);
     }
 }
@@ -1999,8 +2218,10 @@ boolean ghostly;
 {
     timer_element *curr;
     unsigned nid;
+    int i;
 
-    for (curr = timer_base; curr; curr = curr->next) {
+    for (i = 0; i < timer_count; i++) {
+        curr = &timer_heap[i]->t;
         if (curr->needs_fixup) {
             if (curr->kind == TIMER_OBJECT) {
                 if (ghostly) {
@@ -2008,10 +2229,12 @@ boolean ghostly;
                         panic("relink_timers 1");
                 } else
                     nid = curr->arg.a_uint;
+                unhash_timer(timer_heap[i]); /* was hashed on the id */
                 curr->arg.a_obj = find_oid(nid);
                 if (!curr->arg.a_obj)
                     panic("cant find o_id %d", nid);
                 curr->needs_fixup = 0;
+                hash_timer(timer_heap[i]);
             } else if (curr->kind == TIMER_MONSTER) {
                 panic("relink_timers: no monster timer implemented");
             } else
@@ -4,6 +4,12 @@
 
 #include "hack.h"
 #include "dlb.h"
+#ifdef SCORE_INDEX
+#include <limits.h>
+#endif
+#ifdef LOGAPPEND
+#include <fcntl.h>
+#endif
 #ifdef SHORT_FILENAMES
 #include "patchlev.h"
 #else
@@ -55,6 +61,8 @@ struct toptenentry {
 /* size big enough to read in all the string fields at once; includes
    room for separating space or trailing newline plus string terminator */
 #define SCANBUFSZ (4 * (ROLESZ + 1) + (NAMSZ + 1) + (DTHSZ + 1) + 1)
+/* size of one formatted logfile or xlogfile line */
+#define LOGLINESZ (4 * BUFSZ)
 
 STATIC_DCL void FDECL(topten_print, (const char *));
 STATIC_DCL void FDECL(topten_print_bold, (const char *));
@@ -63,8 +71,16 @@ STATIC_DCL void NDECL(outheader);
 STATIC_DCL void FDECL(outentry, (int, struct toptenentry *, BOOLEAN_P));
 STATIC_DCL void FDECL(discardexcess, (FILE *));
 STATIC_DCL void FDECL(readentry, (FILE *, struct toptenentry *));
+STATIC_DCL void FDECL(formatentry, (char *, struct toptenentry *));
+#if !defined(SCORE_INDEX) || (defined(LOGFILE) && !defined(LOGAPPEND))
 STATIC_DCL void FDECL(writeentry, (FILE *, struct toptenentry *));
+#endif
+STATIC_DCL void FDECL(formatxlentry, (char *, struct toptenentry *));
+#ifndef LOGAPPEND
 STATIC_DCL void FDECL(writexlentry, (FILE *, struct toptenentry *));
+#else
+STATIC_DCL boolean FDECL(appendlog, (const char *, const char *));
+#endif
 STATIC_DCL long NDECL(encodexlogflags);
 STATIC_DCL long NDECL(encodeconduct);
 STATIC_DCL long NDECL(encodeachieve);
@@ -76,6 +92,53 @@ STATIC_DCL int FDECL(score_wanted, (BOOLEAN_P, int, struct toptenentry *, int,
 STATIC_DCL void FDECL(nsb_mung_line, (char *));
 STATIC_DCL void FDECL(nsb_unmung_line, (char *));
 #endif
+#ifdef SCORE_INDEX
+struct sikey;
+struct sinode;
+STATIC_DCL boolean FDECL(topten_index, (struct toptenentry *));
+STATIC_DCL void FDECL(si_put, (char *, unsigned long, int));
+STATIC_DCL void FDECL(si_putstr, (char *, const char *, int));
+STATIC_DCL unsigned long FDECL(si_get, (const char *, int));
+STATIC_DCL long FDECL(si_sget, (const char *));
+STATIC_DCL void FDECL(si_packentry, (char *, struct toptenentry *));
+STATIC_DCL void FDECL(si_unpackentry, (const char *, struct toptenentry *));
+STATIC_DCL void FDECL(si_packnode, (char *, struct sinode *));
+STATIC_DCL struct sinode *FDECL(si_getnode, (long));
+STATIC_DCL void FDECL(si_freenode, (struct sinode *));
+STATIC_DCL int FDECL(si_keycmp, (const struct sikey *, const struct sikey *));
+STATIC_PTR int FDECL(CFDECLSPEC si_qcmp, (const genericptr,
+                                          const genericptr));
+STATIC_DCL unsigned long FDECL(si_class, (struct toptenentry *));
+STATIC_DCL boolean FDECL(si_samepers, (struct toptenentry *,
+                                       struct toptenentry *));
+STATIC_DCL struct sinode *FDECL(si_kid, (struct sinode *, int));
+STATIC_DCL int FDECL(si_slot, (struct sinode *, const struct sikey *));
+STATIC_DCL long FDECL(si_total, (struct sinode *));
+STATIC_DCL long FDECL(si_below, (const struct sikey *));
+STATIC_DCL boolean FDECL(si_select, (long, struct sikey *, long *));
+STATIC_DCL struct sinode *FDECL(si_insert, (struct sinode *,
+                                            const struct sikey *, long));
+STATIC_DCL void FDECL(si_add, (const struct sikey *, long));
+STATIC_DCL boolean FDECL(si_remove, (struct sinode *, const struct sikey *));
+STATIC_DCL void FDECL(si_drop, (const struct sikey *));
+STATIC_DCL boolean NDECL(si_trim);
+STATIC_DCL void FDECL(si_pend, (const char *, unsigned));
+STATIC_DCL long FDECL(si_newentry, (struct toptenentry *));
+STATIC_DCL void FDECL(si_readentry, (long, struct toptenentry *));
+STATIC_DCL boolean FDECL(si_rankentry, (long, struct toptenentry *));
+STATIC_DCL void FDECL(si_packtrailer, (char *, long, long, unsigned long));
+STATIC_DCL boolean FDECL(si_trailer, (long));
+STATIC_DCL void FDECL(si_writenode, (struct sinode *));
+STATIC_DCL boolean NDECL(si_commit);
+STATIC_DCL boolean FDECL(si_recordent, (struct toptenentry *, genericptr_t));
+STATIC_DCL boolean FDECL(si_indexent, (struct toptenentry *, genericptr_t));
+STATIC_DCL boolean FDECL(si_build, (FILE *, boolean (*)(struct toptenentry *,
+                                                        genericptr_t),
+                                    genericptr_t));
+STATIC_DCL boolean FDECL(si_rebuild, (BOOLEAN_P));
+STATIC_DCL boolean FDECL(si_open, (BOOLEAN_P));
+STATIC_DCL void NDECL(si_close);
+#endif
 
 static winid toptenwin = WIN_ERR;
 
@@ -261,8 +324,8 @@ struct toptenentry *tt;
 }
 
 STATIC_OVL void
-writeentry(rfile, tt)
-FILE *rfile;
+formatentry(buf, tt)
+char *buf; /* LOGLINESZ */
 struct toptenentry *tt;
 {
     static const char fmt32[] = "%c%c ";        /* role,gender */
@@ -278,19 +341,17 @@ struct toptenentry *tt;
     nsb_mung_line(tt->death);
 #endif
 
-    (void) fprintf(rfile, fmt0, tt->ver_major, tt->ver_minor, tt->patchlevel,
-                   tt->points, tt->deathdnum, tt->deathlev, tt->maxlvl,
-                   tt->hp, tt->maxhp, tt->deaths, tt->deathdate,
-                   tt->birthdate, tt->uid);
+    Sprintf(buf, fmt0, tt->ver_major, tt->ver_minor, tt->patchlevel,
+            tt->points, tt->deathdnum, tt->deathlev, tt->maxlvl, tt->hp,
+            tt->maxhp, tt->deaths, tt->deathdate, tt->birthdate, tt->uid);
     if (tt->ver_major < 3 || (tt->ver_major == 3 && tt->ver_minor < 3))
-        (void) fprintf(rfile, fmt32, tt->plrole[0], tt->plgend[0]);
+        Sprintf(eos(buf), fmt32, tt->plrole[0], tt->plgend[0]);
     else
-        (void) fprintf(rfile, fmt33, tt->plrole, tt->plrace, tt->plgend,
-                       tt->plalign);
-    (void) fprintf(rfile, fmtX, onlyspace(tt->name) ? "_" : tt->name,
-                   tt->death,
-                   (multi ? ", while " : ""),
-                   (multi ? (multi_reason ? multi_reason : "helpless") : ""));
+        Sprintf(eos(buf), fmt33, tt->plrole, tt->plrace, tt->plgend,
+                tt->plalign);
+    Sprintf(eos(buf), fmtX, onlyspace(tt->name) ? "_" : tt->name, tt->death,
+            (multi ? ", while " : ""),
+            (multi ? (multi_reason ? multi_reason : "helpless") : ""));
 
 #ifdef NO_SCAN_BRACK
     nsb_unmung_line(tt->name);
@@ -298,16 +359,27 @@ struct toptenentry *tt;
 #endif
 }
 
-/* as tab is never used in eg. plname or death, no need to mangle those. */
+/* for RECORD, and for LOGFILE when it isn't appended to with write() */
+#if !defined(SCORE_INDEX) || (defined(LOGFILE) && !defined(LOGAPPEND))
 STATIC_OVL void
-writexlentry(rfile, tt)
+writeentry(rfile, tt)
 FILE *rfile;
 struct toptenentry *tt;
 {
-#define Fprintf (void) fprintf
-#define XLOG_SEP '\t' /* xlogfile field separator. */
-    char buf[BUFSZ];
+    char buf[LOGLINESZ];
 
+    formatentry(buf, tt);
+    (void) fputs(buf, rfile);
+}
+#endif
+
+/* as tab is never used in eg. plname or death, no need to mangle those. */
+STATIC_OVL void
+formatxlentry(buf, tt)
+char *buf; /* LOGLINESZ */
+struct toptenentry *tt;
+{
+#define XLOG_SEP '\t' /* xlogfile field separator. */
     Sprintf(buf, "version=%d.%d.%d", tt->ver_major, tt->ver_minor,
             tt->patchlevel);
     Sprintf(eos(buf), "%cpoints=%ld%cdeathdnum=%d%cdeathlev=%d", XLOG_SEP,
@@ -317,29 +389,62 @@ struct toptenentry *tt;
     Sprintf(eos(buf), "%cdeaths=%d%cdeathdate=%ld%cbirthdate=%ld%cuid=%d",
             XLOG_SEP, tt->deaths, XLOG_SEP, tt->deathdate, XLOG_SEP,
             tt->birthdate, XLOG_SEP, tt->uid);
-    Fprintf(rfile, "%s", buf);
-    Sprintf(buf, "%crole=%s%crace=%s%cgender=%s%calign=%s", XLOG_SEP,
+    Sprintf(eos(buf), "%crole=%s%crace=%s%cgender=%s%calign=%s", XLOG_SEP,
             tt->plrole, XLOG_SEP, tt->plrace, XLOG_SEP, tt->plgend, XLOG_SEP,
             tt->plalign);
-    Fprintf(rfile, "%s%cname=%s%cdeath=%s",
-            buf, /* (already includes separator) */
-            XLOG_SEP, plname, XLOG_SEP, tt->death);
+    Sprintf(eos(buf), "%cname=%s%cdeath=%s", XLOG_SEP, plname, XLOG_SEP,
+            tt->death);
     if (multi)
-        Fprintf(rfile, "%cwhile=%s", XLOG_SEP,
+        Sprintf(eos(buf), "%cwhile=%s", XLOG_SEP,
                 multi_reason ? multi_reason : "helpless");
-    Fprintf(rfile, "%cconduct=0x%lx%cturns=%ld%cachieve=0x%lx", XLOG_SEP,
+    Sprintf(eos(buf), "%cconduct=0x%lx%cturns=%ld%cachieve=0x%lx", XLOG_SEP,
             encodeconduct(), XLOG_SEP, moves, XLOG_SEP, encodeachieve());
-    Fprintf(rfile, "%crealtime=%ld%cstarttime=%ld%cendtime=%ld", XLOG_SEP,
+    Sprintf(eos(buf), "%crealtime=%ld%cstarttime=%ld%cendtime=%ld", XLOG_SEP,
             (long) urealtime.realtime, XLOG_SEP,
             (long) ubirthday, XLOG_SEP, (long) urealtime.finish_time);
-    Fprintf(rfile, "%cgender0=%s%calign0=%s", XLOG_SEP,
+    Sprintf(eos(buf), "%cgender0=%s%calign0=%s", XLOG_SEP,
             genders[flags.initgend].filecode, XLOG_SEP,
             aligns[1 - u.ualignbase[A_ORIGINAL]].filecode);
-    Fprintf(rfile, "%cflags=0x%lx", XLOG_SEP, encodexlogflags());
-    Fprintf(rfile, "\n");
+    Sprintf(eos(buf), "%cflags=0x%lx\n", XLOG_SEP, encodexlogflags());
 #undef XLOG_SEP
 }
 
+#ifndef LOGAPPEND
+STATIC_OVL void
+writexlentry(rfile, tt)
+FILE *rfile;
+struct toptenentry *tt;
+{
+    char buf[LOGLINESZ];
+
+    formatxlentry(buf, tt);
+    (void) fputs(buf, rfile);
+}
+#else /* LOGAPPEND */
+
+/*
+ * Add one line to a log file with a single write() to a descriptor
+ * opened with O_APPEND.  The system positions each such write at the end
+ * of the file as it happens, so lines from games ending at the same time
+ * can't overlap and there's no lock to wait for or fail to get.
+ */
+STATIC_OVL boolean
+appendlog(filename, line)
+const char *filename, *line;
+{
+    int fd, len = (int) strlen(line);
+    boolean ok;
+
+    fd = open(fqname(filename, SCOREPREFIX, 0), O_WRONLY | O_APPEND | O_CREAT,
+              FCMASK);
+    if (fd < 0)
+        return FALSE;
+    ok = (write(fd, line, len) == len);
+    (void) close(fd);
+    return ok;
+}
+#endif /* LOGAPPEND */
+
 STATIC_OVL long
 encodexlogflags()
 {
@@ -445,19 +550,28 @@ int how;
 time_t when;
 {
     int uid = getuid();
+    register struct toptenentry *t0;
+#ifndef SCORE_INDEX
     int rank, rank0 = -1, rank1 = 0;
     int occ_cnt = sysopt.persmax;
-    register struct toptenentry *t0, *tprev;
+    register struct toptenentry *tprev;
     struct toptenentry *t1;
     FILE *rfile;
     register int flg = 0;
+#endif
     boolean t0_used;
+#ifdef LOGAPPEND
+#if defined(LOGFILE) || defined(XLOGFILE)
+    char logline[LOGLINESZ];
+#endif
+#else
 #ifdef LOGFILE
     FILE *lfile;
 #endif /* LOGFILE */
 #ifdef XLOGFILE
     FILE *xlfile;
 #endif /* XLOGFILE */
+#endif
 
 #ifdef _DCC
     /* Under DICE 3.0, this crashes the system consistently, apparently due to
@@ -520,6 +634,18 @@ time_t when;
     t0->fpos = -1L;
 #endif
 
+#ifdef LOGAPPEND
+#ifdef LOGFILE /* used for debugging (who dies of what, where) */
+    formatentry(logline, t0);
+    if (!appendlog(LOGFILE, logline))
+        HUP raw_print("Cannot open log file!");
+#endif
+#ifdef XLOGFILE
+    formatxlentry(logline, t0);
+    if (!appendlog(XLOGFILE, logline))
+        HUP raw_print("Cannot open extended log file!");
+#endif
+#else /* !LOGAPPEND */
 #ifdef LOGFILE /* used for debugging (who dies of what, where) */
     if (lock_file(LOGFILE, SCOREPREFIX, 10)) {
         if (!(lfile = fopen_datafile(LOGFILE, "a", SCOREPREFIX))) {
@@ -542,6 +668,7 @@ time_t when;
         unlock_file(XLOGFILE);
     }
 #endif /* XLOGFILE */
+#endif /* ?LOGAPPEND */
 
     if (wizard || discover) {
         if (how != PANICKED)
@@ -556,6 +683,10 @@ time_t when;
         goto showwin;
     }
 
+#ifdef SCORE_INDEX
+    if (!topten_index(t0))
+        goto destroywin;
+#else
     if (!lock_file(RECORD, SCOREPREFIX, 60))
         goto destroywin;
 
@@ -723,6 +854,7 @@ time_t when;
     (void) fclose(rfile);
     unlock_file(RECORD);
     free_ttlist(tt_head);
+#endif /* SCORE_INDEX */
 
 showwin:
     if (iflags.toptenwin && !done_stopprint)
@@ -967,7 +1099,9 @@ char **argv;
     int playerct, rank;
     boolean current_ver = TRUE, init_done = FALSE;
     register struct toptenentry *t1;
+#ifndef SCORE_INDEX
     FILE *rfile;
+#endif
     boolean match_found = FALSE;
     register int i;
     char pbuf[BUFSZ];
@@ -979,11 +1113,18 @@ char **argv;
         return;
     }
 
+#ifdef SCORE_INDEX
+    if (!si_open(FALSE)) {
+        raw_print("Cannot open record file!");
+        return;
+    }
+#else
     rfile = fopen_datafile(RECORD, "r", SCOREPREFIX);
     if (!rfile) {
         raw_print("Cannot open record file!");
         return;
     }
+#endif
 
 #ifdef AMIGA
     {
@@ -1038,7 +1179,11 @@ char **argv;
 
     t1 = tt_head = newttentry();
     for (rank = 1;; rank++) {
+#ifdef SCORE_INDEX
+        (void) si_rankentry((long) rank, t1);
+#else
         readentry(rfile, t1);
+#endif
         if (t1->points == 0)
             break;
         if (!match_found
@@ -1048,7 +1193,11 @@ char **argv;
         t1 = t1->tt_next;
     }
 
+#ifdef SCORE_INDEX
+    si_close();
+#else
     (void) fclose(rfile);
+#endif
     if (init_done) {
         free_dungeons();
         dlb_cleanup();
@@ -1140,45 +1289,1105 @@ tt_oname(otmp)
 struct obj *otmp;
 {
     int rank;
-    register int i;
     register struct toptenentry *tt;
+#ifndef SCORE_INDEX
+    register int i;
     FILE *rfile;
+#endif
     struct toptenentry tt_buf;
 
     if (!otmp)
         return (struct obj *) 0;
 
+#ifdef SCORE_INDEX
+    if (!si_open(FALSE)) {
+        impossible("Cannot open record file!");
+        return (struct obj *) 0;
+    }
+#else
     rfile = fopen_datafile(RECORD, "r", SCOREPREFIX);
     if (!rfile) {
         impossible("Cannot open record file!");
         return (struct obj *) 0;
     }
+#endif
 
     tt = &tt_buf;
     rank = rnd(sysopt.tt_oname_maxrank);
+#ifdef SCORE_INDEX
+    /* like below, fall back to the top entry for a short list */
+    if (!si_rankentry((long) rank, tt) && rank > 1)
+        (void) si_rankentry(1L, tt);
+#else
 pickentry:
     for (i = rank; i; i--) {
         readentry(rfile, tt);
         if (tt->points == 0)
             break;
     }
+#endif
 
     if (tt->points == 0) {
+#ifndef SCORE_INDEX
         if (rank > 1) {
             rank = 1;
             rewind(rfile);
             goto pickentry;
         }
+#endif
         otmp = (struct obj *) 0;
     } else {
         set_corpsenm(otmp, classmon(tt->plrole, (tt->plgend[0] == 'F')));
         otmp = oname(otmp, tt->name);
     }
 
+#ifdef SCORE_INDEX
+    si_close();
+#else
     (void) fclose(rfile);
+#endif
     return otmp;
 }
 
+#ifdef SCORE_INDEX
+/*
+ * Indexed high-score list.
+ *
+ * SCORE_INDEX keeps the scores in a B-tree whose interior nodes carry
+ * the number of keys below each child, so finding where a new score
+ * ranks, filing it, and fetching the entry at a given rank each read
+ * one root-to-leaf path rather than the whole list.  The file is only
+ * ever appended to: a new score goes at the end together with fresh
+ * copies of the nodes it changed, followed by a trailer naming the new
+ * root.  Readers (nethack -s, statue and corpse names) take no lock and
+ * use the last complete trailer, so a torn write just leaves junk which
+ * the next trailer skips.  Once the superseded copies outweigh the live
+ * data the file is rebuilt and renamed over itself.  Writers serialize
+ * on the RECORD lock, which is held for a few reads and one write.
+ *
+ * Each score is filed under two keys.  Class 0 keys order the whole list
+ * by points, older scores first among ties; the other classes are hashed
+ * from player and role and order just that player's scores, so PERSMAX
+ * can be enforced without a scan.  Since class 0 sorts first, a score's
+ * position among all keys is also its rank.
+ *
+ * All numbers are stored little-endian so a playground can be shared by
+ * different machines, as 'record' can.
+ */
+#define SI_MAGIC "NHscor1\n"
+#define SI_HDRSZ 8
+#define SI_NODESZ 1024
+#define SI_KEYSZ 16 /* class 4, points 8, seq 4 */
+#define SI_LEAFMAX ((SI_NODESZ - 4) / (SI_KEYSZ + 4))
+#define SI_KIDMAX ((SI_NODESZ - 4) / (SI_KEYSZ + 8))
+#define SI_ENTSZ (8 + 12 * 4 + 4 * (ROLESZ + 1) + (NAMSZ + 1) + (DTHSZ + 1))
+#define SI_TRAILSZ 24
+#define SI_FILL(max) ((max) * 3 / 4) /* leave room when bulk loading */
+/* rebuild when the file is this much bigger than its live contents */
+#define SI_BLOATED(eof, n) \
+    ((eof) > 4L * (n) * (SI_ENTSZ + 64L) + 32L * SI_NODESZ)
+
+struct sikey {
+    unsigned long cls;  /* 0 for rank order, else player and role hash */
+    long points;
+    unsigned long seq;  /* order of arrival */
+};
+
+struct sinode {
+    long off; /* where it lives in the file; 0 once changed in memory */
+    boolean leaf;
+    int n;
+    struct sikey key[SI_LEAFMAX + 1]; /* +1: full node about to split */
+    long ptr[SI_LEAFMAX + 1];         /* entry (leaf) or child offset */
+    long cnt[SI_KIDMAX + 1];          /* number of keys below each child */
+    struct sinode *kid[SI_KIDMAX + 1]; /* children read in so far */
+};
+
+static struct scoreidx {
+    FILE *fp;
+    long eof;           /* end of file when opened */
+    long count;         /* scores, ie. class 0 keys */
+    unsigned long seq;  /* last arrival number used */
+    struct sinode *root;
+    char *pend;         /* appended by the next si_commit() */
+    unsigned pendlen, pendsz;
+} sidx;
+
+STATIC_OVL void
+si_put(buf, val, len)
+char *buf;
+unsigned long val;
+int len;
+{
+    while (len-- > 0) {
+        *buf++ = (char) (val & 0xff);
+        val >>= 8;
+    }
+}
+
+/* a string field of len bytes; buf is already zeroed, so a shorter
+   string is left padded with NULs (strnlen() isn't portable enough) */
+STATIC_OVL void
+si_putstr(buf, str, len)
+char *buf;
+const char *str;
+int len;
+{
+    int n = 0;
+
+    while (n < len && str[n])
+        n++;
+    (void) memcpy((genericptr_t) buf, (genericptr_t) str, n);
+}
+
+STATIC_OVL unsigned long
+si_get(buf, len)
+const char *buf;
+int len;
+{
+    unsigned long val = 0L;
+
+    while (len-- > 0)
+        val = (val << 8) | (unsigned char) buf[len];
+    return val;
+}
+
+/* 4 byte signed value */
+STATIC_OVL long
+si_sget(buf)
+const char *buf;
+{
+    unsigned long val = si_get(buf, 4);
+
+    return (val & 0x80000000UL) ? -(long) ((~val & 0x7fffffffUL) + 1L)
+                                : (long) val;
+}
+
+STATIC_OVL void
+si_packentry(buf, tt)
+char *buf;
+struct toptenentry *tt;
+{
+    long ival[12];
+    int i;
+
+    ival[0] = tt->deathdnum, ival[1] = tt->deathlev, ival[2] = tt->maxlvl;
+    ival[3] = tt->hp, ival[4] = tt->maxhp, ival[5] = tt->deaths;
+    ival[6] = tt->ver_major, ival[7] = tt->ver_minor;
+    ival[8] = tt->patchlevel, ival[9] = tt->deathdate;
+    ival[10] = tt->birthdate, ival[11] = tt->uid;
+
+    (void) memset((genericptr_t) buf, 0, SI_ENTSZ);
+    si_put(buf, (unsigned long) tt->points, 8), buf += 8;
+    for (i = 0; i < 12; i++)
+        si_put(buf, (unsigned long) ival[i], 4), buf += 4;
+    si_putstr(buf, tt->plrole, ROLESZ), buf += ROLESZ + 1;
+    si_putstr(buf, tt->plrace, ROLESZ), buf += ROLESZ + 1;
+    si_putstr(buf, tt->plgend, ROLESZ), buf += ROLESZ + 1;
+    si_putstr(buf, tt->plalign, ROLESZ), buf += ROLESZ + 1;
+    si_putstr(buf, tt->name, NAMSZ), buf += NAMSZ + 1;
+    si_putstr(buf, tt->death, DTHSZ);
+}
+
+STATIC_OVL void
+si_unpackentry(buf, tt)
+const char *buf;
+struct toptenentry *tt;
+{
+    tt->points = (long) si_get(buf, 8), buf += 8;
+    tt->deathdnum = (int) si_sget(buf), buf += 4;
+    tt->deathlev = (int) si_sget(buf), buf += 4;
+    tt->maxlvl = (int) si_sget(buf), buf += 4;
+    tt->hp = (int) si_sget(buf), buf += 4;
+    tt->maxhp = (int) si_sget(buf), buf += 4;
+    tt->deaths = (int) si_sget(buf), buf += 4;
+    tt->ver_major = (int) si_sget(buf), buf += 4;
+    tt->ver_minor = (int) si_sget(buf), buf += 4;
+    tt->patchlevel = (int) si_sget(buf), buf += 4;
+    tt->deathdate = si_sget(buf), buf += 4;
+    tt->birthdate = si_sget(buf), buf += 4;
+    tt->uid = (int) si_sget(buf), buf += 4;
+    copynchars(tt->plrole, buf, ROLESZ), buf += ROLESZ + 1;
+    copynchars(tt->plrace, buf, ROLESZ), buf += ROLESZ + 1;
+    copynchars(tt->plgend, buf, ROLESZ), buf += ROLESZ + 1;
+    copynchars(tt->plalign, buf, ROLESZ), buf += ROLESZ + 1;
+    copynchars(tt->name, buf, NAMSZ), buf += NAMSZ + 1;
+    copynchars(tt->death, buf, DTHSZ);
+    tt->tt_next = 0;
+}
+
+/* node layout: leaf flag, 2 byte count, pad, then key+ptr[+cnt] items */
+STATIC_OVL void
+si_packnode(buf, nd)
+char *buf;
+struct sinode *nd;
+{
+    char *p = buf + 4;
+    int i;
+
+    (void) memset((genericptr_t) buf, 0, SI_NODESZ);
+    buf[0] = nd->leaf ? 1 : 0;
+    si_put(buf + 1, (unsigned long) nd->n, 2);
+    for (i = 0; i < nd->n; i++) {
+        si_put(p, nd->key[i].cls, 4), p += 4;
+        si_put(p, (unsigned long) nd->key[i].points, 8), p += 8;
+        si_put(p, nd->key[i].seq, 4), p += 4;
+        si_put(p, (unsigned long) nd->ptr[i], 4), p += 4;
+        if (!nd->leaf)
+            si_put(p, (unsigned long) nd->cnt[i], 4), p += 4;
+    }
+}
+
+STATIC_OVL struct sinode *
+si_getnode(off)
+long off;
+{
+    char buf[SI_NODESZ], *p = buf + 4;
+    struct sinode *nd = (struct sinode *) alloc(sizeof (struct sinode));
+    int i;
+
+    (void) memset((genericptr_t) nd, 0, sizeof (struct sinode));
+    nd->leaf = TRUE;
+    if (fseek(sidx.fp, off, SEEK_SET) != 0
+        || fread(buf, SI_NODESZ, 1, sidx.fp) != 1
+        || (nd->n = (int) si_get(buf + 1, 2))
+               > (buf[0] ? SI_LEAFMAX : SI_KIDMAX)) {
+        impossible("Score index damaged at %ld.", off);
+        nd->n = 0;
+        return nd;
+    }
+    nd->off = off;
+    nd->leaf = buf[0] ? TRUE : FALSE;
+    for (i = 0; i < nd->n; i++) {
+        nd->key[i].cls = si_get(p, 4), p += 4;
+        nd->key[i].points = (long) si_get(p, 8), p += 8;
+        nd->key[i].seq = si_get(p, 4), p += 4;
+        nd->ptr[i] = (long) si_get(p, 4), p += 4;
+        if (!nd->leaf)
+            nd->cnt[i] = (long) si_get(p, 4), p += 4;
+    }
+    return nd;
+}
+
+STATIC_OVL void
+si_freenode(nd)
+struct sinode *nd;
+{
+    int i;
+
+    if (!nd->leaf)
+        for (i = 0; i < nd->n; i++)
+            if (nd->kid[i])
+                si_freenode(nd->kid[i]);
+    free((genericptr_t) nd);
+}
+
+STATIC_OVL int
+si_keycmp(a, b)
+const struct sikey *a, *b;
+{
+    if (a->cls != b->cls)
+        return (a->cls < b->cls) ? -1 : 1;
+    if (a->points != b->points)
+        return (a->points > b->points) ? -1 : 1; /* best first */
+    if (a->seq != b->seq)
+        return (a->seq < b->seq) ? -1 : 1;
+    return 0;
+}
+
+/* Args must be (const genericptr) so that qsort will always be happy. */
+STATIC_PTR int CFDECLSPEC
+si_qcmp(vx, vy)
+const genericptr vx;
+const genericptr vy;
+{
+    return si_keycmp((const struct sikey *) vx, (const struct sikey *) vy);
+}
+
+/* key class holding one player's scores for one role */
+STATIC_OVL unsigned long
+si_class(tt)
+struct toptenentry *tt;
+{
+    unsigned long h;
+    int i;
+
+    if (sysopt.pers_is_uid) {
+        h = (unsigned long) tt->uid;
+    } else {
+        h = 0L;
+        for (i = 0; i < NAMSZ && tt->name[i]; i++)
+            h = h * 31 + (unsigned char) tt->name[i];
+    }
+    for (i = 0; i < ROLESZ && tt->plrole[i]; i++)
+        h = h * 31 + (unsigned char) tt->plrole[i];
+    h &= 0xffffffffUL;
+    return h ? h : 1L;
+}
+
+/* is t1 by the same person, in the same role, as t0? */
+STATIC_OVL boolean
+si_samepers(t1, t0)
+struct toptenentry *t1, *t0;
+{
+    return (boolean) ((sysopt.pers_is_uid
+                           ? t1->uid == t0->uid
+                           : strncmp(t1->name, t0->name, NAMSZ) == 0)
+                      && !strncmp(t1->plrole, t0->plrole, ROLESZ));
+}
+
+STATIC_OVL struct sinode *
+si_kid(nd, i)
+struct sinode *nd;
+int i;
+{
+    if (!nd->kid[i])
+        nd->kid[i] = si_getnode(nd->ptr[i]);
+    return nd->kid[i];
+}
+
+/* which child of an interior node may hold key k */
+STATIC_OVL int
+si_slot(nd, k)
+struct sinode *nd;
+const struct sikey *k;
+{
+    int i;
+
+    for (i = nd->n - 1; i > 0; i--)
+        if (si_keycmp(&nd->key[i], k) <= 0)
+            break;
+    return i;
+}
+
+STATIC_OVL long
+si_total(nd)
+struct sinode *nd;
+{
+    long tot;
+    int i;
+
+    if (nd->leaf)
+        return (long) nd->n;
+    for (tot = 0L, i = 0; i < nd->n; i++)
+        tot += nd->cnt[i];
+    return tot;
+}
+
+/* number of keys which sort before k */
+STATIC_OVL long
+si_below(k)
+const struct sikey *k;
+{
+    struct sinode *nd = sidx.root;
+    long pos = 0L;
+    int i, j;
+
+    if (!nd)
+        return 0L;
+    while (!nd->leaf) {
+        i = si_slot(nd, k);
+        for (j = 0; j < i; j++)
+            pos += nd->cnt[j];
+        nd = si_kid(nd, i);
+    }
+    for (i = 0; i < nd->n && si_keycmp(&nd->key[i], k) < 0; i++)
+        pos++;
+    return pos;
+}
+
+/* fetch the key at position pos (counting from 0) and its entry offset */
+STATIC_OVL boolean
+si_select(pos, kp, offp)
+long pos;
+struct sikey *kp;
+long *offp;
+{
+    struct sinode *nd = sidx.root;
+    int i;
+
+    if (!nd || pos < 0L)
+        return FALSE;
+    while (!nd->leaf) {
+        for (i = 0; i < nd->n - 1 && pos >= nd->cnt[i]; i++)
+            pos -= nd->cnt[i];
+        nd = si_kid(nd, i);
+    }
+    if (pos >= (long) nd->n)
+        return FALSE;
+    *kp = nd->key[pos];
+    *offp = nd->ptr[pos];
+    return TRUE;
+}
+
+/* file k under nd; returns the new right half if nd had to split */
+STATIC_OVL struct sinode *
+si_insert(nd, k, ptr)
+struct sinode *nd;
+const struct sikey *k;
+long ptr;
+{
+    struct sinode *rt;
+    int i, j, m;
+
+    nd->off = 0L;
+    if (nd->leaf) {
+        for (i = nd->n; i > 0 && si_keycmp(&nd->key[i - 1], k) > 0; i--) {
+            nd->key[i] = nd->key[i - 1];
+            nd->ptr[i] = nd->ptr[i - 1];
+        }
+        nd->key[i] = *k;
+        nd->ptr[i] = ptr;
+        if (++nd->n <= SI_LEAFMAX)
+            return (struct sinode *) 0;
+    } else {
+        i = si_slot(nd, k);
+        rt = si_insert(si_kid(nd, i), k, ptr);
+        nd->cnt[i]++;
+        if (!rt)
+            return (struct sinode *) 0;
+        for (j = nd->n; j > i + 1; j--) {
+            nd->key[j] = nd->key[j - 1];
+            nd->ptr[j] = nd->ptr[j - 1];
+            nd->cnt[j] = nd->cnt[j - 1];
+            nd->kid[j] = nd->kid[j - 1];
+        }
+        nd->key[i + 1] = rt->key[0];
+        nd->ptr[i + 1] = 0L;
+        nd->kid[i + 1] = rt;
+        nd->cnt[i + 1] = si_total(rt);
+        nd->cnt[i] -= nd->cnt[i + 1];
+        if (++nd->n <= SI_KIDMAX)
+            return (struct sinode *) 0;
+    }
+    /* split; the upper half's first key becomes its separator */
+    rt = (struct sinode *) alloc(sizeof (struct sinode));
+    (void) memset((genericptr_t) rt, 0, sizeof (struct sinode));
+    rt->leaf = nd->leaf;
+    m = nd->n / 2;
+    for (j = m; j < nd->n; j++) {
+        rt->key[j - m] = nd->key[j];
+        rt->ptr[j - m] = nd->ptr[j];
+        rt->cnt[j - m] = nd->leaf ? 0L : nd->cnt[j];
+        rt->kid[j - m] = nd->leaf ? 0 : nd->kid[j];
+    }
+    rt->n = nd->n - m;
+    nd->n = m;
+    return rt;
+}
+
+STATIC_OVL void
+si_add(k, ptr)
+const struct sikey *k;
+long ptr;
+{
+    struct sinode *rt, *nr;
+
+    if (!sidx.root) {
+        sidx.root = (struct sinode *) alloc(sizeof (struct sinode));
+        (void) memset((genericptr_t) sidx.root, 0, sizeof (struct sinode));
+        sidx.root->leaf = TRUE;
+    }
+    if ((rt = si_insert(sidx.root, k, ptr)) != 0) {
+        nr = (struct sinode *) alloc(sizeof (struct sinode));
+        (void) memset((genericptr_t) nr, 0, sizeof (struct sinode));
+        nr->n = 2;
+        nr->key[0] = sidx.root->key[0];
+        nr->kid[0] = sidx.root;
+        nr->cnt[0] = si_total(sidx.root);
+        nr->key[1] = rt->key[0];
+        nr->kid[1] = rt;
+        nr->cnt[1] = si_total(rt);
+        sidx.root = nr;
+    }
+}
+
+/* underfull and even empty nodes are left alone until the next rebuild */
+STATIC_OVL boolean
+si_remove(nd, k)
+struct sinode *nd;
+const struct sikey *k;
+{
+    int i;
+
+    if (nd->leaf) {
+        for (i = 0; i < nd->n; i++)
+            if (!si_keycmp(&nd->key[i], k))
+                break;
+        if (i == nd->n)
+            return FALSE;
+        for (nd->n--; i < nd->n; i++) {
+            nd->key[i] = nd->key[i + 1];
+            nd->ptr[i] = nd->ptr[i + 1];
+        }
+    } else {
+        i = si_slot(nd, k);
+        if (!si_remove(si_kid(nd, i), k))
+            return FALSE;
+        nd->cnt[i]--;
+    }
+    nd->off = 0L;
+    return TRUE;
+}
+
+/* remove a score, given its class 0 key */
+STATIC_OVL void
+si_drop(k0)
+const struct sikey *k0;
+{
+    struct toptenentry tt;
+    struct sikey k;
+    long off;
+
+    if (!si_select(si_below(k0), &k, &off) || si_keycmp(&k, k0))
+        return;
+    si_readentry(off, &tt);
+    (void) si_remove(sidx.root, k0);
+    k.cls = si_class(&tt);
+    (void) si_remove(sidx.root, &k);
+    sidx.count--;
+}
+
+/* drop scores past ENTRYMAX or under POINTSMIN, as rewriting the record
+   file would */
+STATIC_OVL boolean
+si_trim()
+{
+    struct sikey k;
+    long off;
+    boolean dropped = FALSE;
+
+    while (si_select(sidx.count - 1L, &k, &off)
+           && (sidx.count > (long) sysopt.entrymax
+               || k.points < (long) sysopt.pointsmin)) {
+        si_drop(&k);
+        dropped = TRUE;
+    }
+    return dropped;
+}
+
+STATIC_OVL void
+si_pend(buf, len)
+const char *buf;
+unsigned len;
+{
+    char *newbuf;
+
+    if (sidx.pendlen + len > sidx.pendsz) {
+        sidx.pendsz = 2 * (sidx.pendsz + len);
+        newbuf = (char *) alloc(sidx.pendsz);
+        if (sidx.pend) {
+            (void) memcpy((genericptr_t) newbuf, (genericptr_t) sidx.pend,
+                          sidx.pendlen);
+            free((genericptr_t) sidx.pend);
+        }
+        sidx.pend = newbuf;
+    }
+    (void) memcpy((genericptr_t) (sidx.pend + sidx.pendlen),
+                  (genericptr_t) buf, len);
+    sidx.pendlen += len;
+}
+
+/* queue an entry for writing; returns where it will be */
+STATIC_OVL long
+si_newentry(tt)
+struct toptenentry *tt;
+{
+    char buf[SI_ENTSZ];
+    long off = sidx.eof + (long) sidx.pendlen;
+
+    si_packentry(buf, tt);
+    si_pend(buf, SI_ENTSZ);
+    return off;
+}
+
+STATIC_OVL void
+si_readentry(off, tt)
+long off;
+struct toptenentry *tt;
+{
+    char buf[SI_ENTSZ];
+
+    if (off >= sidx.eof && off + SI_ENTSZ <= sidx.eof + (long) sidx.pendlen) {
+        si_unpackentry(sidx.pend + (off - sidx.eof), tt);
+    } else if (fseek(sidx.fp, off, SEEK_SET) == 0
+               && fread(buf, SI_ENTSZ, 1, sidx.fp) == 1) {
+        si_unpackentry(buf, tt);
+    } else {
+        impossible("Score index damaged at %ld.", off);
+        (void) memset((genericptr_t) tt, 0, sizeof (struct toptenentry));
+    }
+}
+
+/* read the entry ranked 'rank'; points are 0 past the end of the list */
+STATIC_OVL boolean
+si_rankentry(rank, tt)
+long rank;
+struct toptenentry *tt;
+{
+    struct sikey k;
+    long off;
+
+    if (rank > sidx.count || !si_select(rank - 1, &k, &off)) {
+        tt->points = 0L;
+        return FALSE;
+    }
+    si_readentry(off, tt);
+    return TRUE;
+}
+
+/* trailer: magic, root, count, seq, check, magic */
+STATIC_OVL void
+si_packtrailer(buf, root, count, seq)
+char *buf;
+long root, count;
+unsigned long seq;
+{
+    unsigned long sum = 0L;
+    int i;
+
+    (void) memcpy(buf, "NHsT", 4);
+    si_put(buf + 4, (unsigned long) root, 4);
+    si_put(buf + 8, (unsigned long) count, 4);
+    si_put(buf + 12, seq, 4);
+    for (i = 0; i < 16; i++)
+        sum = ((sum << 5) ^ (sum >> 27) ^ (unsigned char) buf[i])
+              & 0xffffffffUL;
+    si_put(buf + 16, sum, 4);
+    (void) memcpy(buf + 20, "NHsE", 4);
+}
+
+/* find the last good trailer at or before 'end' and load its root */
+STATIC_OVL boolean
+si_trailer(end)
+long end;
+{
+    char win[BUFSZ * 16], chk[SI_TRAILSZ];
+    long start, pos;
+    int i, len;
+
+    while (end - SI_TRAILSZ >= SI_HDRSZ) {
+        start = end - (long) sizeof win;
+        if (start < SI_HDRSZ)
+            start = SI_HDRSZ;
+        len = (int) (end - start);
+        if (fseek(sidx.fp, start, SEEK_SET) != 0
+            || fread(win, len, 1, sidx.fp) != 1)
+            return FALSE;
+        for (i = len - SI_TRAILSZ; i >= 0; i--) {
+            if (memcmp(&win[i + 20], "NHsE", 4)
+                || memcmp(&win[i], "NHsT", 4))
+                continue;
+            pos = (long) si_get(&win[i + 4], 4);
+            si_packtrailer(chk, pos, (long) si_get(&win[i + 8], 4),
+                           si_get(&win[i + 12], 4));
+            if (memcmp(chk, &win[i], SI_TRAILSZ))
+                continue;
+            sidx.count = (long) si_get(&win[i + 8], 4);
+            sidx.seq = si_get(&win[i + 12], 4);
+            sidx.root = pos ? si_getnode(pos) : (struct sinode *) 0;
+            return TRUE;
+        }
+        /* overlap the windows so a trailer can't straddle them */
+        end = start + SI_TRAILSZ - 1;
+        if (start == SI_HDRSZ)
+            break;
+    }
+    return FALSE;
+}
+
+/* queue the nodes changed under nd, children before their parents */
+STATIC_OVL void
+si_writenode(nd)
+struct sinode *nd;
+{
+    char buf[SI_NODESZ];
+    int i;
+
+    if (!nd->leaf)
+        for (i = 0; i < nd->n; i++)
+            if (nd->kid[i] && !nd->kid[i]->off) {
+                si_writenode(nd->kid[i]);
+                nd->ptr[i] = nd->kid[i]->off;
+            }
+    si_packnode(buf, nd);
+    nd->off = sidx.eof + (long) sidx.pendlen;
+    si_pend(buf, SI_NODESZ);
+}
+
+/* append the queued entries, the changed nodes, and a new trailer */
+STATIC_OVL boolean
+si_commit()
+{
+    char buf[SI_TRAILSZ];
+    boolean ok;
+
+    if (sidx.root && !sidx.root->off)
+        si_writenode(sidx.root);
+    si_packtrailer(buf, sidx.root ? sidx.root->off : 0L, sidx.count,
+                   sidx.seq);
+    si_pend(buf, SI_TRAILSZ);
+    ok = (fseek(sidx.fp, sidx.eof, SEEK_SET) == 0
+          && fwrite(sidx.pend, sidx.pendlen, 1, sidx.fp) == 1
+          && fflush(sidx.fp) == 0);
+    sidx.eof += (long) sidx.pendlen;
+    sidx.pendlen = 0;
+    return ok;
+}
+
+/* sources of entries for si_build(), best first */
+STATIC_OVL boolean
+si_recordent(tt, arg)
+struct toptenentry *tt;
+genericptr_t arg;
+{
+    if (!arg)
+        return FALSE;
+    readentry((FILE *) arg, tt);
+    return (boolean) (tt->points > 0L);
+}
+
+STATIC_OVL boolean
+si_indexent(tt, arg)
+struct toptenentry *tt;
+genericptr_t arg;
+{
+    return si_rankentry(++*(long *) arg, tt);
+}
+
+/* write a complete index, bulk loading the tree from the bottom up */
+STATIC_OVL boolean
+si_build(fp, nextent, arg)
+FILE *fp;
+boolean FDECL((*nextent), (struct toptenentry *, genericptr_t));
+genericptr_t arg;
+{
+    struct toptenentry tt;
+    struct sinode nd;
+    struct siitem {
+        struct sikey key; /* first member, for si_qcmp() */
+        long ptr, cnt;
+    } *items = 0, *newitems;
+    char buf[SI_NODESZ];
+    long off = SI_HDRSZ, root = 0L, n = 0L, nmax = 0L, count = 0L, i, m;
+    int per, j;
+
+    (void) memset((genericptr_t) &nd, 0, sizeof nd);
+    (void) fwrite(SI_MAGIC, SI_HDRSZ, 1, fp);
+    while (count < (long) sysopt.entrymax && (*nextent)(&tt, arg)) {
+        if (n + 2 > nmax) {
+            nmax = 2 * nmax + 256;
+            newitems = (struct siitem *) alloc(nmax * sizeof *items);
+            if (items) {
+                (void) memcpy((genericptr_t) newitems, (genericptr_t) items,
+                              n * sizeof *items);
+                free((genericptr_t) items);
+            }
+            items = newitems;
+        }
+        si_packentry(buf, &tt);
+        (void) fwrite(buf, SI_ENTSZ, 1, fp);
+        items[n].key.cls = 0L;
+        items[n].key.points = tt.points;
+        items[n].key.seq = (unsigned long) ++count;
+        items[n].ptr = off, items[n].cnt = 1L;
+        items[n + 1] = items[n];
+        items[n + 1].key.cls = si_class(&tt);
+        n += 2;
+        off += SI_ENTSZ;
+    }
+    if (n)
+        qsort((genericptr_t) items, (size_t) n, sizeof *items, si_qcmp);
+
+    /* each level's nodes become the items of the level above */
+    for (nd.leaf = TRUE; n > 0L; nd.leaf = FALSE) {
+        per = nd.leaf ? SI_FILL(SI_LEAFMAX) : SI_FILL(SI_KIDMAX);
+        for (i = m = 0L; i < n; i += per, m++) {
+            nd.n = (n - i < per) ? (int) (n - i) : per;
+            for (j = 0; j < nd.n; j++) {
+                nd.key[j] = items[i + j].key;
+                nd.ptr[j] = items[i + j].ptr;
+                nd.cnt[j] = items[i + j].cnt;
+            }
+            si_packnode(buf, &nd);
+            (void) fwrite(buf, SI_NODESZ, 1, fp);
+            items[m].key = nd.key[0];
+            items[m].ptr = root = off;
+            items[m].cnt = si_total(&nd);
+            off += SI_NODESZ;
+        }
+        if (m == 1L)
+            break;
+        n = m;
+    }
+    if (items)
+        free((genericptr_t) items);
+    si_packtrailer(buf, root, count, (unsigned long) count);
+    (void) fwrite(buf, SI_TRAILSZ, 1, fp);
+    return (boolean) (fflush(fp) == 0 && !ferror(fp));
+}
+
+/* replace the index with a compact copy of itself, or of RECORD if
+   there's no index yet; the caller holds the RECORD lock */
+STATIC_OVL boolean
+si_rebuild(fromrecord)
+boolean fromrecord;
+{
+    char tmpnam[BUFSZ];
+    const char *fq_tmp, *fq_idx;
+    FILE *nfp, *rfile = 0;
+    long rank = 0L;
+    boolean ok;
+
+    Sprintf(tmpnam, "%s.new", SCORE_INDEX);
+    if (!(nfp = fopen_datafile(tmpnam, "wb", SCOREPREFIX)))
+        return FALSE;
+    fq_tmp = fqname(tmpnam, SCOREPREFIX, 1);
+#if defined(UNIX) && !defined(SECURE)
+    (void) chmod(fq_tmp, FCMASK); /* other players need to update it */
+#endif
+    if (fromrecord) {
+        rfile = fopen_datafile(RECORD, "r", SCOREPREFIX);
+        ok = si_build(nfp, si_recordent, (genericptr_t) rfile);
+        if (rfile)
+            (void) fclose(rfile);
+    } else {
+        ok = si_build(nfp, si_indexent, (genericptr_t) &rank);
+    }
+    ok = (fclose(nfp) == 0) && ok;
+    fq_idx = fqname(SCORE_INDEX, SCOREPREFIX, 0);
+    if (ok) {
+#if (defined(SYSV) && !defined(SVR4)) || defined(GENIX)
+        (void) unlink(fq_idx);
+        ok = (link(fq_tmp, fq_idx) == 0 && unlink(fq_tmp) == 0);
+#else
+        ok = (rename(fq_tmp, fq_idx) == 0);
+#endif
+    }
+    if (!ok)
+        (void) unlink(fq_tmp);
+    return ok;
+}
+
+/* open the index, building it from RECORD if it doesn't exist yet;
+   updating requires that the caller already holds the RECORD lock */
+STATIC_OVL boolean
+si_open(update)
+boolean update;
+{
+    const char *mode = update ? "r+b" : "rb";
+    char hdr[SI_HDRSZ];
+    boolean ok;
+
+    (void) memset((genericptr_t) &sidx, 0, sizeof sidx);
+    if (!(sidx.fp = fopen_datafile(SCORE_INDEX, mode, SCOREPREFIX))) {
+        if (update) {
+            ok = si_rebuild(TRUE);
+        } else {
+            if (!lock_file(RECORD, SCOREPREFIX, 60))
+                return FALSE;
+            /* someone else may have built it while we waited */
+            if ((sidx.fp = fopen_datafile(SCORE_INDEX, mode, SCOREPREFIX))
+                != 0)
+                ok = TRUE;
+            else
+                ok = si_rebuild(TRUE);
+            unlock_file(RECORD);
+        }
+        if (!ok
+            || (!sidx.fp
+                && !(sidx.fp = fopen_datafile(SCORE_INDEX, mode,
+                                              SCOREPREFIX))))
+            return FALSE;
+    }
+    if (fread(hdr, SI_HDRSZ, 1, sidx.fp) != 1
+        || strncmp(hdr, SI_MAGIC, SI_HDRSZ)
+        || fseek(sidx.fp, 0L, SEEK_END) != 0
+        || (sidx.eof = ftell(sidx.fp)) < SI_HDRSZ
+        || !si_trailer(sidx.eof)) {
+        raw_printf("Score index %s is damaged.", SCORE_INDEX);
+        (void) fclose(sidx.fp);
+        sidx.fp = (FILE *) 0;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+STATIC_OVL void
+si_close()
+{
+    if (sidx.root)
+        si_freenode(sidx.root);
+    if (sidx.pend)
+        free((genericptr_t) sidx.pend);
+    if (sidx.fp)
+        (void) fclose(sidx.fp);
+    (void) memset((genericptr_t) &sidx, 0, sizeof sidx);
+}
+
+/* topten() for the indexed list; mirrors the record file version */
+STATIC_OVL boolean
+topten_index(t0)
+struct toptenentry *t0;
+{
+    struct toptenentry *t1, tnew;
+    struct sikey k0, k, kx;
+    long off, pos, rank, rank0 = -1L, rank1 = 0L;
+    int occ_cnt = sysopt.persmax;
+    char dbuf[BUFSZ];
+    boolean own, outside, changed;
+
+    if (!lock_file(RECORD, SCOREPREFIX, 60))
+        return FALSE;
+    if (!si_open(TRUE)) {
+        HUP raw_print("Cannot open score index!");
+        unlock_file(RECORD);
+        return FALSE;
+    }
+
+    HUP topten_print("");
+
+    /* assure minimum number of points */
+    if (t0->points < sysopt.pointsmin)
+        t0->points = 0;
+
+    changed = si_trim();
+    t1 = newttentry();
+    k0.cls = si_class(t0);
+    k0.points = t0->points;
+    k0.seq = sidx.seq + 1;
+    /* this player's scores which rank ahead of the new one */
+    k.cls = k0.cls, k.points = LONG_MAX, k.seq = 0L;
+    for (pos = si_below(&k); si_select(pos, &k, &off) && k.cls == k0.cls
+                             && si_keycmp(&k, &k0) < 0;
+         pos++) {
+        si_readentry(off, t1);
+        if (si_samepers(t1, t0) && --occ_cnt <= 0) {
+            kx.cls = 0L, kx.points = k.points, kx.seq = k.seq;
+            rank0 = 0L;
+            rank1 = si_below(&kx) + 1L;
+            HUP {
+                char pbuf[BUFSZ];
+
+                Sprintf(pbuf,
+                        "You didn't beat your previous score of %ld points.",
+                        t1->points);
+                topten_print(pbuf);
+                topten_print("");
+            }
+            break;
+        }
+    }
+
+    kx.cls = 0L, kx.points = k0.points, kx.seq = k0.seq;
+    if (rank0 < 0L && t0->points > 0L
+        && (rank = si_below(&kx) + 1L) <= (long) sysopt.entrymax) {
+        /* as written by writeentry() */
+        tnew = *t0;
+        if (multi) {
+            Sprintf(dbuf, "%s, while %s", t0->death,
+                    multi_reason ? multi_reason : "helpless");
+            copynchars(tnew.death, dbuf, DTHSZ);
+        }
+        off = si_newentry(&tnew);
+        si_add(&kx, off);
+        si_add(&k0, off);
+        sidx.seq++;
+        sidx.count++;
+        rank0 = rank;
+        occ_cnt--;
+        /* drop this player's scores in excess of PERSMAX */
+        for (pos = si_below(&k0) + 1L;
+             si_select(pos, &k, &off) && k.cls == k0.cls;) {
+            si_readentry(off, t1);
+            if (si_samepers(t1, t0) && --occ_cnt < 0) {
+                kx.cls = 0L, kx.points = k.points, kx.seq = k.seq;
+                si_drop(&kx);
+            } else
+                pos++;
+        }
+        (void) si_trim();
+        changed = TRUE;
+
+        if (!done_stopprint) {
+            if (rank0 <= 10) {
+                topten_print("You made the top ten list!");
+            } else {
+                char pbuf[BUFSZ];
+
+                Sprintf(pbuf, "You reached the %ld%s place on the top %d list.",
+                        rank0, ordin((int) rank0), sysopt.entrymax);
+                topten_print(pbuf);
+            }
+            topten_print("");
+        }
+    }
+    if (changed) {
+        if (!si_commit()) {
+            HUP raw_print("Cannot write score index");
+        } else if (SI_BLOATED(sidx.eof, sidx.count)) {
+            (void) si_rebuild(FALSE);
+        }
+    }
+    unlock_file(RECORD);
+
+    if (rank0 == 0L)
+        rank0 = rank1;
+    if (rank0 <= 0L)
+        rank0 = sidx.count + 1L;
+    if (!done_stopprint) {
+        outheader();
+        /* only the ranks which will be shown get read */
+        for (rank = 1L; rank <= sidx.count; rank++) {
+            outside = (rank > flags.end_top
+                       && (rank < rank0 - flags.end_around
+                           || rank > rank0 + flags.end_around));
+            if (outside && !flags.end_own) {
+                if (rank > rank0)
+                    break;
+                rank = rank0 - flags.end_around - 1L;
+                continue;
+            }
+            (void) si_rankentry(rank, t1);
+            own = sysopt.pers_is_uid ? t1->uid == t0->uid
+                                     : !strncmp(t1->name, t0->name, NAMSZ);
+            if (outside && !own)
+                continue;
+            if (rank == rank0 - flags.end_around
+                && rank0 > flags.end_top + flags.end_around + 1
+                && !flags.end_own)
+                topten_print("");
+            if (rank != rank0)
+                outentry((int) rank, t1, FALSE);
+            else if (!rank1)
+                outentry((int) rank, t1, TRUE);
+            else {
+                outentry((int) rank, t1, TRUE);
+                outentry(0, t0, TRUE);
+            }
+        }
+        if (rank0 >= rank)
+            outentry(0, t0, TRUE);
+    }
+    dealloc_ttentry(t1);
+    si_close();
+    return TRUE;
+}
+
+/* is the index due for compaction?  (for the benchmark's log stress) */
+boolean
+score_index_bloated()
+{
+    boolean bloated;
+
+    if (!si_open(FALSE))
+        return FALSE;
+    bloated = SI_BLOATED(sidx.eof, sidx.count);
+    si_close();
+    return bloated;
+}
+#endif /* SCORE_INDEX */
+
 #ifdef NO_SCAN_BRACK
 /* Lattice scanf isn't up to reading the scorefile.  What */
 /* follows deals with that; I admit it's ugly. (KL) */
@@ -438,6 +438,7 @@ register int x, y, typ;
     if (!oldplace) {
         ttmp->ntrap = ftrap;
         ftrap = ttmp;
+        level.traps[x][y] = ttmp;
     } else {
         /* oldplace;
            it shouldn't be possible to override a sokoban pit or hole
@@ -4711,14 +4712,9 @@ struct trap *
 t_at(x, y)
 register int x, y;
 {
-    register struct trap *trap = ftrap;
-
-    while (trap) {
-        if (trap->tx == x && trap->ty == y)
-            return trap;
-        trap = trap->ntrap;
-    }
-    return (struct trap *) 0;
+    if (x < 0 || x >= COLNO || y < 0 || y >= ROWNO)
+        return (struct trap *) 0;
+    return level.traps[x][y];
 }
 
 void
@@ -4738,6 +4734,8 @@ register struct trap *trap;
             panic("deltrap: no preceding trap!");
         ttmp->ntrap = trap->ntrap;
     }
+    if (level.traps[trap->tx][trap->ty] == trap)
+        level.traps[trap->tx][trap->ty] = (struct trap *) 0;
     if (Sokoban && (trap->ttyp == PIT || trap->ttyp == HOLE))
         maybe_finish_sokoban();
     dealloc_trap(trap);
@@ -1338,6 +1338,7 @@ struct attack *mattk;
                 minvent_ptr = &otmp->nobj;
             }
         *minvent_ptr = stealoid; /* put armor back into minvent */
+        relink_nobj(mdef->minvent);
     }
 
     if (stealoid) { /* we will be taking everything */
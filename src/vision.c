@@ -93,6 +93,40 @@ static char *viz_clear_rows[ROWNO];
 static char left_ptrs[ROWNO][COLNO]; /* LOS algorithm helpers */
 static char right_ptrs[ROWNO][COLNO];
 
+#ifdef VISION_BITS
+/* viz_clear[][] again, one bit per location, for the bitset algorithm */
+typedef unsigned long vbword;
+#define VB_BITS ((int) (8 * sizeof (vbword)))
+#define VB_WORDS ((COLNO + VB_BITS - 1) / VB_BITS)
+#define vb_test(bits, col) (((bits)[(col) / VB_BITS] >> ((col) % VB_BITS)) & 1)
+#define vb_set(bits, col) ((bits)[(col) / VB_BITS] |= 1UL << ((col) % VB_BITS))
+#define vb_clr(bits, col) \
+    ((bits)[(col) / VB_BITS] &= ~(1UL << ((col) % VB_BITS)))
+static vbword viz_clear_bits[ROWNO][VB_WORDS];
+#endif
+
+/*
+ * Incremental recalculation.  Where the hero could see from a given
+ * spot and which locations a light source reaches depend only on the
+ * clear/blocked map, so both are kept from one vision_recalc() to the
+ * next: the hero's view until the hero moves, and the lit area of each
+ * light source (by position and range, see light_area()) until it
+ * moves.  Any change to viz_clear[][] drops whatever it could affect.
+ * With the wizard mode sanity_check option on, every reuse is checked
+ * against a full recalculation.
+ */
+static char hero_cs[ROWNO][COLNO]; /* the hero's COULD_SEE bits */
+static char hero_rmin[ROWNO], hero_rmax[ROWNO];
+static boolean hero_cs_valid = FALSE;
+static xchar hero_cs_x, hero_cs_y; /* where hero_cs[][] was seen from */
+
+#define LIT_CACHE_SIZE 128 /* power of 2 */
+static struct lit_area {
+    xchar x, y; /* light position; x == 0 for an unused entry */
+    int range;
+    unsigned long bits[2 * MAX_RADIUS + 1]; /* lit spots, one row each */
+} lit_cache[LIT_CACHE_SIZE];
+
 /* Forward declarations. */
 STATIC_DCL void FDECL(fill_point, (int, int));
 STATIC_DCL void FDECL(dig_point, (int, int));
@@ -101,6 +135,9 @@ STATIC_DCL void FDECL(view_from, (int, int, char **, char *, char *, int,
                                   void (*)(int, int, genericptr_t),
                                   genericptr_t));
 STATIC_DCL void FDECL(get_unused_cs, (char ***, char **, char **));
+STATIC_DCL void FDECL(hero_view, (char **, char *, char *));
+STATIC_DCL void FDECL(forget_blocked_area, (int, int));
+STATIC_DCL void FDECL(compute_lit_area, (int, int, int, unsigned long *));
 STATIC_DCL void FDECL(rogue_vision, (char **, char *, char *));
 
 /* Macro definitions that I can't find anywhere. */
@@ -171,9 +208,10 @@ register struct rm *lev;
         return 1;
 
     /* Boulders block light. */
-    for (obj = level.objects[x][y]; obj; obj = obj->nexthere)
-        if (obj->otyp == BOULDER)
-            return 1;
+    if (objsum_at(OSUM_BOULDER, x, y))
+        for (obj = level.objects[x][y]; obj; obj = obj->nexthere)
+            if (obj->otyp == BOULDER)
+                return 1;
 
     /* Mimics mimicing a door or boulder block light. */
     if ((mon = m_at(x, y)) && (!mon->minvis || See_invisible)
@@ -241,6 +279,16 @@ vision_reset()
             viz_clear[y][i] = !block;
         }
     }
+#ifdef VISION_BITS
+    (void) memset((genericptr_t) viz_clear_bits, 0, sizeof viz_clear_bits);
+    for (y = 0; y < ROWNO; y++)
+        for (x = 0; x < COLNO; x++)
+            if (viz_clear[y][x])
+                vb_set(viz_clear_bits[y], x);
+#endif
+
+    hero_cs_valid = FALSE;
+    (void) memset((genericptr_t) lit_cache, 0, sizeof lit_cache);
 
     iflags.vision_inited = 1; /* vision is ready */
     vision_full_recalc = 1;   /* we want to run vision_recalc() */
@@ -282,6 +330,72 @@ char **rmin, **rmax;
     }
 }
 
+/*
+ * hero_view()
+ *
+ * Set the COULD_SEE bits for the hero's position in an unused work area,
+ * from the copy kept by the previous call if the hero hasn't moved and
+ * nothing has been blocked or unblocked since.
+ */
+STATIC_OVL void
+hero_view(rows, rmin, rmax)
+char **rows;
+char *rmin, *rmax;
+{
+    static char chk_cs[ROWNO][COLNO];
+    static char *chk_rows[ROWNO];
+    char chk_rmin[ROWNO], chk_rmax[ROWNO];
+    int row, len;
+
+    if (!hero_cs_valid || hero_cs_x != u.ux || hero_cs_y != u.uy) {
+        view_from(u.uy, u.ux, rows, rmin, rmax, 0,
+                  (void FDECL((*), (int, int, genericptr_t))) 0,
+                  (genericptr_t) 0);
+        for (row = 0; row < ROWNO; row++) {
+            hero_rmin[row] = rmin[row];
+            hero_rmax[row] = rmax[row];
+            if ((len = rmax[row] - rmin[row] + 1) > 0)
+                (void) memcpy((genericptr_t) &hero_cs[row][(int) rmin[row]],
+                              (genericptr_t) &rows[row][(int) rmin[row]],
+                              len);
+        }
+        hero_cs_x = u.ux, hero_cs_y = u.uy;
+        hero_cs_valid = TRUE;
+        return;
+    }
+
+    for (row = 0; row < ROWNO; row++) {
+        rmin[row] = hero_rmin[row];
+        rmax[row] = hero_rmax[row];
+        if ((len = hero_rmax[row] - hero_rmin[row] + 1) > 0)
+            (void) memcpy((genericptr_t) &rows[row][(int) hero_rmin[row]],
+                          (genericptr_t) &hero_cs[row][(int) hero_rmin[row]],
+                          len);
+    }
+
+    if (iflags.sanity_check) {
+        /* compare with what the full algorithm makes of it */
+        (void) memset((genericptr_t) chk_cs, 0, sizeof chk_cs);
+        for (row = 0; row < ROWNO; row++) {
+            chk_rows[row] = chk_cs[row];
+            chk_rmin[row] = COLNO - 1;
+            chk_rmax[row] = 0;
+        }
+        view_from(u.uy, u.ux, chk_rows, chk_rmin, chk_rmax, 0,
+                  (void FDECL((*), (int, int, genericptr_t))) 0,
+                  (genericptr_t) 0);
+        for (row = 0; row < ROWNO; row++)
+            if (chk_rmin[row] != rmin[row] || chk_rmax[row] != rmax[row]
+                || memcmp((genericptr_t) chk_cs[row],
+                          (genericptr_t) rows[row], COLNO)) {
+                impossible("hero_view: stale view from <%d,%d>, row %d",
+                           u.ux, u.uy, row);
+                hero_cs_valid = FALSE;
+                break;
+            }
+    }
+}
+
 /*
  * rogue_vision()
  *
@@ -522,6 +636,7 @@ int control;
     vision_full_recalc = 0; /* reset flag */
     if (in_mklev || !iflags.vision_inited)
         return;
+    bench_begin(BENCH_VISION);
 
     /*
      * Either the light sources have been taken care of, or we must
@@ -546,9 +661,7 @@ int control;
          *
          *      + Monsters can see you even when you're in a pit.
          */
-        view_from(u.uy, u.ux, next_array, next_rmin, next_rmax, 0,
-                  (void FDECL((*), (int, int, genericptr_t))) 0,
-                  (genericptr_t) 0);
+        hero_view(next_array, next_rmin, next_rmax);
 
         /*
          * Our own version of the update loop below.  We know we can't see
@@ -611,9 +724,7 @@ int control;
                     next_row[col] = IN_SIGHT | COULD_SEE;
             }
         } else
-            view_from(u.uy, u.ux, next_array, next_rmin, next_rmax, 0,
-                      (void FDECL((*), (int, int, genericptr_t))) 0,
-                      (genericptr_t) 0);
+            hero_view(next_array, next_rmin, next_rmax);
 
         /*
          * Set the IN_SIGHT bit for xray and night vision.
@@ -833,6 +944,7 @@ skip:
     viz_rmax = next_rmax;
 
     recalc_mapseen();
+    bench_end(BENCH_VISION);
 }
 
 /*
@@ -876,6 +988,91 @@ int x, y;
         vision_full_recalc = 1;
 }
 
+/*
+ * forget_blocked_area()
+ *
+ * Location <x,y> has been blocked or unblocked; drop the saved views
+ * that might be affected.  The hero's view always goes: view_from()
+ * follows the left_ptrs[] and right_ptrs[] runs of the rows it scans,
+ * so even a spot the hero couldn't see, nowhere near anything that
+ * could be seen, can move the edges of what is seen.  A light source
+ * only looks along clear_path() lines that stay within its range, so
+ * only those in range of the spot need to go.
+ */
+STATIC_OVL void
+forget_blocked_area(x, y)
+int x, y;
+{
+    struct lit_area *la;
+
+    hero_cs_valid = FALSE;
+    for (la = lit_cache; la < &lit_cache[LIT_CACHE_SIZE]; la++)
+        if (la->x && v_abs(x - la->x) <= la->range
+            && v_abs(y - la->y) <= la->range)
+            la->x = 0;
+}
+
+/* find the locations that a light at <scol,srow> reaches */
+STATIC_OVL void
+compute_lit_area(scol, srow, range, bits)
+int scol, srow, range;
+unsigned long *bits; /* 2 * range + 1 rows, bit dx+range of each */
+{
+    char *limits = circle_ptr(range);
+    int x, y, offset;
+
+    for (y = srow - range; y <= srow + range; y++) {
+        bits[y - srow + range] = 0UL;
+        if (y < 0 || y >= ROWNO)
+            continue;
+        offset = limits[v_abs(y - srow)];
+        for (x = max(scol - offset, 0); x <= min(scol + offset, COLNO - 1);
+             x++)
+            if ((x == scol && y == srow) || clear_path(scol, srow, x, y))
+                bits[y - srow + range] |= 1UL << (x - scol + range);
+    }
+}
+
+/*
+ * light_area()
+ *
+ * Set TEMP_LIT on the locations reached by a light source of the given
+ * range at <scol,srow>.  Used by do_light_sources() for light sources
+ * away from the hero; the clear_path() walks that takes are remembered
+ * for the position and range until a nearby location changes opacity.
+ */
+void
+light_area(scol, srow, range, cs_rows)
+int scol, srow, range;
+char **cs_rows;
+{
+    struct lit_area *la;
+    unsigned long chk[2 * MAX_RADIUS + 1], rowbits;
+    int x, y;
+
+    la = &lit_cache[(scol * 7 + srow * 31 + range) & (LIT_CACHE_SIZE - 1)];
+    if (la->x != scol || la->y != srow || la->range != range) {
+        compute_lit_area(scol, srow, range, la->bits);
+        la->x = scol, la->y = srow, la->range = range;
+    } else if (iflags.sanity_check) {
+        compute_lit_area(scol, srow, range, chk);
+        for (y = 0; y <= 2 * range; y++)
+            if (chk[y] != la->bits[y]) {
+                impossible("light_area: stale lit area at <%d,%d>", scol,
+                           srow);
+                (void) memcpy((genericptr_t) la->bits, (genericptr_t) chk,
+                              sizeof chk);
+                break;
+            }
+    }
+
+    for (y = max(srow - range, 0); y <= min(srow + range, ROWNO - 1); y++)
+        if ((rowbits = la->bits[y - srow + range]) != 0UL)
+            for (x = scol - range; rowbits; x++, rowbits >>= 1)
+                if (rowbits & 1UL)
+                    cs_rows[y][x] |= TEMP_LIT;
+}
+
 /*==========================================================================*\
  |                                                                          |
  |      Everything below this line uses (y,x) instead of (x,y) --- the      |
@@ -933,6 +1130,10 @@ int row, col;
         return; /* already done */
 
     viz_clear[row][col] = 1;
+#ifdef VISION_BITS
+    vb_set(viz_clear_bits[row], col);
+#endif
+    forget_blocked_area(col, row);
 
     /*
      * Boundary cases first.
@@ -1018,6 +1219,10 @@ int row, col;
         return;
 
     viz_clear[row][col] = 0;
+#ifdef VISION_BITS
+    vb_clr(viz_clear_bits[row], col);
+#endif
+    forget_blocked_area(col, row);
 
     if (col == 0) {
         if (viz_clear[row][1]) { /* adjacent is clear */
@@ -2296,6 +2501,14 @@ genericptr_t arg;
 /*
  * Defines local to Algorithm C.
  */
+#ifdef VISION_BITS
+/* the bitset version below provides view_from(); this one stays as the
+   reference that vision_diff() compares it with */
+#define view_from c_view_from
+STATIC_DCL void FDECL(c_view_from, (int, int, char **, char *, char *, int,
+                                    void (*)(int, int, genericptr_t),
+                                    genericptr_t));
+#endif
 STATIC_DCL void FDECL(right_side, (int, int, int, char *));
 STATIC_DCL void FDECL(left_side, (int, int, int, char *));
 
@@ -2730,6 +2943,596 @@ genericptr_t arg;
     }
 }
 
+#ifdef VISION_BITS
+#undef view_from
+
+/*==========================================================================*\
+                            GENERAL LINE OF SIGHT
+                         Algorithm C with bitset rows
+\*==========================================================================*/
+
+/*
+ * The same scan as Algorithm C, row by row with the same recursion, but
+ * it reads the clear map from viz_clear_bits[][] and builds the "could
+ * see" rows as bitsets.  The left and right pointers are found by
+ * searching a row's words for the next clear or blocked bit, so
+ * left_ptrs[][] and right_ptrs[][] aren't used, and a run of visible
+ * locations is marked a word at a time.  The bitset rows are copied out
+ * to the caller's could see array at the end.
+ *
+ * vision_diff() runs this and Algorithm C from every location of the
+ * current level and counts the places where they disagree.
+ */
+static vbword cs_bits[ROWNO][VB_WORDS]; /* could see rows being built */
+
+#ifdef __GNUC__
+#define vb_low(w) __builtin_ctzl(w)
+#define vb_high(w) (VB_BITS - 1 - __builtin_clzl(w))
+#else
+STATIC_DCL int FDECL(vb_low, (vbword));
+STATIC_DCL int FDECL(vb_high, (vbword));
+#endif
+STATIC_DCL int FDECL(vb_next, (vbword *, int, int));
+STATIC_DCL int FDECL(vb_prev, (vbword *, int, int));
+STATIC_DCL int FDECL(vb_left_ptr, (int, int));
+STATIC_DCL int FDECL(vb_right_ptr, (int, int));
+STATIC_DCL void FDECL(vb_set_range, (int, int, int));
+STATIC_DCL int FDECL(vb_path, (int, int, int, int));
+STATIC_DCL void FDECL(vb_right_side, (int, int, int, char *));
+STATIC_DCL void FDECL(vb_left_side, (int, int, int, char *));
+STATIC_DCL void FDECL(vb_count, (int, int, genericptr_t));
+
+#ifndef __GNUC__
+/* index of the lowest set bit of a nonzero word */
+STATIC_OVL int
+vb_low(w)
+vbword w;
+{
+    int n = 0;
+
+    while (!(w & 1UL))
+        w >>= 1, n++;
+    return n;
+}
+
+/* index of the highest set bit of a nonzero word */
+STATIC_OVL int
+vb_high(w)
+vbword w;
+{
+    int n = 0;
+
+    while (w >>= 1)
+        n++;
+    return n;
+}
+#endif
+
+/* first column >= col whose bit is 'want', or COLNO if there is none */
+STATIC_OVL int
+vb_next(bits, col, want)
+vbword *bits;
+int col, want;
+{
+    int w = col / VB_BITS;
+    vbword word;
+
+    if (col >= COLNO)
+        return COLNO;
+    word = (want ? bits[w] : ~bits[w]) & (~0UL << (col % VB_BITS));
+    while (!word) {
+        if (++w >= VB_WORDS)
+            return COLNO;
+        word = want ? bits[w] : ~bits[w];
+    }
+    col = w * VB_BITS + vb_low(word);
+    return (col < COLNO) ? col : COLNO;
+}
+
+/* last column <= col whose bit is 'want', or -1 if there is none */
+STATIC_OVL int
+vb_prev(bits, col, want)
+vbword *bits;
+int col, want;
+{
+    int w = col / VB_BITS;
+    vbword word;
+
+    if (col < 0)
+        return -1;
+    word = want ? bits[w] : ~bits[w];
+    if (col % VB_BITS != VB_BITS - 1)
+        word &= (1UL << (col % VB_BITS + 1)) - 1;
+    while (!word) {
+        if (--w < 0)
+            return -1;
+        word = want ? bits[w] : ~bits[w];
+    }
+    return w * VB_BITS + vb_high(word);
+}
+
+/* left_ptrs[row][col], following the rules given above dig_point() */
+STATIC_OVL int
+vb_left_ptr(row, col)
+int row, col;
+{
+    vbword *clear = viz_clear_bits[row];
+
+    if (vb_test(clear, col))
+        return max(vb_prev(clear, col - 1, 0), 0);
+    return vb_prev(clear, col - 1, 1) + 1;
+}
+
+/* right_ptrs[row][col] */
+STATIC_OVL int
+vb_right_ptr(row, col)
+int row, col;
+{
+    vbword *clear = viz_clear_bits[row];
+
+    if (vb_test(clear, col))
+        return min(vb_next(clear, col + 1, 0), COLNO - 1);
+    return vb_next(clear, col + 1, 1) - 1;
+}
+
+/* mark columns first through last of a row as could see */
+STATIC_OVL void
+vb_set_range(row, first, last)
+int row, first, last;
+{
+    vbword *bits = cs_bits[row], mask;
+    int w, lastw = last / VB_BITS;
+
+    for (w = first / VB_BITS; w <= lastw; w++) {
+        mask = ~0UL;
+        if (w == first / VB_BITS)
+            mask <<= first % VB_BITS;
+        if (w == lastw && last % VB_BITS != VB_BITS - 1)
+            mask &= (1UL << (last % VB_BITS + 1)) - 1;
+        bits[w] |= mask;
+    }
+}
+
+/*
+ * clear_path() against the bitset map, for any quadrant.  This steps
+ * through the same locations as q1_path() .. q4_path().
+ */
+STATIC_OVL int
+vb_path(srow, scol, y2, x2)
+int srow, scol, y2, x2;
+{
+    int dx, dy, xs, ys;
+    register int k, err, x, y, dxs, dys;
+
+    x = scol;
+    y = srow;
+    xs = (x2 < x) ? -1 : 1;
+    ys = (y2 < y) ? -1 : 1;
+    dx = v_abs(x2 - x);
+    dy = v_abs(y2 - y);
+
+    dxs = dx << 1; /* save the shifted values */
+    dys = dy << 1;
+    if (dy > dx) {
+        err = dxs - dy;
+
+        for (k = dy - 1; k; k--) {
+            if (err >= 0) {
+                x += xs;
+                err -= dys;
+            }
+            y += ys;
+            err += dxs;
+            if (!vb_test(viz_clear_bits[y], x))
+                return 0; /* blocked */
+        }
+    } else {
+        err = dys - dx;
+
+        for (k = dx - 1; k; k--) {
+            if (err >= 0) {
+                y += ys;
+                err -= dxs;
+            }
+            x += xs;
+            err += dys;
+            if (!vb_test(viz_clear_bits[y], x))
+                return 0; /* blocked */
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * right_side() for bitset rows.  See right_side() in Algorithm C for
+ * the comments.
+ */
+STATIC_OVL void
+vb_right_side(row, left, right_mark, limits)
+int row, left, right_mark;
+char *limits;
+{
+    int right, right_edge, nrow, deeper;
+    register int i;
+    char *row_min = NULL;
+    char *row_max = NULL;
+    int lim_max;
+
+    nrow = row + step;
+    deeper = good_row(nrow) && (!limits || (*limits >= *(limits + 1)));
+    if (!vis_func) {
+        row_min = &cs_left[row];
+        row_max = &cs_right[row];
+    }
+    if (limits) {
+        lim_max = start_col + *limits;
+        if (lim_max > COLNO - 1)
+            lim_max = COLNO - 1;
+        if (right_mark > lim_max)
+            right_mark = lim_max;
+        limits++; /* prepare for next row */
+    } else
+        lim_max = COLNO - 1;
+
+    while (left <= right_mark) {
+        right_edge = vb_right_ptr(row, left);
+        if (right_edge > lim_max)
+            right_edge = lim_max;
+
+        if (!vb_test(viz_clear_bits[row], left)) {
+            /* Jump to the far side of a stone wall. */
+            if (right_edge > right_mark) {
+                /* Maybe see more (kludge). */
+                right_edge = vb_test(viz_clear_bits[row - step], right_mark)
+                                 ? right_mark + 1
+                                 : right_mark;
+            }
+            if (vis_func) {
+                for (i = left; i <= right_edge; i++)
+                    (*vis_func)(i, row, varg);
+            } else {
+                vb_set_range(row, left, right_edge);
+                set_min(left);
+                set_max(right_edge);
+            }
+            left = right_edge + 1; /* no limit check necessary */
+            continue;
+        }
+
+        if (left != start_col) {
+            /* Find the left side. */
+            for (; left <= right_edge; left++)
+                if (vb_path(start_row, start_col, row, left))
+                    break;
+
+            /* Check for boundary conditions. */
+            if (left > lim_max)
+                return;
+            if (left == lim_max) {
+                if (vis_func) {
+                    (*vis_func)(lim_max, row, varg);
+                } else {
+                    vb_set_range(row, lim_max, lim_max);
+                    set_max(lim_max);
+                }
+                return;
+            }
+            /* Check if we can see any spots in the opening. */
+            if (left >= right_edge) {
+                left = right_edge;
+                continue;
+            }
+        }
+
+        /* Find the right side. */
+        if (right_mark < right_edge) {
+            for (right = right_mark; right <= right_edge; right++)
+                if (!vb_path(start_row, start_col, row, right))
+                    break;
+            --right; /* get rid of the last increment */
+        } else
+            right = right_edge;
+
+        if (left <= right) {
+            /* An ugly special case. */
+            if (left == right && left == start_col && start_col < (COLNO - 1)
+                && !vb_test(viz_clear_bits[row], start_col + 1))
+                right = start_col + 1;
+
+            if (right > lim_max)
+                right = lim_max;
+            if (vis_func) {
+                for (i = left; i <= right; i++)
+                    (*vis_func)(i, row, varg);
+            } else {
+                vb_set_range(row, left, right);
+                set_min(left);
+                set_max(right);
+            }
+
+            /* Recurse */
+            if (deeper)
+                vb_right_side(nrow, left, right, limits);
+            left = right + 1; /* no limit check necessary */
+        }
+    }
+}
+
+/* The mirror image of vb_right_side(). */
+STATIC_OVL void
+vb_left_side(row, left_mark, right, limits)
+int row, left_mark, right;
+char *limits;
+{
+    int left, left_edge, nrow, deeper;
+    register int i;
+    char *row_min = NULL;
+    char *row_max = NULL;
+    int lim_min;
+
+    nrow = row + step;
+    deeper = good_row(nrow) && (!limits || (*limits >= *(limits + 1)));
+    if (!vis_func) {
+        row_min = &cs_left[row];
+        row_max = &cs_right[row];
+    }
+    if (limits) {
+        lim_min = start_col - *limits;
+        if (lim_min < 0)
+            lim_min = 0;
+        if (left_mark < lim_min)
+            left_mark = lim_min;
+        limits++; /* prepare for next row */
+    } else
+        lim_min = 0;
+
+    while (right >= left_mark) {
+        left_edge = vb_left_ptr(row, right);
+        if (left_edge < lim_min)
+            left_edge = lim_min;
+
+        if (!vb_test(viz_clear_bits[row], right)) {
+            /* Jump to the far side of a stone wall. */
+            if (left_edge < left_mark) {
+                /* Maybe see more (kludge). */
+                left_edge = vb_test(viz_clear_bits[row - step], left_mark)
+                                ? left_mark - 1
+                                : left_mark;
+            }
+            if (vis_func) {
+                for (i = left_edge; i <= right; i++)
+                    (*vis_func)(i, row, varg);
+            } else {
+                vb_set_range(row, left_edge, right);
+                set_min(left_edge);
+                set_max(right);
+            }
+            right = left_edge - 1; /* no limit check necessary */
+            continue;
+        }
+
+        if (right != start_col) {
+            /* Find the right side. */
+            for (; right >= left_edge; right--)
+                if (vb_path(start_row, start_col, row, right))
+                    break;
+
+            /* Check for boundary conditions. */
+            if (right < lim_min)
+                return;
+            if (right == lim_min) {
+                if (vis_func) {
+                    (*vis_func)(lim_min, row, varg);
+                } else {
+                    vb_set_range(row, lim_min, lim_min);
+                    set_min(lim_min);
+                }
+                return;
+            }
+            /* Check if we can see any spots in the opening. */
+            if (right <= left_edge) {
+                right = left_edge;
+                continue;
+            }
+        }
+
+        /* Find the left side. */
+        if (left_mark > left_edge) {
+            for (left = left_mark; left >= left_edge; --left)
+                if (!vb_path(start_row, start_col, row, left))
+                    break;
+            left++; /* get rid of the last decrement */
+        } else
+            left = left_edge;
+
+        if (left <= right) {
+            /* An ugly special case. */
+            if (left == right && right == start_col && start_col > 0
+                && !vb_test(viz_clear_bits[row], start_col - 1))
+                left = start_col - 1;
+
+            if (left < lim_min)
+                left = lim_min;
+            if (vis_func) {
+                for (i = left; i <= right; i++)
+                    (*vis_func)(i, row, varg);
+            } else {
+                vb_set_range(row, left, right);
+                set_min(left);
+                set_max(right);
+            }
+
+            /* Recurse */
+            if (deeper)
+                vb_left_side(nrow, left, right, limits);
+            right = left - 1; /* no limit check necessary */
+        }
+    }
+}
+
+/*
+ * Calculate all possible visible locations from the given location
+ * (srow,scol).  NOTE this is (y,x)!  Mark the visible locations in the
+ * array provided.
+ */
+STATIC_OVL void
+view_from(srow, scol, loc_cs_rows, left_most, right_most, range, func, arg)
+int srow, scol;     /* starting row and column */
+char **loc_cs_rows; /* pointers to the rows of the could_see array */
+char *left_most;    /* min mark on each row */
+char *right_most;   /* max mark on each row */
+int range;          /* 0 if unlimited */
+void FDECL((*func), (int, int, genericptr_t));
+genericptr_t arg;
+{
+    register int i;
+    int row, w, left, right;
+    char *rowp, *limits;
+    vbword word;
+
+    start_col = scol;
+    start_row = srow;
+    cs_rows = loc_cs_rows;
+    cs_left = left_most;
+    cs_right = right_most;
+    vis_func = func;
+    varg = arg;
+    if (!func)
+        (void) memset((genericptr_t) cs_bits, 0, sizeof cs_bits);
+
+    /* Determine extent of sight on the starting row. */
+    if (vb_test(viz_clear_bits[srow], scol)) {
+        left = vb_left_ptr(srow, scol);
+        right = vb_right_ptr(srow, scol);
+    } else {
+        /* In stone, only the adjacent squares are visible. */
+        left = (!scol) ? 0
+                       : (vb_test(viz_clear_bits[srow], scol - 1)
+                              ? vb_left_ptr(srow, scol - 1)
+                              : scol - 1);
+        right = (scol == COLNO - 1)
+                    ? COLNO - 1
+                    : (vb_test(viz_clear_bits[srow], scol + 1)
+                           ? vb_right_ptr(srow, scol + 1)
+                           : scol + 1);
+    }
+
+    if (range) {
+        if (range > MAX_RADIUS || range < 1)
+            panic("view_from called with range %d", range);
+        limits = circle_ptr(range) + 1; /* start at next row */
+        if (left < scol - range)
+            left = scol - range;
+        if (right > scol + range)
+            right = scol + range;
+    } else
+        limits = (char *) 0;
+
+    if (func) {
+        for (i = left; i <= right; i++)
+            (*func)(i, srow, arg);
+    } else {
+        vb_set_range(srow, left, right);
+        cs_left[srow] = left;
+        cs_right[srow] = right;
+    }
+
+    if (srow + 1 < ROWNO) { /* move down */
+        step = 1;
+        if (scol < COLNO - 1)
+            vb_right_side(srow + 1, scol, right, limits);
+        if (scol)
+            vb_left_side(srow + 1, left, scol, limits);
+    }
+
+    if (srow - 1 >= 0) { /* move up */
+        step = -1;
+        if (scol < COLNO - 1)
+            vb_right_side(srow - 1, scol, right, limits);
+        if (scol)
+            vb_left_side(srow - 1, left, scol, limits);
+    }
+
+    if (func)
+        return;
+    /* copy the bitset rows out to the caller's array */
+    for (row = 0; row < ROWNO; row++) {
+        rowp = cs_rows[row];
+        for (w = 0; w < VB_WORDS; w++)
+            for (word = cs_bits[row][w]; word; word &= word - 1)
+                rowp[w * VB_BITS + vb_low(word)] = COULD_SEE;
+    }
+}
+
+/* view_from() callback for vision_diff(): count the visits to a spot */
+STATIC_OVL void
+vb_count(x, y, arg)
+int x, y;
+genericptr_t arg;
+{
+    ((int *) arg)[y * COLNO + x]++;
+}
+
+/*
+ * vision_diff()
+ *
+ * Compare the bitset view_from() with Algorithm C's from every location
+ * of the current level, without a range limit and at a few light source
+ * ranges, both filling in a could see array and calling a function for
+ * each spot.  Returns the number of viewpoints where they differ.
+ */
+int
+vision_diff()
+{
+    static char c_cs[ROWNO][COLNO], b_cs[ROWNO][COLNO];
+    static char *c_rows[ROWNO], *b_rows[ROWNO];
+    static int c_hits[ROWNO][COLNO], b_hits[ROWNO][COLNO];
+    static const int ranges[] = { 0, 1, 3, MAX_RADIUS };
+    char c_min[ROWNO], c_max[ROWNO], b_min[ROWNO], b_max[ROWNO];
+    int x, y, r, row, ndiff = 0;
+
+    for (row = 0; row < ROWNO; row++) {
+        c_rows[row] = c_cs[row];
+        b_rows[row] = b_cs[row];
+    }
+    for (y = 0; y < ROWNO; y++)
+        for (x = 1; x < COLNO; x++)
+            for (r = 0; r < SIZE(ranges); r++) {
+                (void) memset((genericptr_t) c_cs, 0, sizeof c_cs);
+                (void) memset((genericptr_t) b_cs, 0, sizeof b_cs);
+                (void) memset((genericptr_t) c_hits, 0, sizeof c_hits);
+                (void) memset((genericptr_t) b_hits, 0, sizeof b_hits);
+                for (row = 0; row < ROWNO; row++) {
+                    c_min[row] = b_min[row] = COLNO - 1;
+                    c_max[row] = b_max[row] = 0;
+                }
+                c_view_from(y, x, c_rows, c_min, c_max, ranges[r],
+                            (void FDECL((*), (int, int, genericptr_t))) 0,
+                            (genericptr_t) 0);
+                view_from(y, x, b_rows, b_min, b_max, ranges[r],
+                          (void FDECL((*), (int, int, genericptr_t))) 0,
+                          (genericptr_t) 0);
+                c_view_from(y, x, (char **) 0, (char *) 0, (char *) 0,
+                            ranges[r], vb_count, (genericptr_t) c_hits);
+                view_from(y, x, (char **) 0, (char *) 0, (char *) 0,
+                          ranges[r], vb_count, (genericptr_t) b_hits);
+                if (memcmp((genericptr_t) c_cs, (genericptr_t) b_cs,
+                           sizeof c_cs)
+                    || memcmp((genericptr_t) c_min, (genericptr_t) b_min,
+                              sizeof c_min)
+                    || memcmp((genericptr_t) c_max, (genericptr_t) b_max,
+                              sizeof c_max)
+                    || memcmp((genericptr_t) c_hits, (genericptr_t) b_hits,
+                              sizeof c_hits)) {
+                    ndiff++;
+                    break;
+                }
+            }
+    return ndiff;
+}
+
+#endif /* VISION_BITS */
 #endif /*===== End of algorithm C =====*/
 
 /*
@@ -4072,6 +4072,7 @@ const char *msg;
 #endif
         lev->icedpool = 0;
     }
+    update_bitboards(x, y);
     spot_stop_timers(x, y, MELT_ICE_AWAY); /* no more ice to melt away */
     obj_ice_effects(x, y, FALSE);
     unearth_objs(x, y);
@@ -4187,6 +4188,7 @@ short exploding_wand_typ;
             } else {
                 rangemod -= 3;
                 lev->typ = ROOM;
+                update_bitboards(x, y);
                 t = maketrap(x, y, PIT);
                 if (t)
                     t->tseen = 1;
@@ -4227,6 +4229,7 @@ short exploding_wand_typ;
                             (lev->typ == POOL ? ICED_POOL : ICED_MOAT);
                     lev->typ = (lava ? ROOM : ICE);
                 }
+                update_bitboards(x, y);
                 bury_objs(x, y);
                 if (see_it) {
                     if (lava)
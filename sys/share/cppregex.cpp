@@ -4,6 +4,7 @@
 
 #include <regex>
 #include <memory>
+#include <vector>
 
 /* nhregex interface documented in sys/share/posixregex.c */
 
@@ -57,4 +58,30 @@ extern "C" {
   void regex_free(struct nhregex *re) {
     delete re;
   }
+
+  struct nhregex_set {
+    std::vector<struct nhregex *> res;
+  };
+
+  struct nhregex_set *regex_set_init(void) {
+    return new nhregex_set;
+  }
+
+  void regex_set_add(struct nhregex_set *set, struct nhregex *re) {
+    if (set && re)
+      set->res.push_back(re);
+  }
+
+  int regex_set_match(const char *s, struct nhregex_set *set, int start) {
+    if (!set || !s)
+      return -1;
+    for (size_t i = start < 0 ? 0 : start; i < set->res.size(); ++i)
+      if (regex_match(s, set->res[i]))
+        return (int) i;
+    return -1;
+  }
+
+  void regex_set_free(struct nhregex_set *set) {
+    delete set;
+  }
 }
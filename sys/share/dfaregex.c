@@ -0,0 +1,1166 @@
+/* NetHack 3.6  dfaregex.c	$NHDT-Date$  $NHDT-Branch$:$NHDT-Revision$ */
+/* NetHack may be freely redistributed.  See license for details. */
+
+#include "hack.h"
+
+#include <ctype.h>
+
+/* nhregex interface documented in sys/share/posixregex.c */
+
+/* Implementation of the regex engine with no library support: the
+ * expression is parsed into a tree, the tree is compiled into a
+ * Thompson NFA, and the NFA is turned into a DFA a state at a time as
+ * strings are matched.  Once the states a string passes through have
+ * been built each character costs one table lookup, and building a
+ * state costs time proportional to the size of the NFA, so matching is
+ * always linear in the length of the string; no pattern can make it
+ * backtrack.  The states are cached per expression and the cache is
+ * simply emptied when it fills up.
+ *
+ * A regex set is compiled into a single automaton whose match states
+ * record which members they belong to, so a string is tested against
+ * every member in one pass.
+ *
+ * POSIX extended regular expressions are supported, as matched by
+ * regexec() without REG_ICASE or REG_NEWLINE, except for:
+ *  - back-references (\1 to \9) and the GNU \b \B \< \> \` \' operators,
+ *    which are compile errors; the GNU \w \W \s \S classes work;
+ *  - multi-character collating elements, such as [[.ch.]];
+ *  - a repetition operator with nothing to repeat, such as "*a" or
+ *    "a|+b", which is an error rather than a literal character.
+ * An unmatched ')' is an ordinary character, as is a '{' which does not
+ * begin a valid interval.
+ */
+
+const char regex_id[] = "dfaregex";
+
+#define RX_MAXNODES 32000  /* NFA size limit */
+#define RX_MINSTATES 16    /* initial size of the DFA state table */
+#define RX_MAXSTATES 1024  /* DFA states cached before starting over */
+#define RX_DUPMAX 255      /* largest {m,n} count */
+
+#define RXBITS (8 * (int) sizeof (unsigned long))
+
+/* parse tree */
+#define RXT_EMPTY 0
+#define RXT_CLASS 1 /* one character out of cls */
+#define RXT_BOL 2
+#define RXT_EOL 3
+#define RXT_CAT 4
+#define RXT_ALT 5
+#define RXT_REPEAT 6 /* left, min to max times; max -1 is unbounded */
+
+struct rxtree {
+    int type;
+    int cls;
+    int min, max;
+    struct rxtree *left, *right;
+};
+
+/* NFA nodes */
+#define RXN_CLASS 0 /* consume a character in cls and go to out */
+#define RXN_SPLIT 1 /* go to both out and out1 */
+#define RXN_BOL 2   /* go to out at the start of the string */
+#define RXN_EOL 3   /* go to out at the end of the string */
+#define RXN_MATCH 4 /* member 'arg' of the set has matched */
+
+struct rxnode {
+    int type;
+    int out, out1;
+    int arg; /* class for RXN_CLASS, member for RXN_MATCH */
+};
+
+/* a DFA state is the set of NFA nodes (character tests, end-of-string
+   tests and matches) that are live at some point of the string */
+struct rxstate {
+    int *nodes, nnodes;
+    unsigned long hash;
+    boolean bol;      /* at the start of the string */
+    boolean eoldone;  /* eolmask is valid */
+    int *next;        /* successor for each byte class; -1 if not built */
+    unsigned long *mask, *eolmask; /* members matched, matched at end */
+};
+
+struct rxprog {
+    struct rxnode *node;
+    int nnode, nodesz;
+    uchar (*cls)[32]; /* character classes as bitmaps */
+    int ncls, clssz;
+    int single[256]; /* class holding just one character, or -1 */
+    int start, npat, mwords;
+    /* set up by rx_finish() */
+    uchar bytemap[256]; /* byte class of each character */
+    uchar rep[256];     /* a character from each byte class */
+    int nbc;
+    int *mark, markgen, *stack, *buf, nbuf;
+    unsigned long *acc;
+    /* the DFA built so far */
+    struct rxstate **ds;
+    int nds, dssz, initial, flushes;
+    int *hash; /* 2 * dssz slots, open addressing, -1 is empty */
+};
+
+struct nhregex {
+    char *pat;
+    const char *err;
+    struct rxprog *prog;
+};
+
+struct nhregex_set {
+    struct nhregex **res;
+    int count, size;
+    struct rxprog *prog;
+    boolean built; /* prog is current, or 0 if members must be tried */
+};
+
+struct rxparse {
+    const char *p;
+    const char *err;
+    int depth;
+    struct rxprog *prog;
+};
+
+#define rx_inclass(P, C, B) \
+    (((P)->cls[C][(B) >> 3] & (1 << ((B) & 7))) != 0)
+#define rx_setbit(M, B) ((M)[(B) / RXBITS] |= 1UL << ((B) % RXBITS))
+#define rx_testbit(M, B) \
+    (((M)[(B) / RXBITS] & (1UL << ((B) % RXBITS))) != 0)
+
+STATIC_DCL struct rxprog *NDECL(rx_newprog);
+STATIC_DCL void FDECL(rx_freeprog, (struct rxprog *));
+STATIC_DCL int FDECL(rx_newclass, (struct rxprog *, uchar *));
+STATIC_DCL int FDECL(rx_charclass, (struct rxprog *, int));
+STATIC_DCL struct rxtree *FDECL(rx_tree, (int, struct rxtree *,
+                                          struct rxtree *));
+STATIC_DCL void FDECL(rx_freetree, (struct rxtree *));
+STATIC_DCL boolean FDECL(rx_namedclass, (const char *, int, uchar *));
+STATIC_DCL int FDECL(rx_bracketchar, (struct rxparse *));
+STATIC_DCL struct rxtree *FDECL(rx_bracket, (struct rxparse *));
+STATIC_DCL struct rxtree *FDECL(rx_escape, (struct rxparse *));
+STATIC_DCL struct rxtree *FDECL(rx_atom, (struct rxparse *));
+STATIC_DCL boolean FDECL(rx_interval, (struct rxparse *, int *, int *));
+STATIC_DCL struct rxtree *FDECL(rx_piece, (struct rxparse *));
+STATIC_DCL struct rxtree *FDECL(rx_branch, (struct rxparse *));
+STATIC_DCL struct rxtree *FDECL(rx_regexp, (struct rxparse *));
+STATIC_DCL int FDECL(rx_node, (struct rxprog *, int, int, int, int));
+STATIC_DCL int FDECL(rx_compile, (struct rxprog *, struct rxtree *, int));
+STATIC_DCL const char *FDECL(rx_addpattern, (struct rxprog *,
+                                             const char *, int));
+STATIC_DCL void FDECL(rx_finish, (struct rxprog *));
+STATIC_DCL void FDECL(rx_closure, (struct rxprog *, int, BOOLEAN_P,
+                                   BOOLEAN_P));
+STATIC_DCL void FDECL(rx_flush, (struct rxprog *));
+STATIC_DCL void FDECL(rx_grow, (struct rxprog *));
+STATIC_DCL int FDECL(rx_state, (struct rxprog *, BOOLEAN_P));
+STATIC_DCL int FDECL(rx_step, (struct rxprog *, int, int));
+STATIC_DCL unsigned long *FDECL(rx_eolmask, (struct rxprog *, int));
+STATIC_DCL int FDECL(rx_run, (struct rxprog *, const char *, int));
+STATIC_DCL int FDECL(rx_cmpint, (const genericptr, const genericptr));
+
+/*
+ * Programs.
+ */
+
+STATIC_OVL struct rxprog *
+rx_newprog()
+{
+    struct rxprog *p = (struct rxprog *) alloc(sizeof (struct rxprog));
+    int i;
+
+    (void) memset((genericptr_t) p, 0, sizeof (struct rxprog));
+    for (i = 0; i < 256; i++)
+        p->single[i] = -1;
+    p->start = -1;
+    p->initial = -1;
+    return p;
+}
+
+STATIC_OVL void
+rx_freeprog(p)
+struct rxprog *p;
+{
+    if (!p)
+        return;
+    rx_flush(p);
+    if (p->node)
+        free((genericptr_t) p->node);
+    if (p->cls)
+        free((genericptr_t) p->cls);
+    if (p->mark) {
+        free((genericptr_t) p->mark);
+        free((genericptr_t) p->stack);
+        free((genericptr_t) p->buf);
+        free((genericptr_t) p->acc);
+        free((genericptr_t) p->ds);
+        free((genericptr_t) p->hash);
+    }
+    free((genericptr_t) p);
+}
+
+/* add a character class to the program, returning its index */
+STATIC_OVL int
+rx_newclass(p, bits)
+struct rxprog *p;
+uchar *bits;
+{
+    if (p->ncls == p->clssz) {
+        uchar(*newcls)[32];
+
+        p->clssz = p->clssz ? 2 * p->clssz : 32;
+        newcls = (uchar(*)[32]) alloc((unsigned) p->clssz * 32);
+        if (p->ncls)
+            (void) memcpy((genericptr_t) newcls, (genericptr_t) p->cls,
+                          (size_t) p->ncls * 32);
+        if (p->cls)
+            free((genericptr_t) p->cls);
+        p->cls = newcls;
+    }
+    (void) memcpy((genericptr_t) p->cls[p->ncls], (genericptr_t) bits, 32);
+    return p->ncls++;
+}
+
+STATIC_OVL int
+rx_charclass(p, c)
+struct rxprog *p;
+int c;
+{
+    uchar bits[32];
+
+    if (p->single[c] < 0) {
+        (void) memset((genericptr_t) bits, 0, sizeof bits);
+        bits[c >> 3] |= 1 << (c & 7);
+        p->single[c] = rx_newclass(p, bits);
+    }
+    return p->single[c];
+}
+
+/*
+ * Parsing.
+ */
+
+STATIC_OVL struct rxtree *
+rx_tree(type, left, right)
+int type;
+struct rxtree *left, *right;
+{
+    struct rxtree *t = (struct rxtree *) alloc(sizeof (struct rxtree));
+
+    t->type = type;
+    t->cls = 0;
+    t->min = t->max = 0;
+    t->left = left;
+    t->right = right;
+    return t;
+}
+
+STATIC_OVL void
+rx_freetree(t)
+struct rxtree *t;
+{
+    if (t) {
+        rx_freetree(t->left);
+        rx_freetree(t->right);
+        free((genericptr_t) t);
+    }
+}
+
+/* set the bits of a [:name:] class, or the \w and \s escapes */
+STATIC_OVL boolean
+rx_namedclass(name, len, bits)
+const char *name;
+int len;
+uchar *bits;
+{
+    static const char *const names[] = {
+        "alpha", "digit", "alnum", "upper", "lower", "space",
+        "blank", "punct", "print", "graph", "cntrl", "xdigit", "word",
+    };
+    int i, c, in, which = -1;
+
+    for (i = 0; i < SIZE(names); i++)
+        if ((int) strlen(names[i]) == len && !strncmp(name, names[i], len))
+            which = i;
+    if (which < 0)
+        return FALSE;
+    for (c = 1; c < 256; c++) {
+        switch (which) {
+        case 0: in = (isalpha(c) != 0); break;
+        case 1: in = (isdigit(c) != 0); break;
+        case 2: in = (isalnum(c) != 0); break;
+        case 3: in = (isupper(c) != 0); break;
+        case 4: in = (islower(c) != 0); break;
+        case 5: in = (isspace(c) != 0); break;
+        case 6: in = (c == ' ' || c == '\t'); break;
+        case 7: in = (ispunct(c) != 0); break;
+        case 8: in = (isprint(c) != 0); break;
+        case 9: in = (isgraph(c) != 0); break;
+        case 10: in = (iscntrl(c) != 0); break;
+        case 11: in = (isxdigit(c) != 0); break;
+        default: in = (isalnum(c) || c == '_'); break;
+        }
+        if (in)
+            bits[c >> 3] |= 1 << (c & 7);
+    }
+    return TRUE;
+}
+
+/* one character of a bracket expression, or [.c.] or [=c=]; -1 for
+   anything else */
+STATIC_OVL int
+rx_bracketchar(ps)
+struct rxparse *ps;
+{
+    const char *p = ps->p;
+
+    if (p[0] == '[' && (p[1] == '.' || p[1] == '=')) {
+        if (!p[2] || p[3] != p[1] || p[4] != ']') {
+            ps->err = "Invalid collation character";
+            return -1;
+        }
+        ps->p += 5;
+        return (uchar) p[2];
+    }
+    if (!*p) {
+        ps->err = "Unmatched [ or [^";
+        return -1;
+    }
+    ps->p++;
+    return (uchar) *p;
+}
+
+/* bracket expression; ps->p is just past the '[' */
+STATIC_OVL struct rxtree *
+rx_bracket(ps)
+struct rxparse *ps;
+{
+    uchar bits[32];
+    struct rxtree *t;
+    boolean negate = FALSE, first = TRUE;
+    int c, hi, i;
+
+    (void) memset((genericptr_t) bits, 0, sizeof bits);
+    if (*ps->p == '^')
+        negate = TRUE, ps->p++;
+    while (first || *ps->p != ']') {
+        first = FALSE;
+        if (ps->p[0] == '[' && ps->p[1] == ':') {
+            const char *end = strstr(ps->p + 2, ":]");
+
+            if (!end || !rx_namedclass(ps->p + 2, (int) (end - ps->p - 2),
+                                       bits)) {
+                ps->err = "Invalid character class name";
+                return (struct rxtree *) 0;
+            }
+            ps->p = end + 2;
+            continue;
+        }
+        if ((c = rx_bracketchar(ps)) < 0)
+            return (struct rxtree *) 0;
+        hi = c;
+        if (ps->p[0] == '-' && ps->p[1] && ps->p[1] != ']') {
+            ps->p++;
+            if ((hi = rx_bracketchar(ps)) < 0)
+                return (struct rxtree *) 0;
+            if (hi < c) {
+                ps->err = "Invalid range end";
+                return (struct rxtree *) 0;
+            }
+        }
+        for (; c <= hi; c++)
+            bits[c >> 3] |= 1 << (c & 7);
+    }
+    ps->p++; /* ']' */
+    if (negate)
+        for (i = 0; i < 32; i++)
+            bits[i] = ~bits[i];
+    bits[0] &= ~1; /* NUL never matches */
+    t = rx_tree(RXT_CLASS, (struct rxtree *) 0, (struct rxtree *) 0);
+    t->cls = rx_newclass(ps->prog, bits);
+    return t;
+}
+
+/* backslash escape; ps->p is just past the backslash */
+STATIC_OVL struct rxtree *
+rx_escape(ps)
+struct rxparse *ps;
+{
+    uchar bits[32];
+    struct rxtree *t;
+    int c = (uchar) *ps->p, i;
+
+    if (!c) {
+        ps->err = "Trailing backslash";
+        return (struct rxtree *) 0;
+    }
+    if ((c >= '1' && c <= '9') || index("bB<>`'", c)) {
+        ps->err = "Unsupported backslash operator";
+        return (struct rxtree *) 0;
+    }
+    ps->p++;
+    t = rx_tree(RXT_CLASS, (struct rxtree *) 0, (struct rxtree *) 0);
+    if (index("wWsS", c)) {
+        (void) memset((genericptr_t) bits, 0, sizeof bits);
+        (void) rx_namedclass((c == 'w' || c == 'W') ? "word" : "space",
+                             (c == 'w' || c == 'W') ? 4 : 5, bits);
+        if (c == 'W' || c == 'S') {
+            for (i = 0; i < 32; i++)
+                bits[i] = ~bits[i];
+            bits[0] &= ~1;
+        }
+        t->cls = rx_newclass(ps->prog, bits);
+    } else {
+        t->cls = rx_charclass(ps->prog, c);
+    }
+    return t;
+}
+
+STATIC_OVL struct rxtree *
+rx_atom(ps)
+struct rxparse *ps;
+{
+    uchar bits[32];
+    struct rxtree *t;
+    int c = (uchar) *ps->p++;
+
+    switch (c) {
+    case '(':
+        ps->depth++;
+        t = rx_regexp(ps);
+        ps->depth--;
+        if (!t)
+            return t;
+        if (*ps->p != ')') {
+            rx_freetree(t);
+            ps->err = "Unmatched ( or \\(";
+            return (struct rxtree *) 0;
+        }
+        ps->p++;
+        return t;
+    case '[':
+        return rx_bracket(ps);
+    case '\\':
+        return rx_escape(ps);
+    case '^':
+        return rx_tree(RXT_BOL, (struct rxtree *) 0, (struct rxtree *) 0);
+    case '$':
+        return rx_tree(RXT_EOL, (struct rxtree *) 0, (struct rxtree *) 0);
+    case '.':
+        (void) memset((genericptr_t) bits, 0xff, sizeof bits);
+        bits[0] &= ~1;
+        t = rx_tree(RXT_CLASS, (struct rxtree *) 0, (struct rxtree *) 0);
+        t->cls = rx_newclass(ps->prog, bits);
+        return t;
+    case '*':
+    case '+':
+    case '?':
+        ps->err = "Invalid preceding regular expression";
+        return (struct rxtree *) 0;
+    default:
+        t = rx_tree(RXT_CLASS, (struct rxtree *) 0, (struct rxtree *) 0);
+        t->cls = rx_charclass(ps->prog, c);
+        return t;
+    }
+}
+
+/* parse "{m}", "{m,}" or "{m,n}" at ps->p; FALSE if it isn't one */
+STATIC_OVL boolean
+rx_interval(ps, minp, maxp)
+struct rxparse *ps;
+int *minp, *maxp;
+{
+    const char *p = ps->p + 1;
+    int lo = 0, hi;
+
+    if (!digit(*p))
+        return FALSE;
+    while (digit(*p) && lo <= RX_DUPMAX)
+        lo = 10 * lo + (*p++ - '0');
+    hi = lo;
+    if (*p == ',') {
+        p++;
+        hi = -1;
+        if (digit(*p))
+            for (hi = 0; digit(*p) && hi <= RX_DUPMAX;)
+                hi = 10 * hi + (*p++ - '0');
+    }
+    if (*p != '}')
+        return FALSE;
+    if (lo > RX_DUPMAX || hi > RX_DUPMAX || (hi >= 0 && hi < lo)) {
+        ps->err = "Invalid content of \\{\\}";
+        return FALSE;
+    }
+    ps->p = p + 1;
+    *minp = lo, *maxp = hi;
+    return TRUE;
+}
+
+STATIC_OVL struct rxtree *
+rx_piece(ps)
+struct rxparse *ps;
+{
+    struct rxtree *t, *r;
+    int lo, hi;
+    boolean group = (*ps->p == '(');
+
+    if (*ps->p == '{' && rx_interval(ps, &lo, &hi)) {
+        ps->err = "Invalid preceding regular expression";
+        return (struct rxtree *) 0;
+    }
+    if (ps->err || !(t = rx_atom(ps)))
+        return (struct rxtree *) 0;
+    for (;;) {
+        if (*ps->p == '*')
+            lo = 0, hi = -1, ps->p++;
+        else if (*ps->p == '+')
+            lo = 1, hi = -1, ps->p++;
+        else if (*ps->p == '?')
+            lo = 0, hi = 1, ps->p++;
+        else if (*ps->p != '{' || !rx_interval(ps, &lo, &hi))
+            break;
+        if (!group && (t->type == RXT_BOL || t->type == RXT_EOL)) {
+            rx_freetree(t);
+            ps->err = "Invalid preceding regular expression";
+            return (struct rxtree *) 0;
+        }
+        r = rx_tree(RXT_REPEAT, t, (struct rxtree *) 0);
+        r->min = lo, r->max = hi;
+        t = r;
+    }
+    if (ps->err) {
+        rx_freetree(t);
+        return (struct rxtree *) 0;
+    }
+    return t;
+}
+
+STATIC_OVL struct rxtree *
+rx_branch(ps)
+struct rxparse *ps;
+{
+    struct rxtree *t = 0, *u;
+
+    while (*ps->p && *ps->p != '|' && !(*ps->p == ')' && ps->depth)) {
+        if (!(u = rx_piece(ps))) {
+            rx_freetree(t);
+            return (struct rxtree *) 0;
+        }
+        t = t ? rx_tree(RXT_CAT, t, u) : u;
+    }
+    return t ? t : rx_tree(RXT_EMPTY, (struct rxtree *) 0,
+                           (struct rxtree *) 0);
+}
+
+STATIC_OVL struct rxtree *
+rx_regexp(ps)
+struct rxparse *ps;
+{
+    struct rxtree *t, *u;
+
+    if (!(t = rx_branch(ps)))
+        return t;
+    while (*ps->p == '|') {
+        ps->p++;
+        if (!(u = rx_branch(ps))) {
+            rx_freetree(t);
+            return u;
+        }
+        t = rx_tree(RXT_ALT, t, u);
+    }
+    return t;
+}
+
+/*
+ * Compiling the tree into an NFA.
+ */
+
+STATIC_OVL int
+rx_node(p, type, out, out1, arg)
+struct rxprog *p;
+int type, out, out1, arg;
+{
+    if (p->nnode >= RX_MAXNODES)
+        return -1;
+    if (p->nnode == p->nodesz) {
+        struct rxnode *newnode;
+
+        p->nodesz = p->nodesz ? 2 * p->nodesz : 64;
+        newnode = (struct rxnode *) alloc((unsigned) p->nodesz
+                                          * sizeof (struct rxnode));
+        if (p->nnode)
+            (void) memcpy((genericptr_t) newnode, (genericptr_t) p->node,
+                          p->nnode * sizeof (struct rxnode));
+        if (p->node)
+            free((genericptr_t) p->node);
+        p->node = newnode;
+    }
+    p->node[p->nnode].type = type;
+    p->node[p->nnode].out = out;
+    p->node[p->nnode].out1 = out1;
+    p->node[p->nnode].arg = arg;
+    return p->nnode++;
+}
+
+/* compile t so that it continues to node next; returns its entry node,
+   or -1 if the NFA has grown too big.  Working from the end backwards
+   means every node's successors already exist when it is made. */
+STATIC_OVL int
+rx_compile(p, t, next)
+struct rxprog *p;
+struct rxtree *t;
+int next;
+{
+    int l, r, i, s, cur;
+
+    if (next < 0)
+        return -1;
+    switch (t->type) {
+    case RXT_EMPTY:
+        return next;
+    case RXT_CLASS:
+        return rx_node(p, RXN_CLASS, next, -1, t->cls);
+    case RXT_BOL:
+        return rx_node(p, RXN_BOL, next, -1, 0);
+    case RXT_EOL:
+        return rx_node(p, RXN_EOL, next, -1, 0);
+    case RXT_CAT:
+        return rx_compile(p, t->left, rx_compile(p, t->right, next));
+    case RXT_ALT:
+        l = rx_compile(p, t->left, next);
+        r = rx_compile(p, t->right, next);
+        return (l < 0 || r < 0) ? -1 : rx_node(p, RXN_SPLIT, l, r, 0);
+    case RXT_REPEAT:
+        cur = next;
+        if (t->max < 0) {
+            /* loop: s -> body -> s, or s -> next */
+            if ((s = rx_node(p, RXN_SPLIT, -1, next, 0)) < 0
+                || (cur = rx_compile(p, t->left, s)) < 0)
+                return -1;
+            p->node[s].out = cur;
+            cur = s;
+        } else {
+            /* optional copies, each of which can skip to next */
+            for (i = t->min; i < t->max; i++)
+                if ((cur = rx_compile(p, t->left, cur)) < 0
+                    || (cur = rx_node(p, RXN_SPLIT, cur, next, 0)) < 0)
+                    return -1;
+        }
+        for (i = 0; i < t->min; i++)
+            if ((cur = rx_compile(p, t->left, cur)) < 0)
+                return -1;
+        return cur;
+    }
+    return -1;
+}
+
+/* parse pat and add it to p as member 'which'; returns an error message
+   or null */
+STATIC_OVL const char *
+rx_addpattern(p, pat, which)
+struct rxprog *p;
+const char *pat;
+int which;
+{
+    struct rxparse ps;
+    struct rxtree *t;
+    int entry;
+
+    ps.p = pat;
+    ps.err = (const char *) 0;
+    ps.depth = 0;
+    ps.prog = p;
+    if (!(t = rx_regexp(&ps)))
+        return ps.err ? ps.err : "Invalid regular expression";
+    entry = rx_compile(p, t, rx_node(p, RXN_MATCH, -1, -1, which));
+    rx_freetree(t);
+    if (entry < 0)
+        return "Regular expression too big";
+    if (p->start < 0)
+        p->start = entry;
+    else if ((p->start = rx_node(p, RXN_SPLIT, entry, p->start, 0)) < 0)
+        return "Regular expression too big";
+    if (which >= p->npat)
+        p->npat = which + 1;
+    return (const char *) 0;
+}
+
+/* all patterns have been added; prepare for matching */
+STATIC_OVL void
+rx_finish(p)
+struct rxprog *p;
+{
+    int newid[512], c, b, n;
+
+    /* characters which no class tells apart share a byte class, so
+       that DFA states need only one transition for all of them */
+    (void) memset((genericptr_t) p->bytemap, 0, sizeof p->bytemap);
+    p->nbc = 1;
+    for (c = 0; c < p->ncls; c++) {
+        for (b = 0; b < 2 * p->nbc; b++)
+            newid[b] = -1;
+        for (b = n = 0; b < 256; b++) {
+            int key = 2 * p->bytemap[b] + rx_inclass(p, c, b);
+
+            if (newid[key] < 0)
+                newid[key] = n++;
+            p->bytemap[b] = (uchar) newid[key];
+        }
+        p->nbc = n;
+    }
+    for (b = 255; b >= 0; b--)
+        p->rep[p->bytemap[b]] = (uchar) b;
+
+    p->mwords = (p->npat + RXBITS - 1) / RXBITS;
+    n = max(p->nnode, 1);
+    p->mark = (int *) alloc((unsigned) n * sizeof (int));
+    (void) memset((genericptr_t) p->mark, 0, n * sizeof (int));
+    p->markgen = 0;
+    p->stack = (int *) alloc((unsigned) n * sizeof (int));
+    p->buf = (int *) alloc((unsigned) n * sizeof (int));
+    p->acc = (unsigned long *) alloc((unsigned) max(p->mwords, 1)
+                                     * sizeof (unsigned long));
+    p->dssz = RX_MINSTATES;
+    p->ds = (struct rxstate **) alloc(p->dssz * sizeof (struct rxstate *));
+    p->hash = (int *) alloc(2 * p->dssz * sizeof (int));
+    for (n = 0; n < 2 * p->dssz; n++)
+        p->hash[n] = -1;
+    p->nds = 0;
+    p->initial = -1;
+}
+
+/*
+ * The DFA.
+ */
+
+/* add to p->buf the nodes reachable from n without consuming a character;
+   the caller bumps p->markgen before starting a new set */
+STATIC_OVL void
+rx_closure(p, n, bol, eol)
+struct rxprog *p;
+int n;
+boolean bol, eol;
+{
+    struct rxnode *nd;
+    int sp = 0;
+
+#define rx_push(N)                                \
+    do {                                          \
+        if (p->mark[N] != p->markgen) {           \
+            p->mark[N] = p->markgen;              \
+            p->stack[sp++] = (N);                 \
+        }                                         \
+    } while (0)
+
+    rx_push(n);
+    while (sp) {
+        n = p->stack[--sp];
+        nd = &p->node[n];
+        switch (nd->type) {
+        case RXN_SPLIT:
+            rx_push(nd->out1);
+            rx_push(nd->out);
+            break;
+        case RXN_BOL:
+            /* once past the start, it can never be passed */
+            if (bol)
+                rx_push(nd->out);
+            break;
+        case RXN_EOL:
+            if (eol)
+                rx_push(nd->out);
+            else
+                p->buf[p->nbuf++] = n; /* may pass at the end */
+            break;
+        default:
+            p->buf[p->nbuf++] = n;
+            break;
+        }
+    }
+#undef rx_push
+}
+
+STATIC_OVL int
+rx_cmpint(a, b)
+const genericptr a;
+const genericptr b;
+{
+    return *(const int *) a - *(const int *) b;
+}
+
+STATIC_OVL void
+rx_flush(p)
+struct rxprog *p;
+{
+    struct rxstate *st;
+    int i;
+
+    for (i = 0; i < p->nds; i++) {
+        st = p->ds[i];
+        if (st->nodes)
+            free((genericptr_t) st->nodes);
+        if (st->mask)
+            free((genericptr_t) st->mask);
+        if (st->eolmask)
+            free((genericptr_t) st->eolmask);
+        free((genericptr_t) st->next);
+        free((genericptr_t) st);
+    }
+    if (p->nds) {
+        for (i = 0; i < 2 * p->dssz; i++)
+            p->hash[i] = -1;
+        p->flushes++;
+    }
+    p->nds = 0;
+    p->initial = -1;
+}
+
+/* double the size of the state table */
+STATIC_OVL void
+rx_grow(p)
+struct rxprog *p;
+{
+    struct rxstate **newds;
+    int i, slot;
+
+    p->dssz *= 2;
+    newds = (struct rxstate **) alloc(p->dssz * sizeof (struct rxstate *));
+    (void) memcpy((genericptr_t) newds, (genericptr_t) p->ds,
+                  p->nds * sizeof (struct rxstate *));
+    free((genericptr_t) p->ds);
+    p->ds = newds;
+    free((genericptr_t) p->hash);
+    p->hash = (int *) alloc(2 * p->dssz * sizeof (int));
+    for (i = 0; i < 2 * p->dssz; i++)
+        p->hash[i] = -1;
+    for (i = 0; i < p->nds; i++) {
+        for (slot = (int) (p->ds[i]->hash % (2 * p->dssz));
+             p->hash[slot] >= 0; slot = (slot + 1) % (2 * p->dssz))
+            continue;
+        p->hash[slot] = i;
+    }
+}
+
+/* find or make the state for the nodes in p->buf */
+STATIC_OVL int
+rx_state(p, bol)
+struct rxprog *p;
+boolean bol;
+{
+    struct rxstate *st;
+    unsigned long h = 2166136261UL;
+    int i, slot;
+
+    qsort((genericptr_t) p->buf, (size_t) p->nbuf, sizeof (int),
+          rx_cmpint);
+    for (i = 0; i < p->nbuf; i++)
+        h = (h ^ (unsigned long) p->buf[i]) * 16777619UL;
+    h ^= (unsigned long) bol;
+    for (slot = (int) (h % (2 * p->dssz)); p->hash[slot] >= 0;
+         slot = (slot + 1) % (2 * p->dssz)) {
+        st = p->ds[p->hash[slot]];
+        if (st->bol == bol && st->nnodes == p->nbuf
+            && (!p->nbuf || !memcmp((genericptr_t) st->nodes,
+                                    (genericptr_t) p->buf,
+                                    p->nbuf * sizeof (int))))
+            return p->hash[slot];
+    }
+    if (p->nds == p->dssz) {
+        if (p->dssz < RX_MAXSTATES)
+            rx_grow(p);
+        else
+            rx_flush(p);
+        for (slot = (int) (h % (2 * p->dssz)); p->hash[slot] >= 0;
+             slot = (slot + 1) % (2 * p->dssz))
+            continue;
+    }
+    st = (struct rxstate *) alloc(sizeof (struct rxstate));
+    st->hash = h;
+    st->nnodes = p->nbuf;
+    st->nodes = 0;
+    st->mask = st->eolmask = 0;
+    if (p->nbuf) {
+        st->nodes = (int *) alloc((unsigned) p->nbuf * sizeof (int));
+        (void) memcpy((genericptr_t) st->nodes, (genericptr_t) p->buf,
+                      p->nbuf * sizeof (int));
+    }
+    for (i = 0; i < p->nbuf; i++)
+        if (p->node[p->buf[i]].type == RXN_MATCH) {
+            if (!st->mask) {
+                st->mask = (unsigned long *) alloc((unsigned) p->mwords
+                                               * sizeof (unsigned long));
+                (void) memset((genericptr_t) st->mask, 0,
+                              p->mwords * sizeof (unsigned long));
+            }
+            rx_setbit(st->mask, p->node[p->buf[i]].arg);
+        }
+    st->bol = bol;
+    st->eoldone = FALSE;
+    st->next = (int *) alloc((unsigned) p->nbc * sizeof (int));
+    for (i = 0; i < p->nbc; i++)
+        st->next[i] = -1;
+    p->ds[p->nds] = st;
+    p->hash[slot] = p->nds;
+    return p->nds++;
+}
+
+/* the state following state cur on a character of byte class bc */
+STATIC_OVL int
+rx_step(p, cur, bc)
+struct rxprog *p;
+int cur, bc;
+{
+    struct rxstate *st = p->ds[cur];
+    int i, n, flushes, next;
+
+    if ((next = st->next[bc]) >= 0)
+        return next;
+    if (++p->markgen <= 0) {
+        (void) memset((genericptr_t) p->mark, 0, p->nnode * sizeof (int));
+        p->markgen = 1;
+    }
+    p->nbuf = 0;
+    for (i = 0; i < st->nnodes; i++) {
+        n = st->nodes[i];
+        if (p->node[n].type == RXN_CLASS
+            && rx_inclass(p, p->node[n].arg, p->rep[bc]))
+            rx_closure(p, p->node[n].out, FALSE, FALSE);
+    }
+    /* a match may begin at any character */
+    rx_closure(p, p->start, FALSE, FALSE);
+    flushes = p->flushes;
+    next = rx_state(p, FALSE);
+    if (p->flushes == flushes)
+        st->next[bc] = next;
+    return next;
+}
+
+/* members which match if the string ends in state cur */
+STATIC_OVL unsigned long *
+rx_eolmask(p, cur)
+struct rxprog *p;
+int cur;
+{
+    struct rxstate *st = p->ds[cur];
+    int i;
+
+    if (st->eoldone)
+        return st->eolmask;
+    st->eoldone = TRUE;
+    if (++p->markgen <= 0) {
+        (void) memset((genericptr_t) p->mark, 0, p->nnode * sizeof (int));
+        p->markgen = 1;
+    }
+    p->nbuf = 0;
+    for (i = 0; i < st->nnodes; i++)
+        if (p->node[st->nodes[i]].type == RXN_EOL)
+            rx_closure(p, st->nodes[i], st->bol, TRUE);
+    for (i = 0; i < p->nbuf; i++)
+        if (p->node[p->buf[i]].type == RXN_MATCH) {
+            if (!st->eolmask) {
+                st->eolmask = (unsigned long *) alloc((unsigned) p->mwords
+                                               * sizeof (unsigned long));
+                (void) memset((genericptr_t) st->eolmask, 0,
+                              p->mwords * sizeof (unsigned long));
+            }
+            rx_setbit(st->eolmask, p->node[p->buf[i]].arg);
+        }
+    return st->eolmask;
+}
+
+/* lowest numbered member from start on which matches s, or -1 */
+STATIC_OVL int
+rx_run(p, s, start)
+struct rxprog *p;
+const char *s;
+int start;
+{
+    unsigned long *m;
+    int cur, i;
+
+    if (start >= p->npat)
+        return -1;
+    (void) memset((genericptr_t) p->acc, 0,
+                  p->mwords * sizeof (unsigned long));
+    if ((cur = p->initial) < 0) {
+        if (++p->markgen <= 0) {
+            (void) memset((genericptr_t) p->mark, 0,
+                          p->nnode * sizeof (int));
+            p->markgen = 1;
+        }
+        p->nbuf = 0;
+        rx_closure(p, p->start, TRUE, FALSE);
+        cur = p->initial = rx_state(p, TRUE);
+    }
+    for (;;) {
+        if ((m = p->ds[cur]->mask) != 0) {
+            for (i = 0; i < p->mwords; i++)
+                p->acc[i] |= m[i];
+            if (rx_testbit(p->acc, start))
+                return start;
+        }
+        if (!*s) {
+            if ((m = rx_eolmask(p, cur)) != 0)
+                for (i = 0; i < p->mwords; i++)
+                    p->acc[i] |= m[i];
+            break;
+        }
+        if (!p->ds[cur]->nnodes)
+            break; /* dead; nothing more can match */
+        cur = rx_step(p, cur, p->bytemap[(uchar) *s++]);
+    }
+    for (i = start; i < p->npat; i++)
+        if (rx_testbit(p->acc, i))
+            return i;
+    return -1;
+}
+
+/*
+ * The nhregex interface.
+ */
+
+struct nhregex *
+regex_init()
+{
+    struct nhregex *re = (struct nhregex *) alloc(sizeof (struct nhregex));
+
+    re->pat = (char *) 0;
+    re->err = (const char *) 0;
+    re->prog = (struct rxprog *) 0;
+    return re;
+}
+
+boolean
+regex_compile(s, re)
+const char *s;
+struct nhregex *re;
+{
+    if (!re)
+        return FALSE;
+    if (re->prog)
+        rx_freeprog(re->prog), re->prog = 0;
+    if (re->pat)
+        free((genericptr_t) re->pat), re->pat = 0;
+    re->prog = rx_newprog();
+    if ((re->err = rx_addpattern(re->prog, s, 0)) != 0) {
+        rx_freeprog(re->prog), re->prog = 0;
+        return FALSE;
+    }
+    rx_finish(re->prog);
+    re->pat = dupstr(s);
+    return TRUE;
+}
+
+const char *
+regex_error_desc(re)
+struct nhregex *re;
+{
+    return re ? re->err : (const char *) 0;
+}
+
+boolean
+regex_match(s, re)
+const char *s;
+struct nhregex *re;
+{
+    if (!re || !re->prog || !s)
+        return FALSE;
+    return (boolean) (rx_run(re->prog, s, 0) == 0);
+}
+
+void
+regex_free(re)
+struct nhregex *re;
+{
+    if (re) {
+        rx_freeprog(re->prog);
+        if (re->pat)
+            free((genericptr_t) re->pat);
+        free((genericptr_t) re);
+    }
+}
+
+struct nhregex_set *
+regex_set_init()
+{
+    struct nhregex_set *set;
+
+    set = (struct nhregex_set *) alloc(sizeof (struct nhregex_set));
+    set->res = (struct nhregex **) 0;
+    set->count = set->size = 0;
+    set->prog = (struct rxprog *) 0;
+    set->built = FALSE;
+    return set;
+}
+
+void
+regex_set_add(set, re)
+struct nhregex_set *set;
+struct nhregex *re;
+{
+    if (!set || !re)
+        return;
+    if (set->count == set->size) {
+        struct nhregex **newres;
+
+        set->size = set->size ? 2 * set->size : 16;
+        newres = (struct nhregex **) alloc(set->size * sizeof *newres);
+        if (set->count)
+            (void) memcpy((genericptr_t) newres, (genericptr_t) set->res,
+                          set->count * sizeof *newres);
+        if (set->res)
+            free((genericptr_t) set->res);
+        set->res = newres;
+    }
+    set->res[set->count++] = re;
+    rx_freeprog(set->prog);
+    set->prog = (struct rxprog *) 0;
+    set->built = FALSE;
+}
+
+int
+regex_set_match(s, set, start)
+const char *s;
+struct nhregex_set *set;
+int start;
+{
+    int i;
+
+    if (!set || !s)
+        return -1;
+    if (start < 0)
+        start = 0;
+    if (!set->built) {
+        set->built = TRUE;
+        set->prog = rx_newprog();
+        for (i = 0; i < set->count; i++)
+            if (!set->res[i]->pat
+                || rx_addpattern(set->prog, set->res[i]->pat, i))
+                break;
+        if (i < set->count) {
+            /* too big to combine; fall back to the members */
+            rx_freeprog(set->prog);
+            set->prog = (struct rxprog *) 0;
+        } else if (set->count) {
+            rx_finish(set->prog);
+        }
+    }
+    if (set->prog && set->count)
+        return rx_run(set->prog, s, start);
+    for (i = start; i < set->count; i++)
+        if (regex_match(s, set->res[i]))
+            return i;
+    return -1;
+}
+
+void
+regex_set_free(set)
+struct nhregex_set *set;
+{
+    if (set) {
+        rx_freeprog(set->prog);
+        if (set->res)
+            free((genericptr_t) set->res);
+        free((genericptr_t) set);
+    }
+}
+
+/*dfaregex.c*/
@@ -19,6 +19,12 @@ struct nhregex {
     const char *pat;
 };
 
+/* wildcard patterns can't be combined, so a set just tries each in turn */
+struct nhregex_set {
+    struct nhregex **res;
+    int count, size;
+};
+
 struct nhregex *
 regex_init()
 {
@@ -71,3 +77,63 @@ struct nhregex *re;
         free((genericptr_t) re);
     }
 }
+
+struct nhregex_set *
+regex_set_init()
+{
+    struct nhregex_set *set;
+
+    set = (struct nhregex_set *) alloc(sizeof (struct nhregex_set));
+    set->res = (struct nhregex **) 0;
+    set->count = set->size = 0;
+    return set;
+}
+
+void
+regex_set_add(set, re)
+struct nhregex_set *set;
+struct nhregex *re;
+{
+    if (!set || !re)
+        return;
+    if (set->count == set->size) {
+        struct nhregex **newres;
+
+        set->size = set->size ? 2 * set->size : 16;
+        newres = (struct nhregex **) alloc(set->size * sizeof *newres);
+        if (set->count)
+            (void) memcpy((genericptr_t) newres, (genericptr_t) set->res,
+                          set->count * sizeof *newres);
+        if (set->res)
+            free((genericptr_t) set->res);
+        set->res = newres;
+    }
+    set->res[set->count++] = re;
+}
+
+int
+regex_set_match(s, set, start)
+const char *s;
+struct nhregex_set *set;
+int start;
+{
+    int i;
+
+    if (!set || !s)
+        return -1;
+    for (i = max(start, 0); i < set->count; i++)
+        if (regex_match(s, set->res[i]))
+            return i;
+    return -1;
+}
+
+void
+regex_set_free(set)
+struct nhregex_set *set;
+{
+    if (set) {
+        if (set->res)
+            free((genericptr_t) set->res);
+        free((genericptr_t) set);
+    }
+}
@@ -42,6 +42,27 @@
  *
  * void regex_free(struct nhregex *re)
  * Deallocate a regex object.
+ *
+ * struct nhregex_set
+ * An opaque structure holding an ordered list of compiled regexes which
+ * are tested together.  The set only refers to the regexes, it does not
+ * own them; it has to be freed before any of its members are.
+ *
+ * struct nhregex_set *regex_set_init(void)
+ * Create a new, empty regex set.
+ *
+ * void regex_set_add(struct nhregex_set *set, struct nhregex *re)
+ * Append re, which must have been compiled successfully, to set.  The
+ * first regex added has index 0.
+ *
+ * int regex_set_match(const char *s, struct nhregex_set *set, int start)
+ * Returns the index of the first member of set, starting with index
+ * start, which matches s, or -1 if none of them do.  The result is the
+ * same as calling regex_match for each member in turn, but an
+ * implementation may test all the members at once.
+ *
+ * void regex_set_free(struct nhregex_set *set)
+ * Deallocate a regex set (but not its members).
  */
 
 const char regex_id[] = "posixregex";
@@ -49,12 +70,39 @@ const char regex_id[] = "posixregex";
 struct nhregex {
     regex_t re;
     int err;
+    char *pat; /* source, for combining into a set */
+};
+
+/* A set is matched by compiling its members' patterns into alternations
+ * "(p0)|(p1)|...", which regexec tests in one pass over the string.
+ * One alternation of every member rejects strings matching none of them;
+ * one per group of RXSET_GROUP members narrows down a hit, and only that
+ * group's members are then tried individually, in order, to find the
+ * first one that matches.  Patterns which might mean something else
+ * inside a larger expression (back-references, unbalanced parentheses)
+ * disable the alternations which would contain them. */
+#define RXSET_GROUP 16
+
+struct nhregex_set {
+    struct nhregex **res;
+    int count, size;
+    boolean built;   /* alternations below are current */
+    boolean allok;   /* all compiled */
+    regex_t all;
+    int ngroups;
+    boolean *groupok;
+    regex_t *group;
 };
 
 struct nhregex *
 regex_init()
 {
-    return (struct nhregex *) alloc(sizeof(struct nhregex));
+    struct nhregex *re;
+
+    re = (struct nhregex *) alloc(sizeof(struct nhregex));
+    re->err = 0;
+    re->pat = (char *) 0;
+    return re;
 }
 
 boolean
@@ -62,8 +110,11 @@ regex_compile(const char *s, struct nhregex *re)
 {
     if (!re)
         return FALSE;
+    if (re->pat)
+        free((genericptr_t) re->pat), re->pat = (char *) 0;
     if ((re->err = regcomp(&re->re, s, REG_EXTENDED | REG_NOSUB)))
         return FALSE;
+    re->pat = dupstr(s);
     return TRUE;
 }
 
@@ -102,5 +153,198 @@ void
 regex_free(struct nhregex *re)
 {
     regfree(&re->re);
+    if (re->pat)
+        free((genericptr_t) re->pat);
     free(re);
 }
+
+/* can pat be wrapped in parentheses and combined with other patterns
+   without changing what it matches? */
+static boolean
+rxset_combinable(const char *pat)
+{
+    const char *p;
+    int depth = 0;
+
+    if (!pat || (*pat && index("*+?{", *pat)))
+        return FALSE;
+    for (p = pat; *p; p++) {
+        if (*p == '\\') {
+            if (!*++p || digit(*p))
+                return FALSE; /* back-reference would be renumbered */
+        } else if (*p == '[') {
+            /* skip bracket expression; ']' first in the list is literal */
+            if (*++p == '^')
+                p++;
+            if (*p == ']')
+                p++;
+            for (; *p && *p != ']'; p++)
+                if (*p == '[' && p[1] && index(":.=", p[1])) {
+                    char c = p[1];
+
+                    for (p += 2; *p && !(*p == c && p[1] == ']'); p++)
+                        continue;
+                    if (!*p++)
+                        return FALSE;
+                }
+            if (!*p)
+                return FALSE;
+        } else if (*p == '(') {
+            depth++;
+        } else if (*p == ')') {
+            if (--depth < 0)
+                return FALSE;
+        }
+    }
+    return (boolean) (depth == 0);
+}
+
+/* compile the alternation of set->res[first..last-1] into rx */
+static boolean
+rxset_union(struct nhregex_set *set, int first, int last, regex_t *rx)
+{
+    char *buf;
+    size_t len = 1;
+    int i;
+    boolean ok;
+
+    for (i = first; i < last; i++) {
+        if (!rxset_combinable(set->res[i]->pat))
+            return FALSE;
+        len += strlen(set->res[i]->pat) + 3;
+    }
+    buf = (char *) alloc((unsigned) len);
+    *buf = '\0';
+    for (i = first; i < last; i++) {
+        if (i > first)
+            Strcat(buf, "|");
+        Strcat(buf, "(");
+        Strcat(buf, set->res[i]->pat);
+        Strcat(buf, ")");
+    }
+    ok = !regcomp(rx, buf, REG_EXTENDED | REG_NOSUB);
+    free((genericptr_t) buf);
+    return ok;
+}
+
+static void
+rxset_unbuild(struct nhregex_set *set)
+{
+    int g;
+
+    if (!set->built)
+        return;
+    if (set->allok)
+        regfree(&set->all);
+    for (g = 0; g < set->ngroups; g++)
+        if (set->groupok[g])
+            regfree(&set->group[g]);
+    if (set->ngroups) {
+        free((genericptr_t) set->groupok);
+        free((genericptr_t) set->group);
+    }
+    set->ngroups = 0;
+    set->allok = set->built = FALSE;
+}
+
+static void
+rxset_build(struct nhregex_set *set)
+{
+    int g, last;
+
+    set->allok = (set->count > 1
+                  && rxset_union(set, 0, set->count, &set->all));
+    /* with a single group the overall alternation already covers it */
+    set->ngroups = (set->count > RXSET_GROUP)
+                       ? (set->count + RXSET_GROUP - 1) / RXSET_GROUP : 0;
+    if (set->ngroups) {
+        set->groupok = (boolean *) alloc(set->ngroups * sizeof (boolean));
+        set->group = (regex_t *) alloc(set->ngroups * sizeof (regex_t));
+        for (g = 0; g < set->ngroups; g++) {
+            last = min((g + 1) * RXSET_GROUP, set->count);
+            set->groupok[g] = (last - g * RXSET_GROUP > 1
+                               && rxset_union(set, g * RXSET_GROUP, last,
+                                              &set->group[g]));
+        }
+    }
+    set->built = TRUE;
+}
+
+struct nhregex_set *
+regex_set_init()
+{
+    struct nhregex_set *set;
+
+    set = (struct nhregex_set *) alloc(sizeof (struct nhregex_set));
+    set->res = (struct nhregex **) 0;
+    set->count = set->size = 0;
+    set->built = set->allok = FALSE;
+    set->ngroups = 0;
+    set->groupok = (boolean *) 0;
+    set->group = (regex_t *) 0;
+    return set;
+}
+
+void
+regex_set_add(struct nhregex_set *set, struct nhregex *re)
+{
+    if (!set || !re)
+        return;
+    if (set->count == set->size) {
+        struct nhregex **newres;
+
+        set->size = set->size ? 2 * set->size : RXSET_GROUP;
+        newres = (struct nhregex **) alloc(set->size * sizeof *newres);
+        if (set->count)
+            (void) memcpy((genericptr_t) newres, (genericptr_t) set->res,
+                          set->count * sizeof *newres);
+        if (set->res)
+            free((genericptr_t) set->res);
+        set->res = newres;
+    }
+    set->res[set->count++] = re;
+    rxset_unbuild(set);
+}
+
+int
+regex_set_match(const char *s, struct nhregex_set *set, int start)
+{
+    int g, i, first, last;
+
+    if (!set || !s || start >= set->count)
+        return -1;
+    if (start < 0)
+        start = 0;
+    if (!set->built)
+        rxset_build(set);
+    if (set->allok && regexec(&set->all, s, 0, (regmatch_t *) 0, 0))
+        return -1;
+    if (!set->ngroups) {
+        for (i = start; i < set->count; i++)
+            if (regex_match(s, set->res[i]))
+                return i;
+        return -1;
+    }
+    for (g = start / RXSET_GROUP; g < set->ngroups; g++) {
+        first = max(g * RXSET_GROUP, start);
+        last = min((g + 1) * RXSET_GROUP, set->count);
+        if (set->groupok[g] && first == g * RXSET_GROUP
+            && regexec(&set->group[g], s, 0, (regmatch_t *) 0, 0))
+            continue;
+        for (i = first; i < last; i++)
+            if (regex_match(s, set->res[i]))
+                return i;
+    }
+    return -1;
+}
+
+void
+regex_set_free(struct nhregex_set *set)
+{
+    if (!set)
+        return;
+    rxset_unbuild(set);
+    if (set->res)
+        free((genericptr_t) set->res);
+    free((genericptr_t) set);
+}
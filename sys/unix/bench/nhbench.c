@@ -0,0 +1,1244 @@
+/* NetHack 3.6	nhbench.c	$NHDT-Date$  $NHDT-Branch$:$NHDT-Revision$ */
+/* NetHack may be freely redistributed.  See license for details. */
+
+/*
+ * nhbench - headless turn-throughput benchmark for the game core.
+ *
+ *      nhbench [-d playground] [-s seed] [-t turns] [-w null|tty]
+ *              [-m compat|flow] [-V levels] [-L procs] [-I games]
+ *              scenario
+ *      nhbench [-d playground] [-s seed] -P reps [-C sums] scenario
+ *              file.des ...
+ *
+ * The core is linked against the "null" window port (win/null) instead
+ * of a real interface and this file replaces unixmain.c.  A scenario
+ * file describes the character, the level to measure on and a key
+ * stream; the game is started in wizard mode with a fixed random seed,
+ * the scenario's level is built, and then moveloop() runs until the
+ * requested number of game turns have passed.  The report gives
+ * turns per second and the time spent in movemon(), vision_recalc(),
+ * flush_screen(), run_timers(), goto_level()'s saving of the old level
+ * and loading of the new one, and the travel command's findtravelpath().
+ *
+ * With -m flow the monflow option is set, so that monsters approach the
+ * hero by walking distance from a shared per-turn flow field (see
+ * m_move()); the monflow line of the report is the time spent building
+ * the field and movemon() includes it.  -m compat clears the option,
+ * for monster movement as in a normal game.  Running a scenario both
+ * ways ("make flowbench") compares the per-turn cost of the two.
+ *
+ * With -w tty the tty port draws the game instead, for $TERM (xterm
+ * if unset), with its output collected in a temporary file; keys still
+ * come from the scenario and anything the tty port reads for itself,
+ * such as --More--, gets ESC.  The report then also gives the number
+ * of bytes of terminal output per flush_screen().
+ *
+ * Scenario files are line oriented; '#' starts a comment.  Directives
+ * applied before the game starts:
+ *      seed N                  random seed (default 1)
+ *      turns N                 game turns to measure (default 1000)
+ *      role|race|gender|align NAME
+ *      option TEXT             as for the OPTIONS line of a config file
+ *      keys TEXT               key stream, repeated as needed; \n, \e
+ *                              (ESC) and \\ are escapes, and \d is a
+ *                              pseudo-random direction key
+ *      answer C PROMPT         answer C to prompts that begin with PROMPT
+ * Directives applied in order once the game has started:
+ *      setenv NAME VALUE       e.g. SHOPTYPE to force a shop type
+ *      level DUNGEON N|filler  go to level N of DUNGEON, or its first
+ *                              level that has no special level
+ *      special NAME            go to the special level NAME (eg. bigrm)
+ *      monsters N              create N random monsters
+ *      objects N               scatter N random objects
+ *      corpses N               scatter N corpses (each with a rot timer)
+ *      place shop|random|downstair
+ *                              move the hero
+ *      hp N                    set the hero's hit points
+ *      map                     reveal the level, as magic mapping does
+ *      bones                   turn the current level into a bones file
+ *                              and reload it through getbones()
+ *
+ * Since bones files are written to the playground, benchmarks are best
+ * run against a private copy of it (see -d).
+ *
+ * With -V the scenario's level directives are skipped.  Instead the
+ * first 'levels' levels of the Dungeons of Doom are made in turn and
+ * on each the bitset vision algorithm is compared with Algorithm C
+ * from every location (see vision_diff()); the exit status is nonzero
+ * if they ever disagree.  This needs a build with VISION_BITS defined.
+ *
+ * With -L the game is instead ended by 'procs' processes at once, each
+ * calling topten() LOG_STRESS_GAMES times, and the lines they added to
+ * LOGFILE and XLOGFILE are then checked: every one must be whole and
+ * each process must have all of its lines there.  The exit status is
+ * nonzero if not.  (Being in wizard mode, they leave 'record' alone.)
+ *
+ * With -I the game is instead ended 'games' times by one process outside
+ * wizard mode, so that each goes into 'record' and its SCORE_INDEX (use
+ * a private playground), and the index must then be no bigger than the
+ * size at which topten() compacts it.  The exit status is nonzero if it
+ * is.  This needs a build with SCORE_INDEX defined.
+ *
+ * With -P the scenario only supplies the character.  Each level named
+ * by a LEVEL or MAZE line of the given level descriptions is loaded
+ * with load_special() 'reps' times in a row, starting from the same
+ * random seed, and the report gives the time per load and a checksum
+ * of everything the loads put on the map.  (Only the first load reads
+ * the level file; the game keeps what it parsed.)  With -C the checksums are
+ * compared with the ones in 'sums', or written there if it does not
+ * exist yet, so that a change to the special level code can be checked
+ * against a build without it; the exit status is nonzero if any differ.
+ */
+
+#include "hack.h"
+#include "dlb.h"
+#include "lev.h"
+#include "sp_lev.h"
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <time.h>
+
+extern int n_dgns; /* from dungeon.c */
+extern lev_region *lregions; /* from sp_lev.c */
+extern int num_lregions;
+extern struct window_procs null_procs;
+#ifdef TTY_GRAPHICS
+extern struct window_procs tty_procs;
+#endif
+extern int NDECL((*null_getch_hook));
+extern char FDECL((*null_yn_hook), (const char *, const char *, CHAR_P));
+extern void NDECL(null_player_selection);
+extern void NDECL(null_askname);
+
+#define MAXSCNLINES 100
+#define MAXANSWERS 20
+#define LOG_STRESS_GAMES 200 /* -L: games ended by each process */
+#define MAXSPLEVS 200         /* -P: levels named by the .des files */
+
+static struct bench_line {
+    char cmd[20];
+    char arg[BUFSZ];
+    int lineno;
+} scnlines[MAXSCNLINES];
+static int nscnlines = 0;
+
+static struct bench_answer {
+    char key;
+    char prompt[BUFSZ];
+} answers[MAXANSWERS];
+static int nanswers = 0;
+
+static const char *scenario = 0;
+static char keys[BUFSZ] = "s";
+static int keyidx = 0;
+static unsigned long seed = 1L, dirseed;
+static long turns = 1000L, start_moves, nkeys, maxkeys;
+static double start_time;
+static boolean measuring = FALSE, want_bones = FALSE;
+static FILE *report;        /* where the results go */
+static off_t tty_out_start; /* -w tty: output written before timing */
+static boolean use_tty = FALSE;
+static char *splevs[MAXSPLEVS]; /* -P: levels to load */
+static int nsplevs = 0;
+
+static double slot_time[NUM_BENCH_SLOTS], slot_start[NUM_BENCH_SLOTS];
+static long slot_calls[NUM_BENCH_SLOTS];
+static int slot_depth[NUM_BENCH_SLOTS];
+static const char *const slot_names[NUM_BENCH_SLOTS] = {
+    "movemon", "vision_recalc", "flush_screen", "run_timers",
+    "goto_level", "findtravelpath", "monflow",
+};
+
+static double NDECL(bench_now);
+static void FDECL(bench_timer, (int, BOOLEAN_P));
+static int NDECL(bench_getch);
+static char FDECL(bench_yn, (const char *, const char *, CHAR_P));
+#ifdef TTY_GRAPHICS
+static int FDECL(bench_poskey, (int *, int *, int *));
+static void NDECL(use_tty_port);
+#endif
+static void FDECL(read_scenario, (const char *));
+static void FDECL(scenario_error, (struct bench_line *, const char *))
+    NORETURN;
+static void NDECL(setup_character);
+static void NDECL(setup_level);
+static void FDECL(bench_goto, (d_level *));
+static void FDECL(goto_dungeon_level, (struct bench_line *));
+static boolean FDECL(random_spot, (int *, int *));
+static void FDECL(place_hero, (struct bench_line *));
+static void NDECL(make_bones);
+static void NDECL(bench_finish);
+static void FDECL(vision_test, (int));
+static void FDECL(log_stress, (int));
+#ifdef SCORE_INDEX
+static void FDECL(index_stress, (int));
+#endif
+static void FDECL(read_levnames, (const char *));
+static unsigned long NDECL(splev_sum);
+static void FDECL(splev_test, (int, FILE *, BOOLEAN_P));
+#if defined(LOGFILE) || defined(XLOGFILE)
+static int FDECL(check_log, (const char *, off_t, int, BOOLEAN_P));
+#endif
+
+int
+main(argc, argv)
+int argc;
+char *argv[];
+{
+    const char *dir = (const char *) 0;
+    long turns_override = 0L;
+    unsigned long seed_override = 0L;
+    boolean seed_given = FALSE;
+    const char *sumfile = (const char *) 0;
+    FILE *sumfp = (FILE *) 0;
+    boolean writesums = FALSE;
+    int vision_levels = 0, log_procs = 0, index_games = 0, splev_reps = 0;
+    int flow_mode = -1; /* -m: set iflags.mon_flow to this */
+
+    sys_early_init();
+    hname = argv[0];
+    hackpid = getpid();
+    (void) umask(0777 & ~FCMASK);
+
+    windowprocs = null_procs;
+    null_getch_hook = bench_getch;
+    null_yn_hook = bench_yn;
+
+    while (argc > 1 && argv[1][0] == '-') {
+        char opt = argv[1][1];
+
+        if (argc < 3 || argv[1][2] || !index("dstwmVLIPC", opt))
+            error("Usage: %s [-d playground] [-s seed] [-t turns] "
+                  "[-w null|tty] [-m compat|flow] [-V levels] [-L procs] "
+                  "[-I games] scenario", hname);
+        if (opt == 'd')
+            dir = argv[2];
+        else if (opt == 's')
+            seed_override = strtoul(argv[2], (char **) 0, 10),
+            seed_given = TRUE;
+        else if (opt == 'V')
+            vision_levels = atoi(argv[2]);
+        else if (opt == 'L')
+            log_procs = atoi(argv[2]);
+        else if (opt == 'I')
+            index_games = atoi(argv[2]);
+        else if (opt == 'P')
+            splev_reps = atoi(argv[2]);
+        else if (opt == 'C')
+            sumfile = argv[2];
+        else if (opt == 'w' && !strcmp(argv[2], "tty"))
+            use_tty = TRUE;
+        else if (opt == 'w' && strcmp(argv[2], "null"))
+            error("%s: unknown window port %s.", hname, argv[2]);
+        else if (opt == 'm' && !strcmp(argv[2], "compat"))
+            flow_mode = FALSE;
+        else if (opt == 'm' && !strcmp(argv[2], "flow"))
+            flow_mode = TRUE;
+        else if (opt == 'm')
+            error("%s: unknown monster movement %s.", hname, argv[2]);
+        else
+            turns_override = atol(argv[2]);
+        argc -= 2;
+        argv += 2;
+    }
+    if (splev_reps > 0) {
+        if (argc < 3)
+            error("Usage: %s [-d playground] [-s seed] -P reps [-C sums] "
+                  "scenario file.des ...", hname);
+        while (argc > 2) {
+            read_levnames(argv[2]);
+            argv[2] = argv[1], argc--, argv++;
+        }
+        if (sumfile && !(sumfp = fopen(sumfile, "r"))) {
+            if (!(sumfp = fopen(sumfile, "w")))
+                error("%s: cannot create %s.", hname, sumfile);
+            writesums = TRUE;
+        }
+    }
+    if (argc != 2)
+        error("Usage: %s [-d playground] [-s seed] [-t turns] "
+              "[-w null|tty] [-m compat|flow] [-V levels] [-L procs] "
+              "[-I games] scenario", hname);
+#ifndef TTY_GRAPHICS
+    if (use_tty)
+        error("%s: built without TTY_GRAPHICS.", hname);
+#endif
+#ifndef VISION_BITS
+    if (vision_levels)
+        error("%s: -V needs a build with VISION_BITS defined.", hname);
+#endif
+#ifndef SCORE_INDEX
+    if (index_games)
+        error("%s: -I needs a build with SCORE_INDEX defined.", hname);
+#endif
+    scenario = argv[1];
+    read_scenario(scenario); /* before chdir, the path may be relative */
+
+#ifdef HACKDIR
+    if (!dir)
+        dir = HACKDIR;
+#endif
+    if (dir && chdir(dir) < 0) {
+        perror(dir);
+        error("Cannot chdir to %s.", dir);
+    }
+
+    /* keep the player's own configuration out of the measurement */
+    (void) setenv("NETHACKOPTIONS", "@/dev/null", 1);
+    initoptions();
+    setup_character();
+    if (seed_given) /* the command line overrides the scenario */
+        seed = seed_override;
+    if (turns_override > 0L)
+        turns = turns_override;
+    if (flow_mode >= 0)
+        iflags.mon_flow = (boolean) flow_mode;
+
+    wizard = TRUE, discover = FALSE;
+    Sprintf(plname, "bench%d", (int) hackpid);
+    locknum = 0;
+    getlock();
+
+    report = stdout;
+#ifdef TTY_GRAPHICS
+    if (use_tty)
+        use_tty_port();
+#endif
+    init_nhwindows(&argc, argv);
+    dlb_init();
+    vision_init();
+    display_gamewindows();
+
+    seedrandom(seed);
+    dirseed = seed;
+    player_selection();
+    newgame();
+    if (vision_levels > 0)
+        vision_test(vision_levels);
+    if (log_procs > 0)
+        log_stress(log_procs);
+#ifdef SCORE_INDEX
+    if (index_games > 0)
+        index_stress(index_games);
+#endif
+    if (splev_reps > 0)
+        splev_test(splev_reps, sumfp, writesums);
+    setup_level();
+
+    maxkeys = 50L * turns + 1000L;
+    start_moves = moves;
+    if (use_tty) {
+        (void) fflush(stdout);
+        tty_out_start = lseek(fileno(stdout), (off_t) 0, SEEK_CUR);
+    }
+    start_time = bench_now();
+    measuring = TRUE;
+    bench_hook = bench_timer;
+    moveloop(FALSE);
+    /*NOTREACHED*/
+    return 0;
+}
+
+#ifdef TTY_GRAPHICS
+/*
+ * Switch to the tty port.  Its output goes to a temporary file, which
+ * measures the bytes written, and its own reads from stdin see EOF.
+ */
+static void
+use_tty_port()
+{
+    FILE *out;
+    int fd;
+
+    if (!getenv("TERM"))
+        (void) setenv("TERM", "xterm", 1);
+    (void) fflush(stdout);
+    if ((fd = dup(fileno(stdout))) < 0 || !(report = fdopen(fd, "w"))
+        || !(out = tmpfile()) || dup2(fileno(out), fileno(stdout)) < 0
+        || !freopen("/dev/null", "r", stdin))
+        error("%s: cannot redirect the tty output.", hname);
+
+    /* don't sleep or send padding for delay_output() */
+    flags.nap = flags.null = FALSE;
+
+    windowprocs = tty_procs;
+    windowprocs.win_player_selection = null_player_selection;
+    windowprocs.win_askname = null_askname;
+    windowprocs.win_nhgetch = bench_getch;
+    windowprocs.win_nh_poskey = bench_poskey;
+    windowprocs.win_yn_function = bench_yn;
+}
+
+static int
+bench_poskey(x, y, mod)
+int *x, *y, *mod;
+{
+    *x = *y = *mod = 0;
+    return bench_getch();
+}
+#endif /* TTY_GRAPHICS */
+
+static double
+bench_now()
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1.0e9;
+}
+
+/* the bench_hook; nested entries into one section are timed once */
+static void
+bench_timer(slot, entering)
+int slot;
+boolean entering;
+{
+    if (entering) {
+        if (slot_depth[slot]++ == 0) {
+            slot_start[slot] = bench_now();
+            slot_calls[slot]++;
+        }
+    } else if (slot_depth[slot] > 0 && --slot_depth[slot] == 0) {
+        slot_time[slot] += bench_now() - slot_start[slot];
+    }
+}
+
+static int
+bench_getch()
+{
+    int c;
+
+    if (!measuring)
+        return '\033';
+    if (moves - start_moves >= turns || ++nkeys > maxkeys)
+        bench_finish();
+    if (!keys[keyidx])
+        keyidx = 0;
+    c = (uchar) keys[keyidx++];
+    if (c == '\177') { /* \d placeholder */
+        dirseed = dirseed * 1103515245UL + 12345UL;
+        c = "hjklyubn"[(dirseed >> 16) % 8];
+    }
+    return c;
+}
+
+static char
+bench_yn(query, resp, def)
+const char *query, *resp;
+char def;
+{
+    int i;
+
+    if (!strncmp(query, "Get bones?", 10))
+        return want_bones ? 'y' : 'n';
+    if (!strncmp(query, "Unlink bones?", 13))
+        return 'y';
+    for (i = 0; i < nanswers; i++)
+        if (!strncmp(query, answers[i].prompt, strlen(answers[i].prompt)))
+            return answers[i].key;
+    if (!resp) /* an object letter or similar; take it from the script */
+        return (char) bench_getch();
+    if (index(resp, 'n'))
+        return 'n';
+    return def ? def : *resp;
+}
+
+static void
+read_scenario(fname)
+const char *fname;
+{
+    FILE *fp;
+    char buf[BUFSZ], *p, *q;
+    int lineno = 0;
+
+    if (!(fp = fopen(fname, "r"))) {
+        perror(fname);
+        error("Cannot open scenario %s.", fname);
+    }
+    while (fgets(buf, sizeof buf, fp)) {
+        struct bench_line *sl;
+
+        lineno++;
+        if ((p = index(buf, '\n')) != 0)
+            *p = '\0';
+        for (p = buf; *p == ' ' || *p == '\t'; p++)
+            continue;
+        if (!*p || *p == '#')
+            continue;
+        if (nscnlines >= MAXSCNLINES)
+            error("%s: too many lines.", fname);
+        sl = &scnlines[nscnlines++];
+        sl->lineno = lineno;
+        for (q = sl->cmd; *p && *p != ' ' && *p != '\t'; p++)
+            if (q < sl->cmd + sizeof sl->cmd - 1)
+                *q++ = *p;
+        *q = '\0';
+        while (*p == ' ' || *p == '\t')
+            p++;
+        Strcpy(sl->arg, p);
+        for (q = eos(sl->arg); q > sl->arg && q[-1] == ' '; )
+            *--q = '\0';
+    }
+    (void) fclose(fp);
+}
+
+static void
+scenario_error(sl, msg)
+struct bench_line *sl;
+const char *msg;
+{
+    error("%s, line %d: %s: %s", scenario, sl->lineno, sl->cmd, msg);
+    /* error() exits, but isn't declared NORETURN */
+    exit(EXIT_FAILURE);
+}
+
+/* directives that have to be in effect before newgame() */
+static void
+setup_character()
+{
+    struct bench_line *sl;
+    char *p, *q;
+    int i;
+
+    for (sl = scnlines; sl < &scnlines[nscnlines]; sl++) {
+        if (!strcmp(sl->cmd, "seed")) {
+            seed = strtoul(sl->arg, (char **) 0, 10);
+        } else if (!strcmp(sl->cmd, "turns")) {
+            turns = atol(sl->arg);
+        } else if (!strcmp(sl->cmd, "role")) {
+            if ((flags.initrole = str2role(sl->arg)) < 0)
+                scenario_error(sl, "unknown role");
+        } else if (!strcmp(sl->cmd, "race")) {
+            if ((flags.initrace = str2race(sl->arg)) < 0)
+                scenario_error(sl, "unknown race");
+        } else if (!strcmp(sl->cmd, "gender")) {
+            if ((flags.initgend = str2gend(sl->arg)) < 0)
+                scenario_error(sl, "unknown gender");
+        } else if (!strcmp(sl->cmd, "align")) {
+            if ((flags.initalign = str2align(sl->arg)) < 0)
+                scenario_error(sl, "unknown alignment");
+        } else if (!strcmp(sl->cmd, "option")) {
+            parseoptions(sl->arg, TRUE, FALSE);
+        } else if (!strcmp(sl->cmd, "keys")) {
+            for (p = sl->arg, q = keys; *p; p++) {
+                if (*p == '\\' && p[1]) {
+                    switch (*++p) {
+                    case 'n':
+                        *q++ = '\n';
+                        break;
+                    case 'e':
+                        *q++ = '\033';
+                        break;
+                    case 'd':
+                        *q++ = '\177';
+                        break;
+                    default:
+                        *q++ = *p;
+                        break;
+                    }
+                } else
+                    *q++ = *p;
+            }
+            *q = '\0';
+            if (!*keys)
+                scenario_error(sl, "empty key stream");
+        } else if (!strcmp(sl->cmd, "answer")) {
+            if (nanswers >= MAXANSWERS)
+                scenario_error(sl, "too many answers");
+            if (!sl->arg[0] || sl->arg[1] != ' ')
+                scenario_error(sl, "expected an answer character");
+            answers[nanswers].key = sl->arg[0];
+            for (p = &sl->arg[1]; *p == ' '; p++)
+                continue;
+            Strcpy(answers[nanswers++].prompt, p);
+        }
+    }
+    for (i = 0; i < NUM_BENCH_SLOTS; i++)
+        slot_time[i] = 0.0, slot_calls[i] = 0L, slot_depth[i] = 0;
+}
+
+/* directives that act on the running game, in scenario order */
+static void
+setup_level()
+{
+    struct bench_line *sl;
+    struct monst *mtmp;
+    int i, n, x, y;
+    char *p;
+
+    for (sl = scnlines; sl < &scnlines[nscnlines]; sl++) {
+        n = atoi(sl->arg);
+        if (!strcmp(sl->cmd, "setenv")) {
+            for (p = sl->arg; *p && *p != ' '; p++)
+                continue;
+            if (*p)
+                *p++ = '\0';
+            (void) setenv(sl->arg, p, 1);
+        } else if (!strcmp(sl->cmd, "level")) {
+            goto_dungeon_level(sl);
+        } else if (!strcmp(sl->cmd, "special")) {
+            s_level *slev = find_level(sl->arg);
+
+            if (!slev)
+                scenario_error(sl, "not in this dungeon; try another seed");
+            bench_goto(&slev->dlevel);
+        } else if (!strcmp(sl->cmd, "monsters")) {
+            for (i = 0; i < n; i++)
+                (void) makemon((struct permonst *) 0, 0, 0, NO_MM_FLAGS);
+        } else if (!strcmp(sl->cmd, "objects")) {
+            for (i = 0; i < n; i++)
+                if (random_spot(&x, &y))
+                    (void) mkobj_at(RANDOM_CLASS, x, y, TRUE);
+        } else if (!strcmp(sl->cmd, "corpses")) {
+            for (i = 0; i < n; i++)
+                if (random_spot(&x, &y))
+                    (void) mkcorpstat(CORPSE, (struct monst *) 0,
+                                      (struct permonst *) 0, x, y,
+                                      CORPSTAT_INIT);
+        } else if (!strcmp(sl->cmd, "place")) {
+            place_hero(sl);
+        } else if (!strcmp(sl->cmd, "hp")) {
+            if (n <= 0)
+                scenario_error(sl, "expected a positive number");
+            u.uhp = u.uhpmax = n;
+            context.botl = 1;
+        } else if (!strcmp(sl->cmd, "map")) {
+            do_mapping();
+        } else if (!strcmp(sl->cmd, "bones")) {
+            if (!can_make_bones())
+                scenario_error(sl, "bones are not allowed on this level");
+            make_bones();
+        } else if (strcmp(sl->cmd, "seed") && strcmp(sl->cmd, "turns")
+                   && strcmp(sl->cmd, "role") && strcmp(sl->cmd, "race")
+                   && strcmp(sl->cmd, "gender") && strcmp(sl->cmd, "align")
+                   && strcmp(sl->cmd, "option") && strcmp(sl->cmd, "keys")
+                   && strcmp(sl->cmd, "answer")) {
+            scenario_error(sl, "unknown directive");
+        }
+    }
+    /* anything made above should be displayed before timing starts */
+    for (mtmp = fmon; mtmp; mtmp = mtmp->nmon)
+        mtmp->movement = 0;
+    vision_full_recalc = 1;
+    docrt();
+}
+
+static void
+bench_goto(newlevel)
+d_level *newlevel;
+{
+    goto_level(newlevel, FALSE, FALSE, FALSE);
+    if (!on_level(&u.uz, newlevel))
+        error("%s: could not reach level %d of %s.", scenario,
+              (int) newlevel->dlevel, dungeons[newlevel->dnum].dname);
+}
+
+/* "level <dungeon name> <level number|filler>" */
+static void
+goto_dungeon_level(sl)
+struct bench_line *sl;
+{
+    d_level newlevel;
+    char name[BUFSZ], *spec, *dn;
+    int i;
+
+    Strcpy(name, sl->arg);
+    if (!(spec = rindex(name, ' ')))
+        scenario_error(sl, "expected a dungeon name and a level");
+    *spec++ = '\0';
+    for (i = 0; i < n_dgns; i++) {
+        dn = dungeons[i].dname;
+        if (!strcmpi(name, dn)
+            || (!strncmpi(dn, "The ", 4) && !strcmpi(name, dn + 4)))
+            break;
+    }
+    if (i == n_dgns)
+        scenario_error(sl, "unknown dungeon");
+    newlevel.dnum = i;
+    if (!strcmpi(spec, "filler")) {
+        for (i = 1; i <= dungeons[newlevel.dnum].num_dunlevs; i++) {
+            newlevel.dlevel = i;
+            if (!Is_special(&newlevel) && !Is_branchlev(&newlevel))
+                break;
+        }
+        if (i > dungeons[newlevel.dnum].num_dunlevs)
+            scenario_error(sl, "dungeon has no filler level");
+    } else if ((i = atoi(spec)) < 1
+               || i > dungeons[newlevel.dnum].num_dunlevs)
+        scenario_error(sl, "level number out of range");
+    else
+        newlevel.dlevel = i;
+    bench_goto(&newlevel);
+}
+
+/* an unoccupied square that objects can be placed on */
+static boolean
+random_spot(x, y)
+int *x, *y;
+{
+    int tries;
+
+    for (tries = 0; tries < 500; tries++) {
+        *x = rn1(COLNO - 3, 2);
+        *y = rn2(ROWNO);
+        if (ACCESSIBLE(levl[*x][*y].typ) && !is_pool_or_lava(*x, *y))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void
+place_hero(sl)
+struct bench_line *sl;
+{
+    struct mkroom *sroom;
+    int x, y;
+
+    if (!strcmp(sl->arg, "shop")) {
+        for (sroom = &rooms[0]; sroom->hx > 0; sroom++)
+            if (sroom->rtype >= SHOPBASE)
+                break;
+        if (sroom->hx <= 0)
+            scenario_error(sl, "no shop on this level");
+        for (x = sroom->lx; x <= sroom->hx; x++)
+            for (y = sroom->ly; y <= sroom->hy; y++)
+                if (!MON_AT(x, y))
+                    goto found;
+        scenario_error(sl, "shop is full");
+    } else if (!strcmp(sl->arg, "random")) {
+        u_on_rndspot(0);
+        goto placed;
+    } else if (!strcmp(sl->arg, "downstair")) {
+        if (!xdnstair)
+            scenario_error(sl, "no down stairs on this level");
+        x = xdnstair, y = ydnstair;
+    } else {
+        scenario_error(sl, "expected shop, random or downstair");
+    }
+found:
+    u_on_newpos(x, y);
+placed:
+    vision_full_recalc = 1;
+    check_special_room(FALSE);
+}
+
+/* stand-in for the death of a previous hero: save the current level as
+   a bones file, leave it, discard our copy and come back so that it is
+   regenerated from the bones through getbones() and getlev() */
+static void
+make_bones()
+{
+    d_level here, away;
+    struct monst *mtmp;
+    char c, *bonesid, whynot[BUFSZ];
+    int fd;
+
+    assign_level(&here, &u.uz);
+    assign_level(&away, &u.uz);
+    away.dlevel += (away.dlevel > 1) ? -1 : 1;
+
+    for (mtmp = fmon; mtmp; mtmp = mtmp->nmon)
+        mtmp->mtame = mtmp->mpeaceful = 0, mtmp->mlstmv = 0L;
+    in_mklev = TRUE; /* allow creation at the hero's spot */
+    mtmp = makemon(&mons[PM_GHOST], u.ux, u.uy, MM_NONAME);
+    in_mklev = FALSE;
+    if (mtmp)
+        (void) christen_monst(mtmp, plname);
+    level.flags.wizard_bones = 1;
+
+    fd = create_bonesfile(&u.uz, &bonesid, whynot);
+    if (fd < 0)
+        error("%s", whynot);
+    c = (char) (strlen(bonesid) + 1);
+    store_version(fd);
+    store_savefileinfo(fd);
+    bwrite(fd, (genericptr_t) &c, sizeof c);
+    bwrite(fd, (genericptr_t) bonesid, (unsigned) c);
+    savefruitchn(fd, WRITE_SAVE);
+    savelev(fd, ledger_no(&u.uz), WRITE_SAVE);
+    bclose(fd);
+    commit_bonesfile(&u.uz);
+
+    bench_goto(&away);
+    delete_levelfile(ledger_no(&here));
+    level_info[ledger_no(&here)].flags &= ~(VISITED | FORGOTTEN);
+    want_bones = TRUE;
+    bench_goto(&here);
+    want_bones = FALSE;
+    if (!u.uroleplay.numbones)
+        error("%s: bones file was not loaded.", scenario);
+}
+
+static void
+bench_finish()
+{
+    double elapsed = bench_now() - start_time;
+    long nturns = moves - start_moves;
+    struct monst *mtmp;
+    int i, nmon = 0;
+    long outbytes;
+
+    bench_hook = 0;
+    measuring = FALSE;
+    for (mtmp = fmon; mtmp; mtmp = mtmp->nmon)
+        if (!DEADMONSTER(mtmp))
+            nmon++;
+    (void) fprintf(report, "scenario: %s (seed %lu, %s movement)\n",
+                   scenario, seed, iflags.mon_flow ? "flow" : "compat");
+    (void) fprintf(report, "level: %s %d (depth %d), %d monsters\n",
+                   dungeons[u.uz.dnum].dname, (int) u.uz.dlevel,
+                   (int) depth(&u.uz), nmon);
+    (void) fprintf(report, "turns: %ld in %.3f s, %.1f turns/sec", nturns,
+                   elapsed, elapsed > 0.0 ? (double) nturns / elapsed : 0.0);
+    if (nkeys > maxkeys)
+        (void) fprintf(report, " (stopped: key limit)");
+    (void) fprintf(report, "\n");
+    for (i = 0; i < NUM_BENCH_SLOTS; i++)
+        (void) fprintf(report,
+                       "%-14s %9.3f s %6.1f%% %9ld calls %10.1f us/turn\n",
+                       slot_names[i], slot_time[i],
+                       elapsed > 0.0 ? 100.0 * slot_time[i] / elapsed : 0.0,
+                       slot_calls[i],
+                       nturns ? 1.0e6 * slot_time[i] / nturns : 0.0);
+    if (use_tty) {
+        (void) fflush(stdout);
+        outbytes = (long) (lseek(fileno(stdout), (off_t) 0, SEEK_CUR)
+                           - tty_out_start);
+        (void) fprintf(report, "tty output: %ld bytes, %.1f per flush_screen"
+                               ", %.1f per turn\n",
+                       outbytes,
+                       slot_calls[BENCH_FLUSH]
+                           ? (double) outbytes / slot_calls[BENCH_FLUSH]
+                           : 0.0,
+                       nturns ? (double) outbytes / nturns : 0.0);
+    }
+    (void) fflush(report);
+
+    clearlocks();
+    exit_nhwindows((char *) 0);
+    terminate(EXIT_SUCCESS);
+}
+
+/* -V: compare the vision algorithms on newly made levels, then exit */
+static void
+vision_test(nlevels)
+int nlevels;
+{
+    d_level newlevel;
+    int ndiff, total = 0;
+
+    newlevel.dnum = 0;
+    for (newlevel.dlevel = 1; newlevel.dlevel <= nlevels
+                              && newlevel.dlevel <= dungeons[0].num_dunlevs;
+         newlevel.dlevel++) {
+        bench_goto(&newlevel);
+#ifdef VISION_BITS
+        ndiff = vision_diff();
+#else
+        ndiff = 0;
+#endif
+        (void) printf("vision: %s %d: %d viewpoints differ\n",
+                      dungeons[0].dname, (int) newlevel.dlevel, ndiff);
+        total += ndiff;
+    }
+    (void) fflush(stdout);
+
+    clearlocks();
+    exit_nhwindows((char *) 0);
+    terminate(total ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/* -L: end the game in many processes at once, then check the logs */
+static void
+log_stress(nprocs)
+int nprocs;
+{
+    off_t start[2];
+    struct stat st;
+    double begin, elapsed;
+    pid_t pid;
+    int i, n, status, failed = 0;
+
+    start[0] = start[1] = (off_t) 0;
+#ifdef LOGFILE
+    if (stat(fqname(LOGFILE, SCOREPREFIX, 0), &st) == 0)
+        start[0] = st.st_size;
+#endif
+#ifdef XLOGFILE
+    if (stat(fqname(XLOGFILE, SCOREPREFIX, 0), &st) == 0)
+        start[1] = st.st_size;
+#endif
+    killer.format = NO_KILLER_PREFIX;
+    Strcpy(killer.name, "quit");
+    program_state.stopprint++;
+    program_state.done_hup++; /* quiet, even about failures */
+    (void) fflush(stdout);
+
+    begin = bench_now();
+    for (i = 0; i < nprocs; i++) {
+        if ((pid = fork()) < 0)
+            error("%s: cannot fork.", hname);
+        if (pid == 0) {
+            Sprintf(plname, "stress%d", i);
+            for (n = 0; n < LOG_STRESS_GAMES; n++)
+                topten(QUIT, getnow());
+            _exit(EXIT_SUCCESS);
+        }
+    }
+    while (wait(&status) > 0)
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+            failed++;
+    elapsed = bench_now() - begin;
+
+    (void) printf("log stress: %d processes x %d games in %.3f s, "
+                  "%.1f games/sec\n",
+                  nprocs, LOG_STRESS_GAMES, elapsed,
+                  elapsed > 0.0 ? nprocs * LOG_STRESS_GAMES / elapsed : 0.0);
+    if (failed)
+        (void) printf("log stress: %d processes failed\n", failed);
+#ifdef LOGFILE
+    failed += check_log(LOGFILE, start[0], nprocs, FALSE);
+#endif
+#ifdef XLOGFILE
+    failed += check_log(XLOGFILE, start[1], nprocs, TRUE);
+#endif
+    (void) fflush(stdout);
+
+    clearlocks();
+    exit_nhwindows((char *) 0);
+    terminate(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+#ifdef SCORE_INDEX
+/*
+ * End the game 'ngames' times outside wizard mode, so that each score
+ * is appended to the index, then check that the index got compacted.
+ */
+static void
+index_stress(ngames)
+int ngames;
+{
+    double begin, elapsed;
+    boolean bloated;
+    int n;
+
+    killer.format = NO_KILLER_PREFIX;
+    Strcpy(killer.name, "quit");
+    program_state.stopprint++;
+    program_state.done_hup++; /* quiet, even about failures */
+    wizard = FALSE;
+    sysopt.persmax = sysopt.entrymax; /* so every game makes the list */
+    (void) fflush(stdout);
+
+    begin = bench_now();
+    for (n = 0; n < ngames; n++) {
+        Sprintf(plname, "stress%d", n % 10);
+        u.urexp = 1000L + (n * 7919L) % 100000L; /* enough to be listed */
+        topten(QUIT, getnow());
+    }
+    elapsed = bench_now() - begin;
+    bloated = score_index_bloated();
+
+    (void) printf("index stress: %d games in %.3f s, %.1f games/sec\n",
+                  ngames, elapsed, elapsed > 0.0 ? ngames / elapsed : 0.0);
+    if (bloated)
+        (void) printf("index stress: %s was not compacted\n", SCORE_INDEX);
+    (void) fflush(stdout);
+
+    clearlocks();
+    exit_nhwindows((char *) 0);
+    terminate(bloated ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+#endif /* SCORE_INDEX */
+
+#if defined(LOGFILE) || defined(XLOGFILE)
+/* check the lines added to a log by log_stress(); returns 1 if bad */
+static int
+check_log(fname, start, nprocs, xlog)
+const char *fname;
+off_t start;
+int nprocs;
+boolean xlog;
+{
+    char line[4 * BUFSZ], *p;
+    long *count, nlines = 0L, nbad = 0L, nshort = 0L;
+    int i, who, len, tabs, ntabs = -1;
+    FILE *fp;
+
+    if (!(fp = fopen_datafile(fname, "r", SCOREPREFIX))
+        || fseek(fp, (long) start, SEEK_SET) != 0) {
+        (void) printf("%s: cannot read\n", fname);
+        return 1;
+    }
+    count = (long *) alloc(nprocs * sizeof (long));
+    for (i = 0; i < nprocs; i++)
+        count[i] = 0L;
+    while (fgets(line, sizeof line, fp)) {
+        nlines++;
+        who = -1;
+        len = (int) strlen(line);
+        if (len == 0 || line[len - 1] != '\n') {
+            ; /* torn */
+        } else if (xlog) {
+            /* same fields as every other line, and one name */
+            for (tabs = 0, p = line; (p = index(p, '\t')) != 0; p++)
+                tabs++;
+            if (ntabs < 0)
+                ntabs = tabs;
+            if (!strncmp(line, "version=", 8) && tabs == ntabs
+                && (p = strstr(line, "\tname=stress")) != 0
+                && !strstr(p + 6, "name=") && !strstr(p, "version="))
+                who = atoi(p + 12);
+        } else {
+            /* "v.v.v points ... uid role race gender align name,death" */
+            int n = 0;
+
+            for (p = line; *p && *p != ','; p++)
+                if (*p == ' ')
+                    n++;
+            p = rindex(line, ' ');
+            if (n == 15 && p && !strncmp(p + 1, "stress", 6)
+                && !strcmp(index(p, ','), ",quit\n"))
+                who = atoi(p + 7);
+        }
+        if (who >= 0 && who < nprocs)
+            count[who]++;
+        else
+            nbad++;
+    }
+    (void) fclose(fp);
+    for (i = 0; i < nprocs; i++)
+        if (count[i] != LOG_STRESS_GAMES)
+            nshort++;
+    free((genericptr_t) count);
+    (void) printf("%s: %ld lines, %ld malformed, %ld processes with lines "
+                  "missing\n", fname, nlines, nbad, nshort);
+    return (nbad || nshort || nlines != (long) nprocs * LOG_STRESS_GAMES);
+}
+#endif
+
+/* -P: collect the names of the levels in a level description file */
+static void
+read_levnames(fname)
+const char *fname;
+{
+    FILE *fp;
+    char buf[BUFSZ], *p, *q;
+
+    if (!(fp = fopen(fname, "r"))) {
+        perror(fname);
+        error("%s: cannot open %s.", hname, fname);
+    }
+    while (fgets(buf, BUFSZ, fp)) {
+        if (strncmp(buf, "LEVEL", 5) && strncmp(buf, "MAZE", 4))
+            continue;
+        if (!(p = index(buf, '"')) || !(q = index(++p, '"')) || q == p)
+            continue;
+        *q = '\0';
+        if (nsplevs == MAXSPLEVS)
+            error("%s: more than %d levels.", hname, MAXSPLEVS);
+        splevs[nsplevs++] = dupstr(p);
+    }
+    (void) fclose(fp);
+}
+
+/* fold a value into a checksum */
+#define SPLEV_MIX(h, v) ((h) = ((h) ^ (unsigned long) (v)) * 16777619UL \
+                               & 0xffffffffUL)
+
+/* checksum of what a special level put on the map */
+static unsigned long
+splev_sum()
+{
+    unsigned long h = 2166136261UL;
+    struct rm *lev;
+    struct obj *otmp, *stack[10];
+    struct monst *mtmp;
+    struct trap *ttmp;
+    struct engr *ep;
+    struct mkroom *croom;
+    const char *p;
+    int x, y, i, depth;
+
+    for (x = 0; x < COLNO; x++)
+        for (y = 0; y < ROWNO; y++) {
+            lev = &levl[x][y];
+            SPLEV_MIX(h, lev->typ);
+            SPLEV_MIX(h, (lev->flags << 8) | (lev->horizontal << 5)
+                             | (lev->lit << 4) | (lev->edge << 3)
+                             | (lev->candig << 2));
+            SPLEV_MIX(h, lev->roomno);
+            if ((ep = engr_at(x, y)) != 0) {
+                SPLEV_MIX(h, ep->engr_type);
+                for (p = ep->engr_txt; *p; p++)
+                    SPLEV_MIX(h, *p);
+            }
+        }
+    /* objects, including the contents of containers */
+    for (i = 0; i < 2; i++) {
+        otmp = i ? level.buriedobjlist : fobj;
+        depth = 0;
+        while (otmp) {
+            SPLEV_MIX(h, (otmp->otyp << 16) | (otmp->ox << 8) | otmp->oy);
+            SPLEV_MIX(h, otmp->quan);
+            SPLEV_MIX(h, (otmp->spe << 8) | (otmp->blessed << 1)
+                             | otmp->cursed);
+            SPLEV_MIX(h, otmp->corpsenm);
+            SPLEV_MIX(h, otmp->owt);
+            if (otmp->cobj && depth < SIZE(stack)) {
+                stack[depth++] = otmp;
+                otmp = otmp->cobj;
+                continue;
+            }
+            while (!otmp->nobj && depth > 0)
+                otmp = stack[--depth];
+            otmp = otmp->nobj;
+        }
+    }
+    for (mtmp = fmon; mtmp; mtmp = mtmp->nmon) {
+        if (DEADMONSTER(mtmp))
+            continue;
+        SPLEV_MIX(h, (monsndx(mtmp->data) << 16) | (mtmp->mx << 8)
+                         | mtmp->my);
+        SPLEV_MIX(h, mtmp->mhpmax);
+        SPLEV_MIX(h, (mtmp->mpeaceful << 2) | (mtmp->msleeping << 1)
+                         | mtmp->mcanmove);
+        for (otmp = mtmp->minvent; otmp; otmp = otmp->nobj)
+            SPLEV_MIX(h, (otmp->otyp << 16) | otmp->quan);
+    }
+    for (ttmp = ftrap; ttmp; ttmp = ttmp->ntrap)
+        SPLEV_MIX(h, (ttmp->ttyp << 16) | (ttmp->tx << 8) | ttmp->ty);
+    for (croom = rooms; croom < &rooms[nroom]; croom++)
+        SPLEV_MIX(h, (croom->rtype << 24) | (croom->lx << 16)
+                         | (croom->hx << 8) | croom->ly);
+    SPLEV_MIX(h, (xupstair << 24) | (yupstair << 16) | (xdnstair << 8)
+                     | ydnstair);
+    SPLEV_MIX(h, (sstairs.sx << 8) | sstairs.sy);
+    SPLEV_MIX(h, num_lregions);
+    SPLEV_MIX(h, rn2(1000)); /* where the random sequence ended up */
+    return h;
+}
+
+/* -P: load every special level many times over, then exit */
+static void
+splev_test(reps, fp, writing)
+int reps;
+FILE *fp;        /* -C file, or null */
+boolean writing; /* whether to write sums to fp rather than check them */
+{
+    char name[BUFSZ], buf[BUFSZ], *p;
+    unsigned long sum, *sums, want;
+    double start, elapsed, total = 0.0;
+    s_level *slev;
+    int i, n, r, nbad = 0;
+
+    sums = (unsigned long *) alloc((unsigned) nsplevs * sizeof *sums);
+    for (i = 0; i < nsplevs; i++) {
+        /* be on the level if it is part of this game's dungeon */
+        Strcpy(name, splevs[i]);
+        if (!(slev = find_level(name)) && (p = rindex(name, '-')) != 0
+            && digit(p[1])) {
+            *p = '\0';
+            slev = find_level(name);
+        }
+        if (slev)
+            assign_level(&u.uz, &slev->dlevel);
+        Sprintf(name, "%s%s", splevs[i], LEV_EXT);
+
+        seedrandom(seed);
+        sum = 0L;
+        elapsed = 0.0;
+        for (r = 0; r < reps; r++) {
+            savelev(-1, ledger_no(&u.uz), FREE_SAVE);
+            save_waterlevel(-1, FREE_SAVE);
+            clear_level_structures();
+            in_mklev = TRUE;
+            start = bench_now();
+            if (!load_special(name))
+                error("%s: cannot load %s.", hname, name);
+            elapsed += bench_now() - start;
+            dmonsfree();
+            in_mklev = FALSE;
+            SPLEV_MIX(sum, splev_sum());
+            for (n = 0; n < num_lregions; n++)
+                if (lregions[n].rname.str)
+                    free((genericptr_t) lregions[n].rname.str);
+            if (lregions)
+                free((genericptr_t) lregions), lregions = 0;
+            num_lregions = 0;
+        }
+        sums[i] = sum;
+        total += elapsed;
+        (void) printf("splev: %-10s %8.1f us/load  %08lx\n", splevs[i],
+                      elapsed * 1.0e6 / reps, sum);
+    }
+    (void) printf("splev: %d levels x %d loads in %.3f s, %.1f us/load\n",
+                  nsplevs, reps, total, total * 1.0e6 / (nsplevs * reps));
+
+    if (fp) {
+        for (i = 0; i < nsplevs; i++) {
+            if (writing) {
+                (void) fprintf(fp, "%s %d %08lx\n", splevs[i], reps,
+                               sums[i]);
+                continue;
+            }
+            /* sums are only comparable for the same number of loads */
+            Sprintf(name, "%s %d ", splevs[i], reps);
+            want = 0L;
+            rewind(fp);
+            while (fgets(buf, BUFSZ, fp))
+                if (!strncmp(buf, name, strlen(name))) {
+                    want = strtoul(buf + strlen(name), (char **) 0, 16);
+                    break;
+                }
+            if (want != sums[i]) {
+                (void) printf("splev: %s differs from the saved sum\n",
+                              splevs[i]);
+                nbad++;
+            }
+        }
+        (void) fclose(fp);
+        (void) printf("splev: %s %d checksums\n",
+                      writing ? "saved" : "checked", nsplevs);
+    }
+    free((genericptr_t) sums);
+    (void) fflush(stdout);
+
+    clearlocks();
+    exit_nhwindows((char *) 0);
+    terminate(nbad ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/* unixmain.c entry points the core expects */
+
+void
+sethanguphandler(handler)
+void FDECL((*handler), (int));
+{
+    (void) signal(SIGHUP, (SIG_RET_TYPE) handler);
+}
+
+#ifdef PORT_HELP
+void
+port_help()
+{
+    display_file(PORT_HELP, TRUE);
+}
+#endif
+
+boolean
+authorize_wizard_mode()
+{
+    return TRUE;
+}
+
+boolean
+check_user_string(optstr)
+char *optstr UNUSED;
+{
+    return TRUE;
+}
+
+/*nhbench.c*/
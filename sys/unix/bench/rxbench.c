@@ -0,0 +1,284 @@
+/* NetHack 3.6	rxbench.c	$NHDT-Date$  $NHDT-Branch$:$NHDT-Revision$ */
+/* NetHack may be freely redistributed.  See license for details. */
+
+/*
+ * rxbench - microbenchmark for the nhregex interface.
+ *
+ *      rxbench [-n passes] patterns strings
+ *      rxbench -p
+ *
+ * It is linked with the regex backend named by REGEXOBJ in src/Makefile
+ * and nothing else of the game but alloc.o and hacklib.o, so comparing
+ * backends means relinking it, eg.
+ *      rm -f src/rxbench; make -C src rxbench REGEXOBJ=dfaregex.o
+ *
+ * Each line of 'patterns' holds a pattern between its first and last
+ * double quotes, so the MENUCOLOR and MSGTYPE lines of a configuration
+ * file can be used as they are; '#' starts a comment line.  Each line of
+ * 'strings' is matched against them in order, first with regex_match()
+ * on one pattern after another until one matches, then with a single
+ * regex_set_match() on a set of all of them.  The report gives the time
+ * to compile the patterns and the time per string for each method, over
+ * 'passes' passes (default 200); the exit status is nonzero if the two
+ * methods ever pick a different pattern.
+ *
+ * sys/unix/bench holds corpora for both: menucolor.rc against menus.txt
+ * (inventory lines) and msgtype.rc against messages.txt (the messages
+ * from running the nhbench scenarios).
+ *
+ * With -p it instead matches patterns which take a backtracking matcher
+ * exponential time, such as "(a|aa)*c", against strings of a's of
+ * increasing length.  A pattern is dropped once a match takes more than
+ * RX_SLOW seconds.
+ */
+
+#define NEED_VARARGS
+#include "hack.h"
+
+#include <time.h>
+
+#define MAXRXPATS 1000
+#define MAXRXSTRS 20000
+#define RX_SLOW 0.02
+
+extern const char regex_id[];
+
+static struct nhregex *pats[MAXRXPATS];
+static int npats = 0;
+static char *strs[MAXRXSTRS];
+static int nstrs = 0;
+static double compile_time;
+
+static double NDECL(rx_now);
+static char *FDECL(rx_getline, (FILE *, char *, int));
+static void FDECL(read_patterns, (const char *));
+static void FDECL(read_strings, (const char *));
+static int FDECL(corpus_bench, (int));
+static void NDECL(pathological);
+
+int
+main(argc, argv)
+int argc;
+char *argv[];
+{
+    int passes = 200;
+
+    if (argc == 2 && !strcmp(argv[1], "-p")) {
+        pathological();
+        return EXIT_SUCCESS;
+    }
+    if (argc == 5 && !strcmp(argv[1], "-n")) {
+        passes = atoi(argv[2]);
+        argc -= 2;
+        argv += 2;
+    }
+    if (argc != 3 || passes < 1) {
+        (void) fprintf(stderr,
+                       "Usage: %s [-n passes] patterns strings\n"
+                       "       %s -p\n", argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+    read_patterns(argv[1]);
+    read_strings(argv[2]);
+    return corpus_bench(passes);
+}
+
+void panic
+VA_DECL(const char *, str)
+{
+    VA_START(str);
+    VA_INIT(str, char *);
+    (void) fputs("rxbench: ", stderr);
+    Vfprintf(stderr, str, VA_ARGS);
+    (void) fputc('\n', stderr);
+    VA_END();
+    exit(EXIT_FAILURE);
+}
+
+static double
+rx_now()
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1.0e9;
+}
+
+/* fgets() without the newline */
+static char *
+rx_getline(fp, buf, size)
+FILE *fp;
+char *buf;
+int size;
+{
+    char *p;
+
+    if (!fgets(buf, size, fp))
+        return (char *) 0;
+    if ((p = index(buf, '\n')) != 0)
+        *p = '\0';
+    return buf;
+}
+
+static void
+read_patterns(fname)
+const char *fname;
+{
+    FILE *fp;
+    char buf[BUFSZ], *first, *last;
+    double start;
+
+    if (!(fp = fopen(fname, "r")))
+        panic("cannot open %s", fname);
+    compile_time = 0.0;
+    while (rx_getline(fp, buf, BUFSZ)) {
+        if (*buf == '#' || !(first = index(buf, '"'))
+            || (last = rindex(buf, '"')) == first)
+            continue;
+        *last = '\0';
+        if (npats == MAXRXPATS)
+            panic("%s: more than %d patterns", fname, MAXRXPATS);
+        start = rx_now();
+        pats[npats] = regex_init();
+        if (!regex_compile(first + 1, pats[npats])) {
+            (void) fprintf(stderr, "%s: \"%s\": %s\n", fname, first + 1,
+                           regex_error_desc(pats[npats]));
+            regex_free(pats[npats]);
+            continue;
+        }
+        compile_time += rx_now() - start;
+        npats++;
+    }
+    (void) fclose(fp);
+}
+
+static void
+read_strings(fname)
+const char *fname;
+{
+    FILE *fp;
+    char buf[BUFSZ];
+
+    if (!(fp = fopen(fname, "r")))
+        panic("cannot open %s", fname);
+    while (rx_getline(fp, buf, BUFSZ)) {
+        if (nstrs == MAXRXSTRS)
+            panic("%s: more than %d strings", fname, MAXRXSTRS);
+        strs[nstrs++] = dupstr(buf);
+    }
+    (void) fclose(fp);
+}
+
+static int
+corpus_bench(passes)
+int passes;
+{
+    struct nhregex_set *set;
+    int *loopidx, *setidx, pass, i, j, matched = 0, differ = 0;
+    double start, looptime, firsttime, settime;
+
+    if (!npats || !nstrs)
+        panic("no patterns or no strings");
+    loopidx = (int *) alloc((unsigned) nstrs * sizeof (int));
+    setidx = (int *) alloc((unsigned) nstrs * sizeof (int));
+
+    start = rx_now();
+    for (pass = 0; pass < passes; pass++)
+        for (j = 0; j < nstrs; j++) {
+            for (i = 0; i < npats; i++)
+                if (regex_match(strs[j], pats[i]))
+                    break;
+            loopidx[j] = (i < npats) ? i : -1;
+        }
+    looptime = rx_now() - start;
+
+    /* the first pass includes whatever work the set defers */
+    start = rx_now();
+    set = regex_set_init();
+    for (i = 0; i < npats; i++)
+        regex_set_add(set, pats[i]);
+    for (j = 0; j < nstrs; j++)
+        setidx[j] = regex_set_match(strs[j], set, 0);
+    firsttime = rx_now() - start;
+    start = rx_now();
+    for (pass = 0; pass < passes; pass++)
+        for (j = 0; j < nstrs; j++)
+            setidx[j] = regex_set_match(strs[j], set, 0);
+    settime = rx_now() - start;
+
+    for (j = 0; j < nstrs; j++) {
+        if (loopidx[j] >= 0)
+            matched++;
+        if (loopidx[j] != setidx[j] && differ++ < 10)
+            (void) fprintf(stderr, "\"%s\": pattern %d one at a time, "
+                                   "%d as a set\n",
+                           strs[j], loopidx[j], setidx[j]);
+    }
+    (void) printf("%s: %d patterns, %d strings (%d matched), %d passes\n",
+                  regex_id, npats, nstrs, matched, passes);
+    (void) printf("  compile       %10.1f us\n", compile_time * 1.0e6);
+    (void) printf("  one at a time %10.1f ns/string\n",
+                  looptime * 1.0e9 / ((double) passes * nstrs));
+    (void) printf("  set 1st pass  %10.1f ns/string\n",
+                  firsttime * 1.0e9 / nstrs);
+    (void) printf("  set           %10.1f ns/string\n",
+                  settime * 1.0e9 / ((double) passes * nstrs));
+    if (differ)
+        (void) printf("  %d strings matched a different pattern as a set\n",
+                      differ);
+
+    regex_set_free(set);
+    free((genericptr_t) loopidx);
+    free((genericptr_t) setidx);
+    return differ ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static void
+pathological()
+{
+    static const char *const nasty[] = {
+        "(a|aa)*c", "(a*)*b", "(a+)+b", "(a|a?)+c", "(.*a){8}b",
+    };
+    static const int lens[] = { 10, 15, 20, 25, 30, 100, 1000, 10000 };
+    struct nhregex *re;
+    char *str;
+    double start, elapsed;
+    int i, j, reps;
+
+    str = (char *) alloc(lens[SIZE(lens) - 1] + 1);
+    (void) printf("%s: us per match against a string of n a's\n", regex_id);
+    (void) printf("%-12s", "pattern");
+    for (j = 0; j < SIZE(lens); j++)
+        (void) printf(" %8d", lens[j]);
+    (void) printf("\n");
+    for (i = 0; i < SIZE(nasty); i++) {
+        re = regex_init();
+        if (!regex_compile(nasty[i], re))
+            panic("\"%s\": %s", nasty[i], regex_error_desc(re));
+        (void) printf("%-12s", nasty[i]);
+        elapsed = 0.0;
+        for (j = 0; j < SIZE(lens); j++) {
+            if (elapsed > RX_SLOW) {
+                (void) printf(" %8s", "-");
+                continue;
+            }
+            (void) memset((genericptr_t) str, 'a', lens[j]);
+            str[lens[j]] = '\0';
+            reps = 0;
+            start = rx_now();
+            do {
+                (void) regex_match(str, re);
+                reps++;
+                elapsed = rx_now() - start;
+            } while (elapsed < RX_SLOW && reps < 1000);
+            (void) printf(" %8.1f", elapsed * 1.0e6 / reps);
+            (void) fflush(stdout);
+            elapsed /= reps;
+        }
+        (void) printf("\n");
+        regex_free(re);
+    }
+    free((genericptr_t) str);
+}
+
+/*rxbench.c*/
@@ -64,6 +64,7 @@ static const char SCCS_Id[] = "@(#)makedefs.c\t3.5\t2004/02/01";
 #endif
 #define ORACLE_FILE "oracles"
 #define DATA_FILE "data"
+#define DATAIDX_FILE "dataidx"
 #define RUMOR_FILE "rumors"
 #define DGN_I_FILE "dungeon.def"
 #define DGN_O_FILE "dungeon.pdf"
@@ -172,7 +173,13 @@ static char *FDECL(xcrypt, (const char *));
 static unsigned long FDECL(read_rumors_file,
                            (const char *, int *, long *, unsigned long));
 static void FDECL(do_rnd_access_file, (const char *));
+static void FDECL(add_line_offset, (long));
+static void FDECL(put_line_offsets, (FILE *));
 static boolean FDECL(d_filter, (char *));
+static void FDECL(dx_addkey, (char *));
+static void FDECL(dx_endentry, (long, int));
+static void FDECL(dx_putword, (unsigned long));
+static void FDECL(write_dataidx, (long));
 static boolean FDECL(h_filter, (char *));
 static boolean FDECL(ranged_attk, (struct permonst *));
 static int FDECL(mstrength, (struct permonst *));
@@ -863,7 +870,41 @@ const char *str;
     return buf;
 }
 
-#define PAD_RUMORS_TO 60
+/* offsets of the lines of a random-access text file, collected as they
+   are written; the game picks a line by picking one of these */
+static long *line_offsets = 0;
+static int line_offset_cnt = 0, line_offset_max = 0;
+
+static void
+add_line_offset(offset)
+long offset;
+{
+    if (line_offset_cnt == line_offset_max) {
+        line_offset_max = line_offset_max ? 2 * line_offset_max : 512;
+        line_offsets = (long *) realloc((genericptr_t) line_offsets,
+                                        line_offset_max * sizeof (long));
+        if (!line_offsets) {
+            perror("line offsets");
+            exit(EXIT_FAILURE);
+        }
+    }
+    line_offsets[line_offset_cnt++] = offset;
+}
+
+/* write the collected offsets one per line, then forget them */
+static void
+put_line_offsets(fp)
+FILE *fp;
+{
+    int i;
+
+    for (i = 0; i < line_offset_cnt; i++)
+        Fprintf(fp, "%06lx\n", (unsigned long) line_offsets[i]);
+    free((genericptr_t) line_offsets);
+    line_offsets = 0;
+    line_offset_cnt = line_offset_max = 0;
+}
+
 /* common code for do_rumors().  Return 0 on error. */
 static unsigned long
 read_rumors_file(file_ext, rumor_count, rumor_size, old_rumor_offset)
@@ -885,31 +926,12 @@ unsigned long old_rumor_offset;
 
     /* copy the rumors */
     while ((line = fgetline(ifp)) != 0) {
-#ifdef PAD_RUMORS_TO
-        /* rumor selection is accomplished by seeking to a random
-           position in the file, advancing to newline, and taking
-           the next line; therefore, rumors which follow long-line
-           rumors are most likely to be chosen and rumors which
-           follow short-line rumors are least likely to be chosen;
-           we ameliorate the latter by padding the shortest lines,
-           increasing the chance of the random seek landing in them */
-        int len = (int) strlen(line);
-
-        if (len <= PAD_RUMORS_TO) {
-            char *base = index(line, '\n');
-            /* this is only safe because fgetline() overallocates */
-            while (len++ < PAD_RUMORS_TO) {
-                *base++ = '_';
-            }
-            *base++ = '\n';
-            *base = '\0';
-        }
-#endif
         (*rumor_count)++;
 #if 0
         /*[if we forced binary output, this would be sufficient]*/
         *rumor_size += strlen(line); /* includes newline */
 #endif
+        add_line_offset(ftell(tfp));
         (void) fputs(xcrypt(line), tfp);
         free(line);
     }
@@ -953,15 +975,32 @@ const char *fname;
     grep0(ifp, tfp);
     ifp = getfp(DATA_TEMPLATE, "grep.tmp", RDTMODE);
 
+    /* collect the text, noting where each line starts */
+    tfp = getfp(DATA_TEMPLATE, "rndtxt.tmp", WRTMODE);
     while ((line = fgetline(ifp)) != 0) {
-        if (line[0] != '#' && line[0] != '\n')
-            (void) fputs(xcrypt(line), ofp);
+        if (line[0] != '#' && line[0] != '\n') {
+            add_line_offset(ftell(tfp));
+            (void) fputs(xcrypt(line), tfp);
+        }
         free(line);
     }
     Fclose(ifp);
+    Fclose(tfp);
+
+    /* a count and the offsets, relative to the first line, precede
+       the text itself */
+    Fprintf(ofp, "%05d\n", line_offset_cnt);
+    put_line_offsets(ofp);
+    tfp = getfp(DATA_TEMPLATE, "rndtxt.tmp", RDTMODE);
+    while ((line = fgetline(tfp)) != 0) {
+        (void) fputs(line, ofp);
+        free(line);
+    }
+    Fclose(tfp);
     Fclose(ofp);
 
     delete_file(DATA_TEMPLATE, "grep.tmp");
+    delete_file(DATA_TEMPLATE, "rndtxt.tmp");
     return;
 }
 
@@ -1043,6 +1082,9 @@ do_rumors()
         (void) fputs(line, ofp);
         free(line);
     }
+    /* the offset of every rumor, true ones first, follows at eof_offset;
+       the header is the same size in both files so the offsets hold */
+    put_line_offsets(ofp);
     /* all done; delete temp file */
     Fclose(tfp);
     Unlink(tempfile);
@@ -1141,7 +1183,7 @@ make_version()
      */
     version.struct_sizes1 =
         (((unsigned long) sizeof(struct context_info) << 24)
-         | ((unsigned long) sizeof(struct obj) << 17)
+         | ((unsigned long) OBJ_SAVESZ << 17)
          | ((unsigned long) sizeof(struct monst) << 10)
          | ((unsigned long) sizeof(struct you)));
     version.struct_sizes2 = (((unsigned long) sizeof(struct flag) << 10) |
@@ -1594,6 +1636,171 @@ char *line;
     return FALSE;
 }
 
+/* keys of 'data', collected by do_data() for the 'dataidx' index */
+static struct dx_key {
+    char *name;          /* key, without any leading '~' */
+    unsigned long flags; /* DATAIDX_TILDE */
+    unsigned long entry; /* entry number; keys sharing text share this */
+    long offset;         /* offset of the entry's text in the text area */
+    int count;           /* # of lines of text */
+    unsigned long next;  /* next literal key in the same hash chain */
+} *dx_keys = 0;
+static int dx_nkeys = 0, dx_maxkeys = 0, dx_pending = 0;
+static unsigned long dx_nentries = 0;
+static boolean dx_done = FALSE;
+
+/* remember one key line for the index, mirroring how checkfile() reads
+   the key section: a line starting with '.' ends the search there, and
+   a line starting with a digit can't be matched */
+static void
+dx_addkey(line)
+char *line;
+{
+    struct dx_key *k;
+    char *p;
+
+    if (*line == '.')
+        dx_done = TRUE;
+    if (dx_done || (*line >= '0' && *line <= '9'))
+        return;
+    if (dx_nkeys == dx_maxkeys) {
+        dx_maxkeys = dx_maxkeys ? 2 * dx_maxkeys : 256;
+        dx_keys = (struct dx_key *) realloc((genericptr_t) dx_keys,
+                                            dx_maxkeys * sizeof *dx_keys);
+        if (!dx_keys) {
+            perror("dataidx keys");
+            exit(EXIT_FAILURE);
+        }
+    }
+    k = &dx_keys[dx_nkeys++];
+    k->flags = (*line == '~') ? DATAIDX_TILDE : 0UL;
+    if (k->flags)
+        line++;
+    k->name = malloc(strlen(line) + 1);
+    Strcpy(k->name, line);
+    if ((p = index(k->name, '\n')) != 0)
+        *p = '\0';
+    k->entry = dx_nentries;
+    k->offset = 0L;
+    k->count = 0;
+    k->next = DATAIDX_NONE;
+}
+
+/* an "offset,count" line closes every key seen since the previous one */
+static void
+dx_endentry(offset, count)
+long offset;
+int count;
+{
+    for (; dx_pending < dx_nkeys; dx_pending++) {
+        dx_keys[dx_pending].entry = dx_nentries;
+        dx_keys[dx_pending].offset = offset;
+        dx_keys[dx_pending].count = count;
+    }
+    dx_nentries++;
+}
+
+static void
+dx_putword(val)
+unsigned long val;
+{
+    (void) putc((int) (val & 0xff), ofp);
+    (void) putc((int) ((val >> 8) & 0xff), ofp);
+    (void) putc((int) ((val >> 16) & 0xff), ofp);
+    (void) putc((int) ((val >> 24) & 0xff), ofp);
+}
+
+/*
+ * Write 'dataidx' from the keys collected while writing 'data'.  Literal
+ * keys go into a hash table whose chains are kept in key order; keys with
+ * '*' or '?' wildcards are listed separately for checkfile() to scan.
+ */
+static void
+write_dataidx(txt_offset)
+long txt_offset;
+{
+    unsigned long nbuckets, *buckets, h, stroff, strsize;
+    int i, nwild = 0;
+    const char *p;
+
+    for (nbuckets = 16; nbuckets < 2UL * (unsigned long) dx_nkeys;)
+        nbuckets <<= 1;
+    buckets = (unsigned long *) malloc(nbuckets * sizeof *buckets);
+    if (!buckets) {
+        perror("dataidx buckets");
+        exit(EXIT_FAILURE);
+    }
+    for (h = 0; h < nbuckets; h++)
+        buckets[h] = DATAIDX_NONE;
+    for (i = 0, strsize = 0UL; i < dx_nkeys; i++)
+        strsize += strlen(dx_keys[i].name) + 1;
+    /* push in reverse so that each chain ends up in ascending order */
+    for (i = dx_nkeys - 1; i >= 0; i--) {
+        if (index(dx_keys[i].name, '*') || index(dx_keys[i].name, '?')) {
+            nwild++;
+            continue;
+        }
+        for (h = DATAIDX_HASHINIT, p = dx_keys[i].name; *p; p++)
+            h = DATAIDX_HASH(h, *p);
+        h &= nbuckets - 1;
+        dx_keys[i].next = buckets[h];
+        buckets[h] = (unsigned long) i;
+    }
+
+    filename[0] = '\0';
+#ifdef FILE_PREFIX
+    Strcat(filename, file_prefix);
+#endif
+    Sprintf(eos(filename), DATA_TEMPLATE, DATAIDX_FILE);
+    if (!(ofp = fopen(filename, WRBMODE))) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+    dx_putword(DATAIDX_MAGIC);
+    dx_putword(DATAIDX_VERSION);
+    dx_putword((unsigned long) txt_offset);
+    dx_putword(nbuckets);
+    dx_putword((unsigned long) dx_nkeys);
+    dx_putword((unsigned long) nwild);
+    dx_putword(strsize);
+    for (h = 0; h < nbuckets; h++)
+        dx_putword(buckets[h]);
+    for (i = 0, stroff = 0UL; i < dx_nkeys; i++) {
+        dx_putword(dx_keys[i].next);
+        dx_putword(stroff);
+        dx_putword(dx_keys[i].entry);
+        dx_putword(dx_keys[i].flags);
+        dx_putword((unsigned long) dx_keys[i].offset);
+        dx_putword((unsigned long) dx_keys[i].count);
+        stroff += strlen(dx_keys[i].name) + 1;
+    }
+    for (i = 0, stroff = 0UL; i < dx_nkeys; i++) {
+        if (index(dx_keys[i].name, '*') || index(dx_keys[i].name, '?')) {
+            dx_putword((unsigned long) i);
+            dx_putword(stroff);
+        }
+        stroff += strlen(dx_keys[i].name) + 1;
+    }
+    for (i = 0; i < dx_nkeys; i++)
+        (void) fwrite(dx_keys[i].name, strlen(dx_keys[i].name) + 1, 1, ofp);
+    if (fflush(ofp) != 0 || ferror(ofp)) {
+        perror(filename);
+        Fclose(ofp);
+        Unlink(filename);
+        exit(EXIT_FAILURE);
+    }
+    Fclose(ofp);
+
+    free((genericptr_t) buckets);
+    for (i = 0; i < dx_nkeys; i++)
+        free((genericptr_t) dx_keys[i].name);
+    free((genericptr_t) dx_keys);
+    dx_keys = 0;
+    dx_nkeys = dx_maxkeys = dx_pending = 0;
+    dx_nentries = 0;
+    dx_done = FALSE;
+}
+
 /*
  *
      New format (v3.1) of 'data' file which allows much faster lookups [pr]
@@ -1621,7 +1828,7 @@ do_data()
 {
     char infile[60], tempfile[60];
     boolean ok;
-    long txt_offset;
+    long txt_offset, entry_offset = 0L;
     int entry_cnt, line_cnt;
     char *line;
 
@@ -1666,15 +1873,21 @@ do_data()
         }
         if (*line > ' ') { /* got an entry name */
             /* first finish previous entry */
-            if (line_cnt)
-                Fprintf(ofp, "%d\n", line_cnt), line_cnt = 0;
+            if (line_cnt) {
+                Fprintf(ofp, "%d\n", line_cnt);
+                dx_endentry(entry_offset, line_cnt);
+                line_cnt = 0;
+            }
             /* output the entry name */
             (void) fputs(line, ofp);
+            dx_addkey(line);
             entry_cnt++;        /* update number of entries */
         } else if (entry_cnt) { /* got some descriptive text */
             /* update previous entry with current text offset */
-            if (!line_cnt)
-                Fprintf(ofp, "%ld,", ftell(tfp));
+            if (!line_cnt) {
+                entry_offset = ftell(tfp);
+                Fprintf(ofp, "%ld,", entry_offset);
+            }
             /* save the text line in the scratch file */
             (void) fputs(line, tfp);
             line_cnt++; /* update line counter */
@@ -1682,8 +1895,12 @@ do_data()
         free(line);
     }
     /* output an end marker and then record the current position */
-    if (line_cnt)
+    if (line_cnt) {
         Fprintf(ofp, "%d\n", line_cnt);
+        dx_endentry(entry_offset, line_cnt);
+    }
+    /* keys left without text share the dummy record that follows '.' */
+    dx_endentry(ftell(tfp), 0);
     Fprintf(ofp, ".\n%ld,%d\n", ftell(tfp), 0);
     txt_offset = ftell(ofp);
     Fclose(ifp); /* all done with original input file */
@@ -1727,6 +1944,8 @@ do_data()
     /* all done */
     Fclose(ofp);
 
+    /* now the index of its keys */
+    write_dataidx(txt_offset);
     return;
 }
 
@@ -0,0 +1,438 @@
+/* NetHack 3.6	winnull.c	$NHDT-Date$  $NHDT-Branch$:$NHDT-Revision$ */
+/* NetHack may be freely redistributed.  See license for details. */
+
+/*
+ * "null" is a window port that displays nothing at all.  Keystrokes and
+ * answers to prompts come from optional hooks supplied by the program
+ * that installs it; without hooks every request for input is answered
+ * with ESC.  It exists so that the game core can be driven without a
+ * terminal, as the benchmark harness in sys/unix/bench does.
+ *
+ * The procs table follows the layout used by win/chain.
+ */
+
+#include "hack.h"
+
+/* input hooks; may be left null */
+int NDECL((*null_getch_hook)) = 0;
+char FDECL((*null_yn_hook), (const char *, const char *, CHAR_P)) = 0;
+
+void FDECL(null_init_nhwindows, (int *, char **));
+void NDECL(null_player_selection);
+void NDECL(null_askname);
+void NDECL(null_get_nh_event);
+void FDECL(null_exit_nhwindows, (const char *));
+void FDECL(null_suspend_nhwindows, (const char *));
+void NDECL(null_resume_nhwindows);
+winid FDECL(null_create_nhwindow, (int));
+void FDECL(null_clear_nhwindow, (winid));
+void FDECL(null_display_nhwindow, (winid, BOOLEAN_P));
+void FDECL(null_destroy_nhwindow, (winid));
+void FDECL(null_curs, (winid, int, int));
+void FDECL(null_putstr, (winid, int, const char *));
+void FDECL(null_display_file, (const char *, BOOLEAN_P));
+void FDECL(null_start_menu, (winid));
+void FDECL(null_add_menu, (winid, int, const ANY_P *, CHAR_P, CHAR_P, int,
+                           const char *, BOOLEAN_P));
+void FDECL(null_end_menu, (winid, const char *));
+int FDECL(null_select_menu, (winid, int, MENU_ITEM_P **));
+void NDECL(null_update_inventory);
+void NDECL(null_mark_synch);
+void NDECL(null_wait_synch);
+#ifdef CLIPPING
+void FDECL(null_cliparound, (int, int));
+#endif
+#ifdef POSITIONBAR
+void FDECL(null_update_positionbar, (char *));
+#endif
+void FDECL(null_print_glyph, (winid, XCHAR_P, XCHAR_P, int, int));
+void FDECL(null_raw_print, (const char *));
+int NDECL(null_nhgetch);
+int FDECL(null_nh_poskey, (int *, int *, int *));
+void NDECL(null_nhbell);
+int NDECL(null_doprev_message);
+char FDECL(null_yn_function, (const char *, const char *, CHAR_P));
+void FDECL(null_getlin, (const char *, char *));
+int NDECL(null_get_ext_cmd);
+void FDECL(null_number_pad, (int));
+void NDECL(null_delay_output);
+void NDECL(null_start_screen);
+void NDECL(null_end_screen);
+void FDECL(null_outrip, (winid, int, time_t));
+#ifdef STATUS_VIA_WINDOWPORT
+void FDECL(null_status_update, (int, genericptr_t, int, int));
+#ifdef STATUS_HILITES
+void FDECL(null_status_threshold, (int, int, anything, int, int, int));
+#endif
+#endif
+
+/* menus remember their first selectable entry so that select_menu()
+   can return something useful to callers such as pickup */
+#define MAXNULLWIN 32
+static struct null_window {
+    boolean inuse;
+    boolean has_item;
+    anything first_item;
+} null_wins[MAXNULLWIN];
+
+void
+null_init_nhwindows(argcp, argv)
+int *argcp UNUSED;
+char **argv UNUSED;
+{
+    iflags.window_inited = TRUE;
+}
+
+/* pick anything the options left open; there is nobody to ask */
+void
+null_player_selection()
+{
+    rigid_role_checks();
+    if (flags.initrole < 0)
+        flags.initrole = pick_role(flags.initrace, flags.initgend,
+                                   flags.initalign, PICK_RANDOM);
+    if (flags.initrace < 0 || !validrace(flags.initrole, flags.initrace))
+        flags.initrace = pick_race(flags.initrole, flags.initgend,
+                                   flags.initalign, PICK_RANDOM);
+    if (flags.initgend < 0
+        || !validgend(flags.initrole, flags.initrace, flags.initgend))
+        flags.initgend = pick_gend(flags.initrole, flags.initrace,
+                                   flags.initalign, PICK_RANDOM);
+    if (flags.initalign < 0
+        || !validalign(flags.initrole, flags.initrace, flags.initalign))
+        flags.initalign = pick_align(flags.initrole, flags.initrace,
+                                     flags.initgend, PICK_RANDOM);
+}
+
+void
+null_askname()
+{
+    if (!*plname)
+        Strcpy(plname, "null");
+}
+
+void
+null_get_nh_event()
+{
+}
+
+void
+null_exit_nhwindows(str)
+const char *str;
+{
+    if (str && *str)
+        null_raw_print(str);
+    iflags.window_inited = FALSE;
+}
+
+void
+null_suspend_nhwindows(str)
+const char *str UNUSED;
+{
+}
+
+void
+null_resume_nhwindows()
+{
+}
+
+winid
+null_create_nhwindow(type)
+int type UNUSED;
+{
+    winid w;
+
+    for (w = 0; w < MAXNULLWIN; w++)
+        if (!null_wins[w].inuse) {
+            null_wins[w].inuse = TRUE;
+            null_wins[w].has_item = FALSE;
+            return w;
+        }
+    panic("null_create_nhwindow: no free windows");
+    /*NOTREACHED*/
+    return WIN_ERR;
+}
+
+void
+null_clear_nhwindow(window)
+winid window UNUSED;
+{
+}
+
+void
+null_display_nhwindow(window, blocking)
+winid window UNUSED;
+boolean blocking UNUSED;
+{
+}
+
+void
+null_destroy_nhwindow(window)
+winid window;
+{
+    if (window >= 0 && window < MAXNULLWIN)
+        null_wins[window].inuse = FALSE;
+}
+
+void
+null_curs(window, x, y)
+winid window UNUSED;
+int x UNUSED, y UNUSED;
+{
+}
+
+void
+null_putstr(window, attr, str)
+winid window UNUSED;
+int attr UNUSED;
+const char *str UNUSED;
+{
+}
+
+void
+null_display_file(fname, complain)
+const char *fname UNUSED;
+boolean complain UNUSED;
+{
+}
+
+void
+null_start_menu(window)
+winid window;
+{
+    if (window >= 0 && window < MAXNULLWIN)
+        null_wins[window].has_item = FALSE;
+}
+
+void
+null_add_menu(window, glyph, identifier, ch, gch, attr, str, preselected)
+winid window;
+int glyph UNUSED;
+const anything *identifier;
+char ch UNUSED, gch UNUSED;
+int attr UNUSED;
+const char *str UNUSED;
+boolean preselected UNUSED;
+{
+    if (window < 0 || window >= MAXNULLWIN || null_wins[window].has_item)
+        return;
+    if (identifier->a_void) {
+        null_wins[window].first_item = *identifier;
+        null_wins[window].has_item = TRUE;
+    }
+}
+
+void
+null_end_menu(window, prompt)
+winid window UNUSED;
+const char *prompt UNUSED;
+{
+}
+
+/* choose the first selectable entry, if any */
+int
+null_select_menu(window, how, menu_list)
+winid window;
+int how;
+menu_item **menu_list;
+{
+    *menu_list = (menu_item *) 0;
+    if (how == PICK_NONE || window < 0 || window >= MAXNULLWIN
+        || !null_wins[window].has_item)
+        return 0;
+    *menu_list = (menu_item *) alloc(sizeof(menu_item));
+    (*menu_list)->item = null_wins[window].first_item;
+    (*menu_list)->count = -1L;
+    return 1;
+}
+
+void
+null_update_inventory()
+{
+}
+
+void
+null_mark_synch()
+{
+}
+
+void
+null_wait_synch()
+{
+}
+
+#ifdef CLIPPING
+void
+null_cliparound(x, y)
+int x UNUSED, y UNUSED;
+{
+}
+#endif
+
+#ifdef POSITIONBAR
+void
+null_update_positionbar(posbar)
+char *posbar UNUSED;
+{
+}
+#endif
+
+void
+null_print_glyph(window, x, y, glyph, bkglyph)
+winid window UNUSED;
+xchar x UNUSED, y UNUSED;
+int glyph UNUSED, bkglyph UNUSED;
+{
+}
+
+/* raw output is reserved for errors, so it isn't suppressed */
+void
+null_raw_print(str)
+const char *str;
+{
+    (void) fprintf(stderr, "%s\n", str);
+}
+
+int
+null_nhgetch()
+{
+    return null_getch_hook ? (*null_getch_hook)() : '\033';
+}
+
+int
+null_nh_poskey(x, y, mod)
+int *x, *y, *mod;
+{
+    *x = *y = *mod = 0;
+    return null_nhgetch();
+}
+
+void
+null_nhbell()
+{
+}
+
+int
+null_doprev_message()
+{
+    return 0;
+}
+
+/* without a hook: decline when possible, else take the default */
+char
+null_yn_function(query, resp, def)
+const char *query, *resp;
+char def;
+{
+    if (null_yn_hook)
+        return (*null_yn_hook)(query, resp, def);
+    if (resp && index(resp, 'n'))
+        return 'n';
+    return def ? def : '\033';
+}
+
+void
+null_getlin(query, bufp)
+const char *query UNUSED;
+char *bufp;
+{
+    Strcpy(bufp, "\033");
+}
+
+int
+null_get_ext_cmd()
+{
+    return -1;
+}
+
+void
+null_number_pad(state)
+int state UNUSED;
+{
+}
+
+void
+null_delay_output()
+{
+}
+
+void
+null_start_screen()
+{
+}
+
+void
+null_end_screen()
+{
+}
+
+void
+null_outrip(tmpwin, how, when)
+winid tmpwin UNUSED;
+int how UNUSED;
+time_t when UNUSED;
+{
+}
+
+#ifdef STATUS_VIA_WINDOWPORT
+void
+null_status_update(idx, ptr, chg, percent)
+int idx UNUSED, chg UNUSED, percent UNUSED;
+genericptr_t ptr UNUSED;
+{
+}
+
+#ifdef STATUS_HILITES
+void
+null_status_threshold(fldidx, thresholdtype, threshold, behavior, under, over)
+int fldidx UNUSED, thresholdtype UNUSED;
+anything threshold UNUSED;
+int behavior UNUSED, under UNUSED, over UNUSED;
+{
+}
+#endif
+#endif
+
+struct window_procs null_procs = {
+    "null", 0, /* wincap */
+    0,         /* wincap2 */
+    null_init_nhwindows, null_player_selection, null_askname,
+    null_get_nh_event, null_exit_nhwindows, null_suspend_nhwindows,
+    null_resume_nhwindows, null_create_nhwindow, null_clear_nhwindow,
+    null_display_nhwindow, null_destroy_nhwindow, null_curs, null_putstr,
+    genl_putmixed, null_display_file, null_start_menu, null_add_menu,
+    null_end_menu, null_select_menu, genl_message_menu,
+    null_update_inventory, null_mark_synch, null_wait_synch,
+#ifdef CLIPPING
+    null_cliparound,
+#endif
+#ifdef POSITIONBAR
+    null_update_positionbar,
+#endif
+    null_print_glyph, null_raw_print, null_raw_print, null_nhgetch,
+    null_nh_poskey, null_nhbell, null_doprev_message, null_yn_function,
+    null_getlin, null_get_ext_cmd, null_number_pad, null_delay_output,
+#ifdef CHANGE_COLOR
+    donull, /* change_color */
+#ifdef MAC
+    donull, donull, /* change_background, set_font_name */
+#endif
+    donull, /* get_color_string */
+#endif
+
+    /* other defs that really should go away (they're tty specific) */
+    null_start_screen, null_end_screen,
+
+    null_outrip, genl_preference_update, genl_getmsghistory,
+    genl_putmsghistory,
+#ifdef STATUS_VIA_WINDOWPORT
+    genl_status_init, genl_status_finish, genl_status_enablefield,
+    null_status_update,
+#ifdef STATUS_HILITES
+    null_status_threshold,
+#endif
+#endif
+    genl_can_suspend_no,
+};
+
+/*winnull.c*/
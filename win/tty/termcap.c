@@ -17,6 +17,7 @@
 
 static char *FDECL(s_atr2str, (int));
 static char *FDECL(e_atr2str, (int));
+STATIC_DCL void FDECL(sgr_puts, (const char *));
 
 void FDECL(cmov, (int, int));
 void FDECL(nocmov, (int, int));
@@ -65,8 +66,15 @@ static char nullstr[] = "";
 
 #if defined(ASCIIGRAPH) && !defined(NO_TERMS)
 extern boolean HE_resets_AS;
+extern boolean GFlag;
+#endif
+#ifdef TEXTCOLOR
+extern boolean move_keeps_color; /* in wintty.c */
 #endif
 
+/* nothing has been turned on since nh_HE was last sent */
+static boolean sgr_plain = FALSE;
+
 #ifndef TERMLIB
 STATIC_VAR char tgotobuf[20];
 #ifdef TOS
@@ -161,6 +169,7 @@ int *wid, *hgt;
 #endif
         TE = VS = VE = nullstr;
 #ifdef TEXTCOLOR
+        move_keeps_color = TRUE;
         for (i = 0; i < CLR_MAX / 2; i++)
             if (i != CLR_BLACK) {
                 hilites[i | BRIGHT] = (char *) alloc(sizeof("\033[1;3%dm"));
@@ -310,6 +319,7 @@ int *wid, *hgt;
     nh_CD = Tgetstr("cd");
 #ifdef TEXTCOLOR
     MD = Tgetstr("md");
+    move_keeps_color = tgetflag("ms"); /* colour is only an attribute */
 #endif
 #ifdef TEXTCOLOR
 #if defined(TOS) && defined(__GNUC__)
@@ -473,6 +483,8 @@ tty_start_screen()
 {
     xputs(TI);
     xputs(VS);
+    sgr_plain = FALSE; /* who knows what was left on */
+    shadow_forget(-1);
 #ifdef PC9800
     if (!SYMHANDLING(H_IBM))
         tty_ascgraphics_hilite_fixup();
@@ -514,6 +526,133 @@ tty_end_screen()
    and or xputc() is taken out of the ROOT overlay, then action must be taken
    in trampoli.[ch]. */
 
+/*
+ * Cursor motion is chosen by cost: cmov() compares the length of the
+ * terminal's absolute motion string with single steps (up, down, left,
+ * right, optionally after a carriage return) and with rewriting map
+ * characters that are already on the screen, and sends the shortest.
+ * For the last, shadow[][] remembers what tty_print_glyph() has put at
+ * each map location, and in which colour; anything else that writes to
+ * a row makes it forget that row.
+ */
+#define NO_MOVE 10000 /* cost of a motion the terminal can't do */
+
+static struct shadow_cell {
+    char ch;     /* 0 if unknown */
+    schar color; /* colour it was drawn in, NO_COLOR for none */
+} shadow[ROWNO + 1][COLNO];
+
+STATIC_DCL int FDECL(rewrite_cost, (int, int, int));
+STATIC_DCL int FDECL(step_cost, (int, int, int, int, BOOLEAN_P));
+STATIC_DCL void FDECL(step_to, (int, int, BOOLEAN_P));
+
+/* tty_print_glyph() put ch at <x,y> with the terminal in this colour */
+void
+shadow_glyph(x, y, ch, color)
+int x, y, ch, color;
+{
+    if (y >= 0 && y <= ROWNO && x >= 0 && x < COLNO) {
+        shadow[y][x].ch = (ch >= ' ' && ch < '\177') ? (char) ch : '\0';
+        shadow[y][x].color = (schar) color;
+    }
+}
+
+/* something else may have been written on a row; row < 0 for all */
+void
+shadow_forget(row)
+int row;
+{
+    if (row < 0)
+        (void) memset((genericptr_t) shadow, 0, sizeof shadow);
+    else if (row <= ROWNO)
+        (void) memset((genericptr_t) shadow[row], 0, sizeof shadow[row]);
+}
+
+/* bytes needed to move right from col to x on row y by rewriting */
+STATIC_OVL int
+rewrite_cost(y, col, x)
+int y, col, x;
+{
+    int i, color = NO_COLOR;
+
+#ifdef TEXTCOLOR
+    color = ttyDisplay->color;
+#endif
+#if defined(ASCIIGRAPH)
+    if (GFlag)
+        return NO_MOVE;
+#endif
+    if (y > ROWNO || x > COLNO)
+        return NO_MOVE;
+    for (i = col; i < x; i++)
+        if (!shadow[y][i].ch || shadow[y][i].color != color)
+            return NO_MOVE;
+    return x - col;
+}
+
+/* bytes needed to step from <col,row> to <x,y>, after '\r' if cr */
+STATIC_OVL int
+step_cost(col, row, x, y, cr)
+int col, row, x, y;
+boolean cr;
+{
+    int cost = 0, n;
+
+    if (cr)
+        col = 0, cost = 1;
+    if (y < row)
+        cost += UP ? (row - y) * (int) strlen(UP) : NO_MOVE;
+    else if (y > row)
+        /* a linefeed is one step down if it can't move us sideways */
+        cost += (y - row) * ((!col && (!XD || strlen(XD) > 1)) ? 1
+                             : XD ? (int) strlen(XD) : NO_MOVE);
+    if (x < col) {
+        cost += (col - x) * (int) strlen(BC);
+    } else if (x > col) {
+        n = nh_ND ? (x - col) * (int) strlen(nh_ND) : NO_MOVE;
+        cost += min(n, rewrite_cost(y, col, x));
+    }
+    return min(cost, NO_MOVE);
+}
+
+/* carry out the moves that step_cost() priced */
+STATIC_OVL void
+step_to(x, y, cr)
+int x, y;
+boolean cr;
+{
+    int col;
+
+    if (cr) {
+        xputc('\r');
+        ttyDisplay->curx = 0;
+    }
+    while ((int) ttyDisplay->cury > y) {
+        xputs(UP);
+        ttyDisplay->cury--;
+    }
+    while ((int) ttyDisplay->cury < y) {
+        if (!ttyDisplay->curx && (!XD || strlen(XD) > 1))
+            xputc('\n');
+        else
+            xputs(XD);
+        ttyDisplay->cury++;
+    }
+    col = ttyDisplay->curx;
+    if (x < col) {
+        while (col-- > x)
+            xputs(BC);
+    } else if (x > col) {
+        if (!nh_ND || rewrite_cost(y, col, x) < (x - col) * (int) strlen(nh_ND))
+            for (; col < x; col++)
+                xputc(shadow[y][col].ch);
+        else
+            for (; col < x; col++)
+                xputs(nh_ND);
+    }
+    ttyDisplay->curx = x;
+}
+
 void
 nocmov(x, y)
 int x, y;
@@ -547,10 +686,12 @@ int x, y;
         }
     }
     if ((int) ttyDisplay->curx < x) { /* Go to the right. */
-        if (!nh_ND) {
+        if ((int) ttyDisplay->cury == y
+            && rewrite_cost(y, (int) ttyDisplay->curx, x) < NO_MOVE) {
+            step_to(x, y, FALSE); /* reprint what is there already */
+        } else if (!nh_ND) {
             cmov(x, y);
         } else { /* bah */
-             /* should instead print what is there already */
             while ((int) ttyDisplay->curx < x) {
                 xputs(nh_ND);
                 ttyDisplay->curx++;
@@ -568,7 +709,22 @@ void
 cmov(x, y)
 register int x, y;
 {
-    xputs(tgoto(nh_CM, x, y));
+    const char *cm = tgoto(nh_CM, x, y);
+    int cx = ttyDisplay->curx, cy = ttyDisplay->cury;
+    int best = (int) strlen(cm), here, there;
+
+    /* moving to where we are resends the sequence (see delay_output);
+       past the last column, where the cursor is isn't certain */
+    if ((x != cx || y != cy) && cx < CO) {
+        here = step_cost(cx, cy, x, y, FALSE);
+        there = step_cost(cx, cy, x, y, TRUE);
+        if (here < best || there < best) {
+            step_to(x, y, (boolean) (there < here));
+            ttyDisplay->cury = y;
+            return;
+        }
+    }
+    xputs(cm);
     ttyDisplay->cury = y;
     ttyDisplay->curx = x;
 }
@@ -603,6 +759,7 @@ const char *s;
 void
 cl_end()
 {
+    shadow_forget((int) ttyDisplay->cury);
     if (CE) {
         xputs(CE);
     } else { /* no-CE fix - free after Harold Rynes */
@@ -629,6 +786,7 @@ clear_screen()
         xputs(CL);
         home();
     }
+    shadow_forget(-1);
 }
 
 void
@@ -647,14 +805,14 @@ void
 standoutbeg()
 {
     if (SO)
-        xputs(SO);
+        sgr_puts(SO);
 }
 
 void
 standoutend()
 {
     if (SE)
-        xputs(SE);
+        sgr_puts(SE);
 }
 
 #if 0 /* if you need one of these, uncomment it (here and in extern.h) */
@@ -714,8 +872,10 @@ tty_nhbell()
 void
 graph_on()
 {
-    if (AS)
+    if (AS) {
         xputs(AS);
+        sgr_plain = FALSE; /* nh_HE might be needed to undo it */
+    }
 }
 
 void
@@ -797,6 +957,7 @@ tty_delay_output()
 void
 cl_eos() /* free after Robert Viduya */
 {
+    shadow_forget(-1);
     if (nh_CD) {
         xputs(nh_CD);
     } else {
@@ -1201,12 +1362,32 @@ int n;
     return nulstr;
 }
 
+/*
+ * Send an attribute or colour sequence.  Turning everything off with
+ * nh_HE when nothing has been turned on since the last time is skipped;
+ * tty_print_glyph() would otherwise often send it twice in a row, once
+ * to end reverse video and again to end the colour.
+ */
+STATIC_OVL void
+sgr_puts(s)
+const char *s;
+{
+    boolean plain;
+
+    if (!s || !*s)
+        return;
+    if ((plain = !strcmp(s, nh_HE)) && sgr_plain)
+        return;
+    xputs(s);
+    sgr_plain = plain;
+}
+
 void
 term_start_attr(attr)
 int attr;
 {
     if (attr) {
-        xputs(s_atr2str(attr));
+        sgr_puts(s_atr2str(attr));
     }
 }
 
@@ -1215,20 +1396,20 @@ term_end_attr(attr)
 int attr;
 {
     if (attr) {
-        xputs(e_atr2str(attr));
+        sgr_puts(e_atr2str(attr));
     }
 }
 
 void
 term_start_raw_bold()
 {
-    xputs(nh_HI);
+    sgr_puts(nh_HI);
 }
 
 void
 term_end_raw_bold()
 {
-    xputs(nh_HE);
+    sgr_puts(nh_HE);
 }
 
 #ifdef TEXTCOLOR
@@ -1236,14 +1417,14 @@ term_end_raw_bold()
 void
 term_end_color()
 {
-    xputs(nh_HE);
+    sgr_puts(nh_HE);
 }
 
 void
 term_start_color(color)
 int color;
 {
-    xputs(hilites[color]);
+    sgr_puts(hilites[color]);
 }
 
 int
@@ -107,7 +107,9 @@ struct DisplayDesc *ttyDisplay; /* the tty display descriptor */
 extern void FDECL(cmov, (int, int));   /* from termcap.c */
 extern void FDECL(nocmov, (int, int)); /* from termcap.c */
 #if defined(UNIX) || defined(VMS)
-static char obuf[BUFSIZ]; /* BUFSIZ is defined in stdio.h */
+/* BUFSIZ is defined in stdio.h; room for redrawing the whole screen
+   in colour, so that each flush is usually a single write */
+static char obuf[4 * BUFSIZ];
 #endif
 
 static char winpanicstr[] = "Bad window id %d";
@@ -132,6 +134,9 @@ extern void FDECL(adjust_cursor_flags, (struct WinDesc *));
 boolean GFlag = FALSE;
 boolean HE_resets_AS; /* see termcap.c */
 #endif
+#if defined(TEXTCOLOR) && !defined(NO_TERMS)
+boolean move_keeps_color; /* terminal can move the cursor while in colour */
+#endif
 
 #if defined(MICRO) || defined(WIN32CON)
 static const char to_continue[] = "to continue";
@@ -278,7 +283,7 @@ char **argv UNUSED;
  *    due to ordering of graphics settings
  */
 #if defined(UNIX) || defined(VMS)
-    setbuf(stdout, obuf);
+    (void) setvbuf(stdout, obuf, _IOFBF, sizeof obuf);
 #endif
     gettty();
 
@@ -2245,10 +2250,28 @@ register int x, y; /* not xchar: perhaps xchar is unsigned and
     if (y == cy && x == cx)
         return;
 
-    if (cw->type == NHW_MAP)
-        end_glyphout();
-
+    if (cw->type == NHW_MAP) {
+#if defined(TEXTCOLOR) && !defined(NO_TERMS)
+        /* leave the colour on for the next glyph if it's safe to move */
+        if (move_keeps_color) {
+#ifdef ASCIIGRAPH
+            if (GFlag) {
+                GFlag = FALSE;
+                graph_off();
+            }
+#endif
+        } else
+#endif
+            end_glyphout();
+    }
 #ifndef NO_TERMS
+    else
+        shadow_forget(y); /* text is about to go on this row */
+
+    if (nh_CM) { /* picks the cheapest way of getting there */
+        cmov(x, y);
+        return;
+    }
     if (!nh_ND && (cx != x || x <= 3)) { /* Extremely primitive */
         cmov(x, y);                      /* bunker!wtm */
         return;
@@ -2292,6 +2315,9 @@ char ch;
     case NHW_MAP:
     case NHW_BASE:
         tty_curs(window, x, y);
+#ifndef NO_TERMS
+        shadow_forget((int) ttyDisplay->cury);
+#endif
         (void) putchar(ch);
         ttyDisplay->curx++;
         cw->curx++;
@@ -3084,6 +3110,16 @@ int bkglyph UNUSED;
     else
 #endif
         g_putch(ch); /* print the character */
+#ifndef NO_TERMS
+    shadow_glyph((int) ttyDisplay->curx, (int) ttyDisplay->cury,
+                 (reverse_on || (ch & 0x80)) ? 0 : ch,
+#ifdef TEXTCOLOR
+                 ttyDisplay->color
+#else
+                 NO_COLOR
+#endif
+                 );
+#endif
 
     if (reverse_on) {
         term_end_attr(ATR_INVERSE);
@@ -3106,6 +3142,9 @@ const char *str;
 {
     if (ttyDisplay)
         ttyDisplay->rawprint++;
+#ifndef NO_TERMS
+    shadow_forget(-1); /* may scroll */
+#endif
 #if defined(MICRO) || defined(WIN32CON)
     msmsg("%s\n", str);
 #else
@@ -3120,6 +3159,9 @@ const char *str;
 {
     if (ttyDisplay)
         ttyDisplay->rawprint++;
+#ifndef NO_TERMS
+    shadow_forget(-1);
+#endif
     term_start_raw_bold();
 #if defined(MICRO) || defined(WIN32CON)
     msmsg("%s", str);